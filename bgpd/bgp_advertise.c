@@ -25,6 +25,112 @@
 #include "bgpd/bgp_mplsvpn.h"
 #include "bgpd/bgp_updgrp.h"
 
+DEFINE_MTYPE_STATIC(BGPD, BGP_ADJ_OUT_SET, "BGP adj-out set");
+
+/* Grow the array in steps, most dests never go past the first one */
+#define BGP_ADJ_OUT_SET_MIN 4
+
+static inline bool bgp_adj_out_before(const struct bgp_adj_out *adj,
+				      const struct update_subgroup *subgrp,
+				      uint32_t addpath_tx_id)
+{
+	if (adj->subgroup != subgrp)
+		return (uintptr_t)adj->subgroup < (uintptr_t)subgrp;
+
+	return adj->addpath_tx_id < addpath_tx_id;
+}
+
+/* Index of the first entry not sorted before (subgrp, addpath_tx_id) */
+static uint32_t bgp_adj_out_set_bound(const struct bgp_adj_out_set *set,
+				      const struct update_subgroup *subgrp,
+				      uint32_t addpath_tx_id)
+{
+	struct bgp_adj_out *const *adjs = bgp_adj_out_set_array(set);
+	uint32_t lo = 0, hi = set->count, mid;
+
+	while (lo < hi) {
+		mid = lo + (hi - lo) / 2;
+		if (bgp_adj_out_before(adjs[mid], subgrp, addpath_tx_id))
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+
+	return lo;
+}
+
+struct bgp_adj_out *bgp_adj_out_set_find(const struct bgp_adj_out_set *set,
+					 const struct update_subgroup *subgrp,
+					 uint32_t addpath_tx_id)
+{
+	struct bgp_adj_out *const *adjs = bgp_adj_out_set_array(set);
+	uint32_t i;
+
+	i = bgp_adj_out_set_bound(set, subgrp, addpath_tx_id);
+	if (i == set->count || adjs[i]->subgroup != subgrp ||
+	    adjs[i]->addpath_tx_id != addpath_tx_id)
+		return NULL;
+
+	return adjs[i];
+}
+
+void bgp_adj_out_set_add(struct bgp_adj_out_set *set, struct bgp_adj_out *adj)
+{
+	struct bgp_adj_out *first;
+	uint32_t i;
+
+	if (!set->count) {
+		set->one = adj;
+		set->count = 1;
+		return;
+	}
+
+	if (!set->size) {
+		first = set->one;
+		set->size = BGP_ADJ_OUT_SET_MIN;
+		set->many = XMALLOC(MTYPE_BGP_ADJ_OUT_SET,
+				    set->size * sizeof(*set->many));
+		set->many[0] = first;
+	} else if (set->count == set->size) {
+		set->size *= 2;
+		set->many = XREALLOC(MTYPE_BGP_ADJ_OUT_SET, set->many,
+				     set->size * sizeof(*set->many));
+	}
+
+	i = bgp_adj_out_set_bound(set, adj->subgroup, adj->addpath_tx_id);
+	memmove(&set->many[i + 1], &set->many[i],
+		(set->count - i) * sizeof(*set->many));
+	set->many[i] = adj;
+	set->count++;
+}
+
+void bgp_adj_out_set_del(struct bgp_adj_out_set *set, struct bgp_adj_out *adj)
+{
+	struct bgp_adj_out *last;
+	uint32_t i;
+
+	i = bgp_adj_out_set_bound(set, adj->subgroup, adj->addpath_tx_id);
+	assert(i < set->count && bgp_adj_out_set_array(set)[i] == adj);
+
+	if (!set->size) {
+		set->one = NULL;
+		set->count = 0;
+		return;
+	}
+
+	memmove(&set->many[i], &set->many[i + 1],
+		(set->count - i - 1) * sizeof(*set->many));
+	set->count--;
+
+	/* back to the inline entry */
+	if (set->count == 1) {
+		last = set->many[0];
+		XFREE(MTYPE_BGP_ADJ_OUT_SET, set->many);
+		set->size = 0;
+		set->one = last;
+	}
+}
+
 /* BGP advertise attribute is used for pack same attribute update into
    one packet.  To do that we maintain attribute hash in struct
    peer.  */
@@ -136,8 +242,9 @@ bool bgp_adj_out_lookup(struct peer *peer, struct bgp_dest *dest,
 	afi_t afi;
 	safi_t safi;
 	bool addpath_capable;
+	uint32_t i;
 
-	RB_FOREACH (adj, bgp_adj_out_rb, &dest->adj_out)
+	BGP_ADJ_OUT_FOREACH (&dest->adj_out, adj, i)
 		SUBGRP_FOREACH_PEER (adj->subgroup, paf)
 			if (paf->peer == peer) {
 				afi = SUBGRP_AFI(adj->subgroup);
@@ -55,9 +55,6 @@ struct bgp_advertise_attr {
 
 /* BGP adjacency out.  */
 struct bgp_adj_out {
-	/* RB Tree of adjacency entries */
-	RB_ENTRY(bgp_adj_out) adj_entry;
-
 	/* Advertised subgroup.  */
 	struct update_subgroup *subgroup;
 
@@ -79,9 +76,45 @@ struct bgp_adj_out {
 	struct bgp_advertise *adv;
 };
 
-RB_HEAD(bgp_adj_out_rb, bgp_adj_out);
-RB_PROTOTYPE(bgp_adj_out_rb, bgp_adj_out, adj_entry,
-	     bgp_adj_out_compare);
+/*
+ * The adj-out entries of one dest, sorted by subgroup and addpath id.
+ *
+ * A dest is advertised to a handful of subgroups at most, so a sorted
+ * array of pointers is smaller and faster to search than a tree with a
+ * node embedded in every entry.  A single entry, by far the most common
+ * case, is stored inline without an array.
+ */
+struct bgp_adj_out_set {
+	union {
+		struct bgp_adj_out *one;
+		struct bgp_adj_out **many;
+	};
+	uint32_t count;
+	uint32_t size;
+};
+
+static inline struct bgp_adj_out *const *
+bgp_adj_out_set_array(const struct bgp_adj_out_set *set)
+{
+	return set->size ? set->many : &set->one;
+}
+
+static inline bool bgp_adj_out_set_empty(const struct bgp_adj_out_set *set)
+{
+	return set->count == 0;
+}
+
+/* Walks the entries of a set.  The _SAFE variant runs backwards so that
+ * the current entry may be removed from the set.
+ */
+#define BGP_ADJ_OUT_FOREACH(set, adj, i)                                       \
+	for ((i) = 0; (i) < (set)->count &&                                    \
+		      ((adj) = bgp_adj_out_set_array(set)[(i)], true);         \
+	     (i)++)
+
+#define BGP_ADJ_OUT_FOREACH_SAFE(set, adj, i)                                  \
+	for ((i) = (set)->count;                                               \
+	     (i)-- > 0 && ((adj) = bgp_adj_out_set_array(set)[(i)], true);)
 
 /* BGP adjacency in. */
 struct bgp_adj_in {
@@ -100,6 +133,9 @@ struct bgp_adj_in {
 
 	/* Addpath identifier */
 	uint32_t addpath_rx_id;
+
+	/* Queued for inbound soft reconfiguration */
+	bool soft_reconfig;
 };
 
 /* BGP advertisement list.  */
@@ -132,6 +168,15 @@ struct bgp_synchronize {
 #define BGP_ADJ_IN_DEL(N, A) BGP_PATH_INFO_DEL(N, A, adj_in)
 
 /* Prototypes.  */
+extern struct bgp_adj_out *
+bgp_adj_out_set_find(const struct bgp_adj_out_set *set,
+		     const struct update_subgroup *subgrp,
+		     uint32_t addpath_tx_id);
+extern void bgp_adj_out_set_add(struct bgp_adj_out_set *set,
+				struct bgp_adj_out *adj);
+extern void bgp_adj_out_set_del(struct bgp_adj_out_set *set,
+				struct bgp_adj_out *adj);
+
 extern bool bgp_adj_out_lookup(struct peer *peer, struct bgp_dest *dest,
 			       uint32_t addpath_tx_id);
 extern void bgp_adj_in_set(struct bgp_dest *dest, struct peer *peer,
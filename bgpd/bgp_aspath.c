@@ -74,6 +74,9 @@ struct assegment_header {
 /* Hash for aspath.  This is the top level structure of AS path. */
 static struct hash *ashash;
 
+/* Last serial handed out to a newly interned aspath. */
+static uint32_t aspath_serial;
+
 /* Stream for SNMP. See aspath_snmp_pathseg */
 static struct stream *snmp_stream;
 
@@ -674,6 +677,8 @@ struct aspath *aspath_intern(struct aspath *aspath)
 	if (find != aspath)
 		aspath_free(aspath);
 
+	if (!find->refcnt)
+		find->serial = ++aspath_serial;
 	find->refcnt++;
 
 	return find;
@@ -865,7 +870,8 @@ struct aspath *aspath_parse(struct stream *s, size_t length, int use32bit,
 			json_object_free(as.json);
 			as.json = NULL;
 		}
-	}
+	} else
+		find->serial = ++aspath_serial;
 
 	find->refcnt++;
 
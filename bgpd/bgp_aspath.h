@@ -61,6 +61,11 @@ struct aspath {
 
 	/* AS notation used by string expression of AS path */
 	enum asnotation_mode asnotation;
+
+	/* Set when interned, distinguishes an AS path from earlier ones that
+	   lived at the same address.  Lets filter results be cached by
+	   pointer. */
+	uint32_t serial;
 };
 
 #define ASPATH_STR_DEFAULT_LEN 32
@@ -8,6 +8,7 @@
 #include "linklist.h"
 #include "prefix.h"
 #include "memory.h"
+#include "mempool.h"
 #include "vector.h"
 #include "stream.h"
 #include "log.h"
@@ -42,6 +43,11 @@
 #include "bgp_flowspec_private.h"
 #include "bgp_mac.h"
 
+/* Interned attributes, one per distinct attribute set */
+DEFINE_MEMPOOL_STATIC(ATTR, MTYPE_ATTR, sizeof(struct attr));
+DEFINE_MTYPE_STATIC(BGPD, ATTR_EXT, "BGP attribute extension");
+DEFINE_MEMPOOL_STATIC(ATTR_EXT, MTYPE_ATTR_EXT, sizeof(struct attr_ext));
+
 /* Attribute strings for logging. */
 static const struct message attr_str[] = {
 	{BGP_ATTR_ORIGIN, "ORIGIN"},
@@ -383,19 +389,6 @@ static void encap_finish(void)
 #endif
 }
 
-static bool overlay_index_same(const struct attr *a1, const struct attr *a2)
-{
-	if (!a1 && a2)
-		return false;
-	if (!a2 && a1)
-		return false;
-	if (!a1 && !a2)
-		return true;
-
-	return bgp_route_evpn_same(bgp_attr_get_evpn_overlay(a1),
-				   bgp_attr_get_evpn_overlay(a2));
-}
-
 /* Unknown transit attribute. */
 static struct hash *transit_hash;
 
@@ -743,6 +736,196 @@ static void transit_finish(void)
 	hash_clean_and_free(&transit_hash, (void (*)(void *))transit_free);
 }
 
+/* Out of line attribute values, see struct attr_ext. */
+static struct hash *attr_ext_hash;
+
+const struct bgp_route_evpn bgp_route_evpn_none;
+
+static bool attr_ext_empty(const struct attr_ext *ext)
+{
+	return !ext->aigp_metric && !ext->link_bw && !ext->otc &&
+	       !ext->srte_color && !ext->rmap_table_id && !ext->mm_seqnum &&
+	       !ext->mm_sync_seqnum && !ext->encap_tunneltype &&
+	       !ext->df_pref && !ext->df_alg && !ext->router_flag &&
+	       !ext->sticky && !ext->default_gw &&
+	       bgp_route_evpn_same(&ext->evpn_overlay, &bgp_route_evpn_none);
+}
+
+static unsigned int attr_ext_hash_key_make(const void *p)
+{
+	const struct attr_ext *ext = p;
+	uint32_t key = 0;
+
+	if (ext->refcnt)
+		return ext->key;
+	if (attr_ext_empty(ext))
+		return 0;
+
+	key = jhash_2words(ext->aigp_metric >> 32, ext->aigp_metric, key);
+	key = jhash_2words(ext->link_bw >> 32, ext->link_bw, key);
+	key = jhash_3words(ext->otc, ext->srte_color, ext->rmap_table_id, key);
+	key = jhash_3words(ext->mm_seqnum, ext->mm_sync_seqnum,
+			   ext->encap_tunneltype, key);
+	key = jhash_3words(ext->df_pref, ext->df_alg,
+			   ext->router_flag | ext->sticky << 8 |
+				   ext->default_gw << 16,
+			   key);
+	key = jhash_1word(ext->evpn_overlay.type, key);
+	key = jhash(&ext->evpn_overlay.eth_s_id, sizeof(esi_t), key);
+
+	return key;
+}
+
+static bool attr_ext_same(const struct attr_ext *ext1,
+			  const struct attr_ext *ext2)
+{
+	static const struct attr_ext empty;
+
+	if (ext1 == ext2)
+		return true;
+
+	/* Interned blocks are unique */
+	if (ext1 && ext2 && ext1->refcnt && ext2->refcnt)
+		return false;
+
+	if (!ext1)
+		ext1 = &empty;
+	if (!ext2)
+		ext2 = &empty;
+
+	return ext1->aigp_metric == ext2->aigp_metric &&
+	       ext1->link_bw == ext2->link_bw && ext1->otc == ext2->otc &&
+	       ext1->srte_color == ext2->srte_color &&
+	       ext1->rmap_table_id == ext2->rmap_table_id &&
+	       ext1->mm_seqnum == ext2->mm_seqnum &&
+	       ext1->mm_sync_seqnum == ext2->mm_sync_seqnum &&
+	       ext1->encap_tunneltype == ext2->encap_tunneltype &&
+	       ext1->df_pref == ext2->df_pref && ext1->df_alg == ext2->df_alg &&
+	       ext1->router_flag == ext2->router_flag &&
+	       ext1->sticky == ext2->sticky &&
+	       ext1->default_gw == ext2->default_gw &&
+	       bgp_route_evpn_same(&ext1->evpn_overlay, &ext2->evpn_overlay);
+}
+
+static bool attr_ext_hash_cmp(const void *p1, const void *p2)
+{
+	return attr_ext_same(p1, p2);
+}
+
+static void *attr_ext_hash_alloc(void *p)
+{
+	const struct attr_ext *val = p;
+	struct attr_ext *ext;
+
+	ext = mempool_alloc(MPOOL_ATTR_EXT);
+	*ext = *val;
+	ext->refcnt = 0;
+	ext->owner = NULL;
+	ext->key = attr_ext_hash_key_make(ext);
+
+	return ext;
+}
+
+/*
+ * Intern attr->ext.  A private copy made for attr itself is handed over to
+ * the hash, or freed if an equal block is interned already; one borrowed
+ * through a struct copy of another attr is left to that attr.
+ */
+static void attr_ext_intern(struct attr *attr)
+{
+	struct attr_ext *ext = attr->ext;
+	struct attr_ext *find = NULL;
+
+	if (!ext)
+		return;
+
+	if (ext->refcnt) {
+		ext->refcnt++;
+		return;
+	}
+
+	if (ext->owner == attr) {
+		if (!attr_ext_empty(ext)) {
+			find = hash_get(attr_ext_hash, ext, hash_alloc_intern);
+			if (find == ext) {
+				ext->owner = NULL;
+				ext->key = attr_ext_hash_key_make(ext);
+			}
+		}
+		if (find != ext)
+			MPFREE(MPOOL_ATTR_EXT, ext);
+	} else if (!attr_ext_empty(ext))
+		find = hash_get(attr_ext_hash, ext, attr_ext_hash_alloc);
+
+	if (find)
+		find->refcnt++;
+	attr->ext = find;
+}
+
+static void attr_ext_unintern(struct attr_ext **pext)
+{
+	struct attr_ext *ext = *pext;
+
+	*pext = NULL;
+
+	/* Private copies are freed by bgp_attr_flush_ext() */
+	if (!ext || !ext->refcnt)
+		return;
+
+	if (--ext->refcnt == 0) {
+		hash_release(attr_ext_hash, ext);
+		MPFREE(MPOOL_ATTR_EXT, ext);
+	}
+}
+
+struct attr_ext *bgp_attr_ext_mut(struct attr *attr)
+{
+	struct attr_ext *ext = attr->ext;
+
+	if (ext && ext->owner == attr)
+		return ext;
+
+	/* Interned, or borrowed from the attr this one was copied from */
+	ext = mempool_alloc(MPOOL_ATTR_EXT);
+	if (attr->ext)
+		*ext = *attr->ext;
+	ext->refcnt = 0;
+	ext->key = 0;
+	ext->owner = attr;
+
+	attr->ext = ext;
+	return ext;
+}
+
+void bgp_attr_flush_ext(struct attr *attr)
+{
+	if (attr->ext && attr->ext->owner == attr) {
+		MPFREE(MPOOL_ATTR_EXT, attr->ext);
+		attr->ext = NULL;
+	}
+}
+
+unsigned long int attr_ext_count(void)
+{
+	return attr_ext_hash->count;
+}
+
+static void attr_ext_init(void)
+{
+	attr_ext_hash = hash_create(attr_ext_hash_key_make, attr_ext_hash_cmp,
+				    "BGP Attribute Extensions");
+}
+
+static void attr_ext_vfree(void *ext)
+{
+	MPFREE(MPOOL_ATTR_EXT, ext);
+}
+
+static void attr_ext_finish(void)
+{
+	hash_clean_and_free(&attr_ext_hash, attr_ext_vfree);
+}
+
 /* Attribute hash routines. */
 static struct hash *attrhash;
 
@@ -800,11 +983,9 @@ unsigned int attrhash_key_make(const void *p)
 	key = jhash(attr->mp_nexthop_global.s6_addr, IPV6_MAX_BYTELEN, key);
 	key = jhash(attr->mp_nexthop_local.s6_addr, IPV6_MAX_BYTELEN, key);
 	MIX3(attr->nh_ifindex, attr->nh_lla_ifindex, attr->distance);
-	MIX(attr->rmap_table_id);
 	MIX(attr->nh_type);
 	MIX(attr->bh_type);
-	MIX(attr->otc);
-	MIX(bgp_attr_get_aigp_metric(attr));
+	MIX(attr->ext ? attr_ext_hash_key_make(attr->ext) : 0);
 
 	return key;
 }
@@ -839,10 +1020,7 @@ bool attrhash_cmp(const void *p1, const void *p2)
 			    bgp_attr_get_cluster(attr2) &&
 		    bgp_attr_get_transit(attr1) ==
 			    bgp_attr_get_transit(attr2) &&
-		    bgp_attr_get_aigp_metric(attr1) ==
-			    bgp_attr_get_aigp_metric(attr2) &&
-		    attr1->rmap_table_id == attr2->rmap_table_id &&
-		    (attr1->encap_tunneltype == attr2->encap_tunneltype) &&
+		    attr_ext_same(attr1->ext, attr2->ext) &&
 		    encap_same(attr1->encap_subtlvs, attr2->encap_subtlvs)
 #ifdef ENABLE_BGP_VNC
 		    && encap_same(bgp_attr_get_vnc_subtlvs(attr1),
@@ -856,22 +1034,16 @@ bool attrhash_cmp(const void *p1, const void *p2)
 				   &attr2->mp_nexthop_global_in) &&
 		    IPV4_ADDR_SAME(&attr1->originator_id,
 				   &attr2->originator_id) &&
-		    overlay_index_same(attr1, attr2) &&
 		    !memcmp(&attr1->esi, &attr2->esi, sizeof(esi_t)) &&
 		    attr1->es_flags == attr2->es_flags &&
-		    attr1->mm_sync_seqnum == attr2->mm_sync_seqnum &&
-		    attr1->df_pref == attr2->df_pref &&
-		    attr1->df_alg == attr2->df_alg &&
 		    attr1->nh_ifindex == attr2->nh_ifindex &&
 		    attr1->nh_lla_ifindex == attr2->nh_lla_ifindex &&
 		    attr1->nh_flags == attr2->nh_flags &&
 		    attr1->distance == attr2->distance &&
 		    srv6_l3vpn_same(attr1->srv6_l3vpn, attr2->srv6_l3vpn) &&
 		    srv6_vpn_same(attr1->srv6_vpn, attr2->srv6_vpn) &&
-		    attr1->srte_color == attr2->srte_color &&
 		    attr1->nh_type == attr2->nh_type &&
-		    attr1->bh_type == attr2->bh_type &&
-		    attr1->otc == attr2->otc)
+		    attr1->bh_type == attr2->bh_type)
 			return true;
 	}
 
@@ -889,7 +1061,7 @@ static void attrhash_init(void)
  */
 static void attr_vfree(void *attr)
 {
-	XFREE(MTYPE_ATTR, attr);
+	MPFREE(MPOOL_ATTR, attr);
 }
 
 static void attrhash_finish(void)
@@ -914,7 +1086,8 @@ static void attr_show_all_iterator(struct hash_bucket *bucket, struct vty *vty)
 		" distance: %u med: %u local_pref: %u origin: %u weight: %u label: %u sid: %pI6 aigp_metric: %" PRIu64
 		"\n",
 		attr->flag, attr->distance, attr->med, attr->local_pref,
-		attr->origin, attr->weight, attr->label, sid, attr->aigp_metric);
+		attr->origin, attr->weight, attr->label, sid,
+		bgp_attr_get_aigp_metric(attr));
 	vty_out(vty, "\taspath: %s Community: %s Large Community: %s\n",
 		aspath_print(attr->aspath),
 		community_str(attr->community, false, false),
@@ -936,7 +1109,7 @@ static void *bgp_attr_hash_alloc(void *p)
 	struct attr *val = (struct attr *)p;
 	struct attr *attr;
 
-	attr = XMALLOC(MTYPE_ATTR, sizeof(struct attr));
+	attr = mempool_alloc(MPOOL_ATTR);
 	*attr = *val;
 	if (val->encap_subtlvs) {
 		val->encap_subtlvs = NULL;
@@ -1052,6 +1225,7 @@ struct attr *bgp_attr_intern(struct attr *attr)
 			vnc_subtlvs->refcnt++;
 	}
 #endif
+	attr_ext_intern(attr);
 
 	/* At this point, attr only contains intern'd pointers.  that means
 	 * if we find it in attrhash, it has all the same pointers and we
@@ -1257,6 +1431,7 @@ void bgp_attr_unintern_sub(struct attr *attr)
 
 	srv6_l3vpn_unintern(&attr->srv6_l3vpn);
 	srv6_vpn_unintern(&attr->srv6_vpn);
+	attr_ext_unintern(&attr->ext);
 }
 
 /* Free bgp attribute and aspath. */
@@ -1275,7 +1450,7 @@ void bgp_attr_unintern(struct attr **pattr)
 	if (attr->refcnt == 0) {
 		ret = hash_release(attrhash, attr);
 		assert(ret != NULL);
-		XFREE(MTYPE_ATTR, attr);
+		MPFREE(MPOOL_ATTR, attr);
 		*pattr = NULL;
 	}
 
@@ -1347,6 +1522,7 @@ void bgp_attr_flush(struct attr *attr)
 		bgp_attr_set_vnc_subtlvs(attr, NULL);
 	}
 #endif
+	bgp_attr_flush_ext(attr);
 }
 
 /* Implement draft-scudder-idr-optional-transitive behaviour and
@@ -2275,8 +2451,10 @@ cluster_list_ignore:
 /* get locally configure or received srte-color value*/
 uint32_t bgp_attr_get_color(struct attr *attr)
 {
-	if (attr->srte_color)
-		return attr->srte_color;
+	uint32_t srte_color = bgp_attr_get_srte_color(attr);
+
+	if (srte_color)
+		return srte_color;
 	if (attr->ecommunity)
 		return ecommunity_select_color(attr->ecommunity);
 	return 0;
@@ -2578,6 +2756,10 @@ bgp_attr_ext_communities(struct bgp_attr_parser_args *args)
 	uint8_t sticky = 0;
 	bool proxy = false;
 	struct ecommunity *ecomm;
+	uint8_t df_alg, router_flag;
+	uint16_t df_pref;
+	bgp_encap_types tunneltype;
+	uint64_t link_bw;
 
 	if (length == 0) {
 		bgp_attr_set_ecommunity(attr, NULL);
@@ -2602,24 +2784,30 @@ bgp_attr_ext_communities(struct bgp_attr_parser_args *args)
 					  args->total);
 
 	/* Extract DF election preference and  mobility sequence number */
-	attr->df_pref = bgp_attr_df_pref_from_ec(attr, &attr->df_alg);
+	df_alg = bgp_attr_get_df_alg(attr);
+	df_pref = bgp_attr_df_pref_from_ec(attr, &df_alg);
+	bgp_attr_set_df_pref(attr, df_pref);
+	bgp_attr_set_df_alg(attr, df_alg);
 
 	/* Extract MAC mobility sequence number, if any. */
-	attr->mm_seqnum = bgp_attr_mac_mobility_seqnum(attr, &sticky);
-	attr->sticky = sticky;
+	bgp_attr_set_mm_seqnum(attr,
+			       bgp_attr_mac_mobility_seqnum(attr, &sticky));
+	bgp_attr_set_sticky(attr, sticky);
 
 	/* Check if this is a Gateway MAC-IP advertisement */
-	attr->default_gw = bgp_attr_default_gw(attr);
+	bgp_attr_set_default_gw(attr, bgp_attr_default_gw(attr));
 
 	/* Handle scenario where router flag ecommunity is not
 	 * set but default gw ext community is present.
 	 * Use default gateway, set and propogate R-bit.
 	 */
-	if (attr->default_gw)
-		attr->router_flag = 1;
+	router_flag = bgp_attr_get_router_flag(attr);
+	if (bgp_attr_get_default_gw(attr))
+		router_flag = 1;
 
 	/* Check EVPN Neighbor advertisement flags, R-bit */
-	bgp_attr_evpn_na_flag(attr, &attr->router_flag, &proxy);
+	bgp_attr_evpn_na_flag(attr, &router_flag, &proxy);
+	bgp_attr_set_router_flag(attr, router_flag);
 	if (proxy)
 		attr->es_flags |= ATTR_ES_PROXY_ADVERT;
 
@@ -2632,12 +2820,14 @@ bgp_attr_ext_communities(struct bgp_attr_parser_args *args)
 	}
 
 	/* Get the tunnel type from encap extended community */
-	bgp_attr_extcom_tunnel_type(attr,
-		(bgp_encap_types *)&attr->encap_tunneltype);
+	tunneltype = bgp_attr_get_encap_tunneltype(attr);
+	bgp_attr_extcom_tunnel_type(attr, &tunneltype);
+	bgp_attr_set_encap_tunneltype(attr, tunneltype);
 
 	/* Extract link bandwidth, if any. */
 	(void)ecommunity_linkbw_present(bgp_attr_get_ecommunity(attr),
-					&attr->link_bw);
+					&link_bw);
+	bgp_attr_set_link_bw(attr, link_bw);
 
 	return BGP_ATTR_PARSE_PROCEED;
 }
@@ -2650,6 +2840,7 @@ bgp_attr_ipv6_ext_communities(struct bgp_attr_parser_args *args)
 	struct attr *const attr = args->attr;
 	const bgp_size_t length = args->length;
 	struct ecommunity *ipv6_ecomm = NULL;
+	uint64_t link_bw;
 
 	if (length == 0) {
 		bgp_attr_set_ipv6_ecommunity(attr, ipv6_ecomm);
@@ -2672,7 +2863,8 @@ bgp_attr_ipv6_ext_communities(struct bgp_attr_parser_args *args)
 
 	/* Extract link bandwidth, if any. */
 	(void)ecommunity_linkbw_present(bgp_attr_get_ipv6_ecommunity(attr),
-					&attr->link_bw);
+					&link_bw);
+	bgp_attr_set_link_bw(attr, link_bw);
 
 	return BGP_ATTR_PARSE_PROCEED;
 
@@ -2788,7 +2980,7 @@ static int bgp_attr_encap(struct bgp_attr_parser_args *args)
 	}
 
 	if (BGP_ATTR_ENCAP == type) {
-		attr->encap_tunneltype = tunneltype;
+		bgp_attr_set_encap_tunneltype(attr, tunneltype);
 	}
 
 	if (length) {
@@ -3351,8 +3543,8 @@ static enum bgp_attr_parse_ret bgp_attr_otc(struct bgp_attr_parser_args *args)
 	if (peer->discard_attrs[args->type] || peer->withdraw_attrs[args->type])
 		goto otc_ignore;
 
-	attr->otc = stream_getl(peer->curr);
-	if (!attr->otc) {
+	bgp_attr_set_otc(attr, stream_getl(peer->curr));
+	if (!bgp_attr_get_otc(attr)) {
 		flog_err(EC_BGP_ATTR_MAL_AS_PATH, "OTC attribute value is 0");
 		return bgp_attr_malformed(args, BGP_NOTIFY_UPDATE_MAL_AS_PATH,
 					  args->total);
@@ -3958,6 +4150,7 @@ done:
 				attr,
 				encap_intern(vnc_subtlvs, VNC_SUBTLV_TYPE));
 #endif
+		attr_ext_intern(attr);
 	} else {
 		if (transit) {
 			transit_free(transit);
@@ -3965,6 +4158,7 @@ done:
 		}
 
 		bgp_attr_flush_encap(attr);
+		bgp_attr_flush_ext(attr);
 	};
 
 	/* Sanity checks */
@@ -3980,6 +4174,8 @@ done:
 	if (vnc_subtlvs)
 		assert(vnc_subtlvs->refcnt > 0);
 #endif
+	if (attr->ext)
+		assert(attr->ext->refcnt > 0);
 
 	return ret;
 }
@@ -4261,8 +4457,9 @@ static void bgp_packet_mpattr_tea(struct bgp *bgp, struct peer *peer,
 	const char *attrname;
 
 	if (!attr || (attrtype == BGP_ATTR_ENCAP
-		      && (!attr->encap_tunneltype
-			  || attr->encap_tunneltype == BGP_ENCAP_TYPE_MPLS)))
+		      && (!bgp_attr_get_encap_tunneltype(attr)
+			  || bgp_attr_get_encap_tunneltype(attr) ==
+				     BGP_ENCAP_TYPE_MPLS)))
 		return;
 
 	switch (attrtype) {
@@ -4323,7 +4520,7 @@ static void bgp_packet_mpattr_tea(struct bgp *bgp, struct peer *peer,
 
 	if (attrtype == BGP_ATTR_ENCAP) {
 		/* write outer T+L */
-		stream_putw(s, attr->encap_tunneltype);
+		stream_putw(s, bgp_attr_get_encap_tunneltype(attr));
 		stream_putw(s, attrlenfield - 4);
 	}
 
@@ -4908,7 +5105,7 @@ bgp_size_t bgp_packet_attribute(struct bgp *bgp, struct peer *peer,
 		stream_putc(s, BGP_ATTR_FLAG_OPTIONAL | BGP_ATTR_FLAG_TRANS);
 		stream_putc(s, BGP_ATTR_OTC);
 		stream_putc(s, 4);
-		stream_putl(s, attr->otc);
+		stream_putl(s, bgp_attr_get_otc(attr));
 	}
 
 	/* AIGP */
@@ -4995,6 +5192,7 @@ void bgp_attr_init(void)
 	transit_init();
 	encap_init();
 	srv6_init();
+	attr_ext_init();
 }
 
 void bgp_attr_finish(void)
@@ -5008,6 +5206,7 @@ void bgp_attr_finish(void)
 	transit_finish();
 	encap_finish();
 	srv6_finish();
+	attr_ext_finish();
 }
 
 /* Make attribute packet. */
@@ -5181,7 +5380,7 @@ void bgp_dump_routes_attr(struct stream *s, struct bgp_path_info *bpi,
 		stream_putc(s, BGP_ATTR_FLAG_OPTIONAL | BGP_ATTR_FLAG_TRANS);
 		stream_putc(s, BGP_ATTR_OTC);
 		stream_putc(s, 4);
-		stream_putl(s, attr->otc);
+		stream_putl(s, bgp_attr_get_otc(attr));
 	}
 
 	/* AIGP */
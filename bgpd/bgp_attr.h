@@ -136,6 +136,65 @@ struct bgp_attr_srv6_l3vpn {
 	uint8_t transposition_offset;
 };
 
+/* Attribute values that only few paths carry.  They are kept out of line
+ * so that the common case struct attr stays small, and interned like the
+ * other sub-structures.  A NULL attr->ext means all of them are zero; use
+ * the bgp_attr_get_*() and bgp_attr_set_*() accessors below.
+ */
+struct attr_ext {
+	/* Reference count, 0 for private copies (see bgp_attr_ext_mut()) */
+	unsigned long refcnt;
+
+	/* Hash key, only valid while interned */
+	uint32_t key;
+
+	/* The attr a private copy was made for, NULL if interned */
+	const struct attr *owner;
+
+	/* EVPN */
+	struct bgp_route_evpn evpn_overlay;
+
+	/* AIGP Metric */
+	uint64_t aigp_metric;
+
+	/* Link bandwidth value, if any. */
+	uint64_t link_bw;
+
+	/* OTC value if set */
+	uint32_t otc;
+
+	/* SR-TE Color */
+	uint32_t srte_color;
+
+	/* rmap set table */
+	uint32_t rmap_table_id;
+
+	/* EVPN MAC Mobility sequence number, if any. */
+	uint32_t mm_seqnum;
+	/* highest MM sequence number rxed in a MAC-IP route from an
+	 * ES peer (this includes both proxy and non-proxy MAC-IP
+	 * advertisements from ES peers).
+	 * This is only applicable to local paths in the VNI routing
+	 * table and derived from other imported/non-best paths.
+	 */
+	uint32_t mm_sync_seqnum;
+
+	uint16_t encap_tunneltype;
+
+	/* EVPN DF preference for DF election on local ESs */
+	uint16_t df_pref;
+	uint8_t df_alg;
+
+	/* NA router flag (R-bit) support in EVPN */
+	uint8_t router_flag;
+
+	/* Static MAC for EVPN */
+	uint8_t sticky;
+
+	/* Flag for default gateway extended community in EVPN */
+	uint8_t default_gw;
+};
+
 /* BGP core attribute structure. */
 struct attr {
 	/* AS Path structure */
@@ -197,16 +256,9 @@ struct attr {
 #define ATTR_ES_L3_NHG_ACTIVE (1 << 6)
 #define ATTR_ES_L3_NHG	      (ATTR_ES_L3_NHG_USE | ATTR_ES_L3_NHG_ACTIVE)
 
-	/* NA router flag (R-bit) support in EVPN */
-	uint8_t router_flag;
-
 	/* Distance as applied by Route map */
 	uint8_t distance;
 
-	/* EVPN DF preference for DF election on local ESs */
-	uint8_t df_alg;
-	uint16_t df_pref;
-
 	/* PMSI tunnel type (RFC 6514). */
 	enum pta_type pmsi_tnl_type;
 
@@ -256,12 +308,6 @@ struct attr {
 	/* MP Nexthop length */
 	uint8_t mp_nexthop_len;
 
-	/* Static MAC for EVPN */
-	uint8_t sticky;
-
-	/* Flag for default gateway extended community in EVPN */
-	uint8_t default_gw;
-
 	/* route tag */
 	route_tag_t tag;
 
@@ -279,47 +325,20 @@ struct attr {
 #ifdef ENABLE_BGP_VNC
 	struct bgp_attr_encap_subtlv *vnc_subtlvs; /* VNC-specific */
 #endif
-	/* EVPN */
-	struct bgp_route_evpn evpn_overlay;
-
-	/* EVPN MAC Mobility sequence number, if any. */
-	uint32_t mm_seqnum;
-	/* highest MM sequence number rxed in a MAC-IP route from an
-	 * ES peer (this includes both proxy and non-proxy MAC-IP
-	 * advertisements from ES peers).
-	 * This is only applicable to local paths in the VNI routing
-	 * table and derived from other imported/non-best paths.
-	 */
-	uint32_t mm_sync_seqnum;
-
 	/* EVPN local router-mac */
 	struct ethaddr rmac;
 
-	uint16_t encap_tunneltype;
-
-	/* rmap set table */
-	uint32_t rmap_table_id;
-
-	/* Link bandwidth value, if any. */
-	uint64_t link_bw;
-
 	/* EVPN ES */
 	esi_t esi;
 
-	/* SR-TE Color */
-	uint32_t srte_color;
-
 	/* Nexthop type */
 	enum nexthop_types_t nh_type;
 
 	/* If NEXTHOP_TYPE_BLACKHOLE, then blackhole type */
 	enum blackhole_type bh_type;
 
-	/* OTC value if set */
-	uint32_t otc;
-
-	/* AIGP Metric */
-	uint64_t aigp_metric;
+	/* Rarely used values, see struct attr_ext */
+	struct attr_ext *ext;
 };
 
 /* rmap_change_flags definition */
@@ -402,6 +421,7 @@ extern unsigned int attrhash_key_make(const void *p);
 extern void attr_show_all(struct vty *vty);
 extern unsigned long int attr_count(void);
 extern unsigned long int attr_unknown_count(void);
+extern unsigned long int attr_ext_count(void);
 extern void bgp_path_attribute_discard_vty(struct vty *vty, struct peer *peer,
 					   const char *discard_attrs, bool set);
 extern void bgp_path_attribute_withdraw_vty(struct vty *vty, struct peer *peer,
@@ -434,6 +454,7 @@ extern struct bgp_attr_encap_subtlv *
 encap_tlv_dup(struct bgp_attr_encap_subtlv *orig);
 
 extern void bgp_attr_flush_encap(struct attr *attr);
+extern void bgp_attr_flush_ext(struct attr *attr);
 
 extern void bgp_attr_extcom_tunnel_type(struct attr *attr,
 					 bgp_encap_types *tunnel_type);
@@ -490,9 +511,43 @@ static inline bool bgp_rmap_nhop_changed(uint32_t out_rmap_flags,
 			: false);
 }
 
+/*
+ * Returns a private copy of attr->ext for modification, installed on attr.
+ * Interned blocks are shared and must never be written to.  The copy
+ * belongs to attr: it is freed by bgp_attr_flush() or handed over to the
+ * hash by bgp_attr_intern().  A struct copy of attr only borrows it and
+ * gets a copy of its own on the first modification.
+ */
+extern struct attr_ext *bgp_attr_ext_mut(struct attr *attr);
+
+#define BGP_ATTR_EXT_ACCESSORS(type, field)                                    \
+	static inline type bgp_attr_get_##field(const struct attr *attr)       \
+	{                                                                      \
+		return attr->ext ? attr->ext->field : 0;                       \
+	}                                                                      \
+	static inline void bgp_attr_set_##field(struct attr *attr, type val)   \
+	{                                                                      \
+		if (bgp_attr_get_##field(attr) != val)                         \
+			bgp_attr_ext_mut(attr)->field = val;                   \
+	}                                                                      \
+	MACRO_REQUIRE_SEMICOLON() /* end */
+
+BGP_ATTR_EXT_ACCESSORS(uint64_t, link_bw);
+BGP_ATTR_EXT_ACCESSORS(uint32_t, otc);
+BGP_ATTR_EXT_ACCESSORS(uint32_t, srte_color);
+BGP_ATTR_EXT_ACCESSORS(uint32_t, rmap_table_id);
+BGP_ATTR_EXT_ACCESSORS(uint32_t, mm_seqnum);
+BGP_ATTR_EXT_ACCESSORS(uint32_t, mm_sync_seqnum);
+BGP_ATTR_EXT_ACCESSORS(uint16_t, encap_tunneltype);
+BGP_ATTR_EXT_ACCESSORS(uint16_t, df_pref);
+BGP_ATTR_EXT_ACCESSORS(uint8_t, df_alg);
+BGP_ATTR_EXT_ACCESSORS(uint8_t, router_flag);
+BGP_ATTR_EXT_ACCESSORS(uint8_t, sticky);
+BGP_ATTR_EXT_ACCESSORS(uint8_t, default_gw);
+
 static inline uint32_t mac_mobility_seqnum(struct attr *attr)
 {
-	return (attr) ? attr->mm_seqnum : 0;
+	return (attr) ? bgp_attr_get_mm_seqnum(attr) : 0;
 }
 
 static inline enum pta_type bgp_attr_get_pmsi_tnl_type(struct attr *attr)
@@ -589,12 +644,13 @@ static inline void bgp_attr_set_transit(struct attr *attr,
 
 static inline uint64_t bgp_attr_get_aigp_metric(const struct attr *attr)
 {
-	return attr->aigp_metric;
+	return attr->ext ? attr->ext->aigp_metric : 0;
 }
 
 static inline void bgp_attr_set_aigp_metric(struct attr *attr, uint64_t aigp)
 {
-	attr->aigp_metric = aigp;
+	if (bgp_attr_get_aigp_metric(attr) != aigp)
+		bgp_attr_ext_mut(attr)->aigp_metric = aigp;
 
 	if (aigp)
 		SET_FLAG(attr->flag, ATTR_FLAG_BIT(BGP_ATTR_AIGP));
@@ -616,16 +672,22 @@ static inline void bgp_attr_set_cluster(struct attr *attr,
 		UNSET_FLAG(attr->flag, ATTR_FLAG_BIT(BGP_ATTR_CLUSTER_LIST));
 }
 
+extern const struct bgp_route_evpn bgp_route_evpn_none;
+
 static inline const struct bgp_route_evpn *
 bgp_attr_get_evpn_overlay(const struct attr *attr)
 {
-	return &attr->evpn_overlay;
+	return attr->ext ? &attr->ext->evpn_overlay : &bgp_route_evpn_none;
 }
 
 static inline void bgp_attr_set_evpn_overlay(struct attr *attr,
-					     struct bgp_route_evpn *eo)
+					     const struct bgp_route_evpn *eo)
 {
-	memcpy(&attr->evpn_overlay, eo, sizeof(struct bgp_route_evpn));
+	if (bgp_route_evpn_same(bgp_attr_get_evpn_overlay(attr), eo))
+		return;
+
+	memcpy(&bgp_attr_ext_mut(attr)->evpn_overlay, eo,
+	       sizeof(struct bgp_route_evpn));
 }
 
 static inline struct bgp_attr_encap_subtlv *
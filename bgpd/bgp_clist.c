@@ -54,6 +54,84 @@ static struct community_entry *bgp_clist_seq_check(struct community_list *list,
 	return NULL;
 }
 
+/*
+ * Community-list lookup index.
+ *
+ * Entries are numbered in list order, and each community value maps to
+ * the numbers of the entries it is relevant to:
+ *
+ * - in standard lists, every entry containing the value.  An entry
+ *   matches once all of its values were hit, which is counted in a single
+ *   pass over the route's communities instead of comparing each entry.
+ * - in expanded lists, the first entry whose regular expression matches
+ *   the value on its own.  These are filled in as values are seen, up to
+ *   CLIST_INDEX_VALUES_MAX of them, so every distinct value is rendered
+ *   and run through regexec() only once.
+ *
+ * Expanded lists matched against the whole attribute string keep their
+ * result per interned attribute in a direct mapped cache, as that string
+ * also depends on community aliases.
+ *
+ * All entries of a list have the same style, see community_list_set().
+ */
+#define CLIST_INDEX_VALUES_MAX 65536
+
+/* Direct mapped by attribute serial, must be a power of 2 */
+#define CLIST_INDEX_CACHE_SIZE 1024
+
+struct clist_index_val {
+	uint8_t val[LCOMMUNITY_SIZE];
+	uint8_t len;
+
+	/* entry numbers, ascending */
+	uint32_t count;
+	uint32_t *entries;
+};
+
+struct clist_index_cache {
+	const void *attr;
+	uint32_t serial;
+	int32_t entry;
+};
+
+struct community_list_index {
+	/* style of the entries, COMMUNITY_SIZE or LCOMMUNITY_SIZE values */
+	uint8_t style;
+	uint8_t len;
+
+	uint32_t count;
+	struct community_entry **entries;
+	/* standard lists: number of distinct values per entry */
+	uint32_t *need;
+
+	struct hash *values;
+
+	struct clist_index_cache *cache;
+	uint32_t alias_gen;
+};
+
+static void clist_index_val_free(void *arg)
+{
+	struct clist_index_val *v = arg;
+
+	XFREE(MTYPE_COMMUNITY_LIST_INDEX, v->entries);
+	XFREE(MTYPE_COMMUNITY_LIST_INDEX, v);
+}
+
+static void community_list_index_free(struct community_list *list)
+{
+	struct community_list_index *idx = list->index;
+
+	if (!idx)
+		return;
+
+	hash_clean_and_free(&idx->values, clist_index_val_free);
+	XFREE(MTYPE_COMMUNITY_LIST_INDEX, idx->entries);
+	XFREE(MTYPE_COMMUNITY_LIST_INDEX, idx->need);
+	XFREE(MTYPE_COMMUNITY_LIST_INDEX, idx->cache);
+	XFREE(MTYPE_COMMUNITY_LIST_INDEX, list->index);
+}
+
 static uint32_t bgp_clist_hash_key_community_list(const void *data)
 {
 	struct community_list *cl = (struct community_list *) data;
@@ -144,6 +222,7 @@ static struct community_list *community_list_new(void)
 /* Free community-list.  */
 static void community_list_free(struct community_list *list)
 {
+	community_list_index_free(list);
 	XFREE(MTYPE_COMMUNITY_LIST_NAME, list->name);
 	XFREE(MTYPE_COMMUNITY_LIST, list);
 }
@@ -308,6 +387,8 @@ static void community_list_entry_delete(struct community_list_master *cm,
 					struct community_list *list,
 					struct community_entry *entry)
 {
+	community_list_index_free(list);
+
 	if (entry->next)
 		entry->next->prev = entry->prev;
 	else
@@ -360,6 +441,8 @@ static void community_list_entry_add(struct community_list *list,
 	struct community_entry *replace;
 	struct community_entry *point;
 
+	community_list_index_free(list);
+
 	/* Automatic assignment of seq no. */
 	if (entry->seq == COMMUNITY_SEQ_NUMBER_AUTO)
 		entry->seq = bgp_clist_new_seq_get(list);
@@ -646,38 +729,323 @@ static bool ecommunity_regexp_match(struct ecommunity *ecom, regex_t *reg)
 	return false;
 }
 
-/* When given community attribute matches to the community-list return
-   1 else return 0.  */
-bool community_list_match(struct community *com, struct community_list *list)
+static unsigned int clist_index_val_hash_key(const void *arg)
+{
+	const struct clist_index_val *v = arg;
+
+	return jhash(v->val, v->len, 0);
+}
+
+static bool clist_index_val_hash_cmp(const void *arg1, const void *arg2)
+{
+	const struct clist_index_val *v1 = arg1;
+	const struct clist_index_val *v2 = arg2;
+
+	return v1->len == v2->len && memcmp(v1->val, v2->val, v1->len) == 0;
+}
+
+static void *clist_index_val_alloc(void *arg)
+{
+	struct clist_index_val *v;
+
+	v = XCALLOC(MTYPE_COMMUNITY_LIST_INDEX, sizeof(*v));
+	memcpy(v, arg, sizeof(*v));
+	return v;
+}
+
+/* Value i of a community or large community attribute */
+static const uint8_t *clist_index_attr_val(struct community_list_index *idx,
+					   const void *attr, int i)
+{
+	if (idx->len == COMMUNITY_SIZE)
+		return (const uint8_t *)com_nthval((const struct community *)attr,
+						   i);
+	return ((const struct lcommunity *)attr)->val + i * LCOMMUNITY_SIZE;
+}
+
+static int clist_index_attr_size(struct community_list_index *idx,
+				 const void *attr)
+{
+	if (!attr)
+		return 0;
+	if (idx->len == COMMUNITY_SIZE)
+		return ((const struct community *)attr)->size;
+	return ((const struct lcommunity *)attr)->size;
+}
+
+static const void *clist_index_entry_attr(struct community_list_index *idx,
+					  struct community_entry *entry)
+{
+	if (idx->len == COMMUNITY_SIZE)
+		return entry->u.com;
+	return entry->u.lcom;
+}
+
+static struct clist_index_val *
+clist_index_val_lookup(struct community_list_index *idx, const uint8_t *val)
 {
+	struct clist_index_val key;
+
+	memcpy(key.val, val, idx->len);
+	key.len = idx->len;
+	return hash_lookup(idx->values, &key);
+}
+
+static struct clist_index_val *
+clist_index_val_get(struct community_list_index *idx, const uint8_t *val)
+{
+	struct clist_index_val key = {};
+
+	memcpy(key.val, val, idx->len);
+	key.len = idx->len;
+	return hash_get(idx->values, &key, clist_index_val_alloc);
+}
+
+static void clist_index_val_add(struct clist_index_val *v, uint32_t entry)
+{
+	v->entries = XREALLOC(MTYPE_COMMUNITY_LIST_INDEX, v->entries,
+			      (v->count + 1) * sizeof(*v->entries));
+	v->entries[v->count++] = entry;
+}
+
+static struct community_list_index *
+community_list_index_get(struct community_list *list)
+{
+	struct community_list_index *idx = list->index;
 	struct community_entry *entry;
+	struct clist_index_val *v;
+	const void *attr;
+	uint32_t n = 0;
+	int i;
 
-	for (entry = list->head; entry; entry = entry->next) {
-		if (entry->style == COMMUNITY_LIST_STANDARD) {
-			if (community_match(com, entry->u.com))
-				return entry->direct == COMMUNITY_PERMIT;
-		} else if (entry->style == COMMUNITY_LIST_EXPANDED) {
-			if (community_regexp_match(com, entry->reg))
-				return entry->direct == COMMUNITY_PERMIT;
+	if (idx)
+		return idx;
+
+	idx = XCALLOC(MTYPE_COMMUNITY_LIST_INDEX, sizeof(*idx));
+	if (list->head)
+		idx->style = list->head->style;
+	if (idx->style == LARGE_COMMUNITY_LIST_STANDARD ||
+	    idx->style == LARGE_COMMUNITY_LIST_EXPANDED)
+		idx->len = LCOMMUNITY_SIZE;
+	else
+		idx->len = COMMUNITY_SIZE;
+
+	for (entry = list->head; entry; entry = entry->next)
+		idx->count++;
+
+	idx->entries = XCALLOC(MTYPE_COMMUNITY_LIST_INDEX,
+			       idx->count * sizeof(*idx->entries));
+	idx->need = XCALLOC(MTYPE_COMMUNITY_LIST_INDEX,
+			    idx->count * sizeof(*idx->need));
+	idx->values = hash_create_size(32, clist_index_val_hash_key,
+				       clist_index_val_hash_cmp,
+				       "Community-list index");
+
+	for (entry = list->head; entry; entry = entry->next, n++) {
+		idx->entries[n] = entry;
+
+		if (entry->style != COMMUNITY_LIST_STANDARD &&
+		    entry->style != LARGE_COMMUNITY_LIST_STANDARD)
+			continue;
+
+		attr = clist_index_entry_attr(idx, entry);
+		for (i = 0; i < clist_index_attr_size(idx, attr); i++) {
+			v = clist_index_val_get(idx,
+						clist_index_attr_val(idx, attr,
+								     i));
+			/* repeated value within the entry */
+			if (v->count && v->entries[v->count - 1] == n)
+				continue;
+			clist_index_val_add(v, n);
+			idx->need[n]++;
 		}
 	}
-	return false;
+
+	list->index = idx;
+	return idx;
 }
 
-bool lcommunity_list_match(struct lcommunity *lcom, struct community_list *list)
+static bool clist_index_regexp_include(struct community_list_index *idx,
+				       regex_t *reg, const void *attr, int i)
 {
-	struct community_entry *entry;
+	if (idx->len == COMMUNITY_SIZE)
+		return community_regexp_include(reg, (struct community *)attr,
+						i);
+	return lcommunity_regexp_include(reg, (struct lcommunity *)attr, i);
+}
 
-	for (entry = list->head; entry; entry = entry->next) {
-		if (entry->style == LARGE_COMMUNITY_LIST_STANDARD) {
-			if (lcommunity_match(lcom, entry->u.lcom))
-				return entry->direct == COMMUNITY_PERMIT;
-		} else if (entry->style == LARGE_COMMUNITY_LIST_EXPANDED) {
-			if (lcommunity_regexp_match(lcom, entry->reg))
-				return entry->direct == COMMUNITY_PERMIT;
+static bool clist_index_regexp_match(struct community_list_index *idx,
+				     regex_t *reg, const void *attr)
+{
+	if (idx->len == COMMUNITY_SIZE)
+		return community_regexp_match((struct community *)attr, reg);
+	return lcommunity_regexp_match((struct lcommunity *)attr, reg);
+}
+
+/* Number of the first entry that decides on value i of attr on its own, as
+ * "match community any" and "set comm-list delete" do, or -1.
+ */
+static int clist_index_value_match(struct community_list_index *idx,
+				   const void *attr, int i)
+{
+	const uint8_t *val = clist_index_attr_val(idx, attr, i);
+	struct clist_index_val *v;
+	uint32_t n;
+	int first = -1;
+
+	v = clist_index_val_lookup(idx, val);
+	if (v)
+		return v->count ? (int)v->entries[0] : -1;
+
+	if (idx->style == COMMUNITY_LIST_STANDARD ||
+	    idx->style == LARGE_COMMUNITY_LIST_STANDARD)
+		return -1;
+
+	for (n = 0; n < idx->count; n++) {
+		if (clist_index_regexp_include(idx, idx->entries[n]->reg, attr,
+					       i)) {
+			first = n;
+			break;
 		}
 	}
-	return false;
+
+	if (hashcount(idx->values) < CLIST_INDEX_VALUES_MAX) {
+		v = clist_index_val_get(idx, val);
+		if (first >= 0)
+			clist_index_val_add(v, first);
+	}
+	return first;
+}
+
+/* Number of the first standard entry whose values are all present in attr,
+ * or with exact, which has exactly the values of attr.  -1 if none.
+ */
+static int clist_index_standard_match(struct community_list_index *idx,
+				      const void *attr, bool exact)
+{
+	uint32_t hits_buf[128], *hits = hits_buf;
+	uint32_t best = idx->count, n, j;
+	const uint8_t *val, *prev = NULL;
+	struct clist_index_val *v;
+	int size, i;
+
+	size = clist_index_attr_size(idx, attr);
+	if (!size || !idx->count)
+		return -1;
+
+	if (idx->count > array_size(hits_buf))
+		hits = XCALLOC(MTYPE_TMP, idx->count * sizeof(*hits));
+	else
+		memset(hits, 0, idx->count * sizeof(*hits));
+
+	for (i = 0; i < size; i++) {
+		val = clist_index_attr_val(idx, attr, i);
+		/* values are sorted, skip repeats */
+		if (prev && memcmp(prev, val, idx->len) == 0)
+			continue;
+		prev = val;
+
+		v = clist_index_val_lookup(idx, val);
+		if (!v)
+			continue;
+
+		for (j = 0; j < v->count; j++) {
+			n = v->entries[j];
+			if (n >= best)
+				break;
+			if (++hits[n] < idx->need[n])
+				continue;
+			if (exact &&
+			    clist_index_attr_size(idx,
+						  clist_index_entry_attr(
+							  idx, idx->entries[n])) !=
+				    size)
+				continue;
+			best = n;
+		}
+	}
+
+	if (hits != hits_buf)
+		XFREE(MTYPE_TMP, hits);
+
+	return best < idx->count ? (int)best : -1;
+}
+
+/* Number of the first expanded entry matching the string form of attr */
+static int clist_index_expanded_match(struct community_list_index *idx,
+				      const void *attr)
+{
+	struct clist_index_cache *c = NULL;
+	unsigned long refcnt = 0;
+	uint32_t serial = 0;
+	uint32_t n;
+	int first = -1;
+
+	if (attr && idx->len == COMMUNITY_SIZE) {
+		refcnt = ((const struct community *)attr)->refcnt;
+		serial = ((const struct community *)attr)->serial;
+	} else if (attr) {
+		refcnt = ((const struct lcommunity *)attr)->refcnt;
+		serial = ((const struct lcommunity *)attr)->serial;
+	}
+
+	/* Only interned attributes have a serial and stay immutable */
+	if (refcnt) {
+		if (!idx->cache ||
+		    idx->alias_gen != bgp_community_alias_generation()) {
+			XFREE(MTYPE_COMMUNITY_LIST_INDEX, idx->cache);
+			idx->cache = XCALLOC(MTYPE_COMMUNITY_LIST_INDEX,
+					     CLIST_INDEX_CACHE_SIZE *
+						     sizeof(*idx->cache));
+			idx->alias_gen = bgp_community_alias_generation();
+		}
+
+		c = &idx->cache[serial & (CLIST_INDEX_CACHE_SIZE - 1)];
+		if (c->attr == attr && c->serial == serial)
+			return c->entry;
+	}
+
+	for (n = 0; n < idx->count; n++) {
+		if (clist_index_regexp_match(idx, idx->entries[n]->reg, attr)) {
+			first = n;
+			break;
+		}
+	}
+
+	if (c) {
+		c->attr = attr;
+		c->serial = serial;
+		c->entry = first;
+	}
+	return first;
+}
+
+static int clist_index_match(struct community_list *list, const void *attr,
+			     bool exact)
+{
+	struct community_list_index *idx = community_list_index_get(list);
+
+	if (idx->style == COMMUNITY_LIST_EXPANDED ||
+	    idx->style == LARGE_COMMUNITY_LIST_EXPANDED)
+		return clist_index_expanded_match(idx, attr);
+	return clist_index_standard_match(idx, attr, exact);
+}
+
+static bool clist_index_permit(struct community_list *list, int n)
+{
+	return n >= 0 && list->index->entries[n]->direct == COMMUNITY_PERMIT;
+}
+
+/* When given community attribute matches to the community-list return
+   1 else return 0.  */
+bool community_list_match(struct community *com, struct community_list *list)
+{
+	return clist_index_permit(list, clist_index_match(list, com, false));
+}
+
+bool lcommunity_list_match(struct lcommunity *lcom, struct community_list *list)
+{
+	return clist_index_permit(list, clist_index_match(list, lcom, false));
 }
 
 
@@ -687,18 +1055,7 @@ bool lcommunity_list_match(struct lcommunity *lcom, struct community_list *list)
 bool lcommunity_list_exact_match(struct lcommunity *lcom,
 				 struct community_list *list)
 {
-	struct community_entry *entry;
-
-	for (entry = list->head; entry; entry = entry->next) {
-		if (entry->style == LARGE_COMMUNITY_LIST_STANDARD) {
-			if (lcommunity_cmp(lcom, entry->u.lcom))
-				return entry->direct == COMMUNITY_PERMIT;
-		} else if (entry->style == LARGE_COMMUNITY_LIST_EXPANDED) {
-			if (lcommunity_regexp_match(lcom, entry->reg))
-				return entry->direct == COMMUNITY_PERMIT;
-		}
-	}
-	return false;
+	return clist_index_permit(list, clist_index_match(list, lcom, true));
 }
 
 bool ecommunity_list_match(struct ecommunity *ecom, struct community_list *list)
@@ -722,37 +1079,18 @@ bool ecommunity_list_match(struct ecommunity *ecom, struct community_list *list)
 bool community_list_exact_match(struct community *com,
 				struct community_list *list)
 {
-	struct community_entry *entry;
-
-	for (entry = list->head; entry; entry = entry->next) {
-		if (entry->style == COMMUNITY_LIST_STANDARD) {
-			if (community_cmp(com, entry->u.com))
-				return entry->direct == COMMUNITY_PERMIT;
-		} else if (entry->style == COMMUNITY_LIST_EXPANDED) {
-			if (community_regexp_match(com, entry->reg))
-				return entry->direct == COMMUNITY_PERMIT;
-		}
-	}
-	return false;
+	return clist_index_permit(list, clist_index_match(list, com, true));
 }
 
 bool community_list_any_match(struct community *com, struct community_list *list)
 {
-	struct community_entry *entry;
-	uint32_t val;
-	int i;
+	struct community_list_index *idx = community_list_index_get(list);
+	int i, n;
 
 	for (i = 0; i < com->size; i++) {
-		val = community_val_get(com, i);
-
-		for (entry = list->head; entry; entry = entry->next) {
-			if (entry->style == COMMUNITY_LIST_STANDARD &&
-			    community_include(entry->u.com, val))
-				return entry->direct == COMMUNITY_PERMIT;
-			if ((entry->style == COMMUNITY_LIST_EXPANDED) &&
-			    community_regexp_include(entry->reg, com, i))
-				return entry->direct == COMMUNITY_PERMIT;
-		}
+		n = clist_index_value_match(idx, com, i);
+		if (n >= 0)
+			return clist_index_permit(list, n);
 	}
 	return false;
 }
@@ -761,7 +1099,7 @@ bool community_list_any_match(struct community *com, struct community_list *list
 struct community *community_list_match_delete(struct community *com,
 					      struct community_list *list)
 {
-	struct community_entry *entry;
+	struct community_list_index *idx = community_list_index_get(list);
 	uint32_t val;
 	uint32_t com_index_to_delete[com->size];
 	int delete_index = 0;
@@ -772,25 +1110,8 @@ struct community *community_list_match_delete(struct community *com,
 	 * to com_index_to_delete.
 	 */
 	for (i = 0; i < com->size; i++) {
-		val = community_val_get(com, i);
-
-		for (entry = list->head; entry; entry = entry->next) {
-			if ((entry->style == COMMUNITY_LIST_STANDARD) &&
-			    community_include(entry->u.com, val)) {
-				if (entry->direct == COMMUNITY_PERMIT) {
-					com_index_to_delete[delete_index] = i;
-					delete_index++;
-				}
-				break;
-			} else if ((entry->style == COMMUNITY_LIST_EXPANDED) &&
-				   community_regexp_include(entry->reg, com, i)) {
-				if (entry->direct == COMMUNITY_PERMIT) {
-					com_index_to_delete[delete_index] = i;
-					delete_index++;
-				}
-				break;
-			}
-		}
+		if (clist_index_permit(list, clist_index_value_match(idx, com, i)))
+			com_index_to_delete[delete_index++] = i;
 	}
 
 	/* Delete all of the communities we flagged for deletion */
@@ -947,21 +1268,13 @@ int community_list_unset(struct community_list_handler *ch, const char *name,
 bool lcommunity_list_any_match(struct lcommunity *lcom,
 			       struct community_list *list)
 {
-	struct community_entry *entry;
-	uint8_t *ptr;
-	int i;
+	struct community_list_index *idx = community_list_index_get(list);
+	int i, n;
 
 	for (i = 0; i < lcom->size; i++) {
-		ptr = lcom->val + (i * LCOMMUNITY_SIZE);
-
-		for (entry = list->head; entry; entry = entry->next) {
-			if ((entry->style == LARGE_COMMUNITY_LIST_STANDARD) &&
-			    lcommunity_include(entry->u.lcom, ptr))
-				return entry->direct == COMMUNITY_PERMIT;
-			if ((entry->style == LARGE_COMMUNITY_LIST_EXPANDED) &&
-			    lcommunity_regexp_include(entry->reg, lcom, i))
-				return entry->direct == COMMUNITY_PERMIT;
-		}
+		n = clist_index_value_match(idx, lcom, i);
+		if (n >= 0)
+			return clist_index_permit(list, n);
 	}
 	return false;
 }
@@ -970,7 +1283,7 @@ bool lcommunity_list_any_match(struct lcommunity *lcom,
 struct lcommunity *lcommunity_list_match_delete(struct lcommunity *lcom,
 						struct community_list *list)
 {
-	struct community_entry *entry;
+	struct community_list_index *idx = community_list_index_get(list);
 	uint32_t com_index_to_delete[lcom->size];
 	uint8_t *ptr;
 	int delete_index = 0;
@@ -981,28 +1294,9 @@ struct lcommunity *lcommunity_list_match_delete(struct lcommunity *lcom,
 	 * to com_index_to_delete.
 	 */
 	for (i = 0; i < lcom->size; i++) {
-		ptr = lcom->val + (i * LCOMMUNITY_SIZE);
-		for (entry = list->head; entry; entry = entry->next) {
-			if ((entry->style == LARGE_COMMUNITY_LIST_STANDARD) &&
-			    lcommunity_include(entry->u.lcom, ptr)) {
-				if (entry->direct == COMMUNITY_PERMIT) {
-					com_index_to_delete[delete_index] = i;
-					delete_index++;
-				}
-				break;
-			}
-
-			else if ((entry->style ==
-				  LARGE_COMMUNITY_LIST_EXPANDED) &&
-				 lcommunity_regexp_include(entry->reg, lcom,
-							   i)) {
-				if (entry->direct == COMMUNITY_PERMIT) {
-					com_index_to_delete[delete_index] = i;
-					delete_index++;
-				}
-				break;
-			}
-		}
+		if (clist_index_permit(list,
+				       clist_index_value_match(idx, lcom, i)))
+			com_index_to_delete[delete_index++] = i;
 	}
 
 	/* Delete all of the communities we flagged for deletion */
@@ -52,6 +52,10 @@ struct community_list {
 	/* Community-list entry in this community-list.  */
 	struct community_entry *head;
 	struct community_entry *tail;
+
+	/* Lookup index over the entries, built on first match and dropped
+	   whenever they change.  Community and large community lists only. */
+	struct community_list_index *index;
 };
 
 /* Each entry in community-list.  */
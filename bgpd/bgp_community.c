@@ -18,6 +18,9 @@
 /* Hash of community attribute. */
 static struct hash *comhash;
 
+/* Last serial handed out to a newly interned community. */
+static uint32_t community_serial;
+
 /* Allocate a new communities value.  */
 static struct community *community_new(void)
 {
@@ -457,6 +460,9 @@ struct community *community_intern(struct community *com)
 	if (find != com)
 		community_free(&com);
 
+	if (!find->refcnt)
+		find->serial = ++community_serial;
+
 	/* Increment refrence counter.  */
 	find->refcnt++;
 
@@ -27,6 +27,11 @@ struct community {
 	/* String of community attribute.  This sring is used by vty output
 	   and expanded community-list for regular expression match.  */
 	char *str;
+
+	/* Set when interned, distinguishes a community attribute from
+	   earlier ones that lived at the same address.  Lets community-list
+	   results be cached by pointer. */
+	uint32_t serial;
 };
 
 /* Well-known communities value.  */
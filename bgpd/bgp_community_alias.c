@@ -16,6 +16,9 @@
 static struct hash *bgp_ca_alias_hash;
 static struct hash *bgp_ca_community_hash;
 
+/* Changed whenever an alias is added or removed */
+static uint32_t bgp_ca_generation;
+
 static unsigned int bgp_ca_community_hash_key(const void *p)
 {
 	const struct community_alias *ca = p;
@@ -97,11 +100,13 @@ int bgp_community_alias_write(struct vty *vty)
 
 void bgp_ca_community_insert(struct community_alias *ca)
 {
+	bgp_ca_generation++;
 	(void)hash_get(bgp_ca_community_hash, ca, bgp_community_alias_alloc);
 }
 
 void bgp_ca_alias_insert(struct community_alias *ca)
 {
+	bgp_ca_generation++;
 	(void)hash_get(bgp_ca_alias_hash, ca, bgp_community_alias_alloc);
 }
 
@@ -109,6 +114,7 @@ void bgp_ca_community_delete(struct community_alias *ca)
 {
 	struct community_alias *data = hash_release(bgp_ca_community_hash, ca);
 
+	bgp_ca_generation++;
 	XFREE(MTYPE_COMMUNITY_ALIAS, data);
 }
 
@@ -116,9 +122,15 @@ void bgp_ca_alias_delete(struct community_alias *ca)
 {
 	struct community_alias *data = hash_release(bgp_ca_alias_hash, ca);
 
+	bgp_ca_generation++;
 	XFREE(MTYPE_COMMUNITY_ALIAS, data);
 }
 
+uint32_t bgp_community_alias_generation(void)
+{
+	return bgp_ca_generation;
+}
+
 struct community_alias *bgp_ca_community_lookup(struct community_alias *ca)
 {
 	return hash_lookup(bgp_ca_community_hash, ca);
@@ -27,6 +27,8 @@ extern void bgp_ca_alias_insert(struct community_alias *ca);
 extern void bgp_ca_community_delete(struct community_alias *ca);
 extern void bgp_ca_alias_delete(struct community_alias *ca);
 extern int bgp_community_alias_write(struct vty *vty);
+/* Changes whenever aliases are added or removed */
+extern uint32_t bgp_community_alias_generation(void);
 extern const char *bgp_community2alias(char *community);
 extern const char *bgp_alias2community(char *alias);
 extern char *bgp_alias2community_str(const char *str);
@@ -125,7 +125,12 @@ static void bgp_conditional_adv_routes(struct peer *peer, afi_t afi,
 				if (!bgp_adj_out_set_subgroup(dest, subgrp,
 							      &attr, pi))
 					bgp_attr_flush(&attr);
+
+				/* attr_ext is not handed over by struct copies */
+				bgp_attr_flush_ext(&advmap_attr);
 			} else {
+				bgp_attr_flush_ext(&attr);
+
 				/* If default originate is enabled for
 				 * the peer, do not send explicit
 				 * withdraw. This will prevent deletion
@@ -134,8 +139,10 @@ static void bgp_conditional_adv_routes(struct peer *peer, afi_t afi,
 				 */
 				if (CHECK_FLAG(peer->af_flags[afi][safi],
 					       PEER_FLAG_DEFAULT_ORIGINATE) &&
-				    is_default_prefix(dest_p))
+				    is_default_prefix(dest_p)) {
+					bgp_attr_flush_ext(&advmap_attr);
 					break;
+				}
 
 				bgp_adj_out_unset_subgroup(
 					dest, subgrp, 1,
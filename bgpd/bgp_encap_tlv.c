@@ -241,7 +241,7 @@ void bgp_encap_type_l2tpv3overip_to_tlv(
 	for (last = attr->encap_subtlvs; last && last->next; last = last->next)
 		;
 
-	attr->encap_tunneltype = BGP_ENCAP_TYPE_L2TPV3_OVER_IP;
+	bgp_attr_set_encap_tunneltype(attr, BGP_ENCAP_TYPE_L2TPV3_OVER_IP);
 
 	assert(CHECK_FLAG(bet->valid_subtlvs, BGP_TEA_SUBTLV_ENCAP));
 
@@ -264,7 +264,7 @@ void bgp_encap_type_gre_to_tlv(
 	for (last = attr->encap_subtlvs; last && last->next; last = last->next)
 		;
 
-	attr->encap_tunneltype = BGP_ENCAP_TYPE_GRE;
+	bgp_attr_set_encap_tunneltype(attr, BGP_ENCAP_TYPE_GRE);
 
 	ENC_SUBTLV(BGP_TEA_SUBTLV_ENCAP, subtlv_encode_encap_gre, st_encap);
 	ENC_SUBTLV(BGP_TEA_SUBTLV_PROTO_TYPE, subtlv_encode_proto_type,
@@ -284,7 +284,7 @@ void bgp_encap_type_ip_in_ip_to_tlv(
 	for (last = attr->encap_subtlvs; last && last->next; last = last->next)
 		;
 
-	attr->encap_tunneltype = BGP_ENCAP_TYPE_IP_IN_IP;
+	bgp_attr_set_encap_tunneltype(attr, BGP_ENCAP_TYPE_IP_IN_IP);
 
 	ENC_SUBTLV(BGP_TEA_SUBTLV_PROTO_TYPE, subtlv_encode_proto_type,
 		   st_proto);
@@ -304,7 +304,8 @@ void bgp_encap_type_transmit_tunnel_endpoint(
 	for (last = attr->encap_subtlvs; last && last->next; last = last->next)
 		;
 
-	attr->encap_tunneltype = BGP_ENCAP_TYPE_TRANSMIT_TUNNEL_ENDPOINT;
+	bgp_attr_set_encap_tunneltype(attr,
+				      BGP_ENCAP_TYPE_TRANSMIT_TUNNEL_ENDPOINT);
 
 	/* no subtlvs for this type */
 }
@@ -319,7 +320,8 @@ void bgp_encap_type_ipsec_in_tunnel_mode_to_tlv(
 	for (last = attr->encap_subtlvs; last && last->next; last = last->next)
 		;
 
-	attr->encap_tunneltype = BGP_ENCAP_TYPE_IPSEC_IN_TUNNEL_MODE;
+	bgp_attr_set_encap_tunneltype(attr,
+				      BGP_ENCAP_TYPE_IPSEC_IN_TUNNEL_MODE);
 
 	ENC_SUBTLV(BGP_TEA_SUBTLV_IPSEC_TA, subtlv_encode_ipsec_ta,
 		   st_ipsec_ta);
@@ -336,8 +338,8 @@ void bgp_encap_type_ip_in_ip_tunnel_with_ipsec_transport_mode_to_tlv(
 	for (last = attr->encap_subtlvs; last && last->next; last = last->next)
 		;
 
-	attr->encap_tunneltype =
-		BGP_ENCAP_TYPE_IP_IN_IP_TUNNEL_WITH_IPSEC_TRANSPORT_MODE;
+	bgp_attr_set_encap_tunneltype(
+		attr, BGP_ENCAP_TYPE_IP_IN_IP_TUNNEL_WITH_IPSEC_TRANSPORT_MODE);
 
 	ENC_SUBTLV(BGP_TEA_SUBTLV_IPSEC_TA, subtlv_encode_ipsec_ta,
 		   st_ipsec_ta);
@@ -354,8 +356,8 @@ void bgp_encap_type_mpls_in_ip_tunnel_with_ipsec_transport_mode_to_tlv(
 	for (last = attr->encap_subtlvs; last && last->next; last = last->next)
 		;
 
-	attr->encap_tunneltype =
-		BGP_ENCAP_TYPE_MPLS_IN_IP_TUNNEL_WITH_IPSEC_TRANSPORT_MODE;
+	bgp_attr_set_encap_tunneltype(
+		attr, BGP_ENCAP_TYPE_MPLS_IN_IP_TUNNEL_WITH_IPSEC_TRANSPORT_MODE);
 
 	ENC_SUBTLV(BGP_TEA_SUBTLV_IPSEC_TA, subtlv_encode_ipsec_ta,
 		   st_ipsec_ta);
@@ -371,7 +373,7 @@ void bgp_encap_type_pbb_to_tlv(
 	for (last = attr->encap_subtlvs; last && last->next; last = last->next)
 		;
 
-	attr->encap_tunneltype = BGP_ENCAP_TYPE_PBB;
+	bgp_attr_set_encap_tunneltype(attr, BGP_ENCAP_TYPE_PBB);
 
 	assert(CHECK_FLAG(bet->valid_subtlvs, BGP_TEA_SUBTLV_ENCAP));
 	ENC_SUBTLV(BGP_TEA_SUBTLV_ENCAP, subtlv_encode_encap_pbb, st_encap);
@@ -384,7 +386,7 @@ void bgp_encap_type_vxlan_to_tlv(
 	struct bgp_attr_encap_subtlv *tlv;
 	uint32_t vnid;
 
-	attr->encap_tunneltype = BGP_ENCAP_TYPE_VXLAN;
+	bgp_attr_set_encap_tunneltype(attr, BGP_ENCAP_TYPE_VXLAN);
 
 	if (bet == NULL || !bet->vnid)
 		return;
@@ -409,7 +411,7 @@ void bgp_encap_type_nvgre_to_tlv(
 	struct bgp_encap_type_nvgre *bet, /* input structure */
 	struct attr *attr)
 {
-	attr->encap_tunneltype = BGP_ENCAP_TYPE_NVGRE;
+	bgp_attr_set_encap_tunneltype(attr, BGP_ENCAP_TYPE_NVGRE);
 }
 
 void bgp_encap_type_mpls_to_tlv(
@@ -423,7 +425,7 @@ void bgp_encap_type_mpls_in_gre_to_tlv(
 	struct bgp_encap_type_mpls_in_gre *bet, /* input structure */
 	struct attr *attr)
 {
-	attr->encap_tunneltype = BGP_ENCAP_TYPE_MPLS_IN_GRE;
+	bgp_attr_set_encap_tunneltype(attr, BGP_ENCAP_TYPE_MPLS_IN_GRE);
 }
 
 void bgp_encap_type_vxlan_gpe_to_tlv(
@@ -431,7 +433,7 @@ void bgp_encap_type_vxlan_gpe_to_tlv(
 	struct attr *attr)
 {
 
-	attr->encap_tunneltype = BGP_ENCAP_TYPE_VXLAN_GPE;
+	bgp_attr_set_encap_tunneltype(attr, BGP_ENCAP_TYPE_VXLAN_GPE);
 }
 
 void bgp_encap_type_mpls_in_udp_to_tlv(
@@ -439,7 +441,7 @@ void bgp_encap_type_mpls_in_udp_to_tlv(
 	struct attr *attr)
 {
 
-	attr->encap_tunneltype = BGP_ENCAP_TYPE_MPLS_IN_UDP;
+	bgp_attr_set_encap_tunneltype(attr, BGP_ENCAP_TYPE_MPLS_IN_UDP);
 }
 
 
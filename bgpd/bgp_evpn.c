@@ -1075,7 +1075,7 @@ static void build_evpn_type5_route_extcomm(struct bgp *bgp_vrf,
 	} else
 		ecom = ecommunity_dup(&ecom_encap);
 	bgp_attr_set_ecommunity(attr, ecom);
-	attr->encap_tunneltype = tnl_type;
+	bgp_attr_set_encap_tunneltype(attr, tnl_type);
 
 	/* Add the export RTs for L3VNI/VRF */
 	vrf_export_rtl = bgp_vrf->vrf_export_rtl;
@@ -1134,7 +1134,7 @@ static void build_evpn_route_extcomm(struct bgpevpn *vpn, struct attr *attr,
 
 	/* Add Encap */
 	bgp_attr_set_ecommunity(attr, ecommunity_dup(&ecom_encap));
-	attr->encap_tunneltype = tnl_type;
+	bgp_attr_set_encap_tunneltype(attr, tnl_type);
 
 	/* Add the export RTs for L2VNI */
 	for (ALL_LIST_ELEMENTS(vpn->export_rtl, node, nnode, ecom))
@@ -1159,7 +1159,7 @@ static void build_evpn_route_extcomm(struct bgpevpn *vpn, struct attr *attr,
 	}
 
 	/* Add MAC mobility (sticky) if needed. */
-	if (attr->sticky) {
+	if (bgp_attr_get_sticky(attr)) {
 		seqnum = 0;
 		memset(&ecom_sticky, 0, sizeof(ecom_sticky));
 		encode_mac_mobility_extcomm(1, seqnum, &eval_sticky);
@@ -1179,7 +1179,7 @@ static void build_evpn_route_extcomm(struct bgpevpn *vpn, struct attr *attr,
 	}
 
 	/* Add default gateway, if needed. */
-	if (attr->default_gw) {
+	if (bgp_attr_get_default_gw(attr)) {
 		memset(&ecom_default_gw, 0, sizeof(ecom_default_gw));
 		encode_default_gw_extcomm(&eval_default_gw);
 		ecom_default_gw.size = 1;
@@ -1191,9 +1191,10 @@ static void build_evpn_route_extcomm(struct bgpevpn *vpn, struct attr *attr,
 	}
 
 	proxy = !!(attr->es_flags & ATTR_ES_PROXY_ADVERT);
-	if (attr->router_flag || proxy) {
+	if (bgp_attr_get_router_flag(attr) || proxy) {
 		memset(&ecom_na, 0, sizeof(ecom_na));
-		encode_na_flag_extcomm(&eval_na, attr->router_flag, proxy);
+		encode_na_flag_extcomm(&eval_na, bgp_attr_get_router_flag(attr),
+				       proxy);
 		ecom_na.size = 1;
 		ecom_na.unit_size = ECOMMUNITY_SIZE;
 		ecom_na.val = (uint8_t *)eval_na.val;
@@ -1278,12 +1279,12 @@ enum zclient_send_status evpn_zebra_install(struct bgp *bgp, struct bgpevpn *vpn
 		flags = 0;
 
 		if (pi->sub_type == BGP_ROUTE_IMPORTED) {
-			if (pi->attr->sticky)
+			if (bgp_attr_get_sticky(pi->attr))
 				SET_FLAG(flags, ZEBRA_MACIP_TYPE_STICKY);
-			if (pi->attr->default_gw)
+			if (bgp_attr_get_default_gw(pi->attr))
 				SET_FLAG(flags, ZEBRA_MACIP_TYPE_GW);
 			if (is_evpn_prefix_ipaddr_v6(p) &&
-					pi->attr->router_flag)
+					bgp_attr_get_router_flag(pi->attr))
 				SET_FLAG(flags, ZEBRA_MACIP_TYPE_ROUTER_FLAG);
 
 			seq = mac_mobility_seqnum(pi->attr);
@@ -1672,6 +1673,7 @@ static int update_evpn_type5_route(struct bgp *bgp_vrf, struct prefix_evpn *evp,
 	afi_t afi = AFI_L2VPN;
 	safi_t safi = SAFI_EVPN;
 	struct attr attr;
+	struct bgp_route_evpn eo;
 	struct bgp_dest *dest = NULL;
 	struct bgp *bgp_evpn = NULL;
 	int route_changed = 0;
@@ -1730,20 +1732,24 @@ static int update_evpn_type5_route(struct bgp *bgp_vrf, struct prefix_evpn *evp,
 		       BGP_L2VPN_EVPN_ADV_IPV6_UNICAST_GW_IP)) {
 		if (src_attr &&
 		    !IN6_IS_ADDR_UNSPECIFIED(&src_attr->mp_nexthop_global)) {
-			attr.evpn_overlay.type = OVERLAY_INDEX_GATEWAY_IP;
-			SET_IPADDR_V6(&attr.evpn_overlay.gw_ip);
-			memcpy(&attr.evpn_overlay.gw_ip.ipaddr_v6,
+			memset(&eo, 0, sizeof(eo));
+			eo.type = OVERLAY_INDEX_GATEWAY_IP;
+			SET_IPADDR_V6(&eo.gw_ip);
+			memcpy(&eo.gw_ip.ipaddr_v6,
 			       &src_attr->mp_nexthop_global,
 			       sizeof(struct in6_addr));
+			bgp_attr_set_evpn_overlay(&attr, &eo);
 		}
 	} else if (src_afi == AFI_IP &&
 		   CHECK_FLAG(bgp_vrf->af_flags[AFI_L2VPN][SAFI_EVPN],
 			      BGP_L2VPN_EVPN_ADV_IPV4_UNICAST_GW_IP)) {
 		if (src_attr && src_attr->nexthop.s_addr != 0) {
-			attr.evpn_overlay.type = OVERLAY_INDEX_GATEWAY_IP;
-			SET_IPADDR_V4(&attr.evpn_overlay.gw_ip);
-			memcpy(&attr.evpn_overlay.gw_ip.ipaddr_v4,
-			       &src_attr->nexthop, sizeof(struct in_addr));
+			memset(&eo, 0, sizeof(eo));
+			eo.type = OVERLAY_INDEX_GATEWAY_IP;
+			SET_IPADDR_V4(&eo.gw_ip);
+			memcpy(&eo.gw_ip.ipaddr_v4, &src_attr->nexthop,
+			       sizeof(struct in_addr));
+			bgp_attr_set_evpn_overlay(&attr, &eo);
 		}
 	}
 
@@ -1768,6 +1774,7 @@ static int update_evpn_type5_route(struct bgp *bgp_vrf, struct prefix_evpn *evp,
 	/* uninten temporary */
 	if (!src_attr)
 		aspath_unintern(&attr.aspath);
+	bgp_attr_flush_ext(&attr);
 	return 0;
 }
 
@@ -1832,7 +1839,7 @@ static void bgp_evpn_get_sync_info(struct bgp *bgp, esi_t *esi,
 			*active_on_peer = true;
 		}
 
-		if (second_best_path->attr->router_flag)
+		if (bgp_attr_get_router_flag(second_best_path->attr))
 			*peer_router = true;
 
 		/* we use both proxy and non-proxy imports to
@@ -1873,7 +1880,7 @@ static void update_evpn_route_entry_sync_info(struct bgp *bgp,
 					       &max_sync_seq, &active_on_peer,
 					       &peer_router, &proxy_from_peer,
 					       mac);
-			attr->mm_sync_seqnum = max_sync_seq;
+			bgp_attr_set_mm_sync_seqnum(attr, max_sync_seq);
 			if (active_on_peer)
 				attr->es_flags |= ATTR_ES_PEER_ACTIVE;
 			else
@@ -1908,7 +1915,7 @@ static void update_evpn_route_entry_sync_info(struct bgp *bgp,
 			}
 		}
 	} else {
-		attr->mm_sync_seqnum = 0;
+		bgp_attr_set_mm_sync_seqnum(attr, 0);
 		attr->es_flags &= ~ATTR_ES_PEER_ACTIVE;
 		attr->es_flags &= ~ATTR_ES_PEER_PROXY;
 	}
@@ -1966,9 +1973,10 @@ static int update_evpn_route_entry(struct bgp *bgp, struct bgpevpn *vpn,
 		local_attr = *attr;
 
 		/* Extract MAC mobility sequence number, if any. */
-		local_attr.mm_seqnum =
-			bgp_attr_mac_mobility_seqnum(&local_attr, &sticky);
-		local_attr.sticky = sticky;
+		bgp_attr_set_mm_seqnum(&local_attr,
+				       bgp_attr_mac_mobility_seqnum(&local_attr,
+								    &sticky));
+		bgp_attr_set_sticky(&local_attr, sticky);
 
 		/* Add (or update) attribute to hash. */
 		attr_new = bgp_attr_intern(&local_attr);
@@ -2053,9 +2061,10 @@ static int update_evpn_route_entry(struct bgp *bgp, struct bgpevpn *vpn,
 					       BGP_PATH_ATTR_CHANGED);
 
 			/* Extract MAC mobility sequence number, if any. */
-			local_attr.mm_seqnum = bgp_attr_mac_mobility_seqnum(
-				&local_attr, &sticky);
-			local_attr.sticky = sticky;
+			bgp_attr_set_mm_seqnum(&local_attr,
+					       bgp_attr_mac_mobility_seqnum(
+						       &local_attr, &sticky));
+			bgp_attr_set_sticky(&local_attr, sticky);
 
 			attr_new = bgp_attr_intern(&local_attr);
 
@@ -2188,10 +2197,14 @@ static int update_evpn_route(struct bgp *bgp, struct bgpevpn *vpn,
 	attr.nexthop = vpn->originator_ip;
 	attr.mp_nexthop_global_in = vpn->originator_ip;
 	attr.mp_nexthop_len = BGP_ATTR_NHLEN_IPV4;
-	attr.sticky = CHECK_FLAG(flags, ZEBRA_MACIP_TYPE_STICKY) ? 1 : 0;
-	attr.default_gw = CHECK_FLAG(flags, ZEBRA_MACIP_TYPE_GW) ? 1 : 0;
-	attr.router_flag = CHECK_FLAG(flags,
-				      ZEBRA_MACIP_TYPE_ROUTER_FLAG) ? 1 : 0;
+	bgp_attr_set_sticky(&attr,
+			    CHECK_FLAG(flags, ZEBRA_MACIP_TYPE_STICKY) ? 1 : 0);
+	bgp_attr_set_default_gw(&attr,
+				CHECK_FLAG(flags, ZEBRA_MACIP_TYPE_GW) ? 1 : 0);
+	bgp_attr_set_router_flag(&attr,
+				 CHECK_FLAG(flags, ZEBRA_MACIP_TYPE_ROUTER_FLAG)
+					 ? 1
+					 : 0);
 	if (CHECK_FLAG(flags, ZEBRA_MACIP_TYPE_PROXY_ADVERT))
 		attr.es_flags |= ATTR_ES_PROXY_ADVERT;
 
@@ -2333,6 +2346,7 @@ static int update_evpn_route(struct bgp *bgp, struct bgpevpn *vpn,
 
 	/* Unintern temporary. */
 	aspath_unintern(&attr.aspath);
+	bgp_attr_flush_ext(&attr);
 
 	return 0;
 }
@@ -2493,13 +2507,15 @@ void bgp_evpn_update_type2_route_entry(struct bgp *bgp, struct bgpevpn *vpn,
 	attr.nexthop = vpn->originator_ip;
 	attr.mp_nexthop_global_in = vpn->originator_ip;
 	attr.mp_nexthop_len = BGP_ATTR_NHLEN_IPV4;
-	attr.sticky = (local_pi->attr->sticky) ? 1 : 0;
-	attr.router_flag = (local_pi->attr->router_flag) ? 1 : 0;
+	bgp_attr_set_sticky(&attr, bgp_attr_get_sticky(local_pi->attr) ? 1 : 0);
+	bgp_attr_set_router_flag(&attr,
+				 bgp_attr_get_router_flag(local_pi->attr) ? 1
+									  : 0);
 	attr.es_flags = local_pi->attr->es_flags;
-	if (local_pi->attr->default_gw) {
-		attr.default_gw = 1;
+	if (bgp_attr_get_default_gw(local_pi->attr)) {
+		bgp_attr_set_default_gw(&attr, 1);
 		if (is_evpn_prefix_ipaddr_v6(&evp))
-			attr.router_flag = 1;
+			bgp_attr_set_router_flag(&attr, 1);
 	}
 	memcpy(&attr.esi, &local_pi->attr->esi, sizeof(esi_t));
 	bgp_evpn_get_rmac_nexthop(vpn, &evp, &attr,
@@ -2604,6 +2620,7 @@ void bgp_evpn_update_type2_route_entry(struct bgp *bgp, struct bgpevpn *vpn,
 
 	/* Unintern temporary. */
 	aspath_unintern(&attr.aspath);
+	bgp_attr_flush_ext(&attr);
 }
 
 static void update_type2_route(struct bgp *bgp, struct bgpevpn *vpn,
@@ -3006,6 +3023,7 @@ static int install_evpn_route_entry_in_vrf(struct bgp *bgp_vrf,
 	struct bgp_path_info *pi;
 	struct attr attr;
 	struct attr *attr_new;
+	const struct bgp_route_evpn *eo;
 	int ret = 0;
 	struct prefix p;
 	struct prefix *pp = &p;
@@ -3045,7 +3063,8 @@ static int install_evpn_route_entry_in_vrf(struct bgp *bgp_vrf,
 	 * make sure to set the flag for next hop attribute.
 	 */
 	attr = *parent_pi->attr;
-	if (attr.evpn_overlay.type != OVERLAY_INDEX_GATEWAY_IP) {
+	eo = bgp_attr_get_evpn_overlay(&attr);
+	if (eo->type != OVERLAY_INDEX_GATEWAY_IP) {
 		if (afi == AFI_IP6)
 			evpn_convert_nexthop_to_ipv6(&attr);
 		else {
@@ -3062,18 +3081,19 @@ static int install_evpn_route_entry_in_vrf(struct bgp *bgp_vrf,
 		if (bgp_debug_zebra(NULL)) {
 			zlog_debug(
 				"Install gateway IP %s as nexthop for prefix %pFX in vrf %s",
-				inet_ntop(pp->family, &attr.evpn_overlay.gw_ip,
+				inet_ntop(pp->family,
+					  &eo->gw_ip,
 					  buf1, sizeof(buf1)), pp,
 					  vrf_id_to_name(bgp_vrf->vrf_id));
 		}
 
 		if (afi == AFI_IP6) {
 			memcpy(&attr.mp_nexthop_global,
-			       &attr.evpn_overlay.gw_ip.ipaddr_v6,
+			       &eo->gw_ip.ipaddr_v6,
 			       sizeof(struct in6_addr));
 			attr.mp_nexthop_len = IPV6_MAX_BYTELEN;
 		} else {
-			attr.nexthop = attr.evpn_overlay.gw_ip.ipaddr_v4;
+			attr.nexthop = eo->gw_ip.ipaddr_v4;
 			attr.flag |= ATTR_FLAG_BIT(BGP_ATTR_NEXT_HOP);
 		}
 	}
@@ -3125,14 +3145,14 @@ static int install_evpn_route_entry_in_vrf(struct bgp *bgp_vrf,
 	}
 
 	/* Gateway IP nexthop should be resolved */
-	if (attr.evpn_overlay.type == OVERLAY_INDEX_GATEWAY_IP) {
+	if (eo->type == OVERLAY_INDEX_GATEWAY_IP) {
 		if (bgp_find_or_add_nexthop(bgp_vrf, bgp_vrf, afi, safi, pi,
 					    NULL, 0, NULL))
 			bgp_path_info_set_flag(dest, pi, BGP_PATH_VALID);
 		else {
 			if (BGP_DEBUG(nht, NHT)) {
 				inet_ntop(pp->family,
-					  &attr.evpn_overlay.gw_ip,
+					  &eo->gw_ip,
 					  buf1, sizeof(buf1));
 				zlog_debug("%s: gateway IP NH unresolved",
 					   buf1);
@@ -5041,7 +5061,7 @@ static void evpn_mpattr_encode_type5(struct stream *s, const struct prefix *p,
 	/* Prefix contains RD, ESI, EthTag, IP length, IP, GWIP and VNI */
 	stream_putc(s, 8 + 10 + 4 + 1 + len + 3);
 	stream_put(s, prd->val, 8);
-	if (attr && attr->evpn_overlay.type == OVERLAY_INDEX_ESI)
+	if (attr && bgp_attr_get_evpn_overlay(attr)->type == OVERLAY_INDEX_ESI)
 		stream_put(s, &attr->esi, sizeof(esi_t));
 	else
 		stream_put(s, 0, sizeof(esi_t));
@@ -5051,7 +5071,8 @@ static void evpn_mpattr_encode_type5(struct stream *s, const struct prefix *p,
 		stream_put_ipv4(s, p_evpn_p->prefix_addr.ip.ipaddr_v4.s_addr);
 	else
 		stream_put(s, &p_evpn_p->prefix_addr.ip.ipaddr_v6, 16);
-	if (attr && attr->evpn_overlay.type == OVERLAY_INDEX_GATEWAY_IP) {
+	if (attr &&
+	    bgp_attr_get_evpn_overlay(attr)->type == OVERLAY_INDEX_GATEWAY_IP) {
 		const struct bgp_route_evpn *evpn_overlay =
 			bgp_attr_get_evpn_overlay(attr);
 
@@ -124,8 +124,11 @@ static int bgp_evpn_es_route_select_install(struct bgp *bgp,
 		if (bgp_zebra_has_route_changed(old_select)) {
 			bgp_evpn_es_vtep_add(bgp, es, old_select->attr->nexthop,
 					     true /*esr*/,
-					     old_select->attr->df_alg,
-					     old_select->attr->df_pref, &zret);
+					     bgp_attr_get_df_alg(
+						     old_select->attr),
+					     bgp_attr_get_df_pref(
+						     old_select->attr),
+					     &zret);
 		}
 		UNSET_FLAG(old_select->flags, BGP_PATH_MULTIPATH_CHG);
 		bgp_zebra_clear_route_change_flags(dest);
@@ -153,8 +156,10 @@ static int bgp_evpn_es_route_select_install(struct bgp *bgp,
 	if (new_select && new_select->type == ZEBRA_ROUTE_BGP
 			&& new_select->sub_type == BGP_ROUTE_IMPORTED) {
 		bgp_evpn_es_vtep_add(bgp, es, new_select->attr->nexthop,
-				     true /*esr */, new_select->attr->df_alg,
-				     new_select->attr->df_pref, &zret);
+				     true /*esr */,
+				     bgp_attr_get_df_alg(new_select->attr),
+				     bgp_attr_get_df_pref(new_select->attr),
+				     &zret);
 	} else {
 		if (old_select && old_select->type == ZEBRA_ROUTE_BGP
 				&& old_select->sub_type == BGP_ROUTE_IMPORTED)
@@ -35,6 +35,21 @@ struct as_list_master {
 };
 
 
+/* Direct mapped by aspath serial, which are handed out sequentially so the
+ * most recently interned paths never collide.  Must be a power of 2.
+ */
+#define AS_LIST_CACHE_SIZE 4096
+
+struct as_list_cache_entry {
+	const struct aspath *aspath;
+	uint32_t serial;
+	enum as_filter_type type;
+};
+
+static void as_list_cache_flush(struct as_list *aslist)
+{
+	XFREE(MTYPE_AS_LIST_CACHE, aslist->cache);
+}
 
 /* Calculate new sequential number. */
 static int64_t bgp_alist_new_seq_get(struct as_list *list)
@@ -84,6 +99,7 @@ static void as_filter_free(struct as_filter *asfilter)
 {
 	if (asfilter->reg)
 		bgp_regex_free(asfilter->reg);
+	bgp_aspath_regex_free(asfilter->asreg);
 	XFREE(MTYPE_AS_FILTER_STR, asfilter->reg_str);
 	XFREE(MTYPE_AS_FILTER, asfilter);
 }
@@ -96,6 +112,7 @@ static struct as_filter *as_filter_make(regex_t *reg, const char *reg_str,
 
 	asfilter = as_filter_new();
 	asfilter->reg = reg;
+	asfilter->asreg = bgp_aspath_regcomp(reg_str);
 	asfilter->type = type;
 	asfilter->reg_str = XSTRDUP(MTYPE_AS_FILTER_STR, reg_str);
 
@@ -143,6 +160,8 @@ static void as_list_filter_add(struct as_list *aslist,
 	struct as_filter *point;
 	struct as_filter *replace;
 
+	as_list_cache_flush(aslist);
+
 	if (aslist->tail && asfilter->seq > aslist->tail->seq)
 		point = NULL;
 	else {
@@ -214,6 +233,7 @@ static void as_list_free(struct as_list *aslist)
 		cur_bp = next_bp;
 	}
 
+	as_list_cache_flush(aslist);
 	XFREE (MTYPE_AS_STR, aslist->name);
 	XFREE (MTYPE_AS_LIST, aslist);
 }
@@ -337,6 +357,8 @@ static void as_list_filter_delete(struct as_list *aslist,
 {
 	char *name = XSTRDUP(MTYPE_AS_STR, aslist->name);
 
+	as_list_cache_flush(aslist);
+
 	if (asfilter->next)
 		asfilter->next->prev = asfilter->prev;
 	else
@@ -361,13 +383,32 @@ static void as_list_filter_delete(struct as_list *aslist,
 
 static bool as_filter_match(struct as_filter *asfilter, struct aspath *aspath)
 {
+	int ret;
+
+	if (asfilter->asreg) {
+		ret = bgp_aspath_regexec(asfilter->asreg, aspath);
+		if (ret >= 0)
+			return ret;
+	}
 	return bgp_regexec(asfilter->reg, aspath) != REG_NOMATCH;
 }
 
+static enum as_filter_type as_list_match(struct as_list *aslist,
+					 struct aspath *aspath)
+{
+	struct as_filter *asfilter;
+
+	for (asfilter = aslist->head; asfilter; asfilter = asfilter->next) {
+		if (as_filter_match(asfilter, aspath))
+			return asfilter->type;
+	}
+	return AS_FILTER_DENY;
+}
+
 /* Apply AS path filter to AS. */
 enum as_filter_type as_list_apply(struct as_list *aslist, void *object)
 {
-	struct as_filter *asfilter;
+	struct as_list_cache_entry *entry;
 	struct aspath *aspath;
 
 	aspath = (struct aspath *)object;
@@ -375,11 +416,26 @@ enum as_filter_type as_list_apply(struct as_list *aslist, void *object)
 	if (aslist == NULL)
 		return AS_FILTER_DENY;
 
-	for (asfilter = aslist->head; asfilter; asfilter = asfilter->next) {
-		if (as_filter_match(asfilter, aspath))
-			return asfilter->type;
+	/* Only interned paths have a serial and stay immutable */
+	if (!aspath->refcnt)
+		return as_list_match(aslist, aspath);
+
+	if (!aslist->cache)
+		aslist->cache = XCALLOC(MTYPE_AS_LIST_CACHE,
+					AS_LIST_CACHE_SIZE *
+						sizeof(*aslist->cache));
+
+	entry = &aslist->cache[aspath->serial & (AS_LIST_CACHE_SIZE - 1)];
+	if (entry->aspath == aspath && entry->serial == aspath->serial) {
+		aslist->cache_hits++;
+		return entry->type;
 	}
-	return AS_FILTER_DENY;
+
+	aslist->cache_misses++;
+	entry->aspath = aspath;
+	entry->serial = aspath->serial;
+	entry->type = as_list_match(aslist, aspath);
+	return entry->type;
 }
 
 /* Add hook function. */
@@ -618,6 +674,12 @@ static void as_list_show(struct vty *vty, struct as_list *aslist,
 				filter_type_str(asfilter->type),
 				asfilter->reg_str);
 	}
+
+	if (!json)
+		vty_out(vty,
+			"    Result cache: %" PRIu64 " hits, %" PRIu64
+			" misses\n",
+			aslist->cache_hits, aslist->cache_misses);
 }
 
 static void as_list_show_all(struct vty *vty, json_object *json)
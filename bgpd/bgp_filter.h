@@ -20,6 +20,8 @@ struct as_filter {
 
 	regex_t *reg;
 	char *reg_str;
+	/* Compiled ASN matcher, NULL if reg_str is outside its subset */
+	struct bgp_aspath_regex *asreg;
 
 	/* Sequence number. */
 	int64_t seq;
@@ -40,6 +42,11 @@ struct as_list {
 	struct as_filter *head;
 	struct as_filter *tail;
 	struct aspath_exclude_list *exclude_list;
+
+	/* Results for recently matched interned AS paths */
+	struct as_list_cache_entry *cache;
+	uint64_t cache_hits;
+	uint64_t cache_misses;
 };
 
 
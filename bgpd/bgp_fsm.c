@@ -40,6 +40,7 @@
 #include "bgpd/bgp_memory.h"
 #include "bgpd/bgp_keepalives.h"
 #include "bgpd/bgp_io.h"
+#include "bgpd/bgp_preparse.h"
 #include "bgpd/bgp_zebra.h"
 #include "bgpd/bgp_vty.h"
 
@@ -1488,8 +1489,9 @@ enum bgp_fsm_state_progress bgp_stop(struct peer_connection *connection)
 	frr_with_mutex (&connection->io_mtx) {
 		if (connection->ibuf)
 			stream_fifo_clean(connection->ibuf);
+		bgp_preparse_fifo_flush(&connection->ipreparse);
 		if (connection->obuf)
-			stream_fifo_clean(connection->obuf);
+			bgp_obuf_clean(connection->obuf);
 
 		if (connection->ibuf_work)
 			ringbuf_wipe(connection->ibuf_work);
@@ -1498,6 +1500,7 @@ enum bgp_fsm_state_progress bgp_stop(struct peer_connection *connection)
 			stream_free(peer->curr);
 			peer->curr = NULL;
 		}
+		bgp_preparse_free(&peer->curr_preparse);
 	}
 
 	/* Close of file descriptor. */
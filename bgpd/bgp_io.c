@@ -14,6 +14,7 @@
 #include "linklist.h"		// for list_delete, list_delete_all_node, lis...
 #include "log.h"		// for zlog_debug, safe_strerror, zlog_err
 #include "memory.h"		// for MTYPE_TMP, XCALLOC, XFREE
+#include "monotime.h"		// for monotime, monotime_since
 #include "network.h"		// for ERRNO_IO_RETRY
 #include "stream.h"		// for stream_get_endp, stream_getw_from, str...
 #include "ringbuf.h"		// for ringbuf_remain, ringbuf_peek, ringbuf_...
@@ -24,13 +25,51 @@
 #include "bgpd/bgp_errors.h"	// for expanded error reference information
 #include "bgpd/bgp_fsm.h"	// for BGP_EVENT_ADD, bgp_event
 #include "bgpd/bgp_packet.h"	// for bgp_notify_io_invalid...
+#include "bgpd/bgp_preparse.h"	// for bgp_preparse_update
 #include "bgpd/bgp_trace.h"	// for frrtraces
 #include "bgpd/bgpd.h"		// for peer, BGP_MARKER_SIZE, bgp_master, bm
+#include "lib/json.h"		// for json_object_new_object, vty_json
 /* clang-format on */
 
+DEFINE_MTYPE_STATIC(BGPD, BGP_IO_SCRATCH, "BGP I/O read buffer");
+DEFINE_MTYPE_STATIC(BGPD, BGP_OBUF, "BGP output queue");
+DEFINE_MTYPE_STATIC(BGPD, BGP_OPKT, "BGP output queue entry");
+DEFINE_MTYPE_STATIC(BGPD, BGP_OPKT_SHARED, "BGP shared UPDATE packet");
+
+/* One I/O pthread of the pool, connections are pinned to one of these */
+struct bgp_io_thread {
+	unsigned int id;
+	struct frr_pthread *pth;
+
+	/* Transfer buffer for bgp_read(), owned by this pthread */
+	uint8_t *ibuf_scratch;
+	bool ibuf_full_logged;
+
+	/* Connections with reads or writes turned on */
+	atomic_uint_fast32_t connections;
+
+	/* Statistics, only written by this pthread */
+	atomic_uint_fast64_t reads;
+	atomic_uint_fast64_t writes;
+	atomic_uint_fast64_t pkts_in;
+	atomic_uint_fast64_t pkts_out;
+	atomic_uint_fast64_t busy_usec;
+};
+
+#define BGP_IO_SCRATCH_SIZE                                                    \
+	(BGP_EXTENDED_MESSAGE_MAX_PACKET_SIZE * BGP_READ_PACKET_MAX)
+
+static struct bgp_io_thread io_threads[BGP_IO_THREADS_MAX];
+/* pthreads created, main pthread only */
+static unsigned int io_nthreads;
+/* pthreads new connections are assigned to, main pthread only */
+static unsigned int io_nactive;
+
 /* forward declarations */
-static uint16_t bgp_write(struct peer_connection *connection);
-static uint16_t bgp_read(struct peer_connection *connection, int *code_p);
+static uint16_t bgp_write(struct peer_connection *connection,
+			  unsigned int *written);
+static uint16_t bgp_read(struct peer_connection *connection,
+			 struct bgp_io_thread *io, int *code_p);
 static void bgp_process_writes(struct event *event);
 static void bgp_process_reads(struct event *event);
 static bool validate_header(struct peer_connection *connection);
@@ -40,11 +79,282 @@ static bool validate_header(struct peer_connection *connection);
 #define BGP_IO_FATAL_ERR (1 << 1) /* some kind of fatal TCP error */
 #define BGP_IO_WORK_FULL_ERR (1 << 2) /* No room in work buffer */
 
+/* Output queue ------------------------------------------------------------ */
+
+struct bgp_obuf *bgp_obuf_new(void)
+{
+	return XCALLOC(MTYPE_BGP_OBUF, sizeof(struct bgp_obuf));
+}
+
+void bgp_obuf_clean(struct bgp_obuf *obuf)
+{
+	struct bgp_opkt *opkt;
+
+	while ((opkt = bgp_obuf_pop(obuf)))
+		bgp_opkt_free(opkt);
+}
+
+void bgp_obuf_free(struct bgp_obuf *obuf)
+{
+	bgp_obuf_clean(obuf);
+	XFREE(MTYPE_BGP_OBUF, obuf);
+}
+
+void bgp_obuf_push(struct bgp_obuf *obuf, struct bgp_opkt *opkt)
+{
+	opkt->next = NULL;
+
+	if (obuf->tail)
+		obuf->tail->next = opkt;
+	else
+		obuf->head = opkt;
+	obuf->tail = opkt;
+
+	atomic_fetch_add_explicit(&obuf->count, 1, memory_order_relaxed);
+}
+
+struct bgp_opkt *bgp_obuf_pop(struct bgp_obuf *obuf)
+{
+	struct bgp_opkt *opkt = obuf->head;
+
+	if (!opkt)
+		return NULL;
+
+	obuf->head = opkt->next;
+	if (!obuf->head)
+		obuf->tail = NULL;
+	opkt->next = NULL;
+
+	atomic_fetch_sub_explicit(&obuf->count, 1, memory_order_relaxed);
+
+	return opkt;
+}
+
+struct bgp_opkt *bgp_obuf_head(struct bgp_obuf *obuf)
+{
+	return obuf->head;
+}
+
+struct bgp_opkt *bgp_opkt_new(struct stream *s)
+{
+	struct bgp_opkt *opkt = XCALLOC(MTYPE_BGP_OPKT, sizeof(*opkt));
+
+	opkt->s = s;
+
+	return opkt;
+}
+
+struct bgp_opkt *bgp_opkt_new_shared(struct bgp_opkt_shared *shared)
+{
+	struct bgp_opkt *opkt = XCALLOC(MTYPE_BGP_OPKT, sizeof(*opkt));
+
+	atomic_fetch_add_explicit(&shared->refcnt, 1, memory_order_relaxed);
+	opkt->shared = shared;
+
+	return opkt;
+}
+
+void bgp_opkt_patch(struct bgp_opkt *opkt, size_t field, size_t field_len,
+		    size_t offset, const void *data, size_t len)
+{
+	const struct stream *s = opkt->shared->s;
+
+	assert(field_len && field_len <= BGP_OPKT_PATCH_MAX);
+	assert(field + field_len <= stream_get_endp(s));
+	assert(offset >= field && offset + len <= field + field_len);
+
+	if (!opkt->patch_len) {
+		opkt->patch_offset = field;
+		opkt->patch_len = field_len;
+		memcpy(opkt->patch, STREAM_DATA(s) + field, field_len);
+	}
+
+	assert(opkt->patch_offset == field && opkt->patch_len == field_len);
+	memcpy(opkt->patch + (offset - field), data, len);
+}
+
+void bgp_opkt_free(struct bgp_opkt *opkt)
+{
+	if (opkt->s)
+		stream_free(opkt->s);
+	if (opkt->shared)
+		bgp_opkt_shared_unref(&opkt->shared);
+
+	XFREE(MTYPE_BGP_OPKT, opkt);
+}
+
+struct bgp_opkt_shared *bgp_opkt_shared_new(struct stream *s)
+{
+	struct bgp_opkt_shared *shared;
+
+	shared = XCALLOC(MTYPE_BGP_OPKT_SHARED, sizeof(*shared));
+	shared->s = s;
+	atomic_store_explicit(&shared->refcnt, 1, memory_order_relaxed);
+
+	return shared;
+}
+
+void bgp_opkt_shared_unref(struct bgp_opkt_shared **shared)
+{
+	if (atomic_fetch_sub_explicit(&(*shared)->refcnt, 1,
+				      memory_order_acq_rel) == 1) {
+		stream_free((*shared)->s);
+		XFREE(MTYPE_BGP_OPKT_SHARED, *shared);
+	}
+
+	*shared = NULL;
+}
+
+/* Start and total length of the packet bytes */
+static const uint8_t *bgp_opkt_data(const struct bgp_opkt *opkt, size_t *len)
+{
+	/* nobody may move the read pointer of a shared stream */
+	if (opkt->shared) {
+		*len = stream_get_endp(opkt->shared->s);
+		return STREAM_DATA(opkt->shared->s);
+	}
+
+	*len = STREAM_READABLE(opkt->s);
+	return stream_pnt(opkt->s);
+}
+
+/*
+ * Fill in the iovecs for the part of the packet that has not been written
+ * yet, returns how many were used (at most BGP_OPKT_IOV_MAX).
+ */
+static unsigned int bgp_opkt_iov(const struct bgp_opkt *opkt,
+				 struct iovec *iov)
+{
+	const uint8_t *data;
+	size_t len, skip = opkt->written;
+	struct {
+		const uint8_t *base;
+		size_t len;
+	} seg[BGP_OPKT_IOV_MAX];
+	unsigned int i, nseg = 0, niov = 0;
+
+	data = bgp_opkt_data(opkt, &len);
+
+	if (opkt->patch_len) {
+		seg[nseg].base = data;
+		seg[nseg++].len = opkt->patch_offset;
+		seg[nseg].base = opkt->patch;
+		seg[nseg++].len = opkt->patch_len;
+		seg[nseg].base = data + opkt->patch_offset + opkt->patch_len;
+		seg[nseg++].len = len - opkt->patch_offset - opkt->patch_len;
+	} else {
+		seg[nseg].base = data;
+		seg[nseg++].len = len;
+	}
+
+	for (i = 0; i < nseg; i++) {
+		if (skip >= seg[i].len) {
+			skip -= seg[i].len;
+			continue;
+		}
+
+		iov[niov].iov_base = (void *)(seg[i].base + skip);
+		iov[niov].iov_len = seg[i].len - skip;
+		niov++;
+		skip = 0;
+	}
+
+	return niov;
+}
+
 /* Thread external API ----------------------------------------------------- */
 
+void bgp_io_init(struct frr_pthread *fpt)
+{
+	io_threads[0].pth = fpt;
+	io_threads[0].ibuf_scratch = XMALLOC(MTYPE_BGP_IO_SCRATCH,
+					     BGP_IO_SCRATCH_SIZE);
+	io_nthreads = io_nactive = 1;
+}
+
+void bgp_io_set_threads(unsigned int threads)
+{
+	struct frr_pthread_attr attr = {
+		.start = frr_pthread_attr_default.start,
+		.stop = frr_pthread_attr_default.stop,
+	};
+	struct bgp_io_thread *io;
+	char name[32], os_name[16];
+
+	threads = MAX(threads, 1U);
+	threads = MIN(threads, BGP_IO_THREADS_MAX);
+
+	/*
+	 * Connections stay on the pthread they were assigned to for as long
+	 * as their I/O is on, so a shrinking pool only stops handing out the
+	 * surplus pthreads; they are not torn down before shutdown.
+	 */
+	while (io_nthreads < threads) {
+		io = &io_threads[io_nthreads];
+
+		snprintf(name, sizeof(name), "BGP I/O thread %u", io_nthreads);
+		snprintf(os_name, sizeof(os_name), "bgpd_io%u", io_nthreads);
+
+		io->id = io_nthreads;
+		io->ibuf_scratch = XMALLOC(MTYPE_BGP_IO_SCRATCH,
+					   BGP_IO_SCRATCH_SIZE);
+		io->pth = frr_pthread_new(&attr, name, os_name);
+		frr_pthread_run(io->pth, NULL);
+		frr_pthread_wait_running(io->pth);
+
+		io_nthreads++;
+	}
+
+	io_nactive = threads;
+}
+
+/*
+ * Pick the least loaded pthread when a connection turns on its first kind
+ * of I/O, it then stays there until both reads and writes are off again.
+ */
+static struct bgp_io_thread *bgp_io_get(struct peer_connection *connection)
+{
+	struct bgp_io_thread *io;
+	uint_fast32_t load, min_load = UINT_FAST32_MAX;
+	unsigned int i;
+
+	if (CHECK_FLAG(connection->thread_flags,
+		       PEER_THREAD_READS_ON | PEER_THREAD_WRITES_ON))
+		return connection->io;
+
+	io = &io_threads[0];
+	for (i = 0; i < io_nactive; i++) {
+		load = atomic_load_explicit(&io_threads[i].connections,
+					    memory_order_relaxed);
+		if (load < min_load) {
+			min_load = load;
+			io = &io_threads[i];
+		}
+	}
+
+	atomic_fetch_add_explicit(&io->connections, 1, memory_order_relaxed);
+	connection->io = io;
+
+	return io;
+}
+
+static void bgp_io_put(struct peer_connection *connection, uint32_t flag)
+{
+	if (!CHECK_FLAG(connection->thread_flags, flag))
+		return;
+
+	UNSET_FLAG(connection->thread_flags, flag);
+
+	if (!CHECK_FLAG(connection->thread_flags,
+			PEER_THREAD_READS_ON | PEER_THREAD_WRITES_ON))
+		atomic_fetch_sub_explicit(&connection->io->connections, 1,
+					  memory_order_relaxed);
+}
+
 void bgp_writes_on(struct peer_connection *connection)
 {
-	struct frr_pthread *fpt = bgp_pth_io;
+	struct bgp_io_thread *io = bgp_io_get(connection);
+	struct frr_pthread *fpt = io->pth;
 
 	assert(fpt->running);
 
@@ -63,19 +373,22 @@ void bgp_writes_on(struct peer_connection *connection)
 
 void bgp_writes_off(struct peer_connection *connection)
 {
-	struct peer *peer = connection->peer;
-	struct frr_pthread *fpt = bgp_pth_io;
-	assert(fpt->running);
-
-	event_cancel_async(fpt->master, &connection->t_write, NULL);
+	/* connection->io is set the first time I/O is turned on */
+	if (connection->io) {
+		assert(connection->io->pth->running);
+		event_cancel_async(connection->io->pth->master,
+				   &connection->t_write, NULL);
+	}
 	EVENT_OFF(connection->t_generate_updgrp_packets);
 
-	UNSET_FLAG(peer->connection->thread_flags, PEER_THREAD_WRITES_ON);
+	bgp_io_put(connection, PEER_THREAD_WRITES_ON);
 }
 
 void bgp_reads_on(struct peer_connection *connection)
 {
-	struct frr_pthread *fpt = bgp_pth_io;
+	struct bgp_io_thread *io = bgp_io_get(connection);
+	struct frr_pthread *fpt = io->pth;
+
 	assert(fpt->running);
 
 	assert(connection->status != Deleted);
@@ -95,14 +408,89 @@ void bgp_reads_on(struct peer_connection *connection)
 
 void bgp_reads_off(struct peer_connection *connection)
 {
-	struct frr_pthread *fpt = bgp_pth_io;
-	assert(fpt->running);
-
-	event_cancel_async(fpt->master, &connection->t_read, NULL);
+	/* connection->io is set the first time I/O is turned on */
+	if (connection->io) {
+		assert(connection->io->pth->running);
+		event_cancel_async(connection->io->pth->master,
+				   &connection->t_read, NULL);
+	}
 	EVENT_OFF(connection->t_process_packet);
 	EVENT_OFF(connection->t_process_packet_error);
 
-	UNSET_FLAG(connection->thread_flags, PEER_THREAD_READS_ON);
+	bgp_io_put(connection, PEER_THREAD_READS_ON);
+}
+
+void bgp_io_show(struct vty *vty, bool use_json)
+{
+	struct bgp_io_thread *io;
+	json_object *json = NULL, *json_threads = NULL, *json_thread;
+	uint64_t reads, writes, pkts_in, pkts_out, busy_usec;
+	uint32_t connections;
+	unsigned int i;
+
+	if (use_json) {
+		json = json_object_new_object();
+		json_threads = json_object_new_array();
+		json_object_int_add(json, "threadCount", io_nthreads);
+		json_object_int_add(json, "activeThreadCount", io_nactive);
+	} else {
+		vty_out(vty, "BGP I/O threads: %u (%u taking new connections)\n",
+			io_nthreads, io_nactive);
+		vty_out(vty, "\n%-6s %-11s %-12s %-12s %-12s %-12s %s\n",
+			"Thread", "Connections", "Reads", "Packets in",
+			"Writes", "Packets out", "Busy (ms)");
+	}
+
+	for (i = 0; i < io_nthreads; i++) {
+		io = &io_threads[i];
+		connections = atomic_load_explicit(&io->connections,
+						   memory_order_relaxed);
+		reads = atomic_load_explicit(&io->reads, memory_order_relaxed);
+		writes = atomic_load_explicit(&io->writes, memory_order_relaxed);
+		pkts_in = atomic_load_explicit(&io->pkts_in,
+					       memory_order_relaxed);
+		pkts_out = atomic_load_explicit(&io->pkts_out,
+						memory_order_relaxed);
+		busy_usec = atomic_load_explicit(&io->busy_usec,
+						 memory_order_relaxed);
+
+		if (use_json) {
+			json_thread = json_object_new_object();
+			json_object_int_add(json_thread, "thread", io->id);
+			json_object_boolean_add(json_thread, "active",
+						i < io_nactive);
+			json_object_int_add(json_thread, "connections",
+					    connections);
+			json_object_int_add(json_thread, "reads", reads);
+			json_object_int_add(json_thread, "packetsIn", pkts_in);
+			json_object_int_add(json_thread, "writes", writes);
+			json_object_int_add(json_thread, "packetsOut",
+					    pkts_out);
+			json_object_int_add(json_thread, "busyMsecs",
+					    busy_usec / 1000);
+			json_object_array_add(json_threads, json_thread);
+		} else
+			vty_out(vty,
+				"%-6u %-11u %-12" PRIu64 " %-12" PRIu64
+				" %-12" PRIu64 " %-12" PRIu64 " %" PRIu64 "\n",
+				io->id, connections, reads, pkts_in, writes,
+				pkts_out, busy_usec / 1000);
+	}
+
+	if (use_json) {
+		json_object_object_add(json, "threads", json_threads);
+		vty_json(vty, json);
+	}
+}
+
+void bgp_io_finish(void)
+{
+	unsigned int i;
+
+	for (i = 0; i < io_nthreads; i++)
+		XFREE(MTYPE_BGP_IO_SCRATCH, io_threads[i].ibuf_scratch);
+
+	io_nthreads = io_nactive = 0;
 }
 
 /* Thread internal functions ----------------------------------------------- */
@@ -112,8 +500,11 @@ void bgp_reads_off(struct peer_connection *connection)
  */
 static void bgp_process_writes(struct event *thread)
 {
-	static struct peer *peer;
+	struct peer *peer;
 	struct peer_connection *connection = EVENT_ARG(thread);
+	struct bgp_io_thread *io = connection->io;
+	struct timeval start;
+	unsigned int written = 0;
 	uint16_t status;
 	bool reschedule;
 	bool fatal = false;
@@ -123,13 +514,18 @@ static void bgp_process_writes(struct event *thread)
 	if (connection->fd < 0)
 		return;
 
-	struct frr_pthread *fpt = bgp_pth_io;
+	struct frr_pthread *fpt = io->pth;
+
+	monotime(&start);
 
 	frr_with_mutex (&connection->io_mtx) {
-		status = bgp_write(connection);
-		reschedule = (stream_fifo_head(connection->obuf) != NULL);
+		status = bgp_write(connection, &written);
+		reschedule = (bgp_obuf_head(connection->obuf) != NULL);
 	}
 
+	atomic_fetch_add_explicit(&io->writes, 1, memory_order_relaxed);
+	atomic_fetch_add_explicit(&io->pkts_out, written, memory_order_relaxed);
+
 	/* no problem */
 	if (CHECK_FLAG(status, BGP_IO_TRANS_ERR)) {
 	}
@@ -152,6 +548,9 @@ static void bgp_process_writes(struct event *thread)
 		BGP_UPDATE_GROUP_TIMER_ON(&connection->t_generate_updgrp_packets,
 					  bgp_generate_updgrp_packets);
 	}
+
+	atomic_fetch_add_explicit(&io->busy_usec, monotime_since(&start, NULL),
+				  memory_order_relaxed);
 }
 
 static int read_ibuf_work(struct peer_connection *connection)
@@ -162,6 +561,7 @@ static int read_ibuf_work(struct peer_connection *connection)
 	/* packet size as given by header */
 	uint16_t pktsize = 0;
 	struct stream *pkt;
+	struct bgp_preparse *pp = NULL;
 
 	/* ============================================== */
 	frr_with_mutex (&connection->io_mtx) {
@@ -199,8 +599,13 @@ static int read_ibuf_work(struct peer_connection *connection)
 	assert(ringbuf_get(ibw, pkt->data, pktsize) == pktsize);
 	stream_set_endp(pkt, pktsize);
 
+	if (CHECK_FLAG(bm->flags, BM_FLAG_UPDATE_PREPARSE))
+		pp = bgp_preparse_update(connection->peer, pkt);
+
 	frrtrace(2, frr_bgp, packet_read, connection->peer, pkt);
 	frr_with_mutex (&connection->io_mtx) {
+		if (pp)
+			bgp_preparse_fifo_add_tail(&connection->ipreparse, pp);
 		stream_fifo_push(connection->ibuf, pkt);
 	}
 
@@ -219,12 +624,14 @@ static void bgp_process_reads(struct event *thread)
 {
 	/* clang-format off */
 	struct peer_connection *connection = EVENT_ARG(thread);
-	static struct peer *peer;       /* peer to read from */
+	struct bgp_io_thread *io = connection->io;
+	struct peer *peer;              /* peer to read from */
+	struct timeval start;           /* for busy time accounting */
+	unsigned int pkts = 0;          /* packets pushed onto ->connection.ibuf */
 	uint16_t status;                /* bgp_read status code */
 	bool fatal = false;             /* whether fatal error occurred */
 	bool added_pkt = false;         /* whether we pushed onto ->connection.ibuf */
 	int code = 0;                   /* FSM code if error occurred */
-	static bool ibuf_full_logged;   /* Have we logged full already */
 	int ret = 1;
 	/* clang-format on */
 
@@ -233,10 +640,12 @@ static void bgp_process_reads(struct event *thread)
 	if (bm->terminating || connection->fd < 0)
 		return;
 
-	struct frr_pthread *fpt = bgp_pth_io;
+	struct frr_pthread *fpt = io->pth;
+
+	monotime(&start);
 
 	frr_with_mutex (&connection->io_mtx) {
-		status = bgp_read(connection, &code);
+		status = bgp_read(connection, io, &code);
 	}
 
 	/* error checking phase */
@@ -263,6 +672,7 @@ static void bgp_process_reads(struct event *thread)
 			break;
 
 		added_pkt = true;
+		pkts++;
 	}
 
 	switch (ret) {
@@ -270,21 +680,26 @@ static void bgp_process_reads(struct event *thread)
 		fatal = true;
 		break;
 	case -ENOMEM:
-		if (!ibuf_full_logged) {
+		if (!io->ibuf_full_logged) {
 			if (bgp_debug_neighbor_events(peer))
 				zlog_debug(
 					"%s [Event] Peer Input-Queue is full: limit (%u)",
 					peer->host, bm->inq_limit);
 
-			ibuf_full_logged = true;
+			io->ibuf_full_logged = true;
 		}
 		break;
 	default:
-		ibuf_full_logged = false;
+		io->ibuf_full_logged = false;
 		break;
 	}
 
 done:
+	atomic_fetch_add_explicit(&io->reads, 1, memory_order_relaxed);
+	atomic_fetch_add_explicit(&io->pkts_in, pkts, memory_order_relaxed);
+	atomic_fetch_add_explicit(&io->busy_usec, monotime_since(&start, NULL),
+				  memory_order_relaxed);
+
 	/* handle invalid header */
 	if (fatal) {
 		/* wipe buffer just in case someone screwed up */
@@ -305,57 +720,58 @@ done:
  * This function pops packets off of peer->connection.obuf and writes them to
  * peer->connection.fd. The amount of packets written is equal to the minimum of
  * peer->wpkt_quanta and the number of packets on the output buffer, unless an
- * error occurs.
+ * error occurs.  Shared UPDATEs are gathered straight from the update-group's
+ * packet and their per-peer patch.
  *
  * If write() returns an error, the appropriate FSM event is generated.
  *
- * The return value is equal to the number of packets written
- * (which may be zero).
+ * The number of packets completely written is stored in *written.
  */
-static uint16_t bgp_write(struct peer_connection *connection)
+static uint16_t bgp_write(struct peer_connection *connection,
+			  unsigned int *written)
 {
 	struct peer *peer = connection->peer;
+	const uint8_t *data;
 	uint8_t type;
-	struct stream *s;
+	struct bgp_opkt *opkt;
 	int update_last_write = 0;
 	unsigned int count;
 	uint32_t uo = 0;
 	uint16_t status = 0;
 	uint32_t wpkt_quanta_old;
 
-	int writenum = 0;
-	int num;
+	size_t writenum;
+	size_t left, len;
+	ssize_t num;
 	unsigned int iovsz;
-	unsigned int strmsz;
 	unsigned int total_written;
 	time_t now;
 
 	wpkt_quanta_old = atomic_load_explicit(&peer->bgp->wpkt_quanta,
 					       memory_order_relaxed);
-	struct stream *ostreams[wpkt_quanta_old];
-	struct stream **streams = ostreams;
-	struct iovec iov[wpkt_quanta_old];
+	struct bgp_opkt *opkts[wpkt_quanta_old];
+	struct iovec iov[wpkt_quanta_old * BGP_OPKT_IOV_MAX];
 
-	s = stream_fifo_head(connection->obuf);
+	count = 0;
+	for (opkt = bgp_obuf_head(connection->obuf);
+	     opkt && count < wpkt_quanta_old; opkt = opkt->next)
+		opkts[count++] = opkt;
 
-	if (!s)
+	if (!count)
 		goto done;
 
-	count = iovsz = 0;
-	while (count < wpkt_quanta_old && iovsz < array_size(iov) && s) {
-		ostreams[iovsz] = s;
-		iov[iovsz].iov_base = stream_pnt(s);
-		iov[iovsz].iov_len = STREAM_READABLE(s);
-		writenum += STREAM_READABLE(s);
-		s = s->next;
-		++iovsz;
-		++count;
-	}
-
-	strmsz = iovsz;
 	total_written = 0;
 
-	do {
+	while (total_written < count) {
+		iovsz = 0;
+		writenum = 0;
+		for (unsigned int i = total_written; i < count; i++) {
+			unsigned int n = bgp_opkt_iov(opkts[i], &iov[iovsz]);
+
+			while (n--)
+				writenum += iov[iovsz++].iov_len;
+		}
+
 		num = writev(connection->fd, iov, iovsz);
 
 		if (num < 0) {
@@ -367,51 +783,42 @@ static uint16_t bgp_write(struct peer_connection *connection)
 			}
 
 			break;
-		} else if (num != writenum) {
-			unsigned int msg_written = 0;
-			unsigned int ic = iovsz;
-
-			for (unsigned int i = 0; i < ic; i++) {
-				size_t ss = iov[i].iov_len;
-
-				if (ss > (unsigned int) num)
-					break;
+		}
 
-				msg_written++;
-				iovsz--;
-				writenum -= ss;
-				num -= ss;
-			}
+		/* socket buffer full, come back later */
+		if (num == 0) {
+			SET_FLAG(status, BGP_IO_TRANS_ERR);
+			break;
+		}
 
-			total_written += msg_written;
+		assert((size_t)num <= writenum);
 
-			assert(total_written < count);
+		/* Retire the packets that went out completely */
+		while (num > 0) {
+			opkt = opkts[total_written];
+			bgp_opkt_data(opkt, &len);
+			left = len - opkt->written;
 
-			memmove(&iov, &iov[msg_written],
-				sizeof(iov[0]) * iovsz);
-			streams = &streams[msg_written];
-			stream_forward_getp(streams[0], num);
-			iov[0].iov_base = stream_pnt(streams[0]);
-			iov[0].iov_len = STREAM_READABLE(streams[0]);
+			if ((size_t)num < left) {
+				opkt->written += num;
+				break;
+			}
 
-			writenum -= num;
-			num = 0;
-			assert(writenum > 0);
-		} else {
-			total_written = strmsz;
+			num -= left;
+			opkt->written = len;
+			total_written++;
 		}
-
-	} while (num != writenum);
+	}
 
 	/* Handle statistics */
 	for (unsigned int i = 0; i < total_written; i++) {
-		s = stream_fifo_pop(connection->obuf);
+		opkt = bgp_obuf_pop(connection->obuf);
 
-		assert(s == ostreams[i]);
+		assert(opkt == opkts[i]);
 
 		/* Retrieve BGP packet type. */
-		stream_set_getp(s, BGP_MARKER_SIZE + 2);
-		type = stream_getc(s);
+		data = bgp_opkt_data(opkt, &len);
+		type = data[BGP_MARKER_SIZE + 2];
 
 		switch (type) {
 		case BGP_MSG_OPEN:
@@ -438,6 +845,8 @@ static uint16_t bgp_write(struct peer_connection *connection)
 			 * to Connect instead of Idle.
 			 */
 			BGP_EVENT_ADD(connection, BGP_Stop);
+			bgp_opkt_free(opkt);
+			(*written)++;
 			goto done;
 
 		case BGP_MSG_KEEPALIVE:
@@ -455,9 +864,10 @@ static uint16_t bgp_write(struct peer_connection *connection)
 			break;
 		}
 
-		stream_free(s);
-		ostreams[i] = NULL;
+		bgp_opkt_free(opkt);
+		opkts[i] = NULL;
 		update_last_write = 1;
+		(*written)++;
 	}
 
 done : {
@@ -482,21 +892,17 @@ done : {
 	return status;
 }
 
-uint8_t ibuf_scratch[BGP_EXTENDED_MESSAGE_MAX_PACKET_SIZE * BGP_READ_PACKET_MAX];
 /*
  * Reads a chunk of data from peer->connection.fd into
- * peer->connection.ibuf_work.
+ * peer->connection.ibuf_work, through the calling pthread's scratch buffer.
  *
  * code_p
  *    Pointer to location to store FSM event code in case of fatal error.
  *
  * @return status flag (see top-of-file)
- *
- * PLEASE NOTE:  If we ever transform the bgp_read to be a pthread
- * per peer then we need to rethink the global ibuf_scratch
- * data structure above.
  */
-static uint16_t bgp_read(struct peer_connection *connection, int *code_p)
+static uint16_t bgp_read(struct peer_connection *connection,
+			 struct bgp_io_thread *io, int *code_p)
 {
 	size_t readsize; /* how many bytes we want to read */
 	ssize_t nbytes;  /* how many bytes we actually read */
@@ -510,9 +916,9 @@ static uint16_t bgp_read(struct peer_connection *connection, int *code_p)
 		return status;
 	}
 
-	readsize = MIN(ibuf_work_space, sizeof(ibuf_scratch));
+	readsize = MIN(ibuf_work_space, BGP_IO_SCRATCH_SIZE);
 
-	nbytes = read(connection->fd, ibuf_scratch, readsize);
+	nbytes = read(connection->fd, io->ibuf_scratch, readsize);
 
 	/* EAGAIN or EWOULDBLOCK; come back later */
 	if (nbytes < 0 && ERRNO_IO_RETRY(errno)) {
@@ -541,7 +947,7 @@ static uint16_t bgp_read(struct peer_connection *connection, int *code_p)
 
 		SET_FLAG(status, BGP_IO_FATAL_ERR);
 	} else {
-		assert(ringbuf_put(connection->ibuf_work, ibuf_scratch,
+		assert(ringbuf_put(connection->ibuf_work, io->ibuf_scratch,
 				   nbytes) == (size_t)nbytes);
 	}
 
@@ -11,10 +11,119 @@
 #define BGP_WRITE_PACKET_MAX 64U
 #define BGP_READ_PACKET_MAX  10U
 
+/* Maximum number of I/O pthreads */
+#define BGP_IO_THREADS_MAX 64U
+
 #include "bgpd/bgpd.h"
 #include "frr_pthread.h"
+#include "frratomic.h"
 
 struct peer_connection;
+struct vty;
+
+/*
+ * UPDATE packet built once per update-group and shared, read-only, by the
+ * output queues of all its members.  The stream is freed with the last
+ * reference, which may be dropped on an I/O pthread.
+ */
+struct bgp_opkt_shared {
+	atomic_uint_fast32_t refcnt;
+	struct stream *s;
+};
+
+/* Largest per-peer patch, the nexthop field of a VPNv6 MP_REACH_NLRI */
+#define BGP_OPKT_PATCH_MAX 48
+
+/* iovecs needed to write one bgp_opkt */
+#define BGP_OPKT_IOV_MAX 3
+
+/* A packet waiting on connection->obuf */
+struct bgp_opkt {
+	struct bgp_opkt *next;
+
+	/* Either a packet of this connection's own... */
+	struct stream *s;
+
+	/* ...or a shared packet with an optional per-peer patch over it */
+	struct bgp_opkt_shared *shared;
+	uint16_t patch_offset;
+	uint8_t patch_len;
+	uint8_t patch[BGP_OPKT_PATCH_MAX];
+
+	/* Bytes already written to the socket */
+	size_t written;
+};
+
+/* Output queue, guarded by connection->io_mtx */
+struct bgp_obuf {
+	struct bgp_opkt *head;
+	struct bgp_opkt *tail;
+
+	/* may be read without the lock, e.g. for show commands */
+	atomic_size_t count;
+};
+
+extern struct bgp_obuf *bgp_obuf_new(void);
+extern void bgp_obuf_free(struct bgp_obuf *obuf);
+extern void bgp_obuf_clean(struct bgp_obuf *obuf);
+extern void bgp_obuf_push(struct bgp_obuf *obuf, struct bgp_opkt *opkt);
+extern struct bgp_opkt *bgp_obuf_pop(struct bgp_obuf *obuf);
+extern struct bgp_opkt *bgp_obuf_head(struct bgp_obuf *obuf);
+
+/**
+ * Wrap a packet for connection->obuf, the stream is consumed.
+ */
+extern struct bgp_opkt *bgp_opkt_new(struct stream *s);
+
+/**
+ * Queue a shared packet, takes a reference.
+ */
+extern struct bgp_opkt *bgp_opkt_new_shared(struct bgp_opkt_shared *shared);
+
+/**
+ * Overwrite part of a shared packet for this opkt only.
+ *
+ * The first call copies the field [field, field + field_len) of the shared
+ * packet into the opkt's patch, later calls must use the same field.
+ * [offset, offset + len) must lie within the field.
+ */
+extern void bgp_opkt_patch(struct bgp_opkt *opkt, size_t field,
+			   size_t field_len, size_t offset, const void *data,
+			   size_t len);
+
+extern void bgp_opkt_free(struct bgp_opkt *opkt);
+
+/**
+ * Take ownership of an UPDATE packet for sharing, with one reference held
+ * by the caller.
+ */
+extern struct bgp_opkt_shared *bgp_opkt_shared_new(struct stream *s);
+extern void bgp_opkt_shared_unref(struct bgp_opkt_shared **shared);
+
+/**
+ * Register the first I/O pthread, created by bgp_pthreads_init().
+ *
+ * @param fpt - the "BGP I/O thread" pthread
+ */
+extern void bgp_io_init(struct frr_pthread *fpt);
+
+/**
+ * Resize the I/O pthread pool.
+ *
+ * Connections are assigned to the least loaded pthread when their I/O is
+ * turned on.  Extra pthreads are started as needed; when the pool shrinks
+ * the surplus pthreads only stop receiving new connections.
+ *
+ * @param threads - number of pthreads, clamped to [1, BGP_IO_THREADS_MAX]
+ */
+extern void bgp_io_set_threads(unsigned int threads);
+
+extern void bgp_io_show(struct vty *vty, bool use_json);
+
+/**
+ * Free per-pthread resources, after all pthreads have been stopped.
+ */
+extern void bgp_io_finish(void);
 
 /**
  * Start function for write thread.
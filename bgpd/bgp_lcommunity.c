@@ -22,6 +22,9 @@
 /* Hash of community attribute. */
 static struct hash *lcomhash;
 
+/* Last serial handed out to a newly interned large community. */
+static uint32_t lcommunity_serial;
+
 /* Allocate a new lcommunities.  */
 static struct lcommunity *lcommunity_new(void)
 {
@@ -261,6 +264,8 @@ struct lcommunity *lcommunity_intern(struct lcommunity *lcom)
 	if (find != lcom)
 		lcommunity_free(&lcom);
 
+	if (!find->refcnt)
+		find->serial = ++lcommunity_serial;
 	find->refcnt++;
 
 	if (!find->str)
@@ -30,6 +30,9 @@ struct lcommunity {
 
 	/* Human readable format string.  */
 	char *str;
+
+	/* Set when interned, see struct community. */
+	uint32_t serial;
 };
 
 /* Large community value is 12 octets.  */
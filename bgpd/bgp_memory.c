@@ -54,6 +54,7 @@ DEFINE_MTYPE(BGPD, BGP_MPATH_INFO, "BGP multipath info");
 
 DEFINE_MTYPE(BGPD, AS_LIST, "BGP AS list");
 DEFINE_MTYPE(BGPD, AS_FILTER, "BGP AS filter");
+DEFINE_MTYPE(BGPD, AS_LIST_CACHE, "BGP AS list result cache");
 DEFINE_MTYPE(BGPD, AS_FILTER_STR, "BGP AS filter str");
 
 DEFINE_MTYPE(BGPD, COMMUNITY_ALIAS, "community alias");
@@ -71,11 +72,13 @@ DEFINE_MTYPE(BGPD, COMMUNITY_LIST_NAME, "community-list name");
 DEFINE_MTYPE(BGPD, COMMUNITY_LIST_ENTRY, "community-list entry");
 DEFINE_MTYPE(BGPD, COMMUNITY_LIST_CONFIG, "community-list config");
 DEFINE_MTYPE(BGPD, COMMUNITY_LIST_HANDLER, "community-list handler");
+DEFINE_MTYPE(BGPD, COMMUNITY_LIST_INDEX, "community-list index");
 
 DEFINE_MTYPE(BGPD, CLUSTER, "Cluster list");
 DEFINE_MTYPE(BGPD, CLUSTER_VAL, "Cluster list val");
 
 DEFINE_MTYPE(BGPD, BGP_PROCESS_QUEUE, "BGP Process queue");
+DEFINE_MTYPE(BGPD, BGP_SELECT_JOB, "BGP best-path selection jobs");
 DEFINE_MTYPE(BGPD, BGP_CLEAR_NODE_QUEUE, "BGP node clear queue");
 
 DEFINE_MTYPE(BGPD, TRANSIT, "BGP transit attr");
@@ -93,6 +96,7 @@ DEFINE_MTYPE(BGPD, BGP_DAMP_INFO, "Dampening info");
 DEFINE_MTYPE(BGPD, BGP_DAMP_ARRAY, "BGP Dampening array");
 DEFINE_MTYPE(BGPD, BGP_DAMP_REUSELIST, "BGP Dampening reuse list");
 DEFINE_MTYPE(BGPD, BGP_REGEXP, "BGP regexp");
+DEFINE_MTYPE(BGPD, BGP_RMAP_MEMO, "BGP route-map results");
 DEFINE_MTYPE(BGPD, BGP_AGGREGATE, "BGP aggregate");
 DEFINE_MTYPE(BGPD, BGP_ADDR, "BGP own address");
 DEFINE_MTYPE(BGPD, TIP_ADDR, "BGP own tunnel-ip address");
@@ -50,6 +50,7 @@ DECLARE_MTYPE(BGP_MPATH_INFO);
 
 DECLARE_MTYPE(AS_LIST);
 DECLARE_MTYPE(AS_FILTER);
+DECLARE_MTYPE(AS_LIST_CACHE);
 DECLARE_MTYPE(AS_FILTER_STR);
 
 DECLARE_MTYPE(COMMUNITY_ALIAS);
@@ -67,11 +68,13 @@ DECLARE_MTYPE(COMMUNITY_LIST_NAME);
 DECLARE_MTYPE(COMMUNITY_LIST_ENTRY);
 DECLARE_MTYPE(COMMUNITY_LIST_CONFIG);
 DECLARE_MTYPE(COMMUNITY_LIST_HANDLER);
+DECLARE_MTYPE(COMMUNITY_LIST_INDEX);
 
 DECLARE_MTYPE(CLUSTER);
 DECLARE_MTYPE(CLUSTER_VAL);
 
 DECLARE_MTYPE(BGP_PROCESS_QUEUE);
+DECLARE_MTYPE(BGP_SELECT_JOB);
 DECLARE_MTYPE(BGP_CLEAR_NODE_QUEUE);
 
 DECLARE_MTYPE(TRANSIT);
@@ -89,6 +92,7 @@ DECLARE_MTYPE(BGP_DAMP_INFO);
 DECLARE_MTYPE(BGP_DAMP_ARRAY);
 DECLARE_MTYPE(BGP_DAMP_REUSELIST);
 DECLARE_MTYPE(BGP_REGEXP);
+DECLARE_MTYPE(BGP_RMAP_MEMO);
 DECLARE_MTYPE(BGP_AGGREGATE);
 DECLARE_MTYPE(BGP_ADDR);
 DECLARE_MTYPE(TIP_ADDR);
@@ -1303,7 +1303,7 @@ void evaluate_paths(struct bgp_nexthop_cache *bnc)
 
 		if (safi == SAFI_UNICAST && path->sub_type == BGP_ROUTE_IMPORTED
 		    && path->extra && path->extra->num_labels
-		    && (path->attr->evpn_overlay.type
+		    && (bgp_attr_get_evpn_overlay(path->attr)->type
 			!= OVERLAY_INDEX_GATEWAY_IP)) {
 			bnc_is_valid_nexthop =
 				bgp_isvalid_nexthop_for_l3vpn(bnc, path)
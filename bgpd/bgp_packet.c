@@ -47,6 +47,7 @@
 #include "bgpd/bgp_updgrp.h"
 #include "bgpd/bgp_label.h"
 #include "bgpd/bgp_io.h"
+#include "bgpd/bgp_preparse.h"
 #include "bgpd/bgp_keepalives.h"
 #include "bgpd/bgp_flowspec.h"
 #include "bgpd/bgp_trace.h"
@@ -103,11 +104,11 @@ void bgp_packet_set_size(struct stream *s)
 }
 
 /*
- * Push a packet onto the beginning of the peer's output queue.
+ * Push a packet onto the end of the peer's output queue.
  * This function acquires the peer's write mutex before proceeding.
  */
-static void bgp_packet_add(struct peer_connection *connection,
-			   struct peer *peer, struct stream *s)
+static void bgp_opkt_add(struct peer_connection *connection,
+			 struct peer *peer, struct bgp_opkt *opkt)
 {
 	intmax_t delta;
 	uint32_t holdtime;
@@ -118,10 +119,10 @@ static void bgp_packet_add(struct peer_connection *connection,
 		 * now, otherwise if we write another packet immediately
 		 * after it'll get confused
 		 */
-		if (!stream_fifo_count_safe(connection->obuf))
+		if (!bgp_obuf_head(connection->obuf))
 			peer->last_sendq_ok = monotime(NULL);
 
-		stream_fifo_push(connection->obuf, s);
+		bgp_obuf_push(connection->obuf, opkt);
 
 		delta = monotime(NULL) - peer->last_sendq_ok;
 
@@ -161,6 +162,12 @@ static void bgp_packet_add(struct peer_connection *connection,
 	}
 }
 
+static void bgp_packet_add(struct peer_connection *connection,
+			   struct peer *peer, struct stream *s)
+{
+	bgp_opkt_add(connection, peer, bgp_opkt_new(s));
+}
+
 static struct stream *bgp_update_packet_eor(struct peer *peer, afi_t afi,
 					    safi_t safi)
 {
@@ -451,6 +458,7 @@ void bgp_generate_updgrp_packets(struct event *thread)
 	struct peer_connection *connection = EVENT_ARG(thread);
 	struct peer *peer = connection->peer;
 	struct stream *s;
+	struct bgp_opkt *opkt;
 	struct peer_af *paf;
 	struct bpacket *next_pkt;
 	uint32_t wpq;
@@ -490,6 +498,7 @@ void bgp_generate_updgrp_packets(struct event *thread)
 		enum bgp_af_index index;
 
 		s = NULL;
+		opkt = NULL;
 		for (index = BGP_AF_START; index < BGP_AF_MAX; index++) {
 			paf = peer->peer_af_array[index];
 			if (!paf || !PAF_SUBGRP(paf))
@@ -604,11 +613,12 @@ void bgp_generate_updgrp_packets(struct event *thread)
 			/* Found a packet template to send, overwrite
 			 * packet with appropriate attributes from peer
 			 * and advance peer */
-			s = bpacket_reformat_for_peer(next_pkt, paf);
-			bgp_packet_add(connection, peer, s);
+			opkt = bpacket_reformat_for_peer(next_pkt, paf);
+			if (opkt)
+				bgp_opkt_add(connection, peer, opkt);
 			bpacket_queue_advance_peer(paf);
 		}
-	} while (s && (++generated < wpq) &&
+	} while ((s || opkt) && (++generated < wpq) &&
 		 (connection->obuf->count <= bm->outq_limit));
 
 	if (generated)
@@ -731,14 +741,17 @@ static void bgp_write_notify(struct peer_connection *connection,
 {
 	int ret, val;
 	uint8_t type;
+	struct bgp_opkt *opkt;
 	struct stream *s;
 
 	/* There should be at least one packet. */
-	s = stream_fifo_pop(connection->obuf);
+	opkt = bgp_obuf_pop(connection->obuf);
 
-	if (!s)
+	if (!opkt)
 		return;
 
+	s = opkt->s;
+
 	assert(stream_get_endp(s) >= BGP_HEADER_SIZE);
 
 	/*
@@ -752,7 +765,7 @@ static void bgp_write_notify(struct peer_connection *connection,
 	 * to write the entire NOTIFY doesn't get different FSM treatment
 	 */
 	if (ret <= 0) {
-		stream_free(s);
+		bgp_opkt_free(opkt);
 		BGP_EVENT_ADD(connection, TCP_fatal_error);
 		return;
 	}
@@ -784,7 +797,7 @@ static void bgp_write_notify(struct peer_connection *connection,
 	 */
 	BGP_EVENT_ADD(connection, BGP_Stop);
 
-	stream_free(s);
+	bgp_opkt_free(opkt);
 }
 
 /*
@@ -951,7 +964,7 @@ static void bgp_notify_send_internal(struct peer_connection *connection,
 	bgp_packet_set_size(s);
 
 	/* wipe output buffer */
-	stream_fifo_clean(connection->obuf);
+	bgp_obuf_clean(connection->obuf);
 
 	/*
 	 * If possible, store last packet for debugging purposes. This check is
@@ -1036,7 +1049,7 @@ static void bgp_notify_send_internal(struct peer_connection *connection,
 		peer->last_reset = PEER_DOWN_NOTIFY_SEND;
 
 	/* Add packet to peer's output queue */
-	stream_fifo_push(connection->obuf, s);
+	bgp_obuf_push(connection->obuf, bgp_opkt_new(s));
 
 	bgp_peer_gr_flags_update(peer);
 	BGP_GR_ROUTER_DETECT_AND_SEND_CAPABILITY_TO_ZEBRA(peer->bgp,
@@ -2257,6 +2270,7 @@ static int bgp_update_receive(struct peer_connection *connection,
 	bgp_size_t update_len;
 	bgp_size_t withdraw_len;
 	bool restart = false;
+	const struct bgp_preparse_section *pp_sec;
 
 	enum NLRI_TYPES {
 		NLRI_UPDATE,
@@ -2447,16 +2461,30 @@ static int bgp_update_receive(struct peer_connection *connection,
 		if (nlris[i].length == 0)
 			continue;
 
+		/* Already decoded on the I/O pthread? */
+		pp_sec = bgp_preparse_lookup(peer->curr_preparse, peer, s,
+					     &nlris[i]);
+
 		switch (i) {
 		case NLRI_UPDATE:
 		case NLRI_MP_UPDATE:
-			nlri_ret = bgp_nlri_parse(peer, NLRI_ATTR_ARG,
-						  &nlris[i], 0);
+			if (pp_sec)
+				nlri_ret = bgp_nlri_parse_ip_preparsed(
+					peer, NLRI_ATTR_ARG,
+					peer->curr_preparse, pp_sec);
+			else
+				nlri_ret = bgp_nlri_parse(peer, NLRI_ATTR_ARG,
+							  &nlris[i], 0);
 			break;
 		case NLRI_WITHDRAW:
 		case NLRI_MP_WITHDRAW:
-			nlri_ret = bgp_nlri_parse(peer, NLRI_ATTR_ARG,
-						  &nlris[i], 1);
+			if (pp_sec)
+				nlri_ret = bgp_nlri_parse_ip_preparsed(
+					peer, NULL, peer->curr_preparse,
+					pp_sec);
+			else
+				nlri_ret = bgp_nlri_parse(peer, NLRI_ATTR_ARG,
+							  &nlris[i], 1);
 			break;
 		default:
 			nlri_ret = BGP_NLRI_PARSE_ERROR;
@@ -3971,6 +3999,7 @@ void bgp_process_packet(struct event *thread)
 	uint32_t rpkt_quanta_old; // how many packets to read
 	int fsm_update_result;    // return code of bgp_event_update()
 	int mprc;		  // message processing return code
+	struct bgp_preparse *pp;  // NLRI decoded by the I/O pthread
 
 	connection = EVENT_ARG(thread);
 	peer = connection->peer;
@@ -3991,6 +4020,11 @@ void bgp_process_packet(struct event *thread)
 
 		frr_with_mutex (&connection->io_mtx) {
 			peer->curr = stream_fifo_pop(connection->ibuf);
+
+			pp = bgp_preparse_fifo_first(&connection->ipreparse);
+			if (pp && pp->pkt == peer->curr)
+				peer->curr_preparse =
+					bgp_preparse_fifo_pop(&connection->ipreparse);
 		}
 
 		if (peer->curr == NULL) // no packets to process, hmm...
@@ -4097,6 +4131,7 @@ void bgp_process_packet(struct event *thread)
 		/* delete processed packet */
 		stream_free(peer->curr);
 		peer->curr = NULL;
+		bgp_preparse_free(&peer->curr_preparse);
 		processed++;
 
 		/* Update FSM */
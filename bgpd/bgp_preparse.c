@@ -0,0 +1,264 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/* BGP UPDATE pre-parsing.
+ * Decodes unicast NLRI of received UPDATEs on the I/O pthread so that the
+ * main pthread only has to insert the prefixes into the RIB.
+ */
+
+#include <zebra.h>
+
+#include "memory.h"
+#include "prefix.h"
+#include "stream.h"
+
+#include "bgpd/bgpd.h"
+#include "bgpd/bgp_attr.h"
+#include "bgpd/bgp_route.h"
+#include "bgpd/bgp_preparse.h"
+
+DEFINE_MTYPE_STATIC(BGPD, BGP_PREPARSE, "BGP pre-parsed UPDATE");
+
+/* Most UPDATEs carry a handful of prefixes, grow from here */
+#define BGP_PREPARSE_PREFIXES_MIN 16
+
+static struct bgp_preparse_prefix *
+bgp_preparse_prefix_new(struct bgp_preparse *pp)
+{
+	if (pp->nprefixes == pp->prefixes_size) {
+		pp->prefixes_size = pp->prefixes_size
+					    ? pp->prefixes_size * 2
+					    : BGP_PREPARSE_PREFIXES_MIN;
+		pp->prefixes = XREALLOC(MTYPE_BGP_PREPARSE, pp->prefixes,
+					pp->prefixes_size *
+						sizeof(*pp->prefixes));
+	}
+
+	return &pp->prefixes[pp->nprefixes++];
+}
+
+/*
+ * Same syntax checks as bgp_nlri_parse_ip(); on any error the field is
+ * dropped again so that the main pthread reparses and reports it.
+ */
+static void bgp_preparse_nlri(struct bgp_preparse *pp, struct peer *peer,
+			      const uint8_t *data, size_t offset,
+			      bgp_size_t length, afi_t afi, safi_t safi)
+{
+	struct bgp_preparse_section *sec;
+	struct bgp_preparse_prefix *pfx;
+	const uint8_t *pnt = data + offset;
+	const uint8_t *lim = pnt + length;
+	uint32_t addpath_id = 0;
+	uint8_t prefixlen;
+	int psize;
+
+	if (!length || pp->nsections == BGP_PREPARSE_SECTIONS_MAX)
+		return;
+
+	if ((afi != AFI_IP && afi != AFI_IP6) ||
+	    (safi != SAFI_UNICAST && safi != SAFI_MULTICAST))
+		return;
+
+	sec = &pp->sections[pp->nsections];
+	sec->afi = afi;
+	sec->safi = safi;
+	sec->addpath = bgp_addpath_encode_rx(peer, afi, safi);
+	sec->offset = offset;
+	sec->length = length;
+	sec->first = pp->nprefixes;
+	sec->count = 0;
+
+	for (; pnt < lim; pnt += psize) {
+		if (sec->addpath) {
+			if (pnt + BGP_ADDPATH_ID_LEN >= lim)
+				goto error;
+
+			memcpy(&addpath_id, pnt, BGP_ADDPATH_ID_LEN);
+			addpath_id = ntohl(addpath_id);
+			pnt += BGP_ADDPATH_ID_LEN;
+		}
+
+		prefixlen = *pnt++;
+		if (prefixlen > (afi == AFI_IP ? IPV4_MAX_BITLEN
+					       : IPV6_MAX_BITLEN))
+			goto error;
+
+		psize = PSIZE(prefixlen);
+		if (pnt + psize > lim)
+			goto error;
+
+		pfx = bgp_preparse_prefix_new(pp);
+		memset(&pfx->p, 0, sizeof(pfx->p));
+		pfx->p.family = afi2family(afi);
+		pfx->p.prefixlen = prefixlen;
+		memcpy(pfx->p.u.val, pnt, psize);
+		pfx->addpath_id = addpath_id;
+		sec->count++;
+	}
+
+	if (pnt != lim)
+		goto error;
+
+	pp->nsections++;
+	return;
+
+error:
+	pp->nprefixes = sec->first;
+}
+
+/*
+ * Find MP_REACH_NLRI and MP_UNREACH_NLRI without interpreting anything
+ * else, bgp_attr_parse() still does the real work on the main pthread.
+ */
+static void bgp_preparse_attrs(struct bgp_preparse *pp, struct peer *peer,
+			       const uint8_t *data, size_t offset,
+			       bgp_size_t length)
+{
+	const uint8_t *pnt = data + offset;
+	const uint8_t *lim = pnt + length;
+	const uint8_t *val;
+	uint8_t flag, type, nh_len;
+	bgp_size_t attr_len;
+	iana_afi_t pkt_afi;
+	iana_safi_t pkt_safi;
+	afi_t afi;
+	safi_t safi;
+
+	while (pnt + 3 <= lim) {
+		flag = pnt[0];
+		type = pnt[1];
+		if (CHECK_FLAG(flag, BGP_ATTR_FLAG_EXTLEN)) {
+			if (pnt + 4 > lim)
+				return;
+			attr_len = (pnt[2] << 8) | pnt[3];
+			val = pnt + 4;
+		} else {
+			attr_len = pnt[2];
+			val = pnt + 3;
+		}
+
+		if (val + attr_len > lim)
+			return;
+
+		pnt = val + attr_len;
+
+		if (type != BGP_ATTR_MP_REACH_NLRI &&
+		    type != BGP_ATTR_MP_UNREACH_NLRI)
+			continue;
+
+		if (attr_len < 3)
+			continue;
+
+		pkt_afi = (val[0] << 8) | val[1];
+		pkt_safi = val[2];
+		if (bgp_map_afi_safi_iana2int(pkt_afi, pkt_safi, &afi, &safi))
+			continue;
+
+		if (type == BGP_ATTR_MP_UNREACH_NLRI) {
+			bgp_preparse_nlri(pp, peer, data, val + 3 - data,
+					  attr_len - 3, afi, safi);
+			continue;
+		}
+
+		/* AFI, SAFI, nexthop length, nexthop, reserved */
+		if (attr_len < 4)
+			continue;
+		nh_len = val[3];
+		if (attr_len < 5 + nh_len)
+			continue;
+
+		bgp_preparse_nlri(pp, peer, data, val + 5 + nh_len - data,
+				  attr_len - 5 - nh_len, afi, safi);
+	}
+}
+
+struct bgp_preparse *bgp_preparse_update(struct peer *peer,
+					 const struct stream *pkt)
+{
+	struct bgp_preparse *pp;
+	const uint8_t *data = STREAM_DATA(pkt);
+	size_t endp = stream_get_endp(pkt);
+	size_t pos = BGP_HEADER_SIZE;
+	bgp_size_t withdraw_len, attribute_len;
+
+	if (endp < BGP_HEADER_SIZE ||
+	    data[BGP_MARKER_SIZE + 2] != BGP_MSG_UPDATE)
+		return NULL;
+
+	/* Section lengths, same bounds as bgp_update_receive() */
+	if (pos + 2 > endp)
+		return NULL;
+	withdraw_len = (data[pos] << 8) | data[pos + 1];
+	pos += 2;
+	if (pos + withdraw_len + 2 > endp)
+		return NULL;
+
+	attribute_len = (data[pos + withdraw_len] << 8) |
+			data[pos + withdraw_len + 1];
+	if (pos + withdraw_len + 2 + attribute_len > endp)
+		return NULL;
+
+	pp = XCALLOC(MTYPE_BGP_PREPARSE, sizeof(*pp));
+	pp->pkt = pkt;
+
+	bgp_preparse_nlri(pp, peer, data, pos, withdraw_len, AFI_IP,
+			  SAFI_UNICAST);
+	pos += withdraw_len + 2;
+
+	bgp_preparse_attrs(pp, peer, data, pos, attribute_len);
+	pos += attribute_len;
+
+	bgp_preparse_nlri(pp, peer, data, pos, endp - pos, AFI_IP,
+			  SAFI_UNICAST);
+
+	if (!pp->nsections)
+		bgp_preparse_free(&pp);
+
+	return pp;
+}
+
+const struct bgp_preparse_section *
+bgp_preparse_lookup(const struct bgp_preparse *pp, struct peer *peer,
+		    const struct stream *pkt, const struct bgp_nlri *nlri)
+{
+	const struct bgp_preparse_section *sec;
+	size_t offset;
+	uint8_t i;
+
+	if (!pp || pp->pkt != pkt || !nlri->nlri)
+		return NULL;
+
+	offset = nlri->nlri - STREAM_DATA(pkt);
+
+	for (i = 0; i < pp->nsections; i++) {
+		sec = &pp->sections[i];
+		if (sec->offset != offset || sec->length != nlri->length ||
+		    sec->afi != nlri->afi || sec->safi != nlri->safi)
+			continue;
+
+		/* ADD-PATH may have been renegotiated in the meantime */
+		if (sec->addpath != bgp_addpath_encode_rx(peer, sec->afi,
+							  sec->safi))
+			return NULL;
+
+		return sec;
+	}
+
+	return NULL;
+}
+
+void bgp_preparse_free(struct bgp_preparse **pp)
+{
+	if (!*pp)
+		return;
+
+	XFREE(MTYPE_BGP_PREPARSE, (*pp)->prefixes);
+	XFREE(MTYPE_BGP_PREPARSE, *pp);
+}
+
+void bgp_preparse_fifo_flush(struct bgp_preparse_fifo_head *head)
+{
+	struct bgp_preparse *pp;
+
+	while ((pp = bgp_preparse_fifo_pop(head)))
+		bgp_preparse_free(&pp);
+}
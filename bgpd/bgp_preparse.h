@@ -0,0 +1,78 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/* BGP UPDATE pre-parsing.
+ * Decodes unicast NLRI of received UPDATEs on the I/O pthread so that the
+ * main pthread only has to insert the prefixes into the RIB.
+ */
+
+#ifndef _FRR_BGP_PREPARSE_H
+#define _FRR_BGP_PREPARSE_H
+
+#include "prefix.h"
+#include "stream.h"
+#include "typesafe.h"
+
+#include "bgpd/bgpd.h"
+
+/* Withdrawn routes, NLRI, MP_REACH_NLRI and MP_UNREACH_NLRI */
+#define BGP_PREPARSE_SECTIONS_MAX 4
+
+struct bgp_preparse_prefix {
+	struct prefix p;
+	uint32_t addpath_id;
+};
+
+/* One NLRI field of the UPDATE, as located by the I/O pthread */
+struct bgp_preparse_section {
+	afi_t afi;
+	safi_t safi;
+	bool addpath;
+
+	/* NLRI position relative to the start of the packet */
+	size_t offset;
+	bgp_size_t length;
+
+	/* Range of decoded prefixes in bgp_preparse->prefixes */
+	uint32_t first;
+	uint32_t count;
+};
+
+struct bgp_preparse {
+	struct bgp_preparse_fifo_item fifo;
+
+	/* Packet this was decoded from, never dereferenced */
+	const struct stream *pkt;
+
+	uint8_t nsections;
+	struct bgp_preparse_section sections[BGP_PREPARSE_SECTIONS_MAX];
+
+	uint32_t nprefixes;
+	uint32_t prefixes_size;
+	struct bgp_preparse_prefix *prefixes;
+};
+
+DECLARE_LIST(bgp_preparse_fifo, struct bgp_preparse, fifo);
+
+/**
+ * Decode the NLRI of an UPDATE packet, called on the I/O pthread.
+ *
+ * Only syntactically valid IPv4/IPv6 unicast and multicast NLRI fields
+ * are decoded, anything else is left to bgp_update_receive().  Returns
+ * NULL if nothing could be decoded.
+ */
+extern struct bgp_preparse *bgp_preparse_update(struct peer *peer,
+						const struct stream *pkt);
+
+/**
+ * Look up the pre-parsed NLRI field matching an NLRI field located by
+ * bgp_update_receive(), NULL if the main pthread has to parse it itself.
+ */
+extern const struct bgp_preparse_section *
+bgp_preparse_lookup(const struct bgp_preparse *pp, struct peer *peer,
+		    const struct stream *pkt, const struct bgp_nlri *nlri);
+
+extern void bgp_preparse_free(struct bgp_preparse **pp);
+
+/* Free everything queued on a connection, io_mtx must be held */
+extern void bgp_preparse_fifo_flush(struct bgp_preparse_fifo_head *head);
+
+#endif /* _FRR_BGP_PREPARSE_H */
@@ -72,3 +72,144 @@ void bgp_regex_free(regex_t *regex)
 	regfree(regex);
 	XFREE(MTYPE_BGP_REGEXP, regex);
 }
+
+/* Compiled form of "(^|_)ELEM(_ELEM)*(_|$)", "^$" and ".*", where ELEM is
+ * a decimal ASN or "[0-9]+".  In the string form of an AS path made of
+ * AS_SEQUENCE segments only, every ELEM delimited like that has to match
+ * one whole ASN, so the regex reduces to comparing a run of ASNs.
+ */
+struct bgp_aspath_regex {
+	enum {
+		ASREG_ANY,
+		ASREG_EMPTY,
+		ASREG_ASNS,
+	} kind;
+	bool anchor_start;
+	bool anchor_end;
+
+	unsigned int count;
+	struct {
+		bool any;
+		as_t asn;
+	} elem[];
+};
+
+/* AS paths longer than this are left to regexec() */
+#define ASREG_PATH_MAX 256
+
+struct bgp_aspath_regex *bgp_aspath_regcomp(const char *regstr)
+{
+	struct bgp_aspath_regex *asreg;
+	const char *p = regstr;
+	unsigned long long asn;
+	unsigned int count = 0;
+	bool anchor_start, anchor_end = false;
+	char *end;
+
+	if (!strcmp(regstr, ".*")) {
+		asreg = XCALLOC(MTYPE_BGP_REGEXP, sizeof(*asreg));
+		asreg->kind = ASREG_ANY;
+		return asreg;
+	}
+	if (!strcmp(regstr, "^$")) {
+		asreg = XCALLOC(MTYPE_BGP_REGEXP, sizeof(*asreg));
+		asreg->kind = ASREG_EMPTY;
+		return asreg;
+	}
+
+	if (*p != '^' && *p != '_')
+		return NULL;
+	anchor_start = (*p == '^');
+
+	/* upper bound on the number of elements */
+	for (; *p; p++)
+		if (*p == '_')
+			count++;
+
+	asreg = XCALLOC(MTYPE_BGP_REGEXP,
+			sizeof(*asreg) + (count + 1) * sizeof(asreg->elem[0]));
+	asreg->kind = ASREG_ASNS;
+	asreg->anchor_start = anchor_start;
+
+	p = regstr + 1;
+	while (true) {
+		if (!strncmp(p, "[0-9]+", 6)) {
+			asreg->elem[asreg->count++].any = true;
+			p += 6;
+		} else if (isdigit((unsigned char)*p)) {
+			/* "065000" never shows up in the string form */
+			if (p[0] == '0' && isdigit((unsigned char)p[1]))
+				goto unsupported;
+			errno = 0;
+			asn = strtoull(p, &end, 10);
+			if (errno || asn > UINT32_MAX)
+				goto unsupported;
+			asreg->elem[asreg->count++].asn = asn;
+			p = end;
+		} else
+			goto unsupported;
+
+		if (*p == '_') {
+			p++;
+			if (*p == '\0')
+				break;
+		} else if (p[0] == '$' && p[1] == '\0') {
+			anchor_end = true;
+			break;
+		} else
+			goto unsupported;
+	}
+	asreg->anchor_end = anchor_end;
+
+	return asreg;
+
+unsupported:
+	XFREE(MTYPE_BGP_REGEXP, asreg);
+	return NULL;
+}
+
+void bgp_aspath_regex_free(struct bgp_aspath_regex *asreg)
+{
+	XFREE(MTYPE_BGP_REGEXP, asreg);
+}
+
+int bgp_aspath_regexec(const struct bgp_aspath_regex *asreg,
+		       const struct aspath *aspath)
+{
+	as_t path[ASREG_PATH_MAX];
+	unsigned int n = 0, start, last, i;
+	struct assegment *seg;
+
+	if (asreg->kind == ASREG_ANY)
+		return 1;
+
+	if (aspath->asnotation != ASNOTATION_PLAIN)
+		return -1;
+
+	for (seg = aspath->segments; seg; seg = seg->next) {
+		if (seg->type != AS_SEQUENCE || !seg->length ||
+		    n + seg->length > ASREG_PATH_MAX)
+			return -1;
+		memcpy(path + n, seg->as, seg->length * sizeof(as_t));
+		n += seg->length;
+	}
+
+	if (asreg->kind == ASREG_EMPTY)
+		return n == 0;
+
+	if (asreg->count > n)
+		return 0;
+
+	start = asreg->anchor_end ? n - asreg->count : 0;
+	last = asreg->anchor_start ? 0 : n - asreg->count;
+
+	for (; start <= last; start++) {
+		for (i = 0; i < asreg->count; i++)
+			if (!asreg->elem[i].any &&
+			    asreg->elem[i].asn != path[start + i])
+				break;
+		if (i == asreg->count)
+			return 1;
+	}
+	return 0;
+}
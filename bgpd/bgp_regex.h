@@ -23,4 +23,18 @@ extern void bgp_regex_free(regex_t *regex);
 extern regex_t *bgp_regcomp(const char *str);
 extern int bgp_regexec(regex_t *regex, struct aspath *aspath);
 
+/* AS path regular expressions of the common "_ASN_ASN_" form, compiled to
+ * a match on the ASN array instead of the string.  Anything outside that
+ * subset does not compile and has to go through regexec().
+ */
+struct bgp_aspath_regex;
+
+extern struct bgp_aspath_regex *bgp_aspath_regcomp(const char *regstr);
+extern void bgp_aspath_regex_free(struct bgp_aspath_regex *asreg);
+/* 1 on match, 0 on no match, -1 if the AS path itself is not covered
+ * (sets, confederations, non-plain notation) and regexec() must decide.
+ */
+extern int bgp_aspath_regexec(const struct bgp_aspath_regex *asreg,
+			      const struct aspath *aspath);
+
 #endif /* _FRR_BGP_REGEX_H */
@@ -29,6 +29,7 @@
 #include "lib_errors.h"
 #include "zclient.h"
 #include "frrdistance.h"
+#include "mempool.h"
 
 #include "bgpd/bgpd.h"
 #include "bgpd/bgp_table.h"
@@ -61,6 +62,8 @@
 #include "bgpd/bgp_network.h"
 #include "bgpd/bgp_trace.h"
 #include "bgpd/bgp_rpki.h"
+#include "bgpd/bgp_select.h"
+#include "bgpd/bgp_preparse.h"
 
 #ifdef ENABLE_BGP_VNC
 #include "bgpd/rfapi/rfapi_backend.h"
@@ -92,6 +95,10 @@ DEFINE_HOOK(bgp_route_update,
 	     struct bgp_path_info *old_route, struct bgp_path_info *new_route),
 	    (bgp, afi, safi, bn, old_route, new_route));
 
+DEFINE_MEMPOOL(BGP_ROUTE, MTYPE_BGP_ROUTE, sizeof(struct bgp_path_info));
+DEFINE_MEMPOOL_STATIC(BGP_ROUTE_EXTRA, MTYPE_BGP_ROUTE_EXTRA,
+		      sizeof(struct bgp_path_info_extra));
+
 /* Extern from bgp_dump.c */
 extern const char *bgp_origin_str[];
 extern const char *bgp_origin_long_str[];
@@ -233,8 +240,7 @@ struct bgp_dest *bgp_safi_node_lookup(struct bgp_table *table, safi_t safi,
 static struct bgp_path_info_extra *bgp_path_info_extra_new(void)
 {
 	struct bgp_path_info_extra *new;
-	new = XCALLOC(MTYPE_BGP_ROUTE_EXTRA,
-		      sizeof(struct bgp_path_info_extra));
+	new = mempool_alloc(MPOOL_BGP_ROUTE_EXTRA);
 	new->label[0] = MPLS_INVALID_LABEL;
 	new->num_labels = 0;
 	new->flowspec = NULL;
@@ -307,7 +313,7 @@ void bgp_path_info_extra_free(struct bgp_path_info_extra **extra)
 		XFREE(MTYPE_BGP_ROUTE_EXTRA_VNC, e->vnc);
 #endif
 
-	XFREE(MTYPE_BGP_ROUTE_EXTRA, *extra);
+	MPFREE(MPOOL_BGP_ROUTE_EXTRA, *extra);
 }
 
 /* Get bgp_path_info extra information for the given bgp_path_info, lazy
@@ -340,7 +346,7 @@ void bgp_path_info_free_with_caller(const char *name,
 
 	peer_unlock(path->peer); /* bgp_path_info peer reference */
 
-	XFREE(MTYPE_BGP_ROUTE, path);
+	MPFREE(MPOOL_BGP_ROUTE, path);
 }
 
 struct bgp_path_info *bgp_path_info_lock(struct bgp_path_info *path)
@@ -815,8 +821,10 @@ int bgp_path_info_cmp(struct bgp *bgp, struct bgp_path_info *new,
 		 * with the
 		 * sticky flag.
 		 */
-		if (newattr->sticky != existattr->sticky) {
-			if (newattr->sticky && !existattr->sticky) {
+		if (bgp_attr_get_sticky(newattr) !=
+		    bgp_attr_get_sticky(existattr)) {
+			if (bgp_attr_get_sticky(newattr) &&
+			    !bgp_attr_get_sticky(existattr)) {
 				*reason = bgp_path_selection_evpn_sticky_mac;
 				if (debug)
 					zlog_debug(
@@ -825,7 +833,8 @@ int bgp_path_info_cmp(struct bgp *bgp, struct bgp_path_info *new,
 				return 1;
 			}
 
-			if (!newattr->sticky && existattr->sticky) {
+			if (!bgp_attr_get_sticky(newattr) &&
+			    bgp_attr_get_sticky(existattr)) {
 				*reason = bgp_path_selection_evpn_sticky_mac;
 				if (debug)
 					zlog_debug(
@@ -1804,7 +1813,8 @@ static bool bgp_otc_filter(struct peer *peer, struct attr *attr)
 		if (peer->local_role == ROLE_PROVIDER ||
 		    peer->local_role == ROLE_RS_SERVER)
 			return true;
-		if (peer->local_role == ROLE_PEER && attr->otc != peer->as)
+		if (peer->local_role == ROLE_PEER &&
+		    bgp_attr_get_otc(attr) != peer->as)
 			return true;
 		return false;
 	}
@@ -1812,7 +1822,7 @@ static bool bgp_otc_filter(struct peer *peer, struct attr *attr)
 	    peer->local_role == ROLE_PEER ||
 	    peer->local_role == ROLE_RS_CLIENT) {
 		attr->flag |= ATTR_FLAG_BIT(BGP_ATTR_OTC);
-		attr->otc = peer->as;
+		bgp_attr_set_otc(attr, peer->as);
 	}
 	return false;
 }
@@ -1830,7 +1840,7 @@ static bool bgp_otc_egress(struct peer *peer, struct attr *attr)
 	    peer->local_role == ROLE_PEER ||
 	    peer->local_role == ROLE_RS_SERVER) {
 		attr->flag |= ATTR_FLAG_BIT(BGP_ATTR_OTC);
-		attr->otc = peer->bgp->as;
+		bgp_attr_set_otc(attr, peer->bgp->as);
 	}
 	return false;
 }
@@ -1888,7 +1898,11 @@ static int bgp_input_modifier(struct peer *peer, const struct prefix *p,
 		SET_FLAG(peer->rmap_type, PEER_RMAP_TYPE_IN);
 
 		/* Apply BGP route map to the attribute. */
-		ret = route_map_apply(rmap, p, &rmap_path);
+		if (rmap_name)
+			ret = route_map_apply(rmap, p, &rmap_path);
+		else
+			ret = bgp_route_map_apply_memo(peer, afi, safi, rmap, p,
+						       &rmap_path);
 
 		peer->rmap_type = 0;
 
@@ -2819,11 +2833,22 @@ static void bgp_route_select_timer_expire(struct event *thread)
 	bgp_best_path_select_defer(bgp, afi, safi);
 }
 
-void bgp_best_selection(struct bgp *bgp, struct bgp_dest *dest,
-			struct bgp_maxpaths_cfg *mpath_cfg,
-			struct bgp_path_info_pair *result, afi_t afi,
-			safi_t safi)
+/*
+ * First half of best path selection: sort the unsorted paths into place,
+ * pick the new bestpath and collect the multipath candidates.
+ *
+ * With job->defer_reap set this only touches state owned by job->dest (path
+ * list, path flags and the job itself), which allows the selection shards
+ * to run it concurrently for different destinations.  Removed paths are then
+ * left for bgp_best_selection_apply() to reap on the main pthread.
+ */
+void bgp_best_selection_compute(struct bgp *bgp,
+				struct bgp_best_selection_job *job,
+				struct bgp_maxpaths_cfg *mpath_cfg)
 {
+	struct bgp_dest *dest = job->dest;
+	afi_t afi = job->afi;
+	safi_t safi = job->safi;
 	struct bgp_path_info *new_select, *look_thru;
 	struct bgp_path_info *old_select, *worse, *first;
 	struct bgp_path_info *pi;
@@ -2831,13 +2856,13 @@ void bgp_best_selection(struct bgp *bgp, struct bgp_dest *dest,
 	struct bgp_path_info *pi2;
 	int paths_eq, do_mpath;
 	bool debug, any_comparisons;
-	struct list mp_list;
 	char pfx_buf[PREFIX2STR_BUFFER] = {};
 	char path_buf[PATH_ADDPATH_STR_BUFFER];
 	enum bgp_path_selection_reason reason = bgp_path_selection_none;
 	bool unsorted_items = true;
 
-	bgp_mp_list_init(&mp_list);
+	bgp_mp_list_init(&job->mp_list);
+	job->computed = true;
 	do_mpath =
 		(mpath_cfg->maxpaths_ebgp > 1 || mpath_cfg->maxpaths_ibgp > 1);
 
@@ -3001,8 +3026,14 @@ void bgp_best_selection(struct bgp *bgp, struct bgp_dest *dest,
 
 			if (old_select != first &&
 			    CHECK_FLAG(first->flags, BGP_PATH_REMOVED)) {
-				dest = bgp_path_info_reap_unsorted(dest, first);
-				assert(dest);
+				if (job->defer_reap) {
+					first->next = job->reap_unsorted;
+					job->reap_unsorted = first;
+				} else {
+					dest = bgp_path_info_reap_unsorted(dest,
+									   first);
+					assert(dest);
+				}
 			} else {
 				/*
 				 * We are in hold down, so we cannot sort this
@@ -3050,9 +3081,13 @@ void bgp_best_selection(struct bgp *bgp, struct bgp_dest *dest,
 				if (CHECK_FLAG(look_thru->flags,
 					       BGP_PATH_REMOVED) &&
 				    (look_thru != old_select)) {
-					dest = bgp_path_info_reap(dest,
-								  look_thru);
-					assert(dest);
+					if (job->defer_reap) {
+						job->reap_pending = true;
+					} else {
+						dest = bgp_path_info_reap(dest,
+									  look_thru);
+						assert(dest);
+					}
 				}
 
 				continue;
@@ -3212,7 +3247,7 @@ void bgp_best_selection(struct bgp *bgp, struct bgp_dest *dest,
 						"%pBD(%s): %s is the bestpath, add to the multipath list",
 						dest, bgp->name_pretty,
 						path_buf);
-				bgp_mp_list_add(&mp_list, pi);
+				bgp_mp_list_add(&job->mp_list, pi);
 				continue;
 			}
 
@@ -3244,22 +3279,121 @@ void bgp_best_selection(struct bgp *bgp, struct bgp_dest *dest,
 						"%pBD(%s): %s is equivalent to the bestpath, add to the multipath list",
 						dest, bgp->name_pretty,
 						path_buf);
-				bgp_mp_list_add(&mp_list, pi);
+				bgp_mp_list_add(&job->mp_list, pi);
 			}
 		}
 	}
 
-	bgp_path_info_mpath_update(bgp, dest, new_select, old_select, &mp_list,
-				   mpath_cfg);
-	bgp_path_info_mpath_aggregate_update(new_select, old_select);
-	bgp_mp_list_clear(&mp_list);
+	job->old_select = old_select;
+	job->new_select = new_select;
+}
 
-	bgp_addpath_update_ids(bgp, dest, afi, safi);
+/*
+ * Reap the paths bgp_best_selection_compute() left behind when running with
+ * job->defer_reap.  Main pthread only.
+ */
+static void bgp_best_selection_reap_deferred(struct bgp_best_selection_job *job)
+{
+	struct bgp_dest *dest = job->dest;
+	struct bgp_path_info *pi, *next;
 
-	result->old = old_select;
-	result->new = new_select;
+	while ((pi = job->reap_unsorted)) {
+		job->reap_unsorted = pi->next;
+		pi->next = NULL;
+		dest = bgp_path_info_reap_unsorted(dest, pi);
+		assert(dest);
+	}
 
-	return;
+	if (!job->reap_pending)
+		return;
+	job->reap_pending = false;
+
+	for (pi = bgp_dest_get_bgp_path_info(dest); pi; pi = next) {
+		next = pi->next;
+
+		/* newly queued paths are for the next selection run */
+		if (CHECK_FLAG(pi->flags, BGP_PATH_UNSORTED))
+			continue;
+
+		if (BGP_PATH_HOLDDOWN(pi) &&
+		    CHECK_FLAG(pi->flags, BGP_PATH_REMOVED) &&
+		    pi != job->old_select) {
+			dest = bgp_path_info_reap(dest, pi);
+			assert(dest);
+		}
+	}
+}
+
+/*
+ * Second half of best path selection: everything that touches state shared
+ * between destinations (path reaping, multipath and addpath bookkeeping).
+ * Main pthread only.
+ */
+void bgp_best_selection_apply(struct bgp *bgp,
+			      struct bgp_best_selection_job *job,
+			      struct bgp_maxpaths_cfg *mpath_cfg,
+			      struct bgp_path_info_pair *result)
+{
+	struct bgp_dest *dest = job->dest;
+
+	bgp_best_selection_reap_deferred(job);
+
+	bgp_path_info_mpath_update(bgp, dest, job->new_select, job->old_select,
+				   &job->mp_list, mpath_cfg);
+	bgp_path_info_mpath_aggregate_update(job->new_select, job->old_select);
+	bgp_mp_list_clear(&job->mp_list);
+	job->computed = false;
+
+	bgp_addpath_update_ids(bgp, dest, job->afi, job->safi);
+
+	result->old = job->old_select;
+	result->new = job->new_select;
+}
+
+/*
+ * Throw away a precomputed selection that is not going to be applied, e.g.
+ * because the destination changed again after the shard looked at it.
+ */
+void bgp_best_selection_discard(struct bgp_best_selection_job *job)
+{
+	if (!job->computed)
+		return;
+
+	bgp_best_selection_reap_deferred(job);
+	bgp_mp_list_clear(&job->mp_list);
+	job->computed = false;
+}
+
+/*
+ * A precomputed selection is stale if paths were (re)queued on the
+ * destination after it was computed.  bgp_process() moves those to the head
+ * of the list, but not every caller that marks a path unsorted goes through
+ * it, so look at the whole list; compute leaves no path unsorted behind.
+ */
+bool bgp_best_selection_stale(const struct bgp_best_selection_job *job)
+{
+	struct bgp_path_info *pi;
+
+	for (pi = bgp_dest_get_bgp_path_info(job->dest); pi; pi = pi->next)
+		if (CHECK_FLAG(pi->flags, BGP_PATH_UNSORTED))
+			return true;
+
+	return false;
+}
+
+void bgp_best_selection(struct bgp *bgp, struct bgp_dest *dest,
+			struct bgp_maxpaths_cfg *mpath_cfg,
+			struct bgp_path_info_pair *result, afi_t afi,
+			safi_t safi)
+{
+	struct bgp_best_selection_job job = {
+		.dest = dest,
+		.afi = afi,
+		.safi = safi,
+	};
+
+	bgp_best_selection_compute(bgp, &job, mpath_cfg);
+	bgp_best_selection_apply(bgp, &job, mpath_cfg, result);
 }
 
 /*
@@ -3601,7 +3735,8 @@ bgp_mplsvpn_handle_label_allocation(struct bgp *bgp, struct bgp_dest *dest,
  *     is being removed.
  */
 static void bgp_process_main_one(struct bgp *bgp, struct bgp_dest *dest,
-				 afi_t afi, safi_t safi)
+				 afi_t afi, safi_t safi,
+				 struct bgp_best_selection_job *job)
 {
 	struct bgp_path_info *new_select;
 	struct bgp_path_info *old_select;
@@ -3653,9 +3788,13 @@ static void bgp_process_main_one(struct bgp *bgp, struct bgp_dest *dest,
 		return;
 	}
 
-	/* Best path selection. */
-	bgp_best_selection(bgp, dest, &bgp->maxpaths[afi][safi], &old_and_new,
-			   afi, safi);
+	/* Best path selection, unless a selection shard already did it. */
+	if (job && job->computed)
+		bgp_best_selection_apply(bgp, job, &bgp->maxpaths[afi][safi],
+					 &old_and_new);
+	else
+		bgp_best_selection(bgp, dest, &bgp->maxpaths[afi][safi],
+				   &old_and_new, afi, safi);
 	old_select = old_and_new.old;
 	new_select = old_and_new.new;
 
@@ -3881,7 +4020,7 @@ void bgp_best_path_select_defer(struct bgp *bgp, afi_t afi, safi_t safi)
 
 		UNSET_FLAG(dest->flags, BGP_NODE_SELECT_DEFER);
 		bgp->gr_info[afi][safi].gr_deferred--;
-		bgp_process_main_one(bgp, dest, afi, safi);
+		bgp_process_main_one(bgp, dest, afi, safi, NULL);
 		cnt++;
 	}
 	/* If iteration stopped before the entire table was traversed then the
@@ -3915,33 +4054,96 @@ void bgp_best_path_select_defer(struct bgp *bgp, afi_t afi, safi_t safi)
 			&bgp->gr_info[afi][safi].t_route_select);
 }
 
+/*
+ * Hand the best path computation for all destinations currently queued on
+ * pqnode to the selection shards.  Returns the precomputed jobs in queue
+ * order, or NULL if the batch is processed serially.
+ */
+static struct bgp_best_selection_job *
+bgp_process_wq_select(struct bgp *bgp, struct bgp_process_queue *pqnode,
+		      size_t *njobs)
+{
+	struct bgp_best_selection_job *jobs;
+	struct bgp_table *table;
+	struct bgp_dest *dest;
+	size_t n = 0;
+
+	*njobs = 0;
+
+	if (!bgp_select_enabled() || pqnode->queued < BGP_SELECT_MIN_BATCH ||
+	    CHECK_FLAG(bgp->flags, BGP_FLAG_DELETE_IN_PROGRESS))
+		return NULL;
+
+	jobs = XCALLOC(MTYPE_BGP_SELECT_JOB, pqnode->queued * sizeof(*jobs));
+
+	STAILQ_FOREACH (dest, &pqnode->pqueue, pq) {
+		if (n == pqnode->queued)
+			break;
+		if (CHECK_FLAG(dest->flags, BGP_NODE_SELECT_DEFER))
+			continue;
+
+		table = bgp_dest_table(dest);
+		jobs[n].dest = dest;
+		jobs[n].afi = table->afi;
+		jobs[n].safi = table->safi;
+		jobs[n].defer_reap = true;
+		n++;
+	}
+
+	bgp_select_run(bgp, jobs, n);
+
+	*njobs = n;
+	return jobs;
+}
+
 static wq_item_status bgp_process_wq(struct work_queue *wq, void *data)
 {
 	struct bgp_process_queue *pqnode = data;
 	struct bgp *bgp = pqnode->bgp;
 	struct bgp_table *table;
 	struct bgp_dest *dest;
+	struct bgp_best_selection_job *jobs, *job;
+	size_t njobs, i = 0;
 
 	/* eoiu marker */
 	if (CHECK_FLAG(pqnode->flags, BGP_PROCESS_QUEUE_EOIU_MARKER)) {
-		bgp_process_main_one(bgp, NULL, 0, 0);
+		bgp_process_main_one(bgp, NULL, 0, 0, NULL);
 		/* should always have dedicated wq call */
 		assert(STAILQ_FIRST(&pqnode->pqueue) == NULL);
 		return WQ_SUCCESS;
 	}
 
+	jobs = bgp_process_wq_select(bgp, pqnode, &njobs);
+
 	while (!STAILQ_EMPTY(&pqnode->pqueue)) {
 		dest = STAILQ_FIRST(&pqnode->pqueue);
 		STAILQ_REMOVE_HEAD(&pqnode->pqueue, pq);
 		STAILQ_NEXT(dest, pq) = NULL; /* complete unlink */
 		table = bgp_dest_table(dest);
+
+		/* DESTs added during processing go after the precomputed
+		 * ones, so the jobs can simply be matched in order.
+		 */
+		job = NULL;
+		if (i < njobs && jobs[i].dest == dest) {
+			job = &jobs[i++];
+			if (bgp_best_selection_stale(job)) {
+				bgp_best_selection_discard(job);
+				bgp_select_stale_inc();
+			}
+		}
+
 		/* note, new DESTs may be added as part of processing */
-		bgp_process_main_one(bgp, dest, table->afi, table->safi);
+		bgp_process_main_one(bgp, dest, table->afi, table->safi, job);
+		if (job)
+			bgp_best_selection_discard(job);
 
 		bgp_dest_unlock_node(dest);
 		bgp_table_unlock(table);
 	}
 
+	XFREE(MTYPE_BGP_SELECT_JOB, jobs);
+
 	return WQ_SUCCESS;
 }
 
@@ -4326,7 +4528,7 @@ struct bgp_path_info *info_make(int type, int sub_type, unsigned short instance,
 	struct bgp_path_info *new;
 
 	/* Make new BGP info. */
-	new = XCALLOC(MTYPE_BGP_ROUTE, sizeof(struct bgp_path_info));
+	new = mempool_alloc(MPOOL_BGP_ROUTE);
 	new->type = type;
 	new->instance = instance;
 	new->sub_type = sub_type;
@@ -4540,6 +4742,7 @@ void bgp_update(struct peer *peer, const struct prefix *p, uint32_t addpath_id,
 	int vnc_implicit_withdraw = 0;
 #endif
 	int same_attr = 0;
+	bool set_evpn_overlay = soft_reconfig;
 	const struct prefix *bgp_nht_param_prefix;
 
 	/* Special case for BGP-LU - map LU safi to ordinary unicast safi */
@@ -4566,14 +4769,20 @@ void bgp_update(struct peer *peer, const struct prefix *p, uint32_t addpath_id,
 		/*
 		 * If the trigger is not from soft_reconfig and if
 		 * PEER_FLAG_SOFT_RECONFIG is enabled for the peer, then attr
-		 * will not be interned. In which case, it is ok to update the
-		 * attr->evpn_overlay, so that, this can be stored in adj_in.
+		 * will not be interned, but it is shared by all NLRIs of the
+		 * UPDATE and holds a reference on its attr_ext.  Store the
+		 * evpn_overlay in adj_in through a copy, new_attr picks it
+		 * up below.
 		 */
 		if ((afi == AFI_L2VPN) && evpn) {
-			memcpy(&attr->evpn_overlay, evpn,
-			       sizeof(struct bgp_route_evpn));
-		}
-		bgp_adj_in_set(dest, peer, attr, addpath_id);
+			struct attr adj_attr = *attr;
+
+			bgp_attr_set_evpn_overlay(&adj_attr, evpn);
+			bgp_adj_in_set(dest, peer, &adj_attr, addpath_id);
+			bgp_attr_flush_ext(&adj_attr);
+			set_evpn_overlay = true;
+		} else
+			bgp_adj_in_set(dest, peer, attr, addpath_id);
 	}
 
 	/* Update permitted loop count */
@@ -4733,9 +4942,8 @@ void bgp_update(struct peer *peer, const struct prefix *p, uint32_t addpath_id,
 	 * attr->evpn_overlay with evpn directly. Instead memcpy
 	 * evpn to new_atr.evpn_overlay before it is interned.
 	 */
-	if (soft_reconfig && (afi == AFI_L2VPN) && evpn)
-		memcpy(&new_attr.evpn_overlay, evpn,
-		       sizeof(struct bgp_route_evpn));
+	if (set_evpn_overlay && (afi == AFI_L2VPN) && evpn)
+		bgp_attr_set_evpn_overlay(&new_attr, evpn);
 
 	/* Apply incoming route-map.
 	 * NB: new_attr may now contain newly allocated values from route-map
@@ -4752,7 +4960,8 @@ void bgp_update(struct peer *peer, const struct prefix *p, uint32_t addpath_id,
 		goto filtered;
 	}
 
-	if (pi && pi->attr->rmap_table_id != new_attr.rmap_table_id) {
+	if (pi && bgp_attr_get_rmap_table_id(pi->attr) !=
+			  bgp_attr_get_rmap_table_id(&new_attr)) {
 		if (CHECK_FLAG(pi->flags, BGP_PATH_SELECTED))
 			/* remove from RIB previous entry */
 			bgp_zebra_route_install(dest, pi, bgp, false, NULL,
@@ -5368,7 +5577,7 @@ filtered:
 		bgp_unlink_nexthop(new);
 		bgp_path_info_delete(dest, new);
 		bgp_path_info_extra_free(&new->extra);
-		XFREE(MTYPE_BGP_ROUTE, new);
+		MPFREE(MPOOL_BGP_ROUTE, new);
 	}
 
 	hook_call(bgp_process, bgp, afi, safi, dest, peer, true);
@@ -5625,26 +5834,66 @@ void bgp_announce_route_all(struct peer *peer)
 		bgp_announce_route(peer, afi, safi, false);
 }
 
-/* Flag or unflag bgp_dest to determine whether it should be treated by
- * bgp_soft_reconfig_table_task.
- * Flag if flag is true. Unflag if flag is false.
+/* Queue the adj-in entries of peer for bgp_soft_reconfig_table_task, and
+ * flag the bgp_dest holding them. Entries still queued from an earlier call
+ * are only counted once in the peer's progress counters.
  */
-static void bgp_soft_reconfig_table_flag(struct bgp_table *table, bool flag)
+static void bgp_soft_reconfig_table_flag(struct bgp_table *table,
+					 struct peer *peer)
 {
 	struct bgp_dest *dest;
 	struct bgp_adj_in *ain;
+	afi_t afi = table->afi;
+	safi_t safi = table->safi;
+	bool fresh;
+
+	fresh = !CHECK_FLAG(peer->af_sflags[afi][safi],
+			    PEER_STATUS_SOFT_RECONFIG_IN);
+	if (fresh) {
+		SET_FLAG(peer->af_sflags[afi][safi],
+			 PEER_STATUS_SOFT_RECONFIG_IN);
+		peer->soft_reconfig_queued[afi][safi] = 0;
+		peer->soft_reconfig_done[afi][safi] = 0;
+	}
+
+	for (dest = bgp_table_top(table); dest; dest = bgp_route_next(dest)) {
+		for (ain = dest->adj_in; ain; ain = ain->next) {
+			if (ain->peer != peer)
+				continue;
+			if (ain->soft_reconfig && !fresh)
+				continue;
+
+			ain->soft_reconfig = true;
+			peer->soft_reconfig_queued[afi][safi]++;
+			SET_FLAG(dest->flags, BGP_NODE_SOFT_RECONFIG);
+		}
+	}
+}
+
+/* Drop all adj-in entries of the table, or only those of peer if not NULL,
+ * from bgp_soft_reconfig_table_task.
+ */
+static void bgp_soft_reconfig_table_unflag(struct bgp_table *table,
+					   const struct peer *peer)
+{
+	struct bgp_dest *dest;
+	struct bgp_adj_in *ain;
+	bool queued;
 
 	if (!table)
 		return;
 
 	for (dest = bgp_table_top(table); dest; dest = bgp_route_next(dest)) {
+		if (!CHECK_FLAG(dest->flags, BGP_NODE_SOFT_RECONFIG))
+			continue;
+
+		queued = false;
 		for (ain = dest->adj_in; ain; ain = ain->next) {
-			if (ain->peer != NULL)
-				break;
+			if (!peer || ain->peer == peer)
+				ain->soft_reconfig = false;
+			queued |= ain->soft_reconfig;
 		}
-		if (flag && ain != NULL && ain->peer != NULL)
-			SET_FLAG(dest->flags, BGP_NODE_SOFT_RECONFIG);
-		else
+		if (!queued)
 			UNSET_FLAG(dest->flags, BGP_NODE_SOFT_RECONFIG);
 	}
 }
@@ -5699,9 +5948,8 @@ static void bgp_soft_reconfig_table(struct peer *peer, afi_t afi, safi_t safi,
 }
 
 /* Do soft reconfig table per bgp table.
- * Walk on SOFT_RECONFIG_TASK_MAX_PREFIX bgp_dest,
- * when BGP_NODE_SOFT_RECONFIG is set,
- * reconfig bgp_dest for list of table->soft_reconfig_peers peers.
+ * Walk on SOFT_RECONFIG_TASK_MAX_PREFIX queued adj-in entries,
+ * starting from the bgp_dest flagged with BGP_NODE_SOFT_RECONFIG.
  * Schedule a new thread to continue the job.
  * Without splitting the full job into several part,
  * vtysh waits for the job to finish before responding to a BGP command
@@ -5728,24 +5976,35 @@ static void bgp_soft_reconfig_table_task(struct event *thread)
 		max_iter = 0;
 	}
 
-	for (iter = 0, dest = bgp_table_top(table); (dest && iter < max_iter);
-	     dest = bgp_route_next(dest)) {
+	/* carry on from where the previous run stopped, bgp_route_next()
+	 * drops the lock taken on it then
+	 */
+	dest = table->soft_reconfig_next;
+	table->soft_reconfig_next = NULL;
+	if (!dest)
+		dest = bgp_table_top(table);
+
+	for (iter = 0; (dest && iter < max_iter); dest = bgp_route_next(dest)) {
 		if (!CHECK_FLAG(dest->flags, BGP_NODE_SOFT_RECONFIG))
 			continue;
 
 		UNSET_FLAG(dest->flags, BGP_NODE_SOFT_RECONFIG);
 
+		/* Each queued entry belongs to exactly one peer, so this is
+		 * linear in the size of adj-in however many peers are being
+		 * reconfigured at once.
+		 */
 		for (ain = dest->adj_in; ain; ain = ain->next) {
-			for (ALL_LIST_ELEMENTS(table->soft_reconfig_peers, node,
-					       nnode, peer)) {
-				if (ain->peer != peer)
-					continue;
+			if (!ain->soft_reconfig)
+				continue;
 
-				bgp_soft_reconfig_table_update(
-					peer, dest, ain, table->afi,
-					table->safi, prd);
-				iter++;
-			}
+			ain->soft_reconfig = false;
+			peer = ain->peer;
+			bgp_soft_reconfig_table_update(peer, dest, ain,
+						       table->afi, table->safi,
+						       prd);
+			peer->soft_reconfig_done[table->afi][table->safi]++;
+			iter++;
 		}
 	}
 
@@ -5753,6 +6012,8 @@ static void bgp_soft_reconfig_table_task(struct event *thread)
 	 * or we're going to continue an ongoing iteration
 	 */
 	if (dest || table->soft_reconfig_init) {
+		/* keep the lock bgp_route_next() took on dest */
+		table->soft_reconfig_next = dest;
 		table->soft_reconfig_init = false;
 		event_add_event(bm->master, bgp_soft_reconfig_table_task, table,
 				0, &table->soft_reconfig_thread);
@@ -5763,6 +6024,8 @@ static void bgp_soft_reconfig_table_task(struct event *thread)
 	*/
 	for (ALL_LIST_ELEMENTS(table->soft_reconfig_peers, node, nnode, peer)) {
 		listnode_delete(table->soft_reconfig_peers, peer);
+		UNSET_FLAG(peer->af_sflags[table->afi][table->safi],
+			   PEER_STATUS_SOFT_RECONFIG_IN);
 		bgp_announce_route(peer, table->afi, table->safi, false);
 	}
 
@@ -5802,14 +6065,25 @@ void bgp_soft_reconfig_table_task_cancel(const struct bgp *bgp,
 			if (peer && peer != npeer)
 				continue;
 			listnode_delete(ntable->soft_reconfig_peers, npeer);
+			UNSET_FLAG(npeer->af_sflags[afi][safi],
+				   PEER_STATUS_SOFT_RECONFIG_IN);
 		}
 
-		if (!ntable->soft_reconfig_peers
-		    || !list_isempty(ntable->soft_reconfig_peers))
+		if (!ntable->soft_reconfig_peers)
 			continue;
 
+		if (!list_isempty(ntable->soft_reconfig_peers)) {
+			/* the others carry on, skip this peer's entries */
+			if (peer)
+				bgp_soft_reconfig_table_unflag(ntable, peer);
+			continue;
+		}
+
 		list_delete(&ntable->soft_reconfig_peers);
-		bgp_soft_reconfig_table_flag(ntable, false);
+		bgp_soft_reconfig_table_unflag(ntable, NULL);
+		if (ntable->soft_reconfig_next)
+			bgp_dest_unlock_node(ntable->soft_reconfig_next);
+		ntable->soft_reconfig_next = NULL;
 		EVENT_OFF(ntable->soft_reconfig_thread);
 	}
 }
@@ -5850,10 +6124,14 @@ bool bgp_soft_reconfig_in(struct peer *peer, afi_t afi, safi_t safi)
 		if (peer != npeer)
 			listnode_add(table->soft_reconfig_peers, peer);
 
-		/* (re)flag all bgp_dest in table. Existing soft_reconfig_in job
-		 * on table would start back at the beginning.
+		/* Queue the adj-in entries of this peer. Existing
+		 * soft_reconfig_in job on table starts back at the beginning,
+		 * but only revisits the entries of peers queued again.
 		 */
-		bgp_soft_reconfig_table_flag(table, true);
+		bgp_soft_reconfig_table_flag(table, peer);
+		if (table->soft_reconfig_next)
+			bgp_dest_unlock_node(table->soft_reconfig_next);
+		table->soft_reconfig_next = NULL;
 
 		if (!table->soft_reconfig_thread)
 			event_add_event(bm->master,
@@ -6465,6 +6743,64 @@ bool bgp_addpath_encode_rx(struct peer *peer, afi_t afi, safi_t safi)
 			      PEER_CAP_ADDPATH_AF_TX_RCV));
 }
 
+/* Sanity check and install or withdraw one IPv4/IPv6 unicast or multicast
+ * prefix.  Returns true when maximum-prefix overflow stopped the session.
+ */
+static bool bgp_nlri_ip_prefix(struct peer *peer, struct attr *attr, afi_t afi,
+			       safi_t safi, const struct prefix *p,
+			       uint32_t addpath_id)
+{
+	/* Check address. */
+	if (afi == AFI_IP && safi == SAFI_UNICAST) {
+		if (IN_CLASSD(ntohl(p->u.prefix4.s_addr))) {
+			/* From RFC4271 Section 6.3:
+			 *
+			 * If a prefix in the NLRI field is semantically
+			 * incorrect
+			 * (e.g., an unexpected multicast IP address),
+			 * an error SHOULD
+			 * be logged locally, and the prefix SHOULD be
+			 * ignored.
+			 */
+			flog_err(EC_BGP_UPDATE_RCV,
+				 "%s: IPv4 unicast NLRI is multicast address %pI4, ignoring",
+				 peer->host, &p->u.prefix4);
+			return false;
+		}
+	}
+
+	/* Check address. */
+	if (afi == AFI_IP6 && safi == SAFI_UNICAST) {
+		if (IN6_IS_ADDR_LINKLOCAL(&p->u.prefix6)) {
+			flog_err(EC_BGP_UPDATE_RCV,
+				 "%s: IPv6 unicast NLRI is link-local address %pI6, ignoring",
+				 peer->host, &p->u.prefix6);
+
+			return false;
+		}
+		if (IN6_IS_ADDR_MULTICAST(&p->u.prefix6)) {
+			flog_err(EC_BGP_UPDATE_RCV,
+				 "%s: IPv6 unicast NLRI is multicast address %pI6, ignoring",
+				 peer->host, &p->u.prefix6);
+
+			return false;
+		}
+	}
+
+	/* Normal process. */
+	if (attr)
+		bgp_update(peer, p, addpath_id, attr, afi, safi,
+			   ZEBRA_ROUTE_BGP, BGP_ROUTE_NORMAL, NULL, NULL, 0, 0,
+			   NULL);
+	else
+		bgp_withdraw(peer, p, addpath_id, afi, safi, ZEBRA_ROUTE_BGP,
+			     BGP_ROUTE_NORMAL, NULL, NULL, 0, NULL);
+
+	/* Do not send BGP notification twice when maximum-prefix count
+	 * overflow. */
+	return CHECK_FLAG(peer->sflags, PEER_STATUS_PREFIX_OVERFLOW);
+}
+
 /* Parse NLRI stream.  Withdraw NLRI is recognized by NULL attr
    value. */
 int bgp_nlri_parse_ip(struct peer *peer, struct attr *attr,
@@ -6544,59 +6880,7 @@ int bgp_nlri_parse_ip(struct peer *peer, struct attr *attr,
 		/* Fetch prefix from NLRI packet. */
 		memcpy(p.u.val, pnt, psize);
 
-		/* Check address. */
-		if (afi == AFI_IP && safi == SAFI_UNICAST) {
-			if (IN_CLASSD(ntohl(p.u.prefix4.s_addr))) {
-				/* From RFC4271 Section 6.3:
-				 *
-				 * If a prefix in the NLRI field is semantically
-				 * incorrect
-				 * (e.g., an unexpected multicast IP address),
-				 * an error SHOULD
-				 * be logged locally, and the prefix SHOULD be
-				 * ignored.
-				 */
-				flog_err(
-					EC_BGP_UPDATE_RCV,
-					"%s: IPv4 unicast NLRI is multicast address %pI4, ignoring",
-					peer->host, &p.u.prefix4);
-				continue;
-			}
-		}
-
-		/* Check address. */
-		if (afi == AFI_IP6 && safi == SAFI_UNICAST) {
-			if (IN6_IS_ADDR_LINKLOCAL(&p.u.prefix6)) {
-				flog_err(
-					EC_BGP_UPDATE_RCV,
-					"%s: IPv6 unicast NLRI is link-local address %pI6, ignoring",
-					peer->host, &p.u.prefix6);
-
-				continue;
-			}
-			if (IN6_IS_ADDR_MULTICAST(&p.u.prefix6)) {
-				flog_err(
-					EC_BGP_UPDATE_RCV,
-					"%s: IPv6 unicast NLRI is multicast address %pI6, ignoring",
-					peer->host, &p.u.prefix6);
-
-				continue;
-			}
-		}
-
-		/* Normal process. */
-		if (attr)
-			bgp_update(peer, &p, addpath_id, attr, afi, safi,
-				   ZEBRA_ROUTE_BGP, BGP_ROUTE_NORMAL, NULL,
-				   NULL, 0, 0, NULL);
-		else
-			bgp_withdraw(peer, &p, addpath_id, afi, safi,
-				     ZEBRA_ROUTE_BGP, BGP_ROUTE_NORMAL, NULL,
-				     NULL, 0, NULL);
-
-		/* Do not send BGP notification twice when maximum-prefix count
-		 * overflow. */
-		if (CHECK_FLAG(peer->sflags, PEER_STATUS_PREFIX_OVERFLOW))
+		if (bgp_nlri_ip_prefix(peer, attr, afi, safi, &p, addpath_id))
 			return BGP_NLRI_PARSE_ERROR_PREFIX_OVERFLOW;
 	}
 
@@ -6612,6 +6896,27 @@ int bgp_nlri_parse_ip(struct peer *peer, struct attr *attr,
 	return BGP_NLRI_PARSE_OK;
 }
 
+/* Same as bgp_nlri_parse_ip() for an NLRI field the I/O pthread has already
+ * decoded and syntax checked.
+ */
+int bgp_nlri_parse_ip_preparsed(struct peer *peer, struct attr *attr,
+				const struct bgp_preparse *pp,
+				const struct bgp_preparse_section *sec)
+{
+	const struct bgp_preparse_prefix *pfx;
+	uint32_t i;
+
+	for (i = 0; i < sec->count; i++) {
+		pfx = &pp->prefixes[sec->first + i];
+
+		if (bgp_nlri_ip_prefix(peer, attr, sec->afi, sec->safi,
+				       &pfx->p, pfx->addpath_id))
+			return BGP_NLRI_PARSE_ERROR_PREFIX_OVERFLOW;
+	}
+
+	return BGP_NLRI_PARSE_OK;
+}
+
 static void bgp_nexthop_reachability_check(afi_t afi, safi_t safi,
 					   struct bgp_path_info *bpi,
 					   const struct prefix *p,
@@ -6721,17 +7026,20 @@ void bgp_static_update(struct bgp *bgp, const struct prefix *p,
 	}
 
 	if (afi == AFI_L2VPN) {
+		struct bgp_route_evpn eo = *bgp_attr_get_evpn_overlay(&attr);
+
 		if (bgp_static->gatewayIp.family == AF_INET) {
-			SET_IPADDR_V4(&attr.evpn_overlay.gw_ip);
-			memcpy(&attr.evpn_overlay.gw_ip.ipaddr_v4,
+			SET_IPADDR_V4(&eo.gw_ip);
+			memcpy(&eo.gw_ip.ipaddr_v4,
 			       &bgp_static->gatewayIp.u.prefix4,
 			       IPV4_MAX_BYTELEN);
 		} else if (bgp_static->gatewayIp.family == AF_INET6) {
-			SET_IPADDR_V6(&attr.evpn_overlay.gw_ip);
-			memcpy(&attr.evpn_overlay.gw_ip.ipaddr_v6,
+			SET_IPADDR_V6(&eo.gw_ip);
+			memcpy(&eo.gw_ip.ipaddr_v6,
 			       &bgp_static->gatewayIp.u.prefix6,
 			       IPV6_MAX_BYTELEN);
 		}
+		bgp_attr_set_evpn_overlay(&attr, &eo);
 		memcpy(&attr.esi, bgp_static->eth_s_id, sizeof(esi_t));
 		if (bgp_static->encap_tunneltype == BGP_ENCAP_TYPE_VXLAN) {
 			struct bgp_encap_type_vxlan bet;
@@ -6764,6 +7072,7 @@ void bgp_static_update(struct bgp *bgp, const struct prefix *p,
 
 			/* Unintern original. */
 			aspath_unintern(&attr.aspath);
+			bgp_attr_flush_ext(&attr);
 			bgp_static_withdraw(bgp, p, afi, safi, &bgp_static->prd);
 			bgp_dest_unlock_node(dest);
 			return;
@@ -6773,6 +7082,7 @@ void bgp_static_update(struct bgp *bgp, const struct prefix *p,
 			bgp_attr_add_gshut_community(&attr_tmp);
 
 		attr_new = bgp_attr_intern(&attr_tmp);
+		bgp_attr_flush_ext(&attr);
 	} else {
 
 		if (bgp_in_graceful_shutdown(bgp))
@@ -8993,6 +9303,7 @@ void bgp_redistribute_add(struct bgp *bgp, struct prefix *p,
 
 				/* Unintern original. */
 				aspath_unintern(&attr.aspath);
+				bgp_attr_flush_ext(&attr);
 				bgp_redistribute_delete(bgp, p, type, instance);
 				return;
 			}
@@ -9005,6 +9316,7 @@ void bgp_redistribute_add(struct bgp *bgp, struct prefix *p,
 				      SAFI_UNICAST, p, NULL);
 
 		new_attr = bgp_attr_intern(&attr_new);
+		bgp_attr_flush_ext(&attr);
 
 		for (bpi = bgp_dest_get_bgp_path_info(bn); bpi; bpi = bpi->next)
 			if (bpi->peer == bgp->peer_self
@@ -9072,6 +9384,7 @@ void bgp_redistribute_add(struct bgp *bgp, struct prefix *p,
 
 	/* Unintern original. */
 	aspath_unintern(&attr.aspath);
+	bgp_attr_flush_ext(&attr);
 }
 
 void bgp_redistribute_delete(struct bgp *bgp, struct prefix *p, uint8_t type,
@@ -10428,10 +10741,11 @@ static void route_vty_out_detail_es_info(struct vty *vty,
 			if (peer_router)
 				json_object_boolean_true_add(
 						json_es_info, "peerRouter");
-			if (attr->mm_sync_seqnum)
+			if (bgp_attr_get_mm_sync_seqnum(attr))
 				json_object_int_add(
 						json_es_info, "peerSeq",
-						attr->mm_sync_seqnum);
+						bgp_attr_get_mm_sync_seqnum(
+							attr));
 			json_object_object_add(
 					json_path, "es_info",
 					json_es_info);
@@ -10445,7 +10759,7 @@ static void route_vty_out_detail_es_info(struct vty *vty,
 					peer_proxy ? "proxy " : "",
 					peer_active ? "active ":"",
 					peer_router ? "router ":"",
-					attr->mm_sync_seqnum);
+					bgp_attr_get_mm_sync_seqnum(attr));
 		else
 			vty_out(vty, "      ESI %s %s\n",
 					esi_buf,
@@ -10527,10 +10841,11 @@ void route_vty_out_detail(struct vty *vty, struct bgp *bgp, struct bgp_dest *bn,
 	}
 
 	if (safi == SAFI_EVPN
-	    && attr->evpn_overlay.type == OVERLAY_INDEX_GATEWAY_IP) {
+	    && bgp_attr_get_evpn_overlay(attr)->type ==
+		       OVERLAY_INDEX_GATEWAY_IP) {
 		char gwip_buf[INET6_ADDRSTRLEN];
 
-		ipaddr2str(&attr->evpn_overlay.gw_ip, gwip_buf,
+		ipaddr2str(&bgp_attr_get_evpn_overlay(attr)->gw_ip, gwip_buf,
 			   sizeof(gwip_buf));
 
 		if (json_paths)
@@ -11084,9 +11399,10 @@ void route_vty_out_detail(struct vty *vty, struct bgp *bgp, struct bgp_dest *bn,
 
 	if (attr->flag & ATTR_FLAG_BIT(BGP_ATTR_OTC)) {
 		if (json_paths)
-			json_object_int_add(json_path, "otc", attr->otc);
+			json_object_int_add(json_path, "otc",
+					    bgp_attr_get_otc(attr));
 		else
-			vty_out(vty, ", otc %u", attr->otc);
+			vty_out(vty, ", otc %u", bgp_attr_get_otc(attr));
 	}
 
 	if (CHECK_FLAG(path->flags, BGP_PATH_MULTIPATH)
@@ -14393,6 +14709,7 @@ show_adj_route(struct vty *vty, struct peer *peer, struct bgp_table *table,
 	struct bgp *bgp;
 	struct attr attr;
 	int ret;
+	uint32_t i;
 	struct update_subgroup *subgrp;
 	struct peer_af *paf = NULL;
 	bool route_filtered;
@@ -14449,7 +14766,7 @@ show_adj_route(struct vty *vty, struct peer *peer, struct bgp_table *table,
 		} else if (type == bgp_show_adj_route_advertised) {
 			bool peer_found = false;
 
-			RB_FOREACH (adj, bgp_adj_out_rb, &dest->adj_out) {
+			BGP_ADJ_OUT_FOREACH (&dest->adj_out, adj, i) {
 				SUBGRP_FOREACH_PEER (adj->subgroup, paf) {
 					if (paf->peer == peer && adj->attr) {
 						attr = *adj->attr;
@@ -14633,7 +14950,7 @@ show_adj_route(struct vty *vty, struct peer *peer, struct bgp_table *table,
 				(*output_count)++;
 			}
 		} else if (type == bgp_show_adj_route_advertised) {
-			RB_FOREACH (adj, bgp_adj_out_rb, &dest->adj_out)
+			BGP_ADJ_OUT_FOREACH (&dest->adj_out, adj, i)
 				SUBGRP_FOREACH_PEER (adj->subgroup, paf) {
 					if (paf->peer != peer || !adj->attr)
 						continue;
@@ -9,6 +9,8 @@
 #include <stdbool.h>
 
 #include "hook.h"
+#include "linklist.h"
+#include "mempool.h"
 #include "queue.h"
 #include "nexthop.h"
 #include "bgp_table.h"
@@ -17,6 +19,8 @@
 
 struct bgp_nexthop_cache;
 struct bgp_route_evpn;
+struct bgp_preparse;
+struct bgp_preparse_section;
 
 enum bgp_show_type {
 	bgp_show_type_normal,
@@ -364,6 +368,27 @@ struct bgp_path_info_pair {
 	struct bgp_path_info *new;
 };
 
+/* State of one destination's best path selection, carried between
+ * bgp_best_selection_compute() and bgp_best_selection_apply().
+ */
+struct bgp_best_selection_job {
+	struct bgp_dest *dest;
+	afi_t afi;
+	safi_t safi;
+
+	/* Leave path reaping to bgp_best_selection_apply() */
+	bool defer_reap;
+
+	/* Results of bgp_best_selection_compute() */
+	bool computed;
+	bool reap_pending;
+	struct bgp_path_info *old_select;
+	struct bgp_path_info *new_select;
+	struct list mp_list;
+	/* removed unsorted paths, chained through ->next */
+	struct bgp_path_info *reap_unsorted;
+};
+
 /* BGP static route configuration. */
 struct bgp_static {
 	/* Backdoor configuration.  */
@@ -705,6 +730,9 @@ DECLARE_HOOK(bgp_route_update,
 #define BGP_SHOW_OPT_TERSE (1 << 8)
 #define BGP_SHOW_OPT_ROUTES_DETAIL (1 << 9)
 
+/* bgp_path_info objects, see info_make() */
+DECLARE_MEMPOOL(BGP_ROUTE);
+
 /* Prototypes. */
 extern void bgp_rib_remove(struct bgp_dest *dest, struct bgp_path_info *pi,
 			   struct peer *peer, afi_t afi, safi_t safi);
@@ -761,6 +789,9 @@ extern void bgp_path_info_path_with_addpath_rx_str(struct bgp_path_info *pi,
 						   char *buf, size_t buf_len);
 
 extern int bgp_nlri_parse_ip(struct peer *, struct attr *, struct bgp_nlri *);
+extern int bgp_nlri_parse_ip_preparsed(struct peer *peer, struct attr *attr,
+				       const struct bgp_preparse *pp,
+				       const struct bgp_preparse_section *sec);
 
 extern bool bgp_maximum_prefix_overflow(struct peer *, afi_t, safi_t, int);
 
@@ -894,6 +925,15 @@ extern void bgp_best_selection(struct bgp *bgp, struct bgp_dest *dest,
 			       struct bgp_maxpaths_cfg *mpath_cfg,
 			       struct bgp_path_info_pair *result, afi_t afi,
 			       safi_t safi);
+extern void bgp_best_selection_compute(struct bgp *bgp,
+				       struct bgp_best_selection_job *job,
+				       struct bgp_maxpaths_cfg *mpath_cfg);
+extern void bgp_best_selection_apply(struct bgp *bgp,
+				     struct bgp_best_selection_job *job,
+				     struct bgp_maxpaths_cfg *mpath_cfg,
+				     struct bgp_path_info_pair *result);
+extern void bgp_best_selection_discard(struct bgp_best_selection_job *job);
+extern bool bgp_best_selection_stale(const struct bgp_best_selection_job *job);
 extern void bgp_zebra_clear_route_change_flags(struct bgp_dest *dest);
 extern bool bgp_zebra_has_route_changed(struct bgp_path_info *selected);
 
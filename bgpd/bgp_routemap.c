@@ -167,6 +167,14 @@ static uint32_t route_value_adjust(struct rmap_value *rv, uint32_t current,
 	}
 }
 
+/* "rtt" follows the peer's measurements, anything else is fixed */
+static bool route_value_memoizable(void *rule)
+{
+	struct rmap_value *rv = rule;
+
+	return rv->variable == 0;
+}
+
 static void *route_value_compile(const char *arg)
 {
 	uint8_t action = RMAP_VALUE_SET, var = 0;
@@ -1068,7 +1076,7 @@ route_match_vni(void *rule, const struct prefix *prefix, void *object)
 	 * For any other tunnel type, return noop to ignore
 	 * this check.
 	 */
-	if (path->attr->encap_tunneltype != BGP_ENCAP_TYPE_VXLAN)
+	if (bgp_attr_get_encap_tunneltype(path->attr) != BGP_ENCAP_TYPE_VXLAN)
 		return RMAP_NOOP;
 
 	/*
@@ -1240,6 +1248,7 @@ route_set_evpn_gateway_ip(void *rule, const struct prefix *prefix, void *object)
 	struct ipaddr *gw_ip = rule;
 	struct bgp_path_info *path;
 	struct prefix_evpn *evp;
+	struct bgp_route_evpn eo;
 
 	if (prefix->family != AF_EVPN)
 		return RMAP_OKAY;
@@ -1255,9 +1264,10 @@ route_set_evpn_gateway_ip(void *rule, const struct prefix *prefix, void *object)
 	path = object;
 
 	/* Set gateway-ip value. */
-	path->attr->evpn_overlay.type = OVERLAY_INDEX_GATEWAY_IP;
-	memcpy(&path->attr->evpn_overlay.gw_ip, &gw_ip->ip.addr,
-	       IPADDRSZ(gw_ip));
+	eo = *bgp_attr_get_evpn_overlay(path->attr);
+	eo.type = OVERLAY_INDEX_GATEWAY_IP;
+	memcpy(&eo.gw_ip, &gw_ip->ip.addr, IPADDRSZ(gw_ip));
+	bgp_attr_set_evpn_overlay(path->attr, &eo);
 
 	return RMAP_OKAY;
 }
@@ -1457,7 +1467,9 @@ static const struct route_map_rule_cmd route_match_local_pref_cmd = {
 	"local-preference",
 	route_match_local_pref,
 	route_match_local_pref_compile,
-	route_match_local_pref_free
+	route_match_local_pref_free,
+	NULL,
+	route_map_rule_memoizable,
 };
 
 /* `match metric METRIC' */
@@ -1480,6 +1492,8 @@ static const struct route_map_rule_cmd route_match_metric_cmd = {
 	route_match_metric,
 	route_value_compile,
 	route_value_free,
+	NULL,
+	route_value_memoizable,
 };
 
 /* `match as-path ASPATH' */
@@ -1521,7 +1535,9 @@ static const struct route_map_rule_cmd route_match_aspath_cmd = {
 	"as-path",
 	route_match_aspath,
 	route_match_aspath_compile,
-	route_match_aspath_free
+	route_match_aspath_free,
+	NULL,
+	route_map_rule_memoizable,
 };
 
 /* `match community COMMUNIY' */
@@ -1627,7 +1643,8 @@ static const struct route_map_rule_cmd route_match_community_cmd = {
 	route_match_community,
 	route_match_community_compile,
 	route_match_community_free,
-	route_match_get_community_key
+	route_match_get_community_key,
+	route_map_rule_memoizable,
 };
 
 /* Match function for lcommunity match. */
@@ -1708,7 +1725,8 @@ static const struct route_map_rule_cmd route_match_lcommunity_cmd = {
 	route_match_lcommunity,
 	route_match_lcommunity_compile,
 	route_match_lcommunity_free,
-	route_match_get_community_key
+	route_match_get_community_key,
+	route_map_rule_memoizable,
 };
 
 
@@ -1759,7 +1777,9 @@ static const struct route_map_rule_cmd route_match_ecommunity_cmd = {
 	"extcommunity",
 	route_match_ecommunity,
 	route_match_ecommunity_compile,
-	route_match_ecommunity_free
+	route_match_ecommunity_free,
+	NULL,
+	route_map_rule_memoizable,
 };
 
 /* `match nlri` and `set nlri` are replaced by `address-family ipv4`
@@ -1808,7 +1828,9 @@ static const struct route_map_rule_cmd route_match_origin_cmd = {
 	"origin",
 	route_match_origin,
 	route_match_origin_compile,
-	route_match_origin_free
+	route_match_origin_free,
+	NULL,
+	route_map_rule_memoizable,
 };
 
 /* match probability  { */
@@ -1943,7 +1965,7 @@ route_set_srte_color(void *rule, const struct prefix *prefix, void *object)
 
 	path = object;
 
-	path->attr->srte_color = *srte_color;
+	bgp_attr_set_srte_color(path->attr, *srte_color);
 
 	return RMAP_OKAY;
 }
@@ -2159,6 +2181,8 @@ static const struct route_map_rule_cmd route_set_local_pref_cmd = {
 	route_set_local_pref,
 	route_value_compile,
 	route_value_free,
+	NULL,
+	route_value_memoizable,
 };
 
 /* `set weight WEIGHT' */
@@ -2186,6 +2210,8 @@ static const struct route_map_rule_cmd route_set_weight_cmd = {
 	route_set_weight,
 	route_value_compile,
 	route_value_free,
+	NULL,
+	route_value_memoizable,
 };
 
 /* `set distance DISTANCE */
@@ -2253,7 +2279,7 @@ route_set_table_id(void *rule, const struct prefix *prefix,
 	rv = rule;
 	path = object;
 
-	path->attr->rmap_table_id = rv->value;
+	bgp_attr_set_rmap_table_id(path->attr, rv->value);
 
 	return RMAP_OKAY;
 }
@@ -2320,6 +2346,8 @@ static const struct route_map_rule_cmd route_set_aspath_prepend_cmd = {
 	route_set_aspath_prepend,
 	route_set_aspath_prepend_compile,
 	route_set_aspath_prepend_free,
+	NULL,
+	route_map_rule_memoizable,
 };
 
 static void *route_aspath_exclude_compile(const char *arg)
@@ -2672,6 +2700,8 @@ static const struct route_map_rule_cmd route_set_community_cmd = {
 	route_set_community,
 	route_set_community_compile,
 	route_set_community_free,
+	NULL,
+	route_map_rule_memoizable,
 };
 
 /* `set community COMMUNITY' */
@@ -2784,6 +2814,8 @@ static const struct route_map_rule_cmd route_set_lcommunity_cmd = {
 	route_set_lcommunity,
 	route_set_lcommunity_compile,
 	route_set_lcommunity_free,
+	NULL,
+	route_map_rule_memoizable,
 };
 
 /* `set large-comm-list (<1-99>|<100-500>|WORD) delete' */
@@ -2866,6 +2898,8 @@ static const struct route_map_rule_cmd route_set_lcommunity_delete_cmd = {
 	route_set_lcommunity_delete,
 	route_set_lcommunity_delete_compile,
 	route_set_lcommunity_delete_free,
+	NULL,
+	route_map_rule_memoizable,
 };
 
 
@@ -2950,6 +2984,8 @@ static const struct route_map_rule_cmd route_set_community_delete_cmd = {
 	route_set_community_delete,
 	route_set_community_delete_compile,
 	route_set_community_delete_free,
+	NULL,
+	route_map_rule_memoizable,
 };
 
 /* `set extcomm-list (<1-99>|<100-500>|WORD) delete' */
@@ -3425,6 +3461,8 @@ static const struct route_map_rule_cmd route_set_origin_cmd = {
 	route_set_origin,
 	route_set_origin_compile,
 	route_set_origin_free,
+	NULL,
+	route_map_rule_memoizable,
 };
 
 /* `set atomic-aggregate' */
@@ -3459,6 +3497,8 @@ static const struct route_map_rule_cmd route_set_atomic_aggregate_cmd = {
 	route_set_atomic_aggregate,
 	route_set_atomic_aggregate_compile,
 	route_set_atomic_aggregate_free,
+	NULL,
+	route_map_rule_memoizable,
 };
 
 /* AIGP TLV Metric */
@@ -4810,6 +4850,108 @@ static void bgp_route_map_event(const char *rmap_name)
 	route_map_notify_dependencies(rmap_name, RMAP_EVENT_MATCH_ADDED);
 }
 
+/* Inbound route-map results of one peer and address family.  For a
+ * memoizable map the outcome only depends on the attributes, so paths
+ * whose attributes are equal as far as interning goes share one result.
+ * Direct mapped by attribute hash.
+ */
+#define BGP_RMAP_MEMO_SIZE 256
+
+struct bgp_rmap_memo_entry {
+	uint32_t key;
+	struct attr *in;
+	/* NULL if the map denied */
+	struct attr *out;
+};
+
+struct bgp_rmap_memo {
+	const struct route_map *map;
+	uint64_t version;
+
+	struct bgp_rmap_memo_entry entries[BGP_RMAP_MEMO_SIZE];
+};
+
+static void bgp_rmap_memo_entry_clear(struct bgp_rmap_memo_entry *entry)
+{
+	if (entry->in)
+		bgp_attr_unintern(&entry->in);
+	if (entry->out)
+		bgp_attr_unintern(&entry->out);
+}
+
+static void bgp_rmap_memo_clear(struct bgp_rmap_memo *memo)
+{
+	unsigned int i;
+
+	for (i = 0; i < BGP_RMAP_MEMO_SIZE; i++)
+		bgp_rmap_memo_entry_clear(&memo->entries[i]);
+}
+
+route_map_result_t bgp_route_map_apply_memo(struct peer *peer, afi_t afi,
+					     safi_t safi, struct route_map *map,
+					     const struct prefix *p,
+					     struct bgp_path_info *path)
+{
+	struct bgp_rmap_memo *memo = peer->rmap_memo[afi][safi];
+	struct bgp_rmap_memo_entry *entry;
+	struct attr *attr = path->attr;
+	struct attr *in;
+	route_map_result_t ret;
+	uint32_t key;
+
+	if (!route_map_memoizable(map))
+		return route_map_apply(map, p, path);
+
+	if (!memo) {
+		memo = XCALLOC(MTYPE_BGP_RMAP_MEMO, sizeof(*memo));
+		peer->rmap_memo[afi][safi] = memo;
+	}
+	if (memo->map != map || memo->version != map->version) {
+		bgp_rmap_memo_clear(memo);
+		memo->map = map;
+		memo->version = map->version;
+	}
+
+	key = attrhash_key_make(attr);
+	entry = &memo->entries[key & (BGP_RMAP_MEMO_SIZE - 1)];
+
+	if (entry->in && entry->key == key && attrhash_cmp(entry->in, attr)) {
+		ret = entry->out ? RMAP_PERMITMATCH : RMAP_DENYMATCH;
+		route_map_memo_hit(map, p, ret);
+		if (!entry->out)
+			return RMAP_DENYMATCH;
+
+		bgp_attr_flush(attr);
+		*attr = *entry->out;
+		return RMAP_PERMITMATCH;
+	}
+
+	map->memo_misses++;
+
+	/* The key has to outlive the set clauses, which modify whatever the
+	 * attribute points to unless it is interned.
+	 */
+	in = bgp_attr_intern(attr);
+	ret = route_map_apply(map, p, path);
+
+	bgp_rmap_memo_entry_clear(entry);
+	entry->key = key;
+	entry->in = in;
+	if (ret == RMAP_PERMITMATCH)
+		entry->out = bgp_attr_intern(attr);
+
+	return ret;
+}
+
+void bgp_route_map_memo_free(struct peer *peer, afi_t afi, safi_t safi)
+{
+	if (!peer->rmap_memo[afi][safi])
+		return;
+
+	bgp_rmap_memo_clear(peer->rmap_memo[afi][safi]);
+	XFREE(MTYPE_BGP_RMAP_MEMO, peer->rmap_memo[afi][safi]);
+}
+
 DEFUN_YANG (match_mac_address,
 	    match_mac_address_cmd,
 	    "match mac address ACCESSLIST_MAC_NAME",
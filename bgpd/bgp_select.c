@@ -0,0 +1,269 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/* BGP best path selection shards.
+ * Runs the per-destination half of best path selection on a pool of
+ * pthreads, see bgp_best_selection_compute().
+ */
+
+#include <zebra.h>
+#include <pthread.h>
+
+#include "frr_pthread.h"
+#include "frrevent.h"
+#include "memory.h"
+#include "monotime.h"
+#include "prefix.h"
+#include "vty.h"
+#include "lib/json.h"
+
+#include "bgpd/bgpd.h"
+#include "bgpd/bgp_table.h"
+#include "bgpd/bgp_route.h"
+#include "bgpd/bgp_select.h"
+
+DEFINE_MTYPE_STATIC(BGPD, BGP_SELECT_SHARD, "BGP best-path selection shard");
+
+struct bgp_select_shard {
+	unsigned int id;
+	struct frr_pthread *pth;
+
+	/* Current batch, owned by the shard pthread while dispatched */
+	struct bgp *bgp;
+	struct bgp_best_selection_job **jobs;
+	size_t njobs;
+	size_t jobs_size;
+
+	/* Statistics, only written by the shard pthread */
+	atomic_uint_fast64_t batches;
+	atomic_uint_fast64_t dests;
+	atomic_uint_fast64_t busy_usec;
+};
+
+static struct bgp_select_shard *shards;
+static unsigned int nshards;
+
+/* Number of shards still working on the current batch */
+static pthread_mutex_t batch_mtx = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t batch_cond = PTHREAD_COND_INITIALIZER;
+static unsigned int batch_pending;
+
+/* Main pthread only */
+static struct {
+	uint64_t batches;
+	uint64_t dests;
+	uint64_t stale;
+} select_stats;
+
+bool bgp_select_enabled(void)
+{
+	return nshards > 0;
+}
+
+static void bgp_select_shard_work(struct event *event)
+{
+	struct bgp_select_shard *shard = EVENT_ARG(event);
+	struct bgp_best_selection_job *job;
+	struct timeval start;
+	size_t i;
+
+	monotime(&start);
+
+	for (i = 0; i < shard->njobs; i++) {
+		job = shard->jobs[i];
+		bgp_best_selection_compute(shard->bgp, job,
+					   &shard->bgp->maxpaths[job->afi]
+								[job->safi]);
+	}
+
+	atomic_fetch_add_explicit(&shard->busy_usec,
+				  monotime_since(&start, NULL),
+				  memory_order_relaxed);
+	atomic_fetch_add_explicit(&shard->dests, shard->njobs,
+				  memory_order_relaxed);
+	atomic_fetch_add_explicit(&shard->batches, 1, memory_order_relaxed);
+
+	frr_with_mutex (&batch_mtx) {
+		if (--batch_pending == 0)
+			pthread_cond_signal(&batch_cond);
+	}
+}
+
+static void bgp_select_shard_add(struct bgp_select_shard *shard,
+				 struct bgp_best_selection_job *job)
+{
+	if (shard->njobs == shard->jobs_size) {
+		shard->jobs_size = shard->jobs_size ? shard->jobs_size * 2
+						    : BGP_SELECT_JOBS_INIT;
+		shard->jobs = XREALLOC(MTYPE_BGP_SELECT_SHARD, shard->jobs,
+				       shard->jobs_size * sizeof(*shard->jobs));
+	}
+	shard->jobs[shard->njobs++] = job;
+}
+
+void bgp_select_run(struct bgp *bgp, struct bgp_best_selection_job *jobs,
+		    size_t njobs)
+{
+	struct bgp_select_shard *shard;
+	unsigned int i, busy = 0;
+	size_t j;
+
+	if (!nshards || !njobs)
+		return;
+
+	for (i = 0; i < nshards; i++) {
+		shards[i].bgp = bgp;
+		shards[i].njobs = 0;
+	}
+
+	for (j = 0; j < njobs; j++) {
+		const struct prefix *p = bgp_dest_get_prefix(jobs[j].dest);
+
+		shard = &shards[prefix_hash_key(p) % nshards];
+		bgp_select_shard_add(shard, &jobs[j]);
+	}
+
+	for (i = 0; i < nshards; i++)
+		if (shards[i].njobs)
+			busy++;
+
+	frr_with_mutex (&batch_mtx) {
+		batch_pending = busy;
+	}
+
+	for (i = 0; i < nshards; i++) {
+		shard = &shards[i];
+		if (shard->njobs)
+			event_add_event(shard->pth->master,
+					bgp_select_shard_work, shard, 0, NULL);
+	}
+
+	frr_with_mutex (&batch_mtx) {
+		while (batch_pending)
+			pthread_cond_wait(&batch_cond, &batch_mtx);
+	}
+
+	select_stats.batches++;
+	select_stats.dests += njobs;
+}
+
+void bgp_select_stale_inc(void)
+{
+	select_stats.stale++;
+}
+
+static void bgp_select_stop(void)
+{
+	unsigned int i;
+
+	for (i = 0; i < nshards; i++) {
+		frr_pthread_stop(shards[i].pth, NULL);
+		frr_pthread_destroy(shards[i].pth);
+		XFREE(MTYPE_BGP_SELECT_SHARD, shards[i].jobs);
+	}
+
+	XFREE(MTYPE_BGP_SELECT_SHARD, shards);
+	nshards = 0;
+}
+
+void bgp_select_set_threads(unsigned int threads)
+{
+	struct frr_pthread_attr attr = {
+		.start = frr_pthread_attr_default.start,
+		.stop = frr_pthread_attr_default.stop,
+	};
+	char name[32], os_name[16];
+	unsigned int i;
+
+	if (threads > BGP_SELECT_THREADS_MAX)
+		threads = BGP_SELECT_THREADS_MAX;
+
+	if (threads == nshards)
+		return;
+
+	bgp_select_stop();
+
+	if (!threads)
+		return;
+
+	shards = XCALLOC(MTYPE_BGP_SELECT_SHARD, threads * sizeof(*shards));
+
+	for (i = 0; i < threads; i++) {
+		snprintf(name, sizeof(name), "BGP select thread %u", i);
+		snprintf(os_name, sizeof(os_name), "bgpd_select%u", i);
+
+		shards[i].id = i;
+		shards[i].pth = frr_pthread_new(&attr, name, os_name);
+		frr_pthread_run(shards[i].pth, NULL);
+	}
+
+	for (i = 0; i < threads; i++)
+		frr_pthread_wait_running(shards[i].pth);
+
+	nshards = threads;
+}
+
+void bgp_select_show(struct vty *vty, bool use_json)
+{
+	struct bgp_select_shard *shard;
+	json_object *json = NULL, *json_shards = NULL, *json_shard;
+	uint64_t batches, dests, busy_usec, rate;
+	unsigned int i;
+
+	if (use_json) {
+		json = json_object_new_object();
+		json_shards = json_object_new_array();
+		json_object_int_add(json, "threads", nshards);
+		json_object_int_add(json, "batches", select_stats.batches);
+		json_object_int_add(json, "destinations", select_stats.dests);
+		json_object_int_add(json, "staleRecomputations",
+				    select_stats.stale);
+	} else {
+		vty_out(vty, "Best path selection threads: %u\n", nshards);
+		vty_out(vty,
+			"Batches: %" PRIu64 ", destinations: %" PRIu64
+			", stale recomputations: %" PRIu64 "\n",
+			select_stats.batches, select_stats.dests,
+			select_stats.stale);
+		if (nshards)
+			vty_out(vty, "\n%-6s %-12s %-14s %-12s %s\n", "Shard",
+				"Batches", "Destinations", "Busy (ms)",
+				"Dests/sec");
+	}
+
+	for (i = 0; i < nshards; i++) {
+		shard = &shards[i];
+		batches = atomic_load_explicit(&shard->batches,
+					       memory_order_relaxed);
+		dests = atomic_load_explicit(&shard->dests,
+					     memory_order_relaxed);
+		busy_usec = atomic_load_explicit(&shard->busy_usec,
+						 memory_order_relaxed);
+		rate = busy_usec ? dests * 1000000 / busy_usec : 0;
+
+		if (use_json) {
+			json_shard = json_object_new_object();
+			json_object_int_add(json_shard, "shard", shard->id);
+			json_object_int_add(json_shard, "batches", batches);
+			json_object_int_add(json_shard, "destinations", dests);
+			json_object_int_add(json_shard, "busyMsecs",
+					    busy_usec / 1000);
+			json_object_int_add(json_shard, "destinationsPerSec",
+					    rate);
+			json_object_array_add(json_shards, json_shard);
+		} else
+			vty_out(vty,
+				"%-6u %-12" PRIu64 " %-14" PRIu64
+				" %-12" PRIu64 " %" PRIu64 "\n",
+				shard->id, batches, dests, busy_usec / 1000,
+				rate);
+	}
+
+	if (use_json) {
+		json_object_object_add(json, "shards", json_shards);
+		vty_json(vty, json);
+	}
+}
+
+void bgp_select_finish(void)
+{
+	bgp_select_stop();
+}
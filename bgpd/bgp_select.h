@@ -0,0 +1,58 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/* BGP best path selection shards.
+ * Runs the per-destination half of best path selection on a pool of
+ * pthreads, see bgp_best_selection_compute().
+ */
+
+#ifndef _FRR_BGP_SELECT_H
+#define _FRR_BGP_SELECT_H
+
+#include "bgpd/bgpd.h"
+#include "bgpd/bgp_route.h"
+
+/* Maximum number of selection shards */
+#define BGP_SELECT_THREADS_MAX 64
+
+/* Process queue items smaller than this are not worth dispatching */
+#define BGP_SELECT_MIN_BATCH 64
+
+/* Initial size of a shard's job array, grown by doubling */
+#define BGP_SELECT_JOBS_INIT 64
+
+/**
+ * Are selection shards configured?
+ */
+extern bool bgp_select_enabled(void);
+
+/**
+ * Resize the shard pool, 0 goes back to fully serial selection.
+ *
+ * Must be called from the main pthread, never while bgp_select_run() is
+ * in progress.
+ */
+extern void bgp_select_set_threads(unsigned int threads);
+
+/**
+ * Run bgp_best_selection_compute() for all jobs on the shards.
+ *
+ * Destinations are partitioned across the shards by prefix hash.  Blocks
+ * the main pthread until all jobs have been computed; the caller is then
+ * responsible for bgp_best_selection_apply() or
+ * bgp_best_selection_discard() on each of them.
+ */
+extern void bgp_select_run(struct bgp *bgp, struct bgp_best_selection_job *jobs,
+			   size_t njobs);
+
+/**
+ * Account for a precomputed job that had to be redone serially.
+ */
+extern void bgp_select_stale_inc(void);
+
+extern void bgp_select_show(struct vty *vty, bool use_json);
+
+/**
+ * Stop and free all shards, called on shutdown.
+ */
+extern void bgp_select_finish(void);
+
+#endif /* _FRR_BGP_SELECT_H */
@@ -7,6 +7,7 @@
 
 #include "prefix.h"
 #include "memory.h"
+#include "mempool.h"
 #include "sockunion.h"
 #include "queue.h"
 #include "filter.h"
@@ -18,6 +19,8 @@
 #include "bgp_addpath.h"
 #include "bgp_trace.h"
 
+DEFINE_MEMPOOL(BGP_NODE, MTYPE_BGP_NODE, sizeof(struct bgp_dest));
+
 void bgp_table_lock(struct bgp_table *rt)
 {
 	rt->lock++;
@@ -88,7 +91,7 @@ inline struct bgp_dest *bgp_dest_unlock_node(struct bgp_dest *dest)
 						   &dest->tx_addpath, rt->afi,
 						   rt->safi);
 		}
-		XFREE(MTYPE_BGP_NODE, dest);
+		MPFREE(MPOOL_BGP_NODE, dest);
 		dest = NULL;
 		rn->info = NULL;
 	}
@@ -113,7 +116,7 @@ static void bgp_node_destroy(route_table_delegate_t *delegate,
 										&dest->tx_addpath,
 										rt->afi, rt->safi);
 		}
-		XFREE(MTYPE_BGP_NODE, dest);
+		MPFREE(MPOOL_BGP_NODE, dest);
 		node->info = NULL;
 	}
 
@@ -10,6 +10,7 @@
 #include "table.h"
 #include "queue.h"
 #include "linklist.h"
+#include "mempool.h"
 #include "bgpd.h"
 #include "bgp_advertise.h"
 
@@ -30,6 +31,9 @@ struct bgp_table {
 	/* list of peers on which soft_reconfig_table has to run */
 	struct list *soft_reconfig_peers;
 
+	/* where the next soft_reconfig_table run resumes, locked */
+	struct bgp_dest *soft_reconfig_next;
+
 	struct route_table *route_table;
 	uint64_t version;
 };
@@ -68,7 +72,7 @@ struct bgp_dest {
 
 	void *info;
 
-	struct bgp_adj_out_rb adj_out;
+	struct bgp_adj_out_set adj_out;
 
 	struct bgp_adj_in *adj_in;
 
@@ -106,6 +110,8 @@ struct bgp_dest {
 
 DECLARE_LIST(zebra_announce, struct bgp_dest, zai);
 
+DECLARE_MEMPOOL(BGP_NODE);
+
 extern void bgp_delete_listnode(struct bgp_dest *dest);
 /*
  * bgp_table_iter_t
@@ -245,10 +251,8 @@ static inline struct bgp_dest *bgp_node_get(struct bgp_table *const table,
 	struct route_node *rn = route_node_get(table->route_table, p);
 
 	if (!rn->info) {
-		struct bgp_dest *dest = XCALLOC(MTYPE_BGP_NODE,
-						sizeof(struct bgp_dest));
+		struct bgp_dest *dest = mempool_alloc(MPOOL_BGP_NODE);
 
-		RB_INIT(bgp_adj_out_rb, &dest->adj_out);
 		rn->info = dest;
 		dest->rn = rn;
 	}
@@ -15,6 +15,7 @@
 
 #include "command.h"
 #include "memory.h"
+#include "mempool.h"
 #include "prefix.h"
 #include "hash.h"
 #include "frrevent.h"
@@ -36,44 +37,22 @@
 #include "bgpd/bgp_advertise.h"
 #include "bgpd/bgp_addpath.h"
 
+DEFINE_MEMPOOL_STATIC(BGP_ADJ_OUT, MTYPE_BGP_ADJ_OUT,
+		      sizeof(struct bgp_adj_out));
 
 /********************
  * PRIVATE FUNCTIONS
  ********************/
-static int bgp_adj_out_compare(const struct bgp_adj_out *o1,
-			       const struct bgp_adj_out *o2)
-{
-	if (o1->subgroup < o2->subgroup)
-		return -1;
-
-	if (o1->subgroup > o2->subgroup)
-		return 1;
-
-	if (o1->addpath_tx_id < o2->addpath_tx_id)
-		return -1;
-
-	if (o1->addpath_tx_id > o2->addpath_tx_id)
-		return 1;
-
-	return 0;
-}
-RB_GENERATE(bgp_adj_out_rb, bgp_adj_out, adj_entry, bgp_adj_out_compare);
-
 static inline struct bgp_adj_out *adj_lookup(struct bgp_dest *dest,
 					     struct update_subgroup *subgrp,
 					     uint32_t addpath_tx_id)
 {
-	struct bgp_adj_out lookup;
-
 	if (!dest || !subgrp)
 		return NULL;
 
 	/* update-groups that do not support addpath will pass 0 for
 	 * addpath_tx_id. */
-	lookup.subgroup = subgrp;
-	lookup.addpath_tx_id = addpath_tx_id;
-
-	return RB_FIND(bgp_adj_out_rb, &dest->adj_out, &lookup);
+	return bgp_adj_out_set_find(&dest->adj_out, subgrp, addpath_tx_id);
 }
 
 static void adj_free(struct bgp_adj_out *adj)
@@ -81,10 +60,10 @@ static void adj_free(struct bgp_adj_out *adj)
 	TAILQ_REMOVE(&(adj->subgroup->adjq), adj, subgrp_adj_train);
 	SUBGRP_DECR_STAT(adj->subgroup, adj_count);
 
-	RB_REMOVE(bgp_adj_out_rb, &adj->dest->adj_out, adj);
+	bgp_adj_out_set_del(&adj->dest->adj_out, adj);
 	bgp_dest_unlock_node(adj->dest);
 
-	XFREE(MTYPE_BGP_ADJ_OUT, adj);
+	MPFREE(MPOOL_BGP_ADJ_OUT, adj);
 }
 
 static void
@@ -175,8 +154,8 @@ subgrp_announce_addpath_best_selected(struct bgp_dest *dest,
 static void subgrp_withdraw_stale_addpath(struct updwalk_context *ctx,
 					  struct update_subgroup *subgrp)
 {
-	struct bgp_adj_out *adj, *adj_next;
-	uint32_t id;
+	struct bgp_adj_out *adj;
+	uint32_t id, i;
 	struct bgp_path_info *pi;
 	afi_t afi = SUBGRP_AFI(subgrp);
 	safi_t safi = SUBGRP_SAFI(subgrp);
@@ -184,7 +163,7 @@ static void subgrp_withdraw_stale_addpath(struct updwalk_context *ctx,
 
 	/* Look through all of the paths we have advertised for this rn and send
 	 * a withdraw for the ones that are no longer present */
-	RB_FOREACH_SAFE (adj, bgp_adj_out_rb, &ctx->dest->adj_out, adj_next) {
+	BGP_ADJ_OUT_FOREACH_SAFE (&ctx->dest->adj_out, adj, i) {
 		if (adj->subgroup != subgrp)
 			continue;
 
@@ -213,8 +192,9 @@ static int group_announce_route_walkcb(struct update_group *updgrp, void *arg)
 	afi_t afi;
 	safi_t safi;
 	struct peer *peer;
-	struct bgp_adj_out *adj, *adj_next;
+	struct bgp_adj_out *adj;
 	bool addpath_capable;
+	uint32_t i;
 
 	afi = UPDGRP_AFI(updgrp);
 	safi = UPDGRP_SAFI(updgrp);
@@ -265,9 +245,8 @@ static int group_announce_route_walkcb(struct update_group *updgrp, void *arg)
 					/* Find the addpath_tx_id of the path we
 					 * had advertised and
 					 * send a withdraw */
-					RB_FOREACH_SAFE (adj, bgp_adj_out_rb,
-							 &ctx->dest->adj_out,
-							 adj_next) {
+					BGP_ADJ_OUT_FOREACH_SAFE (
+						&ctx->dest->adj_out, adj, i) {
 						if (adj->subgroup == subgrp) {
 							subgroup_process_announce_selected(
 								subgrp, NULL,
@@ -297,6 +276,7 @@ static void subgrp_show_adjq_vty(struct update_subgroup *subgrp,
 	int header1 = 1;
 	struct bgp *bgp;
 	int header2 = 1;
+	uint32_t i;
 
 	bgp = SUBGRP_INST(subgrp);
 	if (!bgp)
@@ -309,7 +289,7 @@ static void subgrp_show_adjq_vty(struct update_subgroup *subgrp,
 	for (dest = bgp_table_top(table); dest; dest = bgp_route_next(dest)) {
 		const struct prefix *dest_p = bgp_dest_get_prefix(dest);
 
-		RB_FOREACH (adj, bgp_adj_out_rb, &dest->adj_out) {
+		BGP_ADJ_OUT_FOREACH (&dest->adj_out, adj, i) {
 			if (adj->subgroup != subgrp)
 				continue;
 
@@ -469,11 +449,11 @@ struct bgp_adj_out *bgp_adj_out_alloc(struct update_subgroup *subgrp,
 {
 	struct bgp_adj_out *adj;
 
-	adj = XCALLOC(MTYPE_BGP_ADJ_OUT, sizeof(struct bgp_adj_out));
+	adj = mempool_alloc(MPOOL_BGP_ADJ_OUT);
 	adj->subgroup = subgrp;
 	adj->addpath_tx_id = addpath_tx_id;
 
-	RB_INSERT(bgp_adj_out_rb, &dest->adj_out, adj);
+	bgp_adj_out_set_add(&dest->adj_out, adj);
 	bgp_dest_lock_node(dest);
 	adj->dest = dest;
 
@@ -61,7 +61,10 @@ struct bpacket *bpacket_alloc(void)
 
 void bpacket_free(struct bpacket *pkt)
 {
-	if (pkt->buffer)
+	/* output queues may still be holding on to a shared buffer */
+	if (pkt->shared)
+		bgp_opkt_shared_unref(&pkt->shared);
+	else if (pkt->buffer)
 		stream_free(pkt->buffer);
 	pkt->buffer = NULL;
 	XFREE(MTYPE_BGP_PACKET, pkt);
@@ -329,25 +332,38 @@ void bpacket_queue_show_vty(struct bpacket_queue *q, struct vty *vty)
 	return;
 }
 
-struct stream *bpacket_reformat_for_peer(struct bpacket *pkt,
-					 struct peer_af *paf)
+/*
+ * Queue the packet for one member of the subgroup.
+ *
+ * The packet itself is shared by all members; if the nexthop has to be
+ * rewritten for this peer, only the nexthop field is copied into the
+ * returned bgp_opkt and patched there.
+ */
+struct bgp_opkt *bpacket_reformat_for_peer(struct bpacket *pkt,
+					   struct peer_af *paf)
 {
-	struct stream *s = NULL;
+	struct stream *s;
+	struct bgp_opkt *opkt;
 	bpacket_attr_vec *vec;
 	struct peer *peer;
 	struct bgp_filter *filter;
 
-	s = stream_dup(pkt->buffer);
+	if (!pkt->shared)
+		pkt->shared = bgp_opkt_shared_new(pkt->buffer);
+
+	s = pkt->buffer;
+	opkt = bgp_opkt_new_shared(pkt->shared);
 	peer = PAF_PEER(paf);
 
 	vec = &pkt->arr.entries[BGP_ATTR_VEC_NH];
 
 	if (!CHECK_FLAG(vec->flags, BPKT_ATTRVEC_FLAGS_UPDATED))
-		return s;
+		return opkt;
 
 	uint8_t nhlen;
 	afi_t nhafi;
 	int route_map_sets_nh;
+	size_t nh_field = vec->offset + 1;
 
 	nhlen = stream_getc_from(s, vec->offset);
 	filter = &peer->filter[paf->afi][paf->safi];
@@ -360,7 +376,7 @@ struct stream *bpacket_reformat_for_peer(struct bpacket *pkt,
 	if (nhafi == AFI_IP) {
 		struct in_addr v4nh, *mod_v4nh;
 		int nh_modified = 0;
-		size_t offset_nh = vec->offset + 1;
+		size_t offset_nh = nh_field;
 
 		route_map_sets_nh =
 			(CHECK_FLAG(vec->flags,
@@ -382,7 +398,7 @@ struct stream *bpacket_reformat_for_peer(struct bpacket *pkt,
 				EC_BGP_INVALID_NEXTHOP_LENGTH,
 				"%s: %s: invalid MP nexthop length (AFI IP): %u",
 				__func__, peer->host, nhlen);
-			stream_free(s);
+			bgp_opkt_free(opkt);
 			return NULL;
 		}
 
@@ -432,7 +448,8 @@ struct stream *bpacket_reformat_for_peer(struct bpacket *pkt,
 		}
 
 		if (nh_modified) /* allow for VPN RD */
-			stream_put_in_addr_at(s, offset_nh, mod_v4nh);
+			bgp_opkt_patch(opkt, nh_field, nhlen, offset_nh,
+				       mod_v4nh, IPV4_MAX_BYTELEN);
 
 		if (bgp_debug_update(peer, NULL, NULL, 0))
 			zlog_debug("u%" PRIu64 ":s%" PRIu64
@@ -445,8 +462,8 @@ struct stream *bpacket_reformat_for_peer(struct bpacket *pkt,
 		struct in6_addr v6nhglobal, *mod_v6nhg;
 		struct in6_addr v6nhlocal, *mod_v6nhl;
 		int gnh_modified, lnh_modified;
-		size_t offset_nhglobal = vec->offset + 1;
-		size_t offset_nhlocal = vec->offset + 1;
+		size_t offset_nhglobal = nh_field;
+		size_t offset_nhlocal = nh_field;
 
 		gnh_modified = lnh_modified = 0;
 		mod_v6nhg = &v6nhglobal;
@@ -486,7 +503,7 @@ struct stream *bpacket_reformat_for_peer(struct bpacket *pkt,
 				EC_BGP_INVALID_NEXTHOP_LENGTH,
 				"%s: %s: invalid MP nexthop length (AFI IP6): %u",
 				__func__, peer->host, nhlen);
-			stream_free(s);
+			bgp_opkt_free(opkt);
 			return NULL;
 		}
 
@@ -548,9 +565,11 @@ struct stream *bpacket_reformat_for_peer(struct bpacket *pkt,
 		}
 
 		if (gnh_modified)
-			stream_put_in6_addr_at(s, offset_nhglobal, mod_v6nhg);
+			bgp_opkt_patch(opkt, nh_field, nhlen, offset_nhglobal,
+				       mod_v6nhg, IPV6_MAX_BYTELEN);
 		if (lnh_modified)
-			stream_put_in6_addr_at(s, offset_nhlocal, mod_v6nhl);
+			bgp_opkt_patch(opkt, nh_field, nhlen, offset_nhlocal,
+				       mod_v6nhl, IPV6_MAX_BYTELEN);
 
 		if (bgp_debug_update(peer, NULL, NULL, 0)) {
 			if (nhlen == BGP_ATTR_NHLEN_IPV6_GLOBAL_AND_LL
@@ -579,7 +598,7 @@ struct stream *bpacket_reformat_for_peer(struct bpacket *pkt,
 		struct in_addr v4nh, *mod_v4nh;
 		int nh_modified = 0;
 
-		stream_get_from(&v4nh, s, vec->offset + 1, 4);
+		stream_get_from(&v4nh, s, nh_field, 4);
 		mod_v4nh = &v4nh;
 
 		/* No route-map changes allowed for EVPN nexthops. */
@@ -589,7 +608,8 @@ struct stream *bpacket_reformat_for_peer(struct bpacket *pkt,
 		}
 
 		if (nh_modified)
-			stream_put_in_addr_at(s, vec->offset + 1, mod_v4nh);
+			bgp_opkt_patch(opkt, nh_field, IPV4_MAX_BYTELEN,
+				       nh_field, mod_v4nh, IPV4_MAX_BYTELEN);
 
 		if (bgp_debug_update(peer, NULL, NULL, 0))
 			zlog_debug("u%" PRIu64 ":s%" PRIu64
@@ -598,7 +618,7 @@ struct stream *bpacket_reformat_for_peer(struct bpacket *pkt,
 				   PAF_SUBGRP(paf)->id, peer->host, mod_v4nh);
 	}
 
-	return s;
+	return opkt;
 }
 
 /*
@@ -860,7 +880,8 @@ struct bpacket *subgroup_update_packet(struct update_subgroup *subgrp)
 			bgp_debug_rdpfxpath2str(afi, safi, prd, dest_p,
 						label_pnt, num_labels,
 						addpath_capable, addpath_tx_id,
-						&adv->baa->attr->evpn_overlay,
+						bgp_attr_get_evpn_overlay(
+							adv->baa->attr),
 						pfx_buf, sizeof(pfx_buf));
 			zlog_debug("u%" PRIu64 ":s%" PRIu64 " send UPDATE %s",
 				   subgrp->update_group->id, subgrp->id,
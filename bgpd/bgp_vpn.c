@@ -72,8 +72,9 @@ int show_adj_route_vpn(struct vty *vty, struct peer *peer,
 			struct bgp_adj_out *adj = NULL;
 			struct attr *attr = NULL;
 			struct peer_af *paf = NULL;
+			uint32_t i;
 
-			RB_FOREACH (adj, bgp_adj_out_rb, &rm->adj_out)
+			BGP_ADJ_OUT_FOREACH (&rm->adj_out, adj, i)
 				SUBGRP_FOREACH_PEER (adj->subgroup, paf) {
 					if (paf->peer != peer || !adj->attr)
 						continue;
@@ -65,6 +65,7 @@
 #include "bgpd/bgp_mac.h"
 #include "bgpd/bgp_flowspec.h"
 #include "bgpd/bgp_conditional_adv.h"
+#include "bgpd/bgp_select.h"
 #ifdef ENABLE_BGP_VNC
 #include "bgpd/rfapi/bgp_rfapi_cfg.h"
 #endif
@@ -11493,6 +11494,13 @@ DEFUN (show_bgp_memory,
 	if ((count = attr_unknown_count()))
 		vty_out(vty, "%ld unknown attributes\n", count);
 
+	if ((count = attr_ext_count()))
+		vty_out(vty,
+			"%ld BGP attribute extensions, using %s of memory\n",
+			count,
+			mtype_memstr(memstrbuf, sizeof(memstrbuf),
+				     count * sizeof(struct attr_ext)));
+
 	/* AS_PATH attributes */
 	count = aspath_count();
 	vty_out(vty, "%ld BGP AS-PATH entries, using %s of memory\n", count,
@@ -13296,6 +13304,16 @@ static void bgp_show_peer_afi(struct vty *vty, struct peer *p, afi_t afi,
 		if (CHECK_FLAG(p->af_flags[afi][safi], PEER_FLAG_SOFT_RECONFIG))
 			json_object_boolean_true_add(json_addr,
 						     "inboundSoftConfigPermit");
+		if (CHECK_FLAG(p->af_sflags[afi][safi],
+			       PEER_STATUS_SOFT_RECONFIG_IN)) {
+			json_object_boolean_true_add(json_addr,
+						     "inboundSoftConfigInProgress");
+			json_object_int_add(json_addr,
+					    "inboundSoftConfigQueued",
+					    p->soft_reconfig_queued[afi][safi]);
+			json_object_int_add(json_addr, "inboundSoftConfigDone",
+					    p->soft_reconfig_done[afi][safi]);
+		}
 
 		if (CHECK_FLAG(p->af_flags[afi][safi],
 			       PEER_FLAG_REMOVE_PRIVATE_AS_ALL_REPLACE))
@@ -13601,6 +13619,12 @@ static void bgp_show_peer_afi(struct vty *vty, struct peer *p, afi_t afi,
 		if (CHECK_FLAG(p->af_flags[afi][safi], PEER_FLAG_SOFT_RECONFIG))
 			vty_out(vty,
 				"  Inbound soft reconfiguration allowed\n");
+		if (CHECK_FLAG(p->af_sflags[afi][safi],
+			       PEER_STATUS_SOFT_RECONFIG_IN))
+			vty_out(vty,
+				"  Inbound soft reconfiguration in progress, %u of %u routes done\n",
+				p->soft_reconfig_done[afi][safi],
+				p->soft_reconfig_queued[afi][safi]);
 
 		if (CHECK_FLAG(p->af_flags[afi][safi],
 			       PEER_FLAG_REMOVE_PRIVATE_AS_ALL_REPLACE))
@@ -19202,6 +19226,15 @@ int bgp_config_write(struct vty *vty)
 	if (bm->outq_limit != BM_DEFAULT_Q_LIMIT)
 		vty_out(vty, "bgp output-queue-limit %u\n", bm->outq_limit);
 
+	if (bm->select_threads)
+		vty_out(vty, "bgp bestpath-threads %u\n", bm->select_threads);
+
+	if (bm->io_threads != BM_DEFAULT_IO_THREADS)
+		vty_out(vty, "bgp io-threads %u\n", bm->io_threads);
+
+	if (CHECK_FLAG(bm->flags, BM_FLAG_UPDATE_PREPARSE))
+		vty_out(vty, "bgp update-preparse\n");
+
 	/* BGP configuration. */
 	for (ALL_LIST_ELEMENTS(bm->bgp, mnode, mnnode, bgp)) {
 
@@ -20035,6 +20068,101 @@ DEFPY (no_bgp_inq_limit,
 	return CMD_SUCCESS;
 }
 
+DEFPY (bgp_bestpath_threads,
+       bgp_bestpath_threads_cmd,
+       "bgp bestpath-threads (1-64)$threads",
+       BGP_STR
+       "Run best path selection on a pool of pthreads\n"
+       "Number of pthreads\n")
+{
+	bm->select_threads = threads;
+	bgp_select_set_threads(threads);
+
+	return CMD_SUCCESS;
+}
+
+DEFPY (no_bgp_bestpath_threads,
+       no_bgp_bestpath_threads_cmd,
+       "no bgp bestpath-threads [(1-64)]",
+       NO_STR
+       BGP_STR
+       "Run best path selection on a pool of pthreads\n"
+       "Number of pthreads\n")
+{
+	bm->select_threads = 0;
+	bgp_select_set_threads(0);
+
+	return CMD_SUCCESS;
+}
+
+DEFPY (bgp_io_threads,
+       bgp_io_threads_cmd,
+       "bgp io-threads (1-64)$threads",
+       BGP_STR
+       "Number of pthreads doing peer socket I/O\n"
+       "Number of pthreads\n")
+{
+	bm->io_threads = threads;
+	bgp_io_set_threads(threads);
+
+	return CMD_SUCCESS;
+}
+
+DEFPY (no_bgp_io_threads,
+       no_bgp_io_threads_cmd,
+       "no bgp io-threads [(1-64)]",
+       NO_STR
+       BGP_STR
+       "Number of pthreads doing peer socket I/O\n"
+       "Number of pthreads\n")
+{
+	bm->io_threads = BM_DEFAULT_IO_THREADS;
+	bgp_io_set_threads(BM_DEFAULT_IO_THREADS);
+
+	return CMD_SUCCESS;
+}
+
+DEFPY (show_bgp_io,
+       show_bgp_io_cmd,
+       "show bgp io [json]$uj",
+       SHOW_STR
+       BGP_STR
+       "Peer socket I/O pthreads\n"
+       JSON_STR)
+{
+	bgp_io_show(vty, !!uj);
+
+	return CMD_SUCCESS;
+}
+
+DEFPY (bgp_update_preparse,
+       bgp_update_preparse_cmd,
+       "[no] bgp update-preparse",
+       NO_STR
+       BGP_STR
+       "Decode UPDATE NLRI on the I/O pthread\n")
+{
+	if (no)
+		UNSET_FLAG(bm->flags, BM_FLAG_UPDATE_PREPARSE);
+	else
+		SET_FLAG(bm->flags, BM_FLAG_UPDATE_PREPARSE);
+
+	return CMD_SUCCESS;
+}
+
+DEFPY (show_bgp_bestpath_threads,
+       show_bgp_bestpath_threads_cmd,
+       "show bgp bestpath-threads [json]$uj",
+       SHOW_STR
+       BGP_STR
+       "Best path selection pthreads\n"
+       JSON_STR)
+{
+	bgp_select_show(vty, !!uj);
+
+	return CMD_SUCCESS;
+}
+
 DEFPY (bgp_outq_limit,
        bgp_outq_limit_cmd,
        "bgp output-queue-limit (1-4294967295)$limit",
@@ -20115,6 +20243,13 @@ void bgp_vty_init(void)
 	/* "global bgp inq-limit command */
 	install_element(CONFIG_NODE, &bgp_inq_limit_cmd);
 	install_element(CONFIG_NODE, &no_bgp_inq_limit_cmd);
+	install_element(CONFIG_NODE, &bgp_bestpath_threads_cmd);
+	install_element(CONFIG_NODE, &no_bgp_bestpath_threads_cmd);
+	install_element(CONFIG_NODE, &bgp_io_threads_cmd);
+	install_element(CONFIG_NODE, &no_bgp_io_threads_cmd);
+	install_element(CONFIG_NODE, &bgp_update_preparse_cmd);
+	install_element(VIEW_NODE, &show_bgp_bestpath_threads_cmd);
+	install_element(VIEW_NODE, &show_bgp_io_cmd);
 	install_element(CONFIG_NODE, &bgp_outq_limit_cmd);
 	install_element(CONFIG_NODE, &no_bgp_outq_limit_cmd);
 
@@ -1144,7 +1144,8 @@ static bool update_ipv4nh_for_route_install(int nh_othervrf, struct bgp *nh_bgp,
 		 * treat the nexthop as NEXTHOP_TYPE_IPV4
 		 * Else, mark the nexthop as onlink.
 		 */
-		if (attr->evpn_overlay.type == OVERLAY_INDEX_GATEWAY_IP)
+		if (bgp_attr_get_evpn_overlay(attr)->type ==
+		    OVERLAY_INDEX_GATEWAY_IP)
 			api_nh->type = NEXTHOP_TYPE_IPV4;
 		else {
 			api_nh->type = NEXTHOP_TYPE_IPV4_IFINDEX;
@@ -1183,7 +1184,8 @@ static bool update_ipv6nh_for_route_install(int nh_othervrf, struct bgp *nh_bgp,
 		 * treat the nexthop as NEXTHOP_TYPE_IPV4
 		 * Else, mark the nexthop as onlink.
 		 */
-		if (attr->evpn_overlay.type == OVERLAY_INDEX_GATEWAY_IP)
+		if (bgp_attr_get_evpn_overlay(attr)->type ==
+		    OVERLAY_INDEX_GATEWAY_IP)
 			api_nh->type = NEXTHOP_TYPE_IPV6;
 		else {
 			api_nh->type = NEXTHOP_TYPE_IPV6_IFINDEX;
@@ -1246,7 +1248,7 @@ static bool bgp_zebra_use_nhop_weighted(struct bgp *bgp, struct attr *attr,
 	/* zero link-bandwidth and link-bandwidth not present are treated
 	 * as the same situation.
 	 */
-	if (!attr->link_bw) {
+	if (!bgp_attr_get_link_bw(attr)) {
 		/* the only situations should be if we're either told
 		 * to skip or use default weight.
 		 */
@@ -1254,7 +1256,7 @@ static bool bgp_zebra_use_nhop_weighted(struct bgp *bgp, struct attr *attr,
 			return false;
 		*nh_weight = BGP_ZEBRA_DEFAULT_NHOP_WEIGHT;
 	} else
-		*nh_weight = attr->link_bw;
+		*nh_weight = bgp_attr_get_link_bw(attr);
 
 	return true;
 }
@@ -1269,7 +1271,7 @@ static void bgp_zebra_announce_parse_nexthop(
 	int nh_family;
 	struct bgp_path_info *mpinfo;
 	struct bgp *bgp_orig;
-	struct attr local_attr;
+	struct attr local_attr = {};
 	struct bgp_path_info local_info;
 	struct bgp_path_info *mpinfo_cp = &local_info;
 	mpls_label_t *labels;
@@ -1356,6 +1358,7 @@ static void bgp_zebra_announce_parse_nexthop(
 		if (bgp->table_map[afi][safi].name) {
 			/* Copy info and attributes, so the route-map
 			   apply doesn't modify the BGP route info. */
+			bgp_attr_flush_ext(&local_attr);
 			local_attr = *mpinfo->attr;
 			mpinfo_cp->attr = &local_attr;
 			if (!bgp_table_map_apply(bgp->table_map[afi][safi].map,
@@ -1440,7 +1443,7 @@ static void bgp_zebra_announce_parse_nexthop(
 		}
 
 		if (is_evpn
-		    && mpinfo->attr->evpn_overlay.type
+		    && bgp_attr_get_evpn_overlay(mpinfo->attr)->type
 			       != OVERLAY_INDEX_GATEWAY_IP)
 			memcpy(&api_nh->rmac, &(mpinfo->attr->rmac),
 			       sizeof(struct ethaddr));
@@ -1485,6 +1488,8 @@ static void bgp_zebra_announce_parse_nexthop(
 
 		(*valid_nh_count)++;
 	}
+
+	bgp_attr_flush_ext(&local_attr);
 }
 
 static void bgp_debug_zebra_nh(struct zapi_route *api)
@@ -1553,10 +1558,14 @@ static void bgp_debug_zebra_nh(struct zapi_route *api)
 	}
 }
 
+/*
+ * Installs go through bulk, so that zebra gets them many per message.
+ */
 static enum zclient_send_status
 bgp_zebra_announce_actual(struct bgp_dest *dest, struct bgp_path_info *info,
-			  struct bgp *bgp)
+			  struct bgp *bgp, struct zapi_route_bulk *bulk)
 {
+	enum zclient_send_status status;
 	struct bgp_path_info *bpi_ultimate;
 	struct zapi_route api = { 0 };
 	unsigned int valid_nh_count = 0;
@@ -1604,12 +1613,12 @@ bgp_zebra_announce_actual(struct bgp_dest *dest, struct bgp_path_info *info,
 
 		allow_recursion = true;
 
-	if (info->attr->rmap_table_id) {
+	if (bgp_attr_get_rmap_table_id(info->attr)) {
 		SET_FLAG(api.message, ZAPI_MESSAGE_TABLEID);
-		api.tableid = info->attr->rmap_table_id;
+		api.tableid = bgp_attr_get_rmap_table_id(info->attr);
 	}
 
-	if (info->attr->srte_color)
+	if (bgp_attr_get_srte_color(info->attr))
 		SET_FLAG(api.message, ZAPI_MESSAGE_SRTE);
 
 	/* Metric is currently based on the best-path only */
@@ -1687,8 +1696,16 @@ bgp_zebra_announce_actual(struct bgp_dest *dest, struct bgp_path_info *info,
 		zlog_debug("%s: %pFX: announcing to zebra (recursion %sset)",
 			   __func__, p, (allow_recursion ? "" : "NOT "));
 	}
-	return zclient_route_send(is_add ? ZEBRA_ROUTE_ADD : ZEBRA_ROUTE_DELETE,
-				  zclient, &api);
+
+	if (is_add)
+		return zapi_route_bulk_add(bulk, &api);
+
+	/* keep the order with the routes queued in bulk */
+	status = zapi_route_bulk_flush(bulk);
+	if (zclient_route_send(ZEBRA_ROUTE_DELETE, zclient, &api) ==
+	    ZCLIENT_SEND_BUFFERED)
+		status = ZCLIENT_SEND_BUFFERED;
+	return status;
 }
 
 
@@ -1764,9 +1781,9 @@ enum zclient_send_status bgp_zebra_withdraw_actual(struct bgp_dest *dest,
 	api.safi = table->safi;
 	api.prefix = *p;
 
-	if (info->attr->rmap_table_id) {
+	if (bgp_attr_get_rmap_table_id(info->attr)) {
 		SET_FLAG(api.message, ZAPI_MESSAGE_TABLEID);
-		api.tableid = info->attr->rmap_table_id;
+		api.tableid = bgp_attr_get_rmap_table_id(info->attr);
 	}
 
 	if (bgp_debug_zebra(p))
@@ -1796,8 +1813,11 @@ static void bgp_handle_route_announcements_to_zebra(struct event *e)
 	uint32_t count = 0;
 	struct bgp_dest *dest = NULL;
 	struct bgp_table *table = NULL;
-	enum zclient_send_status status = ZCLIENT_SEND_SUCCESS;
+	enum zclient_send_status status = ZCLIENT_SEND_SUCCESS, flush_status;
 	bool install;
+	struct zapi_route_bulk bulk;
+
+	zapi_route_bulk_init(&bulk, zclient);
 
 	while (count < ZEBRA_ANNOUNCEMENTS_LIMIT) {
 		dest = zebra_announce_pop(&bm->zebra_announce_head);
@@ -1815,6 +1835,13 @@ static void bgp_handle_route_announcements_to_zebra(struct event *e)
 				   install ? "announcing" : "withdrawing", dest,
 				   table->bgp->name_pretty, dest, dest->flags);
 
+		/* EVPN and withdrawals are sent on their own, anything queued
+		 * in bulk has to go first.
+		 */
+		flush_status = ZCLIENT_SEND_SUCCESS;
+		if (is_evpn || !install)
+			flush_status = zapi_route_bulk_flush(&bulk);
+
 		if (install) {
 			if (is_evpn)
 				status =
@@ -1828,7 +1855,8 @@ static void bgp_handle_route_announcements_to_zebra(struct event *e)
 			else
 				status = bgp_zebra_announce_actual(dest,
 								   dest->za_bgp_pi,
-								   table->bgp);
+								   table->bgp,
+								   &bulk);
 			UNSET_FLAG(dest->flags, BGP_NODE_SCHEDULE_FOR_INSTALL);
 		} else {
 			if (is_evpn)
@@ -1844,6 +1872,8 @@ static void bgp_handle_route_announcements_to_zebra(struct event *e)
 
 			UNSET_FLAG(dest->flags, BGP_NODE_SCHEDULE_FOR_DELETE);
 		}
+		if (flush_status == ZCLIENT_SEND_BUFFERED)
+			status = ZCLIENT_SEND_BUFFERED;
 
 		bgp_path_info_unlock(dest->za_bgp_pi);
 		dest->za_bgp_pi = NULL;
@@ -1856,6 +1886,11 @@ static void bgp_handle_route_announcements_to_zebra(struct event *e)
 		count++;
 	}
 
+	/* the routes in bulk are off the list already, send them now */
+	if (zapi_route_bulk_flush(&bulk) == ZCLIENT_SEND_BUFFERED)
+		status = ZCLIENT_SEND_BUFFERED;
+	zapi_route_bulk_fini(&bulk);
+
 	if (status != ZCLIENT_SEND_BUFFERED &&
 	    zebra_announce_count(&bm->zebra_announce_head))
 		event_add_event(bm->master,
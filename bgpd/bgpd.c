@@ -70,6 +70,7 @@
 #include "bgpd/bgp_evpn_vty.h"
 #include "bgpd/bgp_keepalives.h"
 #include "bgpd/bgp_io.h"
+#include "bgpd/bgp_preparse.h"
 #include "bgpd/bgp_ecommunity.h"
 #include "bgpd/bgp_flowspec.h"
 #include "bgpd/bgp_labelpool.h"
@@ -78,6 +79,7 @@
 #include "bgpd/bgp_evpn_private.h"
 #include "bgpd/bgp_evpn_mh.h"
 #include "bgpd/bgp_mac.h"
+#include "bgpd/bgp_select.h"
 #include "bgp_trace.h"
 
 DEFINE_MTYPE_STATIC(BGPD, PEER_TX_SHUTDOWN_MSG, "Peer shutdown message (TX)");
@@ -1174,8 +1176,10 @@ void bgp_peer_connection_buffers_free(struct peer_connection *connection)
 			connection->ibuf = NULL;
 		}
 
+		bgp_preparse_fifo_flush(&connection->ipreparse);
+
 		if (connection->obuf) {
-			stream_fifo_free(connection->obuf);
+			bgp_obuf_free(connection->obuf);
 			connection->obuf = NULL;
 		}
 
@@ -1208,7 +1212,8 @@ struct peer_connection *bgp_peer_connection_new(struct peer *peer)
 	connection->fd = -1;
 
 	connection->ibuf = stream_fifo_new();
-	connection->obuf = stream_fifo_new();
+	connection->obuf = bgp_obuf_new();
+	bgp_preparse_fifo_init(&connection->ipreparse);
 	pthread_mutex_init(&connection->io_mtx, NULL);
 
 	/* We use a larger buffer for peer->obuf_work in the event that:
@@ -1270,6 +1275,9 @@ static void peer_free(struct peer *peer)
 			      peer->filter[afi][safi].advmap.cname);
 	}
 
+	FOREACH_AFI_SAFI (afi, safi)
+		bgp_route_map_memo_free(peer, afi, safi);
+
 	XFREE(MTYPE_PEER_TX_SHUTDOWN_MSG, peer->tx_shutdown_message);
 
 	XFREE(MTYPE_PEER_DESC, peer->desc);
@@ -7541,6 +7549,9 @@ int peer_route_map_unset(struct peer *peer, afi_t afi, safi_t safi, int direct)
 		filter->map[direct].map = NULL;
 	}
 
+	if (direct == RMAP_IN)
+		bgp_route_map_memo_free(peer, afi, safi);
+
 	/* Check if handling a regular peer. */
 	if (!CHECK_FLAG(peer->sflags, PEER_STATUS_GROUP)) {
 		/* Process peer route updates. */
@@ -7575,6 +7586,9 @@ int peer_route_map_unset(struct peer *peer, afi_t afi, safi_t safi, int direct)
 		filter->map[direct].name = NULL;
 		filter->map[direct].map = NULL;
 
+		if (direct == RMAP_IN)
+			bgp_route_map_memo_free(member, afi, safi);
+
 		/* Process peer route updates. */
 		peer_on_policy_change(member, afi, safi,
 				      (direct == RMAP_OUT) ? 1 : 0);
@@ -8381,6 +8395,7 @@ void bgp_master_init(struct event_loop *master, const int buffer_size,
 	bm->tcp_dscp = IPTOS_PREC_INTERNETCONTROL;
 	bm->inq_limit = BM_DEFAULT_Q_LIMIT;
 	bm->outq_limit = BM_DEFAULT_Q_LIMIT;
+	bm->io_threads = BM_DEFAULT_IO_THREADS;
 	bm->t_bgp_sync_label_manager = NULL;
 	bm->t_bgp_start_label_manager = NULL;
 	bm->t_bgp_zebra_route = NULL;
@@ -8486,6 +8501,8 @@ static void bgp_pthreads_init(void)
 	};
 	bgp_pth_io = frr_pthread_new(&io, "BGP I/O thread", "bgpd_io");
 	bgp_pth_ka = frr_pthread_new(&ka, "BGP Keepalives thread", "bgpd_ka");
+
+	bgp_io_init(bgp_pth_io);
 }
 
 void bgp_pthreads_run(void)
@@ -8500,7 +8517,9 @@ void bgp_pthreads_run(void)
 
 void bgp_pthreads_finish(void)
 {
+	bgp_select_finish();
 	frr_pthread_stop_all();
+	bgp_io_finish();
 }
 
 static int peer_unshut_after_cfg(struct bgp *bgp)
@@ -19,6 +19,7 @@
 #include "asn.h"
 
 PREDECL_LIST(zebra_announce);
+PREDECL_LIST(bgp_preparse_fifo);
 
 /* For union sockunion.  */
 #include "queue.h"
@@ -163,6 +164,7 @@ struct bgp_master {
 	uint32_t flags;
 #define BM_FLAG_GRACEFUL_SHUTDOWN        (1 << 0)
 #define BM_FLAG_SEND_EXTRA_DATA_TO_ZEBRA (1 << 1)
+#define BM_FLAG_UPDATE_PREPARSE          (1 << 2)
 
 	bool terminating;	/* global flag that sigint terminate seen */
 
@@ -173,6 +175,13 @@ struct bgp_master {
 	uint32_t inq_limit;
 	uint32_t outq_limit;
 
+	/* Number of best path selection shards, 0 for serial selection */
+	uint32_t select_threads;
+
+	/* Number of I/O pthreads */
+#define BM_DEFAULT_IO_THREADS 1
+	uint32_t io_threads;
+
 	struct event *t_bgp_sync_label_manager;
 	struct event *t_bgp_start_label_manager;
 
@@ -1173,12 +1182,16 @@ struct peer_connection {
 #define PEER_THREAD_READS_ON  (1U << 1)
 
 	/* Packet receive and send buffer. */
-	pthread_mutex_t io_mtx;	  // guards ibuf, obuf
+	pthread_mutex_t io_mtx;	  // guards ibuf, obuf, ipreparse
 	struct stream_fifo *ibuf; // packets waiting to be processed
-	struct stream_fifo *obuf; // packets waiting to be written
+	/* NLRI decoded by the I/O pthread for packets on ibuf */
+	struct bgp_preparse_fifo_head ipreparse;
+	struct bgp_obuf *obuf;	  // packets waiting to be written
 
 	struct ringbuf *ibuf_work; // WiP buffer used by bgp_read() only
 
+	struct bgp_io_thread *io; // I/O pthread serving this connection
+
 	struct event *t_read;
 	struct event *t_write;
 	struct event *t_connect;
@@ -1249,6 +1262,7 @@ struct peer {
 	struct in_addr local_id;
 
 	struct stream *curr; // the current packet being parsed
+	struct bgp_preparse *curr_preparse; // pre-parsed NLRI of curr
 
 	/* the doppelganger peer structure, due to dual TCP conn setup */
 	struct peer *doppelganger;
@@ -1599,6 +1613,7 @@ struct peer {
 #define PEER_STATUS_LLGR_WAIT (1U << 11)
 #define PEER_STATUS_REFRESH_PENDING (1U << 12) /* refresh request from peer */
 #define PEER_STATUS_RTT_SHUTDOWN (1U << 13) /* In shutdown state due to RTT */
+#define PEER_STATUS_SOFT_RECONFIG_IN (1U << 14) /* soft reconfig in progress */
 
 	/* Configured timer values. */
 	_Atomic uint32_t holdtime;
@@ -1732,6 +1747,9 @@ struct peer {
 	/* ORF Prefix-list */
 	struct prefix_list *orf_plist[AFI_MAX][SAFI_MAX];
 
+	/* Inbound route-map results, see bgp_route_map_apply_memo() */
+	struct bgp_rmap_memo *rmap_memo[AFI_MAX][SAFI_MAX];
+
 	/* Text description of last attribute rcvd */
 	char rcvd_attr_str[BUFSIZ];
 
@@ -1741,6 +1759,10 @@ struct peer {
 	/* Accepted prefix count */
 	uint32_t pcount[AFI_MAX][SAFI_MAX];
 
+	/* Inbound soft reconfiguration progress, in adj-in entries */
+	uint32_t soft_reconfig_queued[AFI_MAX][SAFI_MAX];
+	uint32_t soft_reconfig_done[AFI_MAX][SAFI_MAX];
+
 	/* Max prefix count. */
 	uint32_t pmax[AFI_MAX][SAFI_MAX];
 	uint8_t pmax_threshold[AFI_MAX][SAFI_MAX];
@@ -2486,6 +2508,12 @@ extern enum asnotation_mode bgp_get_asnotation(struct bgp *bgp);
 extern void bgp_route_map_terminate(void);
 
 extern bool bgp_route_map_has_extcommunity_rt(const struct route_map *map);
+extern route_map_result_t
+bgp_route_map_apply_memo(struct peer *peer, afi_t afi, safi_t safi,
+			 struct route_map *map, const struct prefix *p,
+			 struct bgp_path_info *path);
+extern void bgp_route_map_memo_free(struct peer *peer, afi_t afi,
+				    safi_t safi);
 
 extern int peer_cmp(struct peer *p1, struct peer *p2);
 
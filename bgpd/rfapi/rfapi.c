@@ -657,6 +657,7 @@ void add_vnc_route(struct rfapi_descriptor *rfd, /* cookie, VPN UN addr, peer */
 				"%s: mpls tunnel type, encap safi omitted",
 				__func__);
 			aspath_unintern(&attr.aspath); /* Unintern original. */
+			bgp_attr_flush_ext(&attr);
 			return;
 		}
 	}
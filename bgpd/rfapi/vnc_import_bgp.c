@@ -414,6 +414,7 @@ static void vnc_import_bgp_add_route_mode_resolve_nve_one_bi(
 	uint32_t lifetime;
 	uint32_t *plifetime;
 	struct bgp_attr_encap_subtlv *encaptlvs;
+	uint16_t tunneltype;
 	uint32_t label = 0;
 
 	struct rfapi_un_option optary[3];
@@ -456,12 +457,13 @@ static void vnc_import_bgp_add_route_mode_resolve_nve_one_bi(
 	}
 
 	encaptlvs = bgp_attr_get_vnc_subtlvs(bpi->attr);
-	if (bpi->attr->encap_tunneltype != BGP_ENCAP_TYPE_RESERVED
-	    && bpi->attr->encap_tunneltype != BGP_ENCAP_TYPE_MPLS) {
+	tunneltype = bgp_attr_get_encap_tunneltype(bpi->attr);
+	if (tunneltype != BGP_ENCAP_TYPE_RESERVED
+	    && tunneltype != BGP_ENCAP_TYPE_MPLS) {
 		opt = &optary[cur_opt++];
 		memset(opt, 0, sizeof(struct rfapi_un_option));
 		opt->type = RFAPI_UN_OPTION_TYPE_TUNNELTYPE;
-		opt->v.tunnel.type = bpi->attr->encap_tunneltype;
+		opt->v.tunnel.type = tunneltype;
 		/* TBD parse bpi->attr->extra->encap_subtlvs */
 	}
 
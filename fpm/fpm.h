@@ -67,6 +67,13 @@
  */
 #define FPM_MAX_MSG_LEN 4096
 
+/*
+ * Payload of the NLMSG_DONE messages that open and close an incremental
+ * RIB replay.
+ */
+#define FPM_RESYNC_START 0
+#define FPM_RESYNC_END 1
+
 #ifdef __SUNPRO_C
 #pragma pack(1)
 #endif
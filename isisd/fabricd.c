@@ -7,6 +7,7 @@
  * This file is part of FRRouting (FRR)
  */
 #include <zebra.h>
+#include "skiplist.h"
 #include "isisd/fabricd.h"
 #include "isisd/isisd.h"
 #include "isisd/isis_circuit.h"
@@ -552,6 +552,8 @@ void lsp_update(struct isis_lsp *lsp, struct isis_lsp_hdr *hdr,
 		struct isis_tlvs *tlvs, struct stream *stream,
 		struct isis_area *area, int level, bool confusion)
 {
+	bool partial = false;
+
 	if (lsp->own_lsp) {
 		flog_err(
 			EC_LIB_DEVELOPMENT,
@@ -564,6 +566,8 @@ void lsp_update(struct isis_lsp *lsp, struct isis_lsp_hdr *hdr,
 	if (confusion) {
 		lsp_purge(lsp, level, NULL);
 	} else {
+		/* Must look at the old data before it is freed */
+		partial = isis_spf_lsp_changed(lsp, hdr, tlvs, stream);
 		lsp_update_data(lsp, hdr, tlvs, stream, area, level);
 	}
 
@@ -574,12 +578,17 @@ void lsp_update(struct isis_lsp *lsp, struct isis_lsp_hdr *hdr,
 		memcpy(lspid, lsp->hdr.lsp_id, ISIS_SYS_ID_LEN + 1);
 		LSP_FRAGMENT(lspid) = 0;
 		lsp0 = lsp_search(&area->lspdb[level - 1], lspid);
-		if (lsp0)
+		if (lsp0) {
 			lsp_link_fragment(lsp, lsp0);
+			partial = false;
+		}
 	}
 
 	if (lsp->hdr.seqno) {
-		isis_spf_schedule(lsp->area, lsp->level);
+		if (partial)
+			isis_spf_schedule_partial(lsp->area, lsp->level);
+		else
+			isis_spf_schedule(lsp->area, lsp->level);
 		isis_te_lsp_event(lsp, LSP_UPD);
 	}
 }
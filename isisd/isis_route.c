@@ -905,6 +905,50 @@ void isis_route_invalidate_table(struct isis_area *area,
 	}
 }
 
+void isis_route_invalidate_prefixes(struct isis_area *area,
+				    struct route_table *table,
+				    struct route_table *prefixes)
+{
+	struct route_node *pnode, *rnode;
+	struct isis_route_info *rinfo;
+
+	for (pnode = route_top(prefixes); pnode; pnode = route_next(pnode)) {
+		if (pnode->info == NULL)
+			continue;
+
+		rnode = srcdest_rnode_lookup(table, &pnode->p, NULL);
+		if (!rnode)
+			continue;
+		route_unlock_node(rnode);
+
+		rinfo = rnode->info;
+		UNSET_FLAG(rinfo->flag, ISIS_ROUTE_FLAG_ACTIVE);
+	}
+}
+
+void isis_route_verify_prefixes(struct isis_area *area,
+				struct route_table *table,
+				struct route_table *prefixes)
+{
+	struct route_node *pnode, *rnode;
+	struct isis_route_info *rinfo;
+
+	for (pnode = route_top(prefixes); pnode; pnode = route_next(pnode)) {
+		if (pnode->info == NULL)
+			continue;
+
+		rnode = srcdest_rnode_lookup(table, &pnode->p, NULL);
+		if (!rnode)
+			continue;
+		route_unlock_node(rnode);
+
+		rinfo = rnode->info;
+		isis_route_update(area, &pnode->p, NULL, rinfo);
+		if (!CHECK_FLAG(rinfo->flag, ISIS_ROUTE_FLAG_ACTIVE))
+			isis_route_delete(area, rnode, table);
+	}
+}
+
 void isis_route_switchover_nexthop(struct isis_area *area,
 				   struct route_table *table, int family,
 				   union g_addr *nexthop_addr,
@@ -73,6 +73,18 @@ void isis_route_verify_merge(struct isis_area *area,
 void isis_route_invalidate_table(struct isis_area *area,
 				 struct route_table *table);
 
+/* Same as isis_route_invalidate_table, for the given prefixes only. Used
+ * before a partial route calculation. */
+void isis_route_invalidate_prefixes(struct isis_area *area,
+				    struct route_table *table,
+				    struct route_table *prefixes);
+
+/* Same as isis_route_verify_table, for the given prefixes of a single level
+ * table only: zebra is sent just the routes to those that changed. */
+void isis_route_verify_prefixes(struct isis_area *area,
+				struct route_table *table,
+				struct route_table *prefixes);
+
 /* Cleanup route node when freeing routing table. */
 void isis_route_node_cleanup(struct route_table *table,
 			     struct route_node *node);
@@ -216,37 +216,135 @@ void isis_vertex_adj_free(void *arg)
 	XFREE(MTYPE_ISIS_VERTEX_ADJ, vadj);
 }
 
+static struct isis_vertex *
+isis_vertex_arena_get(struct isis_vertex_arena *arena)
+{
+	struct isis_vertex_chunk *chunk;
+	struct isis_vertex *vertex;
+
+	if (arena->free) {
+		vertex = arena->free;
+		arena->free = vertex->arena_next;
+		return vertex;
+	}
+
+	if (!arena->current || arena->used == ISIS_VERTEX_CHUNK_SIZE) {
+		chunk = arena->current ? arena->current->next : arena->chunks;
+		if (!chunk) {
+			chunk = XCALLOC(MTYPE_ISIS_VERTEX, sizeof(*chunk));
+			if (arena->current)
+				arena->current->next = chunk;
+			else
+				arena->chunks = chunk;
+		}
+		arena->current = chunk;
+		arena->used = 0;
+	}
+
+	return &arena->current->vertices[arena->used++];
+}
+
+/* Empty the lists of a vertex, but keep them for its next use */
+static void isis_vertex_clear(struct isis_vertex *vertex)
+{
+	if (vertex->Adj_N)
+		list_delete_all_node(vertex->Adj_N);
+	if (vertex->parents)
+		list_delete_all_node(vertex->parents);
+	if (vertex->firsthops)
+		hash_clean(vertex->firsthops, NULL);
+}
+
+/* Give all the vertices back, at the start of a run */
+static void isis_vertex_arena_reset(struct isis_vertex_arena *arena)
+{
+	struct isis_vertex_chunk *chunk;
+	unsigned int i, used;
+
+	arena->free = NULL;
+	if (!arena->current)
+		return;
+
+	for (chunk = arena->chunks; chunk; chunk = chunk->next) {
+		used = chunk == arena->current ? arena->used
+					       : ISIS_VERTEX_CHUNK_SIZE;
+		for (i = 0; i < used; i++)
+			isis_vertex_clear(&chunk->vertices[i]);
+		if (chunk == arena->current)
+			break;
+	}
+
+	arena->current = NULL;
+	arena->used = 0;
+}
+
+void isis_vertex_arena_fini(struct isis_vertex_arena *arena)
+{
+	struct isis_vertex_chunk *chunk;
+	struct isis_vertex *vertex;
+	unsigned int i;
+
+	while ((chunk = arena->chunks)) {
+		arena->chunks = chunk->next;
+
+		/* Vertices are carved in order, the rest was never used */
+		for (i = 0; i < ISIS_VERTEX_CHUNK_SIZE; i++) {
+			vertex = &chunk->vertices[i];
+			if (!vertex->Adj_N)
+				break;
+			list_delete(&vertex->Adj_N);
+			list_delete(&vertex->parents);
+			hash_clean_and_free(&vertex->firsthops, NULL);
+		}
+		XFREE(MTYPE_ISIS_VERTEX, chunk);
+	}
+
+	memset(arena, 0, sizeof(*arena));
+}
+
 static struct isis_vertex *isis_vertex_new(struct isis_spftree *spftree,
 					   void *id,
 					   enum vertextype vtype)
 {
 	struct isis_vertex *vertex;
+	struct list *adj_n, *parents;
+	struct hash *firsthops;
 
-	vertex = XCALLOC(MTYPE_ISIS_VERTEX, sizeof(struct isis_vertex));
+	vertex = isis_vertex_arena_get(&spftree->vertices);
+	adj_n = vertex->Adj_N;
+	parents = vertex->parents;
+	firsthops = vertex->firsthops;
+	memset(vertex, 0, sizeof(struct isis_vertex));
 
 	isis_vertex_id_init(vertex, id, vtype);
 
-	vertex->Adj_N = list_new();
-	vertex->Adj_N->del = isis_vertex_adj_free;
-	vertex->parents = list_new();
-
-	if (CHECK_FLAG(spftree->flags, F_SPFTREE_HOPCOUNT_METRIC)) {
-		vertex->firsthops = hash_create(isis_vertex_queue_hash_key,
-						isis_vertex_queue_hash_cmp,
-						NULL);
+	if (!adj_n) {
+		adj_n = list_new();
+		adj_n->del = isis_vertex_adj_free;
+		parents = list_new();
 	}
+	vertex->Adj_N = adj_n;
+	vertex->parents = parents;
+
+	if (!firsthops && CHECK_FLAG(spftree->flags, F_SPFTREE_HOPCOUNT_METRIC))
+		firsthops = hash_create(isis_vertex_queue_hash_key,
+					isis_vertex_queue_hash_cmp, NULL);
+	vertex->firsthops = firsthops;
 
 	return vertex;
 }
 
-void isis_vertex_del(struct isis_vertex *vertex)
+void isis_vertex_del(struct isis_spftree *spftree, struct isis_vertex *vertex)
 {
-	list_delete(&vertex->Adj_N);
-	list_delete(&vertex->parents);
-	hash_clean_and_free(&vertex->firsthops, NULL);
+	/* Don't leave its Prefix-SID pointing at a recycled vertex */
+	if (VTYPE_IP(vertex->type)
+	    && hash_lookup(spftree->prefix_sids, vertex) == vertex)
+		hash_release(spftree->prefix_sids, vertex);
 
-	memset(vertex, 0, sizeof(struct isis_vertex));
-	XFREE(MTYPE_ISIS_VERTEX, vertex);
+	isis_vertex_clear(vertex);
+
+	vertex->arena_next = spftree->vertices.free;
+	spftree->vertices.free = vertex;
 }
 
 struct isis_vertex_adj *
@@ -393,6 +491,7 @@ static void _isis_spftree_del(struct isis_spftree *spftree)
 	list_delete(&spftree->sadj_list);
 	isis_vertex_queue_free(&spftree->tents);
 	isis_vertex_queue_free(&spftree->paths);
+	isis_vertex_arena_fini(&spftree->vertices);
 	info =  spftree->route_table->info;
 	backup_info = spftree->route_table_backup->info;
 	route_table_finish(spftree->route_table);
@@ -467,6 +566,10 @@ static int spf_adj_state_change(struct isis_adjacency *adj)
 {
 	struct isis_area *area = adj->circuit->area;
 
+	/* The SPT of the last run no longer matches the adjacencies */
+	area->spf_changes[0].full = true;
+	area->spf_changes[1].full = true;
+
 	if (adj->adj_state == ISIS_ADJ_UP)
 		return 0;
 
@@ -668,6 +771,29 @@ isis_spf_add2tent(struct isis_spftree *spftree, enum vertextype vtype, void *id,
 	return vertex;
 }
 
+/*
+ * A partial route calculation only puts the vertices of the prefixes it
+ * recomputes on TENT.
+ */
+static bool isis_spf_prc_skip(struct isis_spftree *spftree,
+			      enum vertextype vtype, const void *id)
+{
+	const struct prefix_pair *p = id;
+	struct route_node *rn;
+
+	if (!spftree->prc_prefixes)
+		return false;
+	if (!VTYPE_IP(vtype))
+		return true;
+
+	rn = route_node_lookup(spftree->prc_prefixes, &p->dest);
+	if (!rn)
+		return true;
+	route_unlock_node(rn);
+
+	return false;
+}
+
 static void isis_spf_add_local(struct isis_spftree *spftree,
 			       enum vertextype vtype, void *id,
 			       struct isis_spf_adj *sadj, uint32_t cost,
@@ -676,6 +802,9 @@ static void isis_spf_add_local(struct isis_spftree *spftree,
 {
 	struct isis_vertex *vertex;
 
+	if (isis_spf_prc_skip(spftree, vtype, id))
+		return;
+
 	vertex = isis_find_vertex(&spftree->tents, id, vtype);
 
 	if (vertex) {
@@ -703,7 +832,7 @@ static void isis_spf_add_local(struct isis_spftree *spftree,
 		} else { /* vertex->d_N > cost */
 			/*         f) */
 			isis_vertex_queue_delete(&spftree->tents, vertex);
-			isis_vertex_del(vertex);
+			isis_vertex_del(spftree, vertex);
 		}
 	}
 
@@ -734,6 +863,9 @@ static void process_N(struct isis_spftree *spftree, enum vertextype vtype,
 		id = &p;
 	}
 
+	if (isis_spf_prc_skip(spftree, vtype, id))
+		return;
+
 	/* RFC3787 section 5.1 */
 	if (spftree->area->newmetric == 1) {
 		if (dist > MAX_WIDE_PATH_METRIC)
@@ -808,7 +940,7 @@ static void process_N(struct isis_spftree *spftree, enum vertextype vtype,
 			/*      4) */
 		} else {
 			isis_vertex_queue_delete(&spftree->tents, vertex);
-			isis_vertex_del(vertex);
+			isis_vertex_del(spftree, vertex);
 		}
 	}
 
@@ -1634,6 +1766,7 @@ static void init_spt(struct isis_spftree *spftree, int mtid)
 	isis_zebra_rlfa_unregister_all(spftree);
 	isis_rlfa_list_clear(spftree);
 	list_delete_all_node(spftree->lfa.remote.pc_spftrees);
+	isis_vertex_arena_reset(&spftree->vertices);
 	memset(&spftree->lfa.protection_counters, 0,
 	       sizeof(spftree->lfa.protection_counters));
 
@@ -2057,12 +2190,657 @@ void isis_spf_switchover_routes(struct isis_area *area,
 				      family, nexthop_ip, ifindex);
 }
 
+void isis_spf_changes_init(struct isis_area *area)
+{
+	for (int level = ISIS_LEVEL1; level <= ISIS_LEVEL2; level++) {
+		struct isis_spf_changes *changes =
+			&area->spf_changes[level - 1];
+
+		changes->full = true;
+		changes->prefixes4 = route_table_init();
+		changes->prefixes6 = route_table_init();
+		isis_spf_node_list_init(&changes->links);
+	}
+}
+
+void isis_spf_changes_fini(struct isis_area *area)
+{
+	for (int level = ISIS_LEVEL1; level <= ISIS_LEVEL2; level++) {
+		struct isis_spf_changes *changes =
+			&area->spf_changes[level - 1];
+
+		route_table_finish(changes->prefixes4);
+		route_table_finish(changes->prefixes6);
+		isis_spf_node_list_clear(&changes->links);
+	}
+}
+
+static void isis_spf_changes_reset(struct isis_spf_changes *changes)
+{
+	changes->full = false;
+	route_table_finish(changes->prefixes4);
+	route_table_finish(changes->prefixes6);
+	changes->prefixes4 = route_table_init();
+	changes->prefixes6 = route_table_init();
+	isis_spf_node_list_clear(&changes->links);
+}
+
+static void spf_changes_prefix_add(struct isis_spf_changes *changes,
+				   const struct prefix *prefix)
+{
+	struct route_table *table;
+	struct route_node *rn;
+	struct prefix p;
+
+	prefix_copy(&p, prefix);
+	apply_mask(&p);
+
+	table = p.family == AF_INET ? changes->prefixes4 : changes->prefixes6;
+	rn = route_node_get(table, &p);
+	if (rn->info)
+		route_unlock_node(rn);
+	else
+		rn->info = (void *)1;
+}
+
+static bool spf_subtlvs_same(const struct isis_subtlvs *a,
+			     const struct isis_subtlvs *b)
+{
+	const struct isis_item *ia, *ib;
+
+	if (!a || !b)
+		return a == b;
+
+	if (!a->source_prefix || !b->source_prefix) {
+		if (a->source_prefix != b->source_prefix)
+			return false;
+	} else if (!prefix_same((struct prefix *)a->source_prefix,
+				(struct prefix *)b->source_prefix))
+		return false;
+
+	for (ia = a->prefix_sids.head, ib = b->prefix_sids.head; ia && ib;
+	     ia = ia->next, ib = ib->next) {
+		const struct isis_prefix_sid *sa = (void *)ia, *sb = (void *)ib;
+
+		if (sa->flags != sb->flags || sa->algorithm != sb->algorithm
+		    || sa->value != sb->value)
+			return false;
+	}
+
+	return !ia && !ib;
+}
+
+static const struct prefix *spf_ip_reach_prefix(uint8_t type,
+						const struct isis_item *i)
+{
+	switch (type) {
+	case ISIS_TLV_OLDSTYLE_IP_REACH:
+		return (struct prefix *)&((struct isis_oldstyle_ip_reach *)i)
+			->prefix;
+	case ISIS_TLV_EXTENDED_IP_REACH:
+		return (struct prefix *)&((struct isis_extended_ip_reach *)i)
+			->prefix;
+	default:
+		return (struct prefix *)&((struct isis_ipv6_reach *)i)->prefix;
+	}
+}
+
+static bool spf_ip_reach_same(uint8_t type, const struct isis_item *a,
+			      const struct isis_item *b)
+{
+	if (!prefix_same(spf_ip_reach_prefix(type, a),
+			 spf_ip_reach_prefix(type, b)))
+		return false;
+
+	switch (type) {
+	case ISIS_TLV_OLDSTYLE_IP_REACH: {
+		const struct isis_oldstyle_ip_reach *ra = (void *)a,
+						    *rb = (void *)b;
+
+		return ra->metric == rb->metric;
+	}
+	case ISIS_TLV_EXTENDED_IP_REACH: {
+		const struct isis_extended_ip_reach *ra = (void *)a,
+						    *rb = (void *)b;
+
+		return ra->metric == rb->metric && ra->down == rb->down
+		       && spf_subtlvs_same(ra->subtlvs, rb->subtlvs);
+	}
+	default: {
+		const struct isis_ipv6_reach *ra = (void *)a, *rb = (void *)b;
+
+		return ra->metric == rb->metric && ra->down == rb->down
+		       && ra->external == rb->external
+		       && spf_subtlvs_same(ra->subtlvs, rb->subtlvs);
+	}
+	}
+}
+
+/* Note the prefixes of the entries of a that b does not have as they are */
+static void spf_changes_ip_reach_gone(struct isis_spf_changes *changes,
+				      uint8_t type,
+				      const struct isis_item_list *a,
+				      const struct isis_item_list *b)
+{
+	const struct isis_item *i, *j;
+
+	for (i = a ? a->head : NULL; i; i = i->next) {
+		for (j = b ? b->head : NULL; j; j = j->next)
+			if (spf_ip_reach_same(type, i, j))
+				break;
+		if (!j)
+			spf_changes_prefix_add(changes,
+					       spf_ip_reach_prefix(type, i));
+	}
+}
+
+static void spf_changes_ip_reach(struct isis_spf_changes *changes,
+				 uint8_t type, const struct isis_item_list *a,
+				 const struct isis_item_list *b)
+{
+	spf_changes_ip_reach_gone(changes, type, a, b);
+	spf_changes_ip_reach_gone(changes, type, b, a);
+}
+
+/* The topologies other than the standard one SPF trees are computed for */
+static const uint16_t spf_mtids[] = {ISIS_MT_IPV6_UNICAST,
+				     ISIS_MT_IPV6_DSTSRC};
+
+static void spf_changes_mt_ip_reach(struct isis_spf_changes *changes,
+				    uint8_t type, struct isis_mt_item_list *a,
+				    struct isis_mt_item_list *b)
+{
+	for (unsigned int i = 0; i < array_size(spf_mtids); i++)
+		spf_changes_ip_reach(changes, type,
+				     isis_lookup_mt_items(a, spf_mtids[i]),
+				     isis_lookup_mt_items(b, spf_mtids[i]));
+}
+
+/*
+ * Check that two lists of IS reachability entries list the same neighbors in
+ * the same order. *metrics is set when some metric differs.
+ */
+static bool spf_is_reach_same(const struct isis_item *a,
+			      const struct isis_item *b, bool oldstyle,
+			      bool *metrics)
+{
+	for (; a && b; a = a->next, b = b->next) {
+		if (oldstyle) {
+			const struct isis_oldstyle_reach *ra = (void *)a,
+							 *rb = (void *)b;
+
+			if (memcmp(ra->id, rb->id, sizeof(ra->id)))
+				return false;
+			if (ra->metric != rb->metric)
+				*metrics = true;
+		} else {
+			const struct isis_extended_reach *ra = (void *)a,
+							 *rb = (void *)b;
+
+			if (memcmp(ra->id, rb->id, sizeof(ra->id)))
+				return false;
+			if (ra->metric != rb->metric)
+				*metrics = true;
+		}
+	}
+
+	return !a && !b;
+}
+
+static bool spf_mt_is_reach_same(struct isis_mt_item_list *a,
+				 struct isis_mt_item_list *b, bool *metrics)
+{
+	struct isis_item_list *la, *lb;
+
+	for (unsigned int i = 0; i < array_size(spf_mtids); i++) {
+		la = isis_lookup_mt_items(a, spf_mtids[i]);
+		lb = isis_lookup_mt_items(b, spf_mtids[i]);
+		if (!spf_is_reach_same(la ? la->head : NULL,
+				       lb ? lb->head : NULL, false, metrics))
+			return false;
+	}
+
+	return true;
+}
+
+static bool spf_lsp_tlv_tracked(uint8_t type)
+{
+	switch (type) {
+	case ISIS_TLV_AUTH:
+	case ISIS_TLV_OLDSTYLE_REACH:
+	case ISIS_TLV_EXTENDED_REACH:
+	case ISIS_TLV_MT_REACH:
+	case ISIS_TLV_OLDSTYLE_IP_REACH:
+	case ISIS_TLV_OLDSTYLE_IP_REACH_EXT:
+	case ISIS_TLV_EXTENDED_IP_REACH:
+	case ISIS_TLV_MT_IP_REACH:
+	case ISIS_TLV_IPV6_REACH:
+	case ISIS_TLV_MT_IPV6_REACH:
+		return true;
+	default:
+		return false;
+	}
+}
+
+/* Offset of the next TLV from pos on that is not a tracked one, or end */
+static size_t spf_lsp_tlv_next(const uint8_t *data, size_t pos, size_t end)
+{
+	while (pos + 2 <= end && pos + 2 + data[pos + 1] <= end) {
+		if (!spf_lsp_tlv_tracked(data[pos]))
+			return pos;
+		pos += 2 + data[pos + 1];
+	}
+
+	return end;
+}
+
+/*
+ * Compare the TLVs of two LSP PDUs, leaving out authentication and the
+ * reachability TLVs isis_spf_lsp_changed() looks at itself.
+ */
+static bool spf_lsp_pdu_same(struct stream *a, struct stream *b)
+{
+	const uint8_t *da = STREAM_DATA(a), *db = STREAM_DATA(b);
+	size_t ea = stream_get_endp(a), eb = stream_get_endp(b);
+	size_t pa = ISIS_FIXED_HDR_LEN + ISIS_LSP_HDR_LEN;
+	size_t pb = ISIS_FIXED_HDR_LEN + ISIS_LSP_HDR_LEN;
+
+	for (;;) {
+		pa = spf_lsp_tlv_next(da, pa, ea);
+		pb = spf_lsp_tlv_next(db, pb, eb);
+		if (pa >= ea || pb >= eb)
+			return pa >= ea && pb >= eb;
+
+		if (da[pa] != db[pb] || da[pa + 1] != db[pb + 1]
+		    || memcmp(da + pa + 2, db + pb + 2, da[pa + 1]))
+			return false;
+
+		pa += 2 + da[pa + 1];
+		pb += 2 + db[pb + 1];
+	}
+}
+
+/*
+ * Called before an LSP gets replaced by a newer instance. When the two only
+ * differ in the prefixes they advertise and in the metrics of the same IS
+ * neighbors, note what changed for the level's next SPF run and return true:
+ * that run may then be partial. Otherwise the next run has to be full.
+ */
+bool isis_spf_lsp_changed(struct isis_lsp *lsp, struct isis_lsp_hdr *hdr,
+			  struct isis_tlvs *tlvs, struct stream *stream)
+{
+	struct isis_spf_changes *changes;
+	bool metrics = false;
+
+	changes = &lsp->area->spf_changes[lsp->level - 1];
+	if (changes->full)
+		return false;
+
+	if (!lsp->tlvs || !lsp->pdu || !tlvs || !lsp->hdr.seqno)
+		return false;
+	if (!lsp->hdr.rem_lifetime || !hdr->rem_lifetime)
+		return false;
+	if (lsp->hdr.lsp_bits != hdr->lsp_bits)
+		return false;
+
+	if (!spf_lsp_pdu_same(lsp->pdu, stream))
+		return false;
+	if (!spf_is_reach_same(lsp->tlvs->oldstyle_reach.head,
+			       tlvs->oldstyle_reach.head, true, &metrics)
+	    || !spf_is_reach_same(lsp->tlvs->extended_reach.head,
+				  tlvs->extended_reach.head, false, &metrics)
+	    || !spf_mt_is_reach_same(&lsp->tlvs->mt_reach, &tlvs->mt_reach,
+				     &metrics))
+		return false;
+	/* The links of pseudonodes all have a zero metric */
+	if (metrics && LSP_PSEUDO_ID(lsp->hdr.lsp_id))
+		return false;
+
+	spf_changes_ip_reach(changes, ISIS_TLV_OLDSTYLE_IP_REACH,
+			     &lsp->tlvs->oldstyle_ip_reach,
+			     &tlvs->oldstyle_ip_reach);
+	spf_changes_ip_reach(changes, ISIS_TLV_OLDSTYLE_IP_REACH,
+			     &lsp->tlvs->oldstyle_ip_reach_ext,
+			     &tlvs->oldstyle_ip_reach_ext);
+	spf_changes_ip_reach(changes, ISIS_TLV_EXTENDED_IP_REACH,
+			     &lsp->tlvs->extended_ip_reach,
+			     &tlvs->extended_ip_reach);
+	spf_changes_mt_ip_reach(changes, ISIS_TLV_EXTENDED_IP_REACH,
+				&lsp->tlvs->mt_ip_reach, &tlvs->mt_ip_reach);
+	spf_changes_ip_reach(changes, ISIS_TLV_IPV6_REACH,
+			     &lsp->tlvs->ipv6_reach, &tlvs->ipv6_reach);
+	spf_changes_mt_ip_reach(changes, ISIS_TLV_IPV6_REACH,
+				&lsp->tlvs->mt_ipv6_reach,
+				&tlvs->mt_ipv6_reach);
+
+	if (metrics && !isis_spf_node_find(&changes->links, lsp->hdr.lsp_id))
+		isis_spf_node_new(&changes->links, lsp->hdr.lsp_id);
+
+	return true;
+}
+
+/*
+ * A new metric m for the link from U to V leaves the SPT alone when the link
+ * is still on a shortest path to V at the same cost, or is still longer than
+ * the shortest path to V.
+ */
+static bool spf_link_unchanged(struct isis_spftree *spftree,
+			       struct isis_vertex *parent, const uint8_t *id,
+			       uint32_t metric, enum vertextype vtype)
+{
+	static const uint8_t null_sysid[ISIS_SYS_ID_LEN];
+	struct isis_vertex *vertex;
+	uint32_t dist;
+
+	/* Same entries as isis_spf_process_lsp() skips */
+	if (!LSP_PSEUDO_ID(id) && !memcmp(id, spftree->sysid, ISIS_SYS_ID_LEN))
+		return true;
+	if (!memcmp(id, null_sysid, ISIS_SYS_ID_LEN))
+		return true;
+
+	vertex = isis_find_vertex(&spftree->paths, id, vtype);
+	if (!vertex)
+		return false;
+
+	dist = parent->d_N + metric;
+	if (listnode_lookup(vertex->parents, parent))
+		return dist == vertex->d_N;
+
+	return dist > vertex->d_N;
+}
+
+static bool spf_lsp_links_unchanged(struct isis_spftree *spftree,
+				    struct isis_vertex *vertex,
+				    struct isis_lsp *lsp)
+{
+	struct isis_item_list *te_neighs = NULL;
+
+	if (spftree->mtid == ISIS_MT_IPV4_UNICAST && spftree->area->oldmetric) {
+		struct isis_oldstyle_reach *r;
+
+		for (r = (struct isis_oldstyle_reach *)
+				 lsp->tlvs->oldstyle_reach.head;
+		     r; r = r->next)
+			if (!spf_link_unchanged(spftree, vertex, r->id,
+						r->metric,
+						LSP_PSEUDO_ID(r->id)
+							? VTYPE_PSEUDO_IS
+							: VTYPE_NONPSEUDO_IS))
+				return false;
+	}
+
+	if (!spftree->area->newmetric)
+		return true;
+
+	if (spftree->mtid == ISIS_MT_IPV4_UNICAST)
+		te_neighs = &lsp->tlvs->extended_reach;
+	else
+		te_neighs = isis_lookup_mt_items(&lsp->tlvs->mt_reach,
+						 spftree->mtid);
+
+	struct isis_extended_reach *er;
+	for (er = te_neighs ? (struct isis_extended_reach *)te_neighs->head
+			    : NULL;
+	     er; er = er->next)
+		if (!spf_link_unchanged(spftree, vertex, er->id, er->metric,
+					LSP_PSEUDO_ID(er->id)
+						? VTYPE_PSEUDO_TE_IS
+						: VTYPE_NONPSEUDO_TE_IS))
+			return false;
+
+	return true;
+}
+
+static bool spf_vertex_links_unchanged(struct isis_spftree *spftree,
+				       struct isis_vertex *vertex)
+{
+	struct isis_mt_router_info *mt_router_info;
+	struct isis_lsp *lsp, *frag;
+	struct listnode *node;
+
+	lsp = lsp_for_vertex(spftree, vertex);
+	if (!lsp || !lsp->tlvs)
+		return true;
+
+	/* Same conditions as isis_spf_process_lsp() */
+	if (spftree->mtid == ISIS_MT_IPV4_UNICAST) {
+		if (!speaks(lsp->tlvs->protocols_supported.protocols,
+			    lsp->tlvs->protocols_supported.count,
+			    spftree->family)
+		    || ISIS_MASK_LSP_OL_BIT(lsp->hdr.lsp_bits))
+			return true;
+	} else {
+		mt_router_info = isis_tlvs_lookup_mt_router_info(lsp->tlvs,
+								 spftree->mtid);
+		if (!mt_router_info || mt_router_info->overload)
+			return true;
+	}
+
+	if (!spf_lsp_links_unchanged(spftree, vertex, lsp))
+		return false;
+	for (ALL_LIST_ELEMENTS_RO(lsp->lspu.frags, node, frag))
+		if (frag->tlvs
+		    && !spf_lsp_links_unchanged(spftree, vertex, frag))
+			return false;
+
+	return true;
+}
+
+/*
+ * Check that the new metrics of the links of the given systems leave the SPT
+ * of the last run as it is.
+ */
+static bool isis_spf_links_unchanged(struct isis_spftree *spftree,
+				     struct isis_spf_nodes *links)
+{
+	static const enum vertextype vtypes[] = {VTYPE_NONPSEUDO_TE_IS,
+						 VTYPE_NONPSEUDO_IS};
+	struct isis_spf_node *node;
+	struct isis_vertex *vertex;
+	uint8_t id[ISIS_SYS_ID_LEN + 1] = {};
+
+	RB_FOREACH (node, isis_spf_nodes, links) {
+		memcpy(id, node->sysid, ISIS_SYS_ID_LEN);
+
+		for (unsigned int i = 0; i < array_size(vtypes); i++) {
+			/* Not being in PATHS, its links are not used */
+			vertex = isis_find_vertex(&spftree->paths, id,
+						  vtypes[i]);
+			if (vertex
+			    && !spf_vertex_links_unchanged(spftree, vertex))
+				return false;
+		}
+	}
+
+	return true;
+}
+
+/*
+ * Whether a partial run of the tree can take in the given changes: the tree
+ * has run before, and the new link metrics leave the SPT of that run as it is.
+ */
+bool isis_spf_prc_tree_possible(struct isis_spftree *spftree,
+				struct isis_spf_changes *changes)
+{
+	return spftree->runcount
+	       && isis_spf_links_unchanged(spftree, &changes->links);
+}
+
+/*
+ * Whether the next SPF run of a level can be a partial route calculation.
+ * It has to be done in full after any topology change, and when what only a
+ * full run takes care of is enabled: L1L2 route merging, flex-algo, SR,
+ * LFA and dst-src routing.
+ */
+static bool isis_spf_prc_possible(struct isis_area *area, int level)
+{
+#ifndef FABRICD
+	struct isis_spf_changes *changes = &area->spf_changes[level - 1];
+	struct isis_spftree *spftree;
+	struct isis_circuit *circuit;
+	struct listnode *node;
+
+	if (changes->full)
+		return false;
+
+	if (area->is_type == IS_LEVEL_1_AND_2
+	    || listcount(area->flex_algos->flex_algos) || area->srdb.enabled
+	    || area->srv6db.config.enabled
+	    || area->lfa_protected_links[level - 1]
+	    || area->rlfa_protected_links[level - 1]
+	    || area->tilfa_protected_links[level - 1]
+	    || isis_area_ipv6_dstsrc_enabled(area))
+		return false;
+
+	for (ALL_LIST_ELEMENTS_RO(area->circuit_list, node, circuit))
+		if (CHECK_FLAG(circuit->flags, ISIS_CIRCUIT_FLAPPED_AFTER_SPF))
+			return false;
+
+	for (int tree = SPFTREE_IPV4; tree <= SPFTREE_IPV6; tree++) {
+		if (!(tree == SPFTREE_IPV4 ? area->ip_circuits
+					   : area->ipv6_circuits))
+			continue;
+
+		spftree = area->spftree[tree][level - 1];
+		if (!isis_spf_prc_tree_possible(spftree, changes))
+			return false;
+	}
+
+	return true;
+#else
+	return false;
+#endif /* ifndef FABRICD */
+}
+
+/* Whether a vertex in PATHS is one a partial run recomputes */
+static bool isis_spf_prc_vertex(struct isis_spftree *spftree,
+				struct isis_vertex *vertex)
+{
+	return VTYPE_IP(vertex->type)
+	       && !isis_spf_prc_skip(spftree, vertex->type, &vertex->N.ip.p);
+}
+
+static bool spf_path_counted(struct isis_spftree *spftree,
+			     struct isis_vertex *vertex)
+{
+	switch (vertex->type) {
+	case VTYPE_IPREACH_INTERNAL:
+	case VTYPE_IPREACH_EXTERNAL:
+		if (isis_find_vertex(&spftree->paths, &vertex->N,
+				     VTYPE_IPREACH_TE))
+			return false;
+		break;
+	case VTYPE_PSEUDO_IS:
+	case VTYPE_PSEUDO_TE_IS:
+	case VTYPE_NONPSEUDO_IS:
+	case VTYPE_NONPSEUDO_TE_IS:
+	case VTYPE_ES:
+	case VTYPE_IPREACH_TE:
+	case VTYPE_IP6REACH_INTERNAL:
+	case VTYPE_IP6REACH_EXTERNAL:
+		break;
+	}
+
+	return vertex->depth > 1 && listcount(vertex->Adj_N) > 0;
+}
+
+/*
+ * Partial route calculation: recompute the routes to the given prefixes only,
+ * over the SPT of the last run, which no change since then has affected.
+ * The vertices of those prefixes are taken out of PATHS, offered again by
+ * the root and by every system in PATHS, and zebra gets the routes that
+ * differ.
+ */
+void isis_run_prc(struct isis_spftree *spftree, struct route_table *prefixes)
+{
+	struct isis_area *area = spftree->area;
+	struct isis_vertex *vertex, *root;
+	struct isis_lsp *root_lsp, *lsp;
+	struct listnode *node, *nnode;
+	struct timeval time_start;
+	struct timeval time_end;
+	struct list *added;
+	enum spf_prefix_priority priority;
+
+	if (!route_table_count(prefixes))
+		return;
+
+	monotime(&time_start);
+
+	root_lsp = isis_root_system_lsp(spftree->lspdb, spftree->sysid);
+	if (!root_lsp || !isis_vertex_queue_count(&spftree->paths))
+		return;
+	root = isis_vertex_queue_first(&spftree->paths);
+
+	spftree->prc_prefixes = prefixes;
+
+	for (ALL_QUEUE_ELEMENTS_RO(&spftree->paths, node, vertex)) {
+		if (!isis_spf_prc_vertex(spftree, vertex)
+		    || !spf_path_counted(spftree, vertex))
+			continue;
+
+		priority = vertex->N.ip.priority;
+		spftree->lfa.protection_counters.total[priority] -= 1;
+		if (listcount(vertex->Adj_N) > 1)
+			spftree->lfa.protection_counters.ecmp[priority] -= 1;
+	}
+	for (ALL_QUEUE_ELEMENTS(&spftree->paths, node, nnode, vertex)) {
+		if (!isis_spf_prc_vertex(spftree, vertex))
+			continue;
+
+		isis_vertex_queue_remove(&spftree->paths, node);
+		isis_vertex_del(spftree, vertex);
+	}
+	isis_route_invalidate_prefixes(area, spftree->route_table, prefixes);
+
+	isis_spf_preload_tent(spftree, spftree->sysid, root_lsp, root);
+	for (ALL_QUEUE_ELEMENTS_RO(&spftree->paths, node, vertex)) {
+		if (!VTYPE_IS(vertex->type) || vertex == root)
+			continue;
+
+		lsp = lsp_for_vertex(spftree, vertex);
+		if (lsp)
+			isis_spf_process_lsp(spftree, lsp, vertex->d_N,
+					     vertex->depth, spftree->sysid,
+					     vertex);
+	}
+
+	added = list_new();
+	while (isis_vertex_queue_count(&spftree->tents)) {
+		vertex = isis_vertex_queue_pop(&spftree->tents);
+		add_to_paths(spftree, vertex);
+		listnode_add(added, vertex);
+	}
+	for (ALL_LIST_ELEMENTS_RO(added, node, vertex)) {
+		/* New-style TLVs take precedence over the old-style TLVs. */
+		if ((vertex->type == VTYPE_IPREACH_INTERNAL
+		     || vertex->type == VTYPE_IPREACH_EXTERNAL)
+		    && isis_find_vertex(&spftree->paths, &vertex->N,
+					VTYPE_IPREACH_TE))
+			continue;
+
+		spf_path_process(spftree, vertex);
+	}
+	list_delete(&added);
+
+	spftree->prc_prefixes = NULL;
+	isis_route_verify_prefixes(area, spftree->route_table, prefixes);
+
+	spftree->prc_runcount++;
+	spftree->last_run_timestamp = time(NULL);
+	spftree->last_run_monotime = monotime(&time_end);
+	spftree->last_run_duration =
+		((time_end.tv_sec - time_start.tv_sec) * 1000000)
+		+ (time_end.tv_usec - time_start.tv_usec);
+}
+
 static void isis_run_spf_cb(struct event *thread)
 {
 	struct isis_spf_run *run = EVENT_ARG(thread);
 	struct isis_area *area = run->area;
 	int level = run->level;
 	int have_run = 0;
+	struct isis_spf_changes *changes;
 	struct listnode *node;
 	struct isis_circuit *circuit;
 #ifndef FABRICD
@@ -2079,6 +2857,23 @@ static void isis_run_spf_cb(struct event *thread)
 		return;
 	}
 
+	changes = &area->spf_changes[level - 1];
+	if (isis_spf_prc_possible(area, level)) {
+		if (IS_DEBUG_SPF_EVENTS)
+			zlog_debug(
+				"ISIS-SPF (%s) L%d partial route calculation",
+				area->area_tag, level);
+
+		if (area->ip_circuits)
+			isis_run_prc(area->spftree[SPFTREE_IPV4][level - 1],
+				     changes->prefixes4);
+		if (area->ipv6_circuits)
+			isis_run_prc(area->spftree[SPFTREE_IPV6][level - 1],
+				     changes->prefixes6);
+		isis_spf_changes_reset(changes);
+		return;
+	}
+
 	isis_area_delete_backup_adj_sids(area, level);
 	isis_area_invalidate_routes(area, level);
 
@@ -2122,6 +2917,7 @@ static void isis_run_spf_cb(struct event *thread)
 		area->spf_run_count[level]++;
 
 	isis_area_verify_routes(area);
+	isis_spf_changes_reset(changes);
 
 	/* walk all circuits and reset any spf specific flags */
 	for (ALL_LIST_ELEMENTS_RO(area->circuit_list, node, circuit))
@@ -2145,7 +2941,7 @@ void isis_spf_timer_free(void *run)
 	XFREE(MTYPE_ISIS_SPF_RUN, run);
 }
 
-int _isis_spf_schedule(struct isis_area *area, int level,
+int _isis_spf_schedule(struct isis_area *area, int level, bool full,
 		       const char *func, const char *file, int line)
 {
 	struct isis_spftree *spftree;
@@ -2153,6 +2949,9 @@ int _isis_spf_schedule(struct isis_area *area, int level,
 	long tree_diff, diff;
 	int tree;
 
+	if (full)
+		area->spf_changes[level - 1].full = true;
+
 	now = monotime(NULL);
 	diff = 0;
 	for (tree = SPFTREE_IPV4; tree < SPFTREE_COUNT; tree++) {
@@ -3415,6 +4214,8 @@ void isis_spf_print(struct isis_spftree *spftree, struct vty *vty)
 		last_run_duration);
 
 	vty_out(vty, "      run count         : %u\n", spftree->runcount);
+	vty_out(vty, "      partial run count : %u\n",
+		spftree->prc_runcount);
 }
 void isis_spf_print_json(struct isis_spftree *spftree, struct json_object *json)
 {
@@ -3427,4 +4228,5 @@ void isis_spf_print_json(struct isis_spftree *spftree, struct json_object *json)
 	json_object_int_add(json, "last-run-duration-usec",
 			    spftree->last_run_duration);
 	json_object_int_add(json, "last-run-count", spftree->runcount);
+	json_object_int_add(json, "partial-run-count", spftree->prc_runcount);
 }
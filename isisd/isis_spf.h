@@ -15,6 +15,8 @@
 #include "lib/json.h"
 
 struct isis_spftree;
+struct isis_spf_changes;
+struct route_table;
 
 enum spf_type {
 	SPF_TYPE_FORWARD = 1,
@@ -57,10 +59,21 @@ void spftree_area_del(struct isis_area *area);
 struct isis_lsp *isis_root_system_lsp(struct lspdb_head *lspdb,
 				      const uint8_t *sysid);
 #define isis_spf_schedule(area, level) \
-	_isis_spf_schedule((area), (level), __func__, \
+	_isis_spf_schedule((area), (level), true, __func__, \
 			   __FILE__, __LINE__)
-int _isis_spf_schedule(struct isis_area *area, int level,
+/* For LSP changes isis_spf_lsp_changed() took note of */
+#define isis_spf_schedule_partial(area, level) \
+	_isis_spf_schedule((area), (level), false, __func__, \
+			   __FILE__, __LINE__)
+int _isis_spf_schedule(struct isis_area *area, int level, bool full,
 		       const char *func, const char *file, int line);
+void isis_spf_changes_init(struct isis_area *area);
+void isis_spf_changes_fini(struct isis_area *area);
+bool isis_spf_lsp_changed(struct isis_lsp *lsp, struct isis_lsp_hdr *hdr,
+			  struct isis_tlvs *tlvs, struct stream *stream);
+bool isis_spf_prc_tree_possible(struct isis_spftree *spftree,
+				struct isis_spf_changes *changes);
+void isis_run_prc(struct isis_spftree *spftree, struct route_table *prefixes);
 void isis_print_spftree(struct vty *vty, struct isis_spftree *spftree);
 void isis_print_routes(struct vty *vty, struct isis_spftree *spftree,
 		       json_object **json, bool prefix_sid, bool backup);
@@ -12,7 +12,7 @@
 
 #include "hash.h"
 #include "jhash.h"
-#include "skiplist.h"
+#include "typesafe.h"
 #include "lib_errors.h"
 
 enum vertextype {
@@ -44,6 +44,8 @@ struct isis_vertex_adj {
 	uint32_t lfa_metric;
 };
 
+PREDECL_HEAP(isis_vertex_tent);
+
 /*
  * Triple <N, d(N), {Adj(N)}>
  */
@@ -63,15 +65,36 @@ struct isis_vertex {
 	struct list *parents;  /* list of parents for ECMP */
 	struct hash *firsthops; /* first two hops to neighbor */
 	uint64_t insert_counter;
+	struct isis_vertex_tent_item tent_item; /* TENT heap position */
+	struct isis_vertex *arena_next;		/* arena free list */
 	uint8_t flags;
 };
 #define F_ISIS_VERTEX_LFA_PROTECTED	0x01
 
+/*
+ * Vertices are carved out of chunks owned by the spftree. They all go back
+ * to the arena when the next run starts, keeping the lists they point to
+ * allocated, so a run on an unchanged topology allocates no vertices.
+ */
+#define ISIS_VERTEX_CHUNK_SIZE 128
+
+struct isis_vertex_chunk {
+	struct isis_vertex_chunk *next;
+	struct isis_vertex vertices[ISIS_VERTEX_CHUNK_SIZE];
+};
+
+struct isis_vertex_arena {
+	struct isis_vertex_chunk *chunks;  /* all of them, in carving order */
+	struct isis_vertex_chunk *current; /* being carved, NULL when none */
+	unsigned int used;		   /* vertices carved from current */
+	struct isis_vertex *free;	   /* deleted during this run */
+};
+
 /* Vertex Queue and associated functions */
 
 struct isis_vertex_queue {
 	union {
-		struct skiplist *slist;
+		struct isis_vertex_tent_head heap;
 		struct list *list;
 	} l;
 	struct hash *hash;
@@ -145,11 +168,8 @@ __attribute__((__unused__)) static int isis_vertex_queue_tent_cmp(const void *a,
 	return 0;
 }
 
-__attribute__((__unused__))
-static struct skiplist *isis_vertex_queue_skiplist(void)
-{
-	return skiplist_new(0, isis_vertex_queue_tent_cmp, NULL);
-}
+DECLARE_HEAP(isis_vertex_tent, struct isis_vertex, tent_item,
+	     isis_vertex_queue_tent_cmp);
 
 __attribute__((__unused__))
 static void isis_vertex_queue_init(struct isis_vertex_queue *queue,
@@ -157,7 +177,7 @@ static void isis_vertex_queue_init(struct isis_vertex_queue *queue,
 {
 	if (ordered) {
 		queue->insert_counter = 1;
-		queue->l.slist = isis_vertex_queue_skiplist();
+		isis_vertex_tent_init(&queue->l.heap);
 	} else {
 		queue->insert_counter = 0;
 		queue->l.list = list_new();
@@ -166,7 +186,9 @@ static void isis_vertex_queue_init(struct isis_vertex_queue *queue,
 				  isis_vertex_queue_hash_cmp, name);
 }
 
-void isis_vertex_del(struct isis_vertex *vertex);
+void isis_vertex_del(struct isis_spftree *spftree,
+		     struct isis_vertex *vertex);
+void isis_vertex_arena_fini(struct isis_vertex_arena *arena);
 
 bool isis_vertex_adj_exists(const struct isis_spftree *spftree,
 			    const struct isis_vertex *vertex,
@@ -177,24 +199,18 @@ isis_vertex_adj_add(struct isis_spftree *spftree, struct isis_vertex *vertex,
 		    struct list *vadj_list, struct isis_spf_adj *sadj,
 		    struct isis_prefix_sid *psid, bool last_hop);
 
+/* The vertices themselves belong to the spftree's arena */
 __attribute__((__unused__))
 static void isis_vertex_queue_clear(struct isis_vertex_queue *queue)
 {
 	hash_clean(queue->hash, NULL);
 
 	if (queue->insert_counter) {
-		struct isis_vertex *vertex;
-		while (0 == skiplist_first(queue->l.slist, NULL,
-					   (void **)&vertex)) {
-			isis_vertex_del(vertex);
-			skiplist_delete_first(queue->l.slist);
-		}
+		while (isis_vertex_tent_pop(&queue->l.heap))
+			;
 		queue->insert_counter = 1;
-	} else {
-		queue->l.list->del = (void (*)(void *))isis_vertex_del;
+	} else
 		list_delete_all_node(queue->l.list);
-		queue->l.list->del = NULL;
-	}
 }
 
 __attribute__((__unused__))
@@ -205,10 +221,9 @@ static void isis_vertex_queue_free(struct isis_vertex_queue *queue)
 	hash_free(queue->hash);
 	queue->hash = NULL;
 
-	if (queue->insert_counter) {
-		skiplist_free(queue->l.slist);
-		queue->l.slist = NULL;
-	} else
+	if (queue->insert_counter)
+		isis_vertex_tent_fini(&queue->l.heap);
+	else
 		list_delete(&queue->l.list);
 }
 
@@ -232,6 +247,18 @@ static void isis_vertex_queue_append(struct isis_vertex_queue *queue,
 	assert(inserted == vertex);
 }
 
+__attribute__((__unused__))
+static struct isis_vertex *
+isis_vertex_queue_first(struct isis_vertex_queue *queue)
+{
+	struct listnode *head;
+
+	assert(!queue->insert_counter);
+	head = listhead(queue->l.list);
+	assert(head);
+	return listgetdata(head);
+}
+
 __attribute__((__unused__))
 static struct isis_vertex *isis_vertex_queue_last(struct isis_vertex_queue *queue)
 {
@@ -251,7 +278,7 @@ static void isis_vertex_queue_insert(struct isis_vertex_queue *queue,
 	vertex->insert_counter = queue->insert_counter++;
 	assert(queue->insert_counter != (uint64_t)-1);
 
-	skiplist_insert(queue->l.slist, vertex, vertex);
+	isis_vertex_tent_add(&queue->l.heap, vertex);
 
 	struct isis_vertex *inserted;
 	inserted = hash_get(queue->hash, vertex, hash_alloc_intern);
@@ -266,10 +293,10 @@ isis_vertex_queue_pop(struct isis_vertex_queue *queue)
 
 	struct isis_vertex *rv;
 
-	if (skiplist_first(queue->l.slist, NULL, (void **)&rv))
+	rv = isis_vertex_tent_pop(&queue->l.heap);
+	if (!rv)
 		return NULL;
 
-	skiplist_delete_first(queue->l.slist);
 	hash_release(queue->hash, rv);
 
 	return rv;
@@ -281,18 +308,32 @@ static void isis_vertex_queue_delete(struct isis_vertex_queue *queue,
 {
 	assert(queue->insert_counter);
 
-	skiplist_delete(queue->l.slist, vertex, vertex);
+	isis_vertex_tent_del(&queue->l.heap, vertex);
 	hash_release(queue->hash, vertex);
 }
 
+__attribute__((__unused__))
+static void isis_vertex_queue_remove(struct isis_vertex_queue *queue,
+				     struct listnode *node)
+{
+	assert(!queue->insert_counter);
+
+	hash_release(queue->hash, listgetdata(node));
+	list_delete_node(queue->l.list, node);
+}
+
 #define ALL_QUEUE_ELEMENTS_RO(queue, node, data)                               \
 	ALL_LIST_ELEMENTS_RO((queue)->l.list, node, data)
+#define ALL_QUEUE_ELEMENTS(queue, node, nnode, data)                           \
+	ALL_LIST_ELEMENTS((queue)->l.list, node, nnode, data)
 
 /* End of vertex queue definitions */
 
 struct isis_spftree {
 	struct isis_vertex_queue paths; /* the SPT */
 	struct isis_vertex_queue tents; /* TENT */
+	struct isis_vertex_arena vertices; /* backing both of them */
+	struct route_table *prc_prefixes; /* what a partial run recomputes */
 	struct route_table *route_table;
 	struct route_table *route_table_backup;
 	struct lspdb_head *lspdb; /* link-state db */
@@ -301,6 +342,7 @@ struct isis_spftree {
 	struct isis_spf_nodes adj_nodes;
 	struct isis_area *area;    /* back pointer to area */
 	unsigned int runcount;     /* number of runs since uptime */
+	unsigned int prc_runcount; /* number of partial runs since uptime */
 	time_t last_run_timestamp; /* last run timestamp as wall time for display */
 	time_t last_run_monotime;  /* last run as monotime for scheduling */
 	time_t last_run_duration;  /* last run duration in msec */
@@ -326,6 +326,7 @@ struct isis_area *isis_area_create(const char *area_tag, const char *vrf_name)
 #endif /* ifndef FABRICD */
 
 	spftree_area_init(area);
+	isis_spf_changes_init(area);
 
 	area->circuit_list = list_new();
 	area->adjacency_list = list_new();
@@ -531,6 +532,7 @@ void isis_area_destroy(struct isis_area *area)
 	isis_mpls_te_term(area);
 
 	spftree_area_del(area);
+	isis_spf_changes_fini(area);
 
 	if (area->spf_timer[0])
 		isis_spf_timer_free(EVENT_ARG(area->spf_timer[0]));
@@ -3057,6 +3059,8 @@ void isis_area_invalidate_routes(struct isis_area *area, int levels)
 	for (int level = ISIS_LEVEL1; level <= ISIS_LEVEL2; level++) {
 		if (!(level & levels))
 			continue;
+		/* Only a full SPF run can bring the routes back */
+		area->spf_changes[level - 1].full = true;
 		for (int tree = SPFTREE_IPV4; tree < SPFTREE_COUNT; tree++) {
 			isis_spf_invalidate_routes(
 					area->spftree[tree][level - 1]);
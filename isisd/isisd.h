@@ -115,6 +115,20 @@ struct lsp_refresh_arg {
 	int level;
 };
 
+/*
+ * LSPDB changes seen since the last SPF run of a level, telling whether the
+ * next one can be a partial route calculation. See isis_spf_lsp_changed().
+ */
+struct isis_spf_changes {
+	/* Some change needs a full SPF run */
+	bool full;
+	/* Prefixes whose advertisements changed */
+	struct route_table *prefixes4;
+	struct route_table *prefixes6;
+	/* Systems whose IS reachability metrics changed */
+	struct isis_spf_nodes links;
+};
+
 /* for yang configuration */
 enum isis_metric_style {
 	ISIS_NARROW_METRIC = 0,
@@ -241,6 +255,7 @@ struct isis_area {
 							    SPF algo
 							    parameters*/
 	struct event *spf_timer[ISIS_LEVELS];
+	struct isis_spf_changes spf_changes[ISIS_LEVELS];
 
 	struct lsp_refresh_arg lsp_refresh_arg[ISIS_LEVELS];
 
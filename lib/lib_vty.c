@@ -21,6 +21,7 @@
 
 #include "log.h"
 #include "memory.h"
+#include "mempool.h"
 #include "module.h"
 #include "defaults.h"
 #include "lib_vty.h"
@@ -112,6 +113,31 @@ static int qmem_walker(void *arg, struct memgroup *mg, struct memtype *mt)
 	return 0;
 }
 
+static int mempool_walker(void *arg, struct mempool *mp)
+{
+	struct vty *vty = arg;
+	struct mempool_stats st;
+
+	if (!mp) {
+		vty_out(vty, "--- memory pools ---\n");
+		vty_out(vty, "%-30s: %6s %7s %9s %9s %5s %5s %9s\n", "Type",
+			"Size", "Slabs", "Used#", "Capacity", "Util%", "Frag%",
+			"IdleBytes");
+		return 0;
+	}
+
+	mempool_stats_get(mp, &st);
+	if (!st.slabs_max && !st.used)
+		return 0;
+
+	vty_out(vty, "%-30s: %6zu %7zu %9zu %9zu %5zu %5zu %9zu\n",
+		mp->mt->name, st.objsize, st.slabs, st.used, st.capacity,
+		st.capacity ? st.used * 100 / st.capacity : 0,
+		st.capacity ? st.fragmented * 100 / st.capacity : 0,
+		st.idle_bytes);
+	return 0;
+}
+
 
 DEFUN_NOSH (show_memory,
 	    show_memory_cmd,
@@ -124,6 +150,7 @@ DEFUN_NOSH (show_memory,
 #endif /* HAVE_MALLINFO */
 
 	qmem_walk(qmem_walker, vty);
+	mempool_walk(mempool_walker, vty);
 	return CMD_SUCCESS;
 }
 
@@ -27,7 +27,8 @@ DEFINE_MGROUP(LIB, "libfrr");
 DEFINE_MTYPE(LIB, TMP, "Temporary memory");
 DEFINE_MTYPE(LIB, BITFIELD, "Bitfield memory");
 
-static inline void mt_count_alloc(struct memtype *mt, size_t size, void *ptr)
+static inline void mt_count_alloc(struct memtype *mt, size_t size,
+				  size_t usable)
 {
 	size_t current;
 	size_t oldsize;
@@ -52,10 +53,8 @@ static inline void mt_count_alloc(struct memtype *mt, size_t size, void *ptr)
 				      memory_order_relaxed);
 
 #ifdef HAVE_MALLOC_USABLE_SIZE
-	size_t mallocsz = malloc_usable_size(ptr);
-
-	current = mallocsz + atomic_fetch_add_explicit(&mt->total, mallocsz,
-						       memory_order_relaxed);
+	current = usable + atomic_fetch_add_explicit(&mt->total, usable,
+						     memory_order_relaxed);
 	oldsize = atomic_load_explicit(&mt->max_size, memory_order_relaxed);
 	if (current > oldsize)
 		/* note that this may fail, but approximation is sufficient */
@@ -66,20 +65,32 @@ static inline void mt_count_alloc(struct memtype *mt, size_t size, void *ptr)
 #endif
 }
 
-static inline void mt_count_free(struct memtype *mt, void *ptr)
+static inline void mt_count_free(struct memtype *mt, size_t usable)
 {
-	frrtrace(2, frr_libfrr, memfree, mt, ptr);
-
 	assert(mt->n_alloc);
 	atomic_fetch_sub_explicit(&mt->n_alloc, 1, memory_order_relaxed);
 
 #ifdef HAVE_MALLOC_USABLE_SIZE
-	size_t mallocsz = malloc_usable_size(ptr);
+	atomic_fetch_sub_explicit(&mt->total, usable, memory_order_relaxed);
+#endif
+}
 
-	atomic_fetch_sub_explicit(&mt->total, mallocsz, memory_order_relaxed);
+static inline size_t mt_usable_size(void *ptr)
+{
+#ifdef HAVE_MALLOC_USABLE_SIZE
+	return malloc_usable_size(ptr);
+#else
+	return 0;
 #endif
 }
 
+static inline void mt_count_free_ptr(struct memtype *mt, void *ptr)
+{
+	frrtrace(2, frr_libfrr, memfree, mt, ptr);
+
+	mt_count_free(mt, mt_usable_size(ptr));
+}
+
 static inline void *mt_checkalloc(struct memtype *mt, void *ptr, size_t size)
 {
 	frrtrace(3, frr_libfrr, memalloc, mt, ptr, size);
@@ -91,7 +102,7 @@ static inline void *mt_checkalloc(struct memtype *mt, void *ptr, size_t size)
 		}
 		return NULL;
 	}
-	mt_count_alloc(mt, size, ptr);
+	mt_count_alloc(mt, size, mt_usable_size(ptr));
 	return ptr;
 }
 
@@ -108,7 +119,7 @@ void *qcalloc(struct memtype *mt, size_t size)
 void *qrealloc(struct memtype *mt, void *ptr, size_t size)
 {
 	if (ptr)
-		mt_count_free(mt, ptr);
+		mt_count_free_ptr(mt, ptr);
 	return mt_checkalloc(mt, ptr ? realloc(ptr, size) : malloc(size), size);
 }
 
@@ -120,16 +131,26 @@ void *qstrdup(struct memtype *mt, const char *str)
 void qcountfree(struct memtype *mt, void *ptr)
 {
 	if (ptr)
-		mt_count_free(mt, ptr);
+		mt_count_free_ptr(mt, ptr);
 }
 
 void qfree(struct memtype *mt, void *ptr)
 {
 	if (ptr)
-		mt_count_free(mt, ptr);
+		mt_count_free_ptr(mt, ptr);
 	free(ptr);
 }
 
+void qcountalloc_sized(struct memtype *mt, size_t size)
+{
+	mt_count_alloc(mt, size, size);
+}
+
+void qcountfree_sized(struct memtype *mt, size_t size)
+{
+	mt_count_free(mt, size);
+}
+
 int qmem_walk(qmem_walk_fn *func, void *arg)
 {
 	struct memgroup *mg;
@@ -152,6 +152,12 @@ extern void qcountfree(struct memtype *mt, void *ptr)
 	__attribute__((nonnull(1)));
 extern void qfree(struct memtype *mt, void *ptr) __attribute__((nonnull(1)));
 
+/* accounting only, for memory not obtained from malloc (cf. mempool.h) */
+extern void qcountalloc_sized(struct memtype *mt, size_t size)
+	__attribute__((nonnull(1)));
+extern void qcountfree_sized(struct memtype *mt, size_t size)
+	__attribute__((nonnull(1)));
+
 #define XMALLOC(mtype, size)		qmalloc(mtype, size)
 #define XCALLOC(mtype, size)		qcalloc(mtype, size)
 #define XREALLOC(mtype, ptr, size)	qrealloc(mtype, ptr, size)
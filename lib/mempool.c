@@ -0,0 +1,281 @@
+// SPDX-License-Identifier: ISC
+/*
+ * Fixed size object pools ("slabs") with MTYPE accounting.
+ *
+ * Each pool carves objects of one size out of MEMPOOL_SLAB_SIZE chunks.
+ * Compared to one malloc() per object this drops the per-allocation
+ * header, keeps objects of the same kind close together, and lets
+ * completely unused slabs go back to the system as a whole.
+ */
+
+#include <zebra.h>
+
+#include "memory.h"
+#include "mempool.h"
+#include "frr_pthread.h"
+
+/* Under AddressSanitizer every object is a separate allocation, otherwise
+ * use-after-free inside a slab would go unnoticed.
+ */
+#if defined(__SANITIZE_ADDRESS__)
+#define MEMPOOL_PASSTHROUGH
+#elif defined(__has_feature)
+#if __has_feature(address_sanitizer)
+#define MEMPOOL_PASSTHROUGH
+#endif
+#endif
+
+#define MEMPOOL_ALIGN (2 * sizeof(void *))
+#define MEMPOOL_ROUNDUP(x) (((x) + MEMPOOL_ALIGN - 1) & ~(MEMPOOL_ALIGN - 1))
+
+struct mempool_slab {
+	struct mempool_slab *next, **prevp;
+	struct mempool *mp;
+
+	/* freed objects, linked through their first word */
+	void *free_list;
+	/* objects never handed out start at index carved */
+	unsigned int carved;
+	unsigned int used;
+};
+
+#define MEMPOOL_SLAB_HDR MEMPOOL_ROUNDUP(sizeof(struct mempool_slab))
+
+static struct mempool *mp_first;
+static pthread_mutex_t mp_list_mtx = PTHREAD_MUTEX_INITIALIZER;
+
+void mempool_register(struct mempool *mp)
+{
+	frr_with_mutex (&mp_list_mtx) {
+		mp->next = mp_first;
+		if (mp_first)
+			mp_first->ref = &mp->next;
+		mp->ref = &mp_first;
+		mp_first = mp;
+	}
+}
+
+static void mempool_slab_link(struct mempool_slab **head,
+			      struct mempool_slab *slab)
+{
+	slab->next = *head;
+	if (*head)
+		(*head)->prevp = &slab->next;
+	slab->prevp = head;
+	*head = slab;
+}
+
+static void mempool_slab_unlink(struct mempool_slab *slab)
+{
+	*slab->prevp = slab->next;
+	if (slab->next)
+		slab->next->prevp = slab->prevp;
+	slab->next = NULL;
+	slab->prevp = NULL;
+}
+
+static void mempool_slab_free(struct mempool *mp, struct mempool_slab *slab)
+{
+	mp->n_slabs--;
+	free(slab);
+}
+
+void mempool_unregister(struct mempool *mp)
+{
+	struct mempool_slab *slab;
+
+	frr_with_mutex (&mp_list_mtx) {
+		if (mp->next)
+			mp->next->ref = mp->ref;
+		*mp->ref = mp->next;
+	}
+
+	/* Anything still allocated at this point is reported as a leak of
+	 * the pool's MTYPE, the slabs themselves are released regardless.
+	 */
+	frr_with_mutex (&mp->mtx) {
+		while ((slab = mp->partial)) {
+			mempool_slab_unlink(slab);
+			mempool_slab_free(mp, slab);
+		}
+		while ((slab = mp->full)) {
+			mempool_slab_unlink(slab);
+			mempool_slab_free(mp, slab);
+		}
+		if (mp->spare) {
+			mempool_slab_free(mp, mp->spare);
+			mp->spare = NULL;
+		}
+	}
+}
+
+static void mempool_setup(struct mempool *mp)
+{
+	mp->objsize = MEMPOOL_ROUNDUP(MAX(mp->size, sizeof(void *)));
+	mp->per_slab = (MEMPOOL_SLAB_SIZE - MEMPOOL_SLAB_HDR) / mp->objsize;
+
+	/* pools are meant for small, numerous objects */
+	assert(mp->per_slab >= 16);
+}
+
+#ifdef MEMPOOL_PASSTHROUGH
+void *mempool_alloc(struct mempool *mp)
+{
+	frr_with_mutex (&mp->mtx) {
+		if (!mp->objsize)
+			mempool_setup(mp);
+		mp->n_used++;
+	}
+	return qcalloc(mp->mt, mp->size);
+}
+
+void mempool_free(struct mempool *mp, void *ptr)
+{
+	if (!ptr)
+		return;
+
+	frr_with_mutex (&mp->mtx) {
+		mp->n_used--;
+	}
+	qfree(mp->mt, ptr);
+}
+#else /* !MEMPOOL_PASSTHROUGH */
+static struct mempool_slab *mempool_slab_new(struct mempool *mp)
+{
+	struct mempool_slab *slab;
+	void *mem;
+
+	if (posix_memalign(&mem, MEMPOOL_SLAB_SIZE, MEMPOOL_SLAB_SIZE))
+		memory_oom(MEMPOOL_SLAB_SIZE, mp->mt->name);
+
+	slab = mem;
+	memset(slab, 0, sizeof(*slab));
+	slab->mp = mp;
+
+	mp->n_slabs++;
+	if (mp->n_slabs > mp->n_slabs_max)
+		mp->n_slabs_max = mp->n_slabs;
+
+	return slab;
+}
+
+static inline struct mempool_slab *mempool_slab_of(void *ptr)
+{
+	return (struct mempool_slab *)((uintptr_t)ptr &
+				       ~((uintptr_t)MEMPOOL_SLAB_SIZE - 1));
+}
+
+void *mempool_alloc(struct mempool *mp)
+{
+	struct mempool_slab *slab;
+	void *ptr;
+
+	frr_with_mutex (&mp->mtx) {
+		if (!mp->objsize)
+			mempool_setup(mp);
+
+		slab = mp->partial;
+		if (!slab) {
+			if (mp->spare) {
+				slab = mp->spare;
+				mp->spare = NULL;
+			} else
+				slab = mempool_slab_new(mp);
+			mempool_slab_link(&mp->partial, slab);
+		}
+
+		if (slab->free_list) {
+			ptr = slab->free_list;
+			slab->free_list = *(void **)ptr;
+		} else
+			ptr = (char *)slab + MEMPOOL_SLAB_HDR +
+			      (size_t)slab->carved++ * mp->objsize;
+
+		if (++slab->used == mp->per_slab) {
+			mempool_slab_unlink(slab);
+			mempool_slab_link(&mp->full, slab);
+		}
+		mp->n_used++;
+	}
+
+	memset(ptr, 0, mp->size);
+	qcountalloc_sized(mp->mt, mp->objsize);
+	return ptr;
+}
+
+void mempool_free(struct mempool *mp, void *ptr)
+{
+	struct mempool_slab *slab;
+
+	if (!ptr)
+		return;
+
+	slab = mempool_slab_of(ptr);
+	assert(slab->mp == mp);
+
+	qcountfree_sized(mp->mt, mp->objsize);
+
+	frr_with_mutex (&mp->mtx) {
+		*(void **)ptr = slab->free_list;
+		slab->free_list = ptr;
+		mp->n_used--;
+
+		if (slab->used-- == mp->per_slab) {
+			mempool_slab_unlink(slab);
+			mempool_slab_link(&mp->partial, slab);
+		}
+
+		if (!slab->used) {
+			mempool_slab_unlink(slab);
+			if (mp->spare)
+				mempool_slab_free(mp, slab);
+			else {
+				/* carve front to back again when reused */
+				slab->free_list = NULL;
+				slab->carved = 0;
+				mp->spare = slab;
+			}
+		}
+	}
+}
+#endif /* !MEMPOOL_PASSTHROUGH */
+
+void mempool_stats_get(struct mempool *mp, struct mempool_stats *stats)
+{
+	memset(stats, 0, sizeof(*stats));
+
+	frr_with_mutex (&mp->mtx) {
+		stats->objsize = mp->objsize ? mp->objsize
+					     : MEMPOOL_ROUNDUP(mp->size);
+		stats->slabs = mp->n_slabs;
+		stats->slabs_max = mp->n_slabs_max;
+		stats->used = mp->n_used;
+#ifdef MEMPOOL_PASSTHROUGH
+		stats->capacity = mp->n_used;
+#else
+		stats->capacity = mp->n_slabs * mp->per_slab;
+		stats->fragmented = stats->capacity - mp->n_used;
+		if (mp->spare)
+			stats->fragmented -= mp->per_slab;
+		stats->idle_bytes = mp->n_slabs * MEMPOOL_SLAB_SIZE -
+				    mp->n_used * mp->objsize;
+#endif
+	}
+}
+
+int mempool_walk(mempool_walk_fn *func, void *arg)
+{
+	struct mempool *mp;
+	int rv;
+
+	frr_with_mutex (&mp_list_mtx) {
+		if (!mp_first)
+			break;
+		if ((rv = func(arg, NULL)))
+			return rv;
+		for (mp = mp_first; mp; mp = mp->next)
+			if ((rv = func(arg, mp)))
+				return rv;
+	}
+	return 0;
+}
@@ -0,0 +1,133 @@
+// SPDX-License-Identifier: ISC
+/*
+ * Fixed size object pools ("slabs") with MTYPE accounting.
+ */
+
+#ifndef _FRR_MEMPOOL_H
+#define _FRR_MEMPOOL_H
+
+#include <pthread.h>
+
+#include "memory.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Objects are carved out of naturally aligned slabs of this size, so the
+ * owning slab of an object is found by masking its address.
+ */
+#define MEMPOOL_SLAB_SIZE (64U * 1024U)
+
+struct mempool_slab;
+
+struct mempool {
+	struct mempool *next, **ref;
+
+	/* objects are accounted against this MTYPE, one allocation each */
+	struct memtype *mt;
+	size_t size;
+
+	/* all fields below are protected by mtx */
+	pthread_mutex_t mtx;
+
+	/* size rounded up for alignment, objects per slab; set on first use */
+	size_t objsize;
+	unsigned int per_slab;
+
+	/* slabs with at least one free object, and completely used ones */
+	struct mempool_slab *partial;
+	struct mempool_slab *full;
+	/* one unused slab is kept around to avoid thrashing, others go */
+	struct mempool_slab *spare;
+
+	size_t n_slabs;
+	size_t n_slabs_max;
+	size_t n_used;
+};
+
+/* macro usage, analogous to MTYPEs:
+ *
+ *  mydaemon_foo.h
+ *    DECLARE_MEMPOOL(FOO);
+ *
+ *  mydaemon_foo.c
+ *    DEFINE_MEMPOOL(FOO, MTYPE_FOO, sizeof(struct foo));
+ *    foo = mempool_alloc(MPOOL_FOO);
+ *    ...
+ *    MPFREE(MPOOL_FOO, foo);
+ *
+ *  Pools are registered on startup so that "show memory" can list them.
+ */
+
+#define DECLARE_MEMPOOL(name)                                                  \
+	extern struct mempool MPOOL_##name[1]                                  \
+	/* end */
+
+#define DEFINE_MEMPOOL_ATTR(mname, attr, mtype, objsize)                       \
+	attr struct mempool MPOOL_##mname[1] = { {                             \
+		.mt = mtype,                                                   \
+		.size = objsize,                                               \
+		.mtx = PTHREAD_MUTEX_INITIALIZER,                              \
+	} };                                                                   \
+	static void _mpinit_##mname(void) __attribute__((_CONSTRUCTOR(1002))); \
+	static void _mpinit_##mname(void)                                      \
+	{                                                                      \
+		mempool_register(MPOOL_##mname);                               \
+	}                                                                      \
+	static void _mpfini_##mname(void) __attribute__((_DESTRUCTOR(1002)));  \
+	static void _mpfini_##mname(void)                                      \
+	{                                                                      \
+		mempool_unregister(MPOOL_##mname);                             \
+	}                                                                      \
+	MACRO_REQUIRE_SEMICOLON() /* end */
+
+#define DEFINE_MEMPOOL(name, mtype, objsize)                                   \
+	DEFINE_MEMPOOL_ATTR(name, , mtype, objsize)                            \
+	/* end */
+
+#define DEFINE_MEMPOOL_STATIC(name, mtype, objsize)                            \
+	DEFINE_MEMPOOL_ATTR(name, static, mtype, objsize)                      \
+	/* end */
+
+extern void mempool_register(struct mempool *mp);
+extern void mempool_unregister(struct mempool *mp);
+
+/* Returns a zeroed object, counted as one allocation of the pool's MTYPE */
+extern void *mempool_alloc(struct mempool *mp)
+	__attribute__((malloc, nonnull(1) _RET_NONNULL));
+extern void mempool_free(struct mempool *mp, void *ptr)
+	__attribute__((nonnull(1)));
+
+#define MPFREE(mp, ptr)                                                        \
+	do {                                                                   \
+		mempool_free(mp, ptr);                                         \
+		ptr = NULL;                                                    \
+	} while (0)
+
+struct mempool_stats {
+	size_t objsize;
+	size_t slabs;
+	size_t slabs_max;
+	size_t used;
+	size_t capacity;
+	/* free objects in slabs that cannot be released */
+	size_t fragmented;
+	/* slab memory not handed out, in bytes */
+	size_t idle_bytes;
+};
+
+extern void mempool_stats_get(struct mempool *mp, struct mempool_stats *stats);
+
+/* Called once with mp == NULL before the first pool, if there are any.
+ *
+ * return value: 0: continue, !0: abort walk.  mempool_walk will return the
+ * last value from mempool_walk_fn. */
+typedef int mempool_walk_fn(void *arg, struct mempool *mp);
+extern int mempool_walk(mempool_walk_fn *func, void *arg);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _FRR_MEMPOOL_H */
@@ -23,6 +23,7 @@ DEFINE_MTYPE_STATIC(LIB, PREFIX_LIST, "Prefix List");
 DEFINE_MTYPE_STATIC(LIB, MPREFIX_LIST_STR, "Prefix List Str");
 DEFINE_MTYPE_STATIC(LIB, PREFIX_LIST_ENTRY, "Prefix List Entry");
 DEFINE_MTYPE_STATIC(LIB, PREFIX_LIST_TRIE, "Prefix List Trie Table");
+DEFINE_MTYPE_STATIC(LIB, PREFIX_LIST_COMPILED, "Prefix List Compiled Table");
 
 /* not currently changeable, code assumes bytes further down */
 #define PLC_BITS	8
@@ -167,7 +168,7 @@ struct prefix_list_entry *prefix_list_entry_new(void)
 
 void prefix_list_entry_free(struct prefix_list_entry *pentry)
 {
-	XFREE(MTYPE_PREFIX_LIST_ENTRY, pentry);
+	rcu_free(MTYPE_PREFIX_LIST_ENTRY, pentry, rcu_head);
 }
 
 /* Insert new prefix list to list of prefix_list.  Each prefix_list
@@ -207,6 +208,7 @@ struct prefix_list *prefix_list_get(afi_t afi, int orf, const char *name)
 
 static void prefix_list_trie_del(struct prefix_list *plist,
 				 struct prefix_list_entry *pentry);
+static void plist_compiled_drop(struct prefix_list *plist);
 
 /* Delete prefix-list from prefix_list_master and free it. */
 void prefix_list_delete(struct prefix_list *plist)
@@ -243,6 +245,7 @@ void prefix_list_delete(struct prefix_list *plist)
 	XFREE(MTYPE_MPREFIX_LIST_STR, plist->name);
 
 	XFREE(MTYPE_PREFIX_LIST_TRIE, plist->trie);
+	plist_compiled_drop(plist);
 
 	prefix_list_free(plist);
 }
@@ -382,6 +385,8 @@ static void prefix_list_trie_del(struct prefix_list *plist,
 	size_t validbits = pentry->prefix.prefixlen;
 	struct pltrie_table *table, **tables[PLC_MAXLEVEL];
 
+	plist_compiled_drop(plist);
+
 	table = plist->trie;
 	for (depth = 0; validbits > PLC_BITS && depth < maxdepth - 1; depth++) {
 		uint8_t byte = bytes[depth];
@@ -514,6 +519,8 @@ static void prefix_list_trie_add(struct prefix_list *plist,
 	size_t validbits = pentry->prefix.prefixlen;
 	struct pltrie_table *table;
 
+	plist_compiled_drop(plist);
+
 	table = plist->trie;
 	while (validbits > PLC_BITS && depth > 1) {
 		if (!table->entries[*bytes].next_table)
@@ -735,35 +742,378 @@ static const char *prefix_list_type_str(struct prefix_list_entry *pentry)
 	}
 }
 
-static int prefix_list_entry_match(struct prefix_list_entry *pentry,
-				   const struct prefix *p, bool address_mode)
+/*
+ * Compiled lookup table.
+ *
+ * The byte-wise trie above is kept up to date on every change, but leaves
+ * the ge/le checks to a walk over each chain it visits.  Lookups instead
+ * use a path-compressed binary trie over the prefix bits, built from the
+ * entries on first use after a change.  Each node carries the entries for
+ * exactly its prefix, folded into disjoint ranges of matching prefix
+ * lengths that each name the winning entry.  A lookup visits at most one
+ * node per bit of the prefix and does a single range check on each, for
+ * any combination of ge and le.
+ *
+ * Entries are numbered in list (sequence) order, so the lowest number
+ * found on the way down is the match.  The table is never modified; it is
+ * replaced as a whole and the old one is freed through RCU.
+ */
+#define PLC_NONE UINT32_MAX
+
+struct plc_node {
+	uint8_t addr[16];
+	uint8_t len;
+	uint8_t nranges;
+
+	/* first of nranges in plist_compiled->ranges */
+	uint32_t ranges;
+	/* lowest numbered entry here regardless of length, for address_mode */
+	uint32_t any;
+
+	uint32_t child[2];
+};
+
+struct plc_range {
+	uint8_t lo, hi;
+	uint32_t entry;
+};
+
+struct plist_compiled {
+	struct rcu_head rcu_head;
+
+	/* AF_INET, AF_INET6 */
+	uint32_t root[2];
+
+	uint32_t nnodes;
+	uint32_t nranges;
+	uint32_t nentries;
+
+	struct plc_node *nodes;
+	struct plc_range *ranges;
+	struct prefix_list_entry **entries;
+};
+
+struct plc_build {
+	struct plc_node *nodes;
+	uint32_t nnodes, nodes_alloc;
+
+	struct plc_range *ranges;
+	uint32_t nranges, ranges_alloc;
+};
+
+static inline unsigned int plc_bit(const uint8_t *addr, unsigned int pos)
+{
+	return (addr[pos / 8] >> (7 - pos % 8)) & 1;
+}
+
+/* Number of leading bits a and b have in common, up to maxlen */
+static unsigned int plc_common_bits(const uint8_t *a, const uint8_t *b,
+				    unsigned int maxlen)
+{
+	unsigned int i;
+	uint8_t diff;
+
+	for (i = 0; i < maxlen; i += 8) {
+		diff = a[i / 8] ^ b[i / 8];
+		if (diff) {
+			i += __builtin_clz(diff) - 24;
+			break;
+		}
+	}
+	return MIN(i, maxlen);
+}
+
+static uint32_t plc_node_new(struct plc_build *b, const uint8_t *addr,
+			     unsigned int len)
 {
-	int ret;
+	struct plc_node *node;
+	unsigned int i;
 
-	if (pentry->prefix.family != p->family)
-		return 0;
+	if (b->nnodes == b->nodes_alloc) {
+		b->nodes_alloc = MAX(b->nodes_alloc * 2, 64U);
+		b->nodes = XREALLOC(MTYPE_TMP, b->nodes,
+				    b->nodes_alloc * sizeof(*b->nodes));
+	}
 
-	ret = prefix_match(&pentry->prefix, p);
-	if (!ret)
-		return 0;
+	node = &b->nodes[b->nnodes];
+	memset(node, 0, sizeof(*node));
+	for (i = 0; i < len; i++)
+		if (plc_bit(addr, i))
+			node->addr[i / 8] |= 0x80 >> (i % 8);
+	node->len = len;
+	node->any = PLC_NONE;
+	node->child[0] = node->child[1] = PLC_NONE;
 
-	if (address_mode)
-		return 1;
+	return b->nnodes++;
+}
 
-	/* In case of le nor ge is specified, exact match is performed. */
-	if (!pentry->le && !pentry->ge) {
-		if (pentry->prefix.prefixlen != p->prefixlen)
-			return 0;
-	} else {
-		if (pentry->le)
-			if (p->prefixlen > pentry->le)
-				return 0;
+/* Node for exactly p, created along with any node needed to branch off */
+static uint32_t plc_node_get(struct plc_build *b, uint32_t *root,
+			     const struct prefix *p)
+{
+	uint32_t cur = *root, parent = PLC_NONE, n = PLC_NONE, top;
+	unsigned int side = 0, common;
+	const uint8_t *addr = p->u.val;
 
-		if (pentry->ge)
-			if (p->prefixlen < pentry->ge)
-				return 0;
+	while (cur != PLC_NONE) {
+		common = plc_common_bits(b->nodes[cur].addr, addr,
+					 MIN(b->nodes[cur].len, p->prefixlen));
+
+		if (common == b->nodes[cur].len) {
+			if (common == p->prefixlen)
+				return cur;
+			parent = cur;
+			side = plc_bit(addr, common);
+			cur = b->nodes[cur].child[side];
+			continue;
+		}
+
+		/* p branches off, or is a prefix of, cur */
+		top = n = plc_node_new(b, addr, p->prefixlen);
+		if (common < p->prefixlen) {
+			top = plc_node_new(b, addr, common);
+			b->nodes[top].child[plc_bit(addr, common)] = n;
+		}
+		b->nodes[top].child[plc_bit(b->nodes[cur].addr, common)] = cur;
+		cur = top;
+		break;
 	}
-	return 1;
+
+	if (cur == PLC_NONE)
+		cur = n = plc_node_new(b, addr, p->prefixlen);
+
+	if (parent == PLC_NONE)
+		*root = cur;
+	else
+		b->nodes[parent].child[side] = cur;
+	return n;
+}
+
+static void plc_range_add(struct plc_build *b, unsigned int lo,
+			  unsigned int hi, uint32_t entry)
+{
+	if (b->nranges == b->ranges_alloc) {
+		b->ranges_alloc = MAX(b->ranges_alloc * 2, 64U);
+		b->ranges = XREALLOC(MTYPE_TMP, b->ranges,
+				     b->ranges_alloc * sizeof(*b->ranges));
+	}
+
+	b->ranges[b->nranges].lo = lo;
+	b->ranges[b->nranges].hi = hi;
+	b->ranges[b->nranges].entry = entry;
+	b->nranges++;
+}
+
+struct plc_pending {
+	uint32_t node;
+	uint32_t entry;
+};
+
+static int plc_pending_cmp(const void *a, const void *b)
+{
+	const struct plc_pending *pa = a, *pb = b;
+
+	if (pa->node != pb->node)
+		return pa->node < pb->node ? -1 : 1;
+	if (pa->entry != pb->entry)
+		return pa->entry < pb->entry ? -1 : 1;
+	return 0;
+}
+
+static struct plist_compiled *plist_compile(struct prefix_list *plist)
+{
+	struct plc_build b = {};
+	struct plc_pending *pending;
+	struct prefix_list_entry *pentry, **entries;
+	struct plist_compiled *plc;
+	uint32_t root[2] = { PLC_NONE, PLC_NONE };
+	uint32_t best[IPV6_MAX_BITLEN + 1];
+	uint32_t n = 0, npending = 0, i, j;
+	unsigned int len, maxlen, lo, hi, l;
+	struct plc_node *node;
+	size_t size;
+
+	for (pentry = plist->head; pentry; pentry = pentry->next)
+		n++;
+
+	entries = XCALLOC(MTYPE_TMP, n * sizeof(*entries));
+	pending = XCALLOC(MTYPE_TMP, n * sizeof(*pending));
+
+	for (pentry = plist->head, i = 0; pentry; pentry = pentry->next, i++) {
+		entries[i] = pentry;
+
+		if (pentry->prefix.family == AF_INET)
+			pending[npending].node =
+				plc_node_get(&b, &root[0], &pentry->prefix);
+		else if (pentry->prefix.family == AF_INET6)
+			pending[npending].node =
+				plc_node_get(&b, &root[1], &pentry->prefix);
+		else
+			continue;
+		pending[npending++].entry = i;
+	}
+
+	/* group entries by node, keeping list order within each */
+	qsort(pending, npending, sizeof(*pending), plc_pending_cmp);
+
+	for (i = 0; i < npending; i = j) {
+		node = &b.nodes[pending[i].node];
+		len = node->len;
+		maxlen = prefix_blen(&entries[pending[i].entry]->prefix) * 8;
+
+		for (l = len; l <= maxlen; l++)
+			best[l] = PLC_NONE;
+
+		node->any = pending[i].entry;
+
+		for (j = i; j < npending && pending[j].node == pending[i].node;
+		     j++) {
+			pentry = entries[pending[j].entry];
+
+			/* neither le nor ge means an exact match */
+			if (!pentry->le && !pentry->ge) {
+				lo = hi = len;
+			} else {
+				lo = pentry->ge ? MAX((unsigned int)pentry->ge,
+						      len)
+						: len;
+				hi = pentry->le ? MIN((unsigned int)pentry->le,
+						      maxlen)
+						: maxlen;
+			}
+
+			for (l = lo; l <= hi; l++)
+				if (best[l] == PLC_NONE)
+					best[l] = pending[j].entry;
+		}
+
+		node->ranges = b.nranges;
+		for (l = len; l <= maxlen; l = hi + 1) {
+			for (hi = l; hi < maxlen && best[hi + 1] == best[l];
+			     hi++)
+				;
+			if (best[l] != PLC_NONE)
+				plc_range_add(&b, l, hi, best[l]);
+		}
+		node->nranges = b.nranges - node->ranges;
+	}
+
+	/* everything goes into one allocation */
+	size = sizeof(*plc) + b.nnodes * sizeof(*plc->nodes) +
+	       b.nranges * sizeof(*plc->ranges) + n * sizeof(*plc->entries);
+	plc = XCALLOC(MTYPE_PREFIX_LIST_COMPILED, size);
+	plc->root[0] = root[0];
+	plc->root[1] = root[1];
+	plc->nnodes = b.nnodes;
+	plc->nranges = b.nranges;
+	plc->nentries = n;
+	plc->nodes = (struct plc_node *)(plc + 1);
+	plc->ranges = (struct plc_range *)(plc->nodes + b.nnodes);
+	plc->entries = (struct prefix_list_entry **)(plc->ranges + b.nranges);
+
+	if (b.nnodes)
+		memcpy(plc->nodes, b.nodes, b.nnodes * sizeof(*plc->nodes));
+	if (b.nranges)
+		memcpy(plc->ranges, b.ranges,
+		       b.nranges * sizeof(*plc->ranges));
+	if (n)
+		memcpy(plc->entries, entries, n * sizeof(*plc->entries));
+
+	XFREE(MTYPE_TMP, b.nodes);
+	XFREE(MTYPE_TMP, b.ranges);
+	XFREE(MTYPE_TMP, pending);
+	XFREE(MTYPE_TMP, entries);
+
+	return plc;
+}
+
+static void plist_compiled_drop(struct prefix_list *plist)
+{
+	struct plist_compiled *plc;
+
+	plc = (struct plist_compiled *)atomic_exchange_explicit(
+		&plist->compiled, (uintptr_t)NULL, memory_order_acq_rel);
+	if (plc)
+		rcu_free(MTYPE_PREFIX_LIST_COMPILED, plc, rcu_head);
+}
+
+static struct plist_compiled *plist_compiled_get(struct prefix_list *plist)
+{
+	struct plist_compiled *plc;
+	uintptr_t prev = (uintptr_t)NULL;
+
+	plc = (struct plist_compiled *)atomic_load_explicit(
+		&plist->compiled, memory_order_acquire);
+	if (plc)
+		return plc;
+
+	plc = plist_compile(plist);
+
+	/* someone else was quicker */
+	if (!atomic_compare_exchange_strong_explicit(
+		    &plist->compiled, &prev, (uintptr_t)plc,
+		    memory_order_acq_rel, memory_order_acquire)) {
+		XFREE(MTYPE_PREFIX_LIST_COMPILED, plc);
+		plc = (struct plist_compiled *)prev;
+	}
+	return plc;
+}
+
+static bool plc_node_match(const struct plc_node *node, const struct prefix *p)
+{
+	unsigned int bytes = node->len / 8, bits = node->len % 8;
+	uint8_t mask;
+
+	if (memcmp(node->addr, p->u.val, bytes))
+		return false;
+	if (!bits)
+		return true;
+
+	mask = 0xff << (8 - bits);
+	return ((node->addr[bytes] ^ p->u.val[bytes]) & mask) == 0;
+}
+
+/* Number of the entry matching p, or PLC_NONE */
+static uint32_t plist_compiled_lookup(const struct plist_compiled *plc,
+				      const struct prefix *p,
+				      bool address_mode)
+{
+	const struct plc_node *node;
+	const struct plc_range *range;
+	uint32_t cur, best = PLC_NONE;
+	unsigned int i;
+
+	if (p->family == AF_INET)
+		cur = plc->root[0];
+	else if (p->family == AF_INET6)
+		cur = plc->root[1];
+	else
+		return PLC_NONE;
+
+	while (cur != PLC_NONE) {
+		node = &plc->nodes[cur];
+		if (node->len > p->prefixlen || !plc_node_match(node, p))
+			break;
+
+		if (address_mode)
+			best = MIN(best, node->any);
+		else {
+			range = &plc->ranges[node->ranges];
+			for (i = 0; i < node->nranges; i++, range++) {
+				if (p->prefixlen > range->hi)
+					continue;
+				if (p->prefixlen >= range->lo)
+					best = MIN(best, range->entry);
+				break;
+			}
+		}
+
+		if (node->len == p->prefixlen)
+			break;
+		cur = node->child[plc_bit(p->u.val, node->len)];
+	}
+
+	return best;
 }
 
 enum prefix_list_type prefix_list_apply_ext(
@@ -772,13 +1122,10 @@ enum prefix_list_type prefix_list_apply_ext(
 	union prefixconstptr object,
 	bool address_mode)
 {
-	struct prefix_list_entry *pentry, *pbest = NULL;
-
+	struct prefix_list_entry *pbest = NULL;
 	const struct prefix *p = object.p;
-	const uint8_t *byte = p->u.val;
-	size_t depth;
-	size_t validbits = p->prefixlen;
-	struct pltrie_table *table;
+	struct plist_compiled *plc;
+	uint32_t entry;
 
 	if (plist == NULL) {
 		if (which)
@@ -792,52 +1139,48 @@ enum prefix_list_type prefix_list_apply_ext(
 		return PREFIX_PERMIT;
 	}
 
-	depth = plist->master->trie_depth;
-	table = plist->trie;
-	while (1) {
-		for (pentry = table->entries[*byte].up_chain; pentry;
-		     pentry = pentry->next_best) {
-			if (pbest && pbest->seq < pentry->seq)
-				continue;
-			if (prefix_list_entry_match(pentry, p, address_mode))
-				pbest = pentry;
-		}
+	plc = plist_compiled_get(plist);
+	entry = plist_compiled_lookup(plc, p, address_mode);
+	if (entry != PLC_NONE)
+		pbest = plc->entries[entry];
 
-		if (validbits <= PLC_BITS)
-			break;
-		validbits -= PLC_BITS;
+	if (which)
+		*which = pbest;
 
-		if (--depth) {
-			if (!table->entries[*byte].next_table)
-				break;
+	if (pbest == NULL)
+		return PREFIX_DENY;
 
-			table = table->entries[*byte].next_table;
-			byte++;
-			continue;
-		}
+	pbest->hitcnt++;
+	return pbest->type;
+}
 
-		for (pentry = table->entries[*byte].final_chain; pentry;
-		     pentry = pentry->next_best) {
-			if (pbest && pbest->seq < pentry->seq)
-				continue;
-			if (prefix_list_entry_match(pentry, p, address_mode))
-				pbest = pentry;
-		}
-		break;
-	}
+void prefix_list_apply_batch(struct prefix_list *plist,
+			     const struct prefix *const *prefixes,
+			     enum prefix_list_type *results, size_t count)
+{
+	struct prefix_list_entry *pentry;
+	struct plist_compiled *plc;
+	uint32_t entry;
+	size_t i;
 
-	if (which) {
-		if (pbest)
-			*which = pbest;
-		else
-			*which = NULL;
+	if (plist == NULL || plist->count == 0) {
+		for (i = 0; i < count; i++)
+			results[i] = plist ? PREFIX_PERMIT : PREFIX_DENY;
+		return;
 	}
 
-	if (pbest == NULL)
-		return PREFIX_DENY;
+	plc = plist_compiled_get(plist);
+	for (i = 0; i < count; i++) {
+		entry = plist_compiled_lookup(plc, prefixes[i], false);
+		if (entry == PLC_NONE) {
+			results[i] = PREFIX_DENY;
+			continue;
+		}
 
-	pbest->hitcnt++;
-	return pbest->type;
+		pentry = plc->entries[entry];
+		pentry->hitcnt++;
+		results[i] = pentry->type;
+	}
 }
 
 static void __attribute__((unused)) prefix_list_print(struct prefix_list *plist)
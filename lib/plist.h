@@ -62,6 +62,18 @@ prefix_list_apply_ext(struct prefix_list *plist,
 #define prefix_list_apply(A, B) \
 	prefix_list_apply_ext((A), NULL, (B), false)
 
+/*
+ * prefix_list_apply_batch
+ *
+ * Same as prefix_list_apply() on each of count prefixes, storing the
+ * results in the results array.  Meant for callers filtering many
+ * prefixes against one list at a time.
+ */
+extern void prefix_list_apply_batch(struct prefix_list *plist,
+				    const struct prefix *const *prefixes,
+				    enum prefix_list_type *results,
+				    size_t count);
+
 extern struct prefix_list *prefix_bgp_orf_lookup(afi_t, const char *);
 extern struct stream *prefix_bgp_orf_entry(struct stream *,
 					   struct prefix_list *, uint8_t,
@@ -7,6 +7,9 @@
 #ifndef _QUAGGA_PLIST_INT_H
 #define _QUAGGA_PLIST_INT_H
 
+#include "frratomic.h"
+#include "frrcu.h"
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -30,6 +33,11 @@ struct prefix_list {
 	struct prefix_list_entry *tail;
 
 	struct pltrie_table *trie;
+
+	/* struct plist_compiled *, built from the entries on first lookup
+	 * after a change and replaced through RCU.
+	 */
+	atomic_uintptr_t compiled;
 };
 
 /* Each prefix-list's entry. */
@@ -57,6 +65,9 @@ struct prefix_list_entry {
 
 	/* Flag to track trie/list installation status. */
 	bool installed;
+
+	/* compiled tables may still refer to deleted entries */
+	struct rcu_head rcu_head;
 };
 
 extern void prefix_list_entry_free(struct prefix_list_entry *pentry);
@@ -637,6 +637,16 @@ static void route_map_rule_delete(struct route_map_rule_list *,
 
 uint32_t rmap_debug;
 
+/* Source of route_map->version, shared by all maps so that a map allocated
+ * in place of a deleted one never repeats a version the old one had.
+ */
+static uint64_t route_map_generation;
+
+void route_map_version_bump(struct route_map *map)
+{
+	map->version = ++route_map_generation;
+}
+
 /* New route map allocation. Please note route map's name must be
    specified. */
 static struct route_map *route_map_new(const char *name)
@@ -645,6 +655,7 @@ static struct route_map *route_map_new(const char *name)
 
 	new = XCALLOC(MTYPE_ROUTE_MAP, sizeof(struct route_map));
 	new->name = XSTRDUP(MTYPE_ROUTE_MAP_NAME, name);
+	route_map_version_bump(new);
 	QOBJ_REG(new, route_map);
 	return new;
 }
@@ -831,12 +842,52 @@ int route_map_mark_updated(const char *name)
 
 	if (map) {
 		map->to_be_processed = true;
+		route_map_version_bump(map);
 		ret = 0;
 	}
 
 	return (ret);
 }
 
+bool route_map_rule_memoizable(void *val)
+{
+	return true;
+}
+
+static bool route_map_rules_memoizable(struct route_map_rule_list *list)
+{
+	struct route_map_rule *rule;
+
+	for (rule = list->head; rule; rule = rule->next)
+		if (!rule->cmd->func_memoizable ||
+		    !rule->cmd->func_memoizable(rule->value))
+			return false;
+	return true;
+}
+
+bool route_map_memoizable(struct route_map *map)
+{
+	struct route_map_index *index;
+
+	if (map->memo_version == map->version)
+		return map->memoizable;
+
+	map->memo_version = map->version;
+	map->memoizable = true;
+
+	for (index = map->head; index; index = index->next) {
+		/* the called map can change without this one noticing */
+		if (index->nextrm ||
+		    !route_map_rules_memoizable(&index->match_list) ||
+		    !route_map_rules_memoizable(&index->set_list)) {
+			map->memoizable = false;
+			break;
+		}
+	}
+
+	return map->memoizable;
+}
+
 static void route_map_clear_updated(struct route_map *map)
 {
 	if (map) {
@@ -920,6 +971,17 @@ static const char *route_map_result_str(route_map_result_t res)
 	return "invalid";
 }
 
+void route_map_memo_hit(struct route_map *map, const struct prefix *prefix,
+			route_map_result_t ret)
+{
+	map->applied++;
+	map->memo_hits++;
+
+	if (unlikely(CHECK_FLAG(rmap_debug, DEBUG_ROUTEMAP)))
+		zlog_debug("Route-map: %s, prefix: %pFX, result: %s (memoized)",
+			   map->name, prefix, route_map_result_str(ret));
+}
+
 /* show route-map */
 static void vty_show_route_map_entry(struct vty *vty, struct route_map *map,
 				     json_object *json)
@@ -940,6 +1002,8 @@ static void vty_show_route_map_entry(struct vty *vty, struct route_map *map,
 					map->optimization_disabled);
 		json_object_boolean_add(json_rmap, "processedChange",
 					map->to_be_processed);
+		json_object_int_add(json_rmap, "memoHits", map->memo_hits);
+		json_object_int_add(json_rmap, "memoMisses", map->memo_misses);
 		json_object_object_add(json_rmap, "rules", json_rules);
 	} else {
 		vty_out(vty,
@@ -948,6 +1012,11 @@ static void vty_show_route_map_entry(struct vty *vty, struct route_map *map,
 			map->name, map->applied - map->applied_clear,
 			map->optimization_disabled ? "disabled" : "enabled",
 			map->to_be_processed ? "true" : "false");
+		if (map->memo_hits || map->memo_misses)
+			vty_out(vty,
+				" Memoized results: %" PRIu64 " hits, %" PRIu64
+				" misses\n",
+				map->memo_hits, map->memo_misses);
 	}
 
 	for (index = map->head; index; index = index->next) {
@@ -3090,6 +3159,8 @@ static void clear_route_map_helper(struct route_map *map)
 	struct route_map_index *index;
 
 	map->applied_clear = map->applied;
+	map->memo_hits = 0;
+	map->memo_misses = 0;
 	for (index = map->head; index; index = index->next)
 		index->applied_clear = index->applied;
 }
@@ -106,6 +106,12 @@ struct route_map_rule_cmd {
 
 	/** To get the rule key after Compilation **/
 	void *(*func_get_rmap_rule_key)(void *val);
+
+	/* Whether the compiled rule only looks at what a daemon memoizes
+	 * route-map results on (e.g. a path's attributes and peer), and
+	 * never at the prefix or other state.  NULL means it does not.
+	 */
+	bool (*func_memoizable)(void *val);
 };
 
 /* Route map apply error. */
@@ -214,6 +220,19 @@ struct route_map {
 	/* Counter to track active usage of this route-map */
 	uint16_t use_count;
 
+	/* Changes on every change to the map or to what it references, and
+	 * is never reused by another map, see route_map_version_bump()
+	 */
+	uint64_t version;
+
+	/* route_map_memoizable() result, valid while memo_version matches */
+	uint64_t memo_version;
+	bool memoizable;
+
+	/* Results a daemon reused instead of applying the map again */
+	uint64_t memo_hits;
+	uint64_t memo_misses;
+
 	/* Tables to maintain IPv4 and IPv6 prefixes from
 	 * the prefix-list match clause.
 	 */
@@ -504,6 +523,25 @@ extern void route_map_delete_hook(void (*func)(const char *));
  */
 extern void route_map_event_hook(void (*func)(const char *name));
 extern int route_map_mark_updated(const char *name);
+
+/* func_memoizable for rules that are always memoizable */
+extern bool route_map_rule_memoizable(void *val);
+
+/* True if applying map gives the same result for every prefix, as long as
+ * the objects the rules look at and map->version are unchanged.  Daemons
+ * may then cache results and count them in map->memo_hits/memo_misses.
+ */
+extern bool route_map_memoizable(struct route_map *map);
+
+/* Account for a memoized result, counted as an application of map.  The
+ * per-sequence counters only count actual evaluations.
+ */
+extern void route_map_memo_hit(struct route_map *map,
+			       const struct prefix *prefix,
+			       route_map_result_t ret);
+
+/* Give map a new version from the global generation counter */
+extern void route_map_version_bump(struct route_map *map);
 extern void route_map_walk_update_list(void (*update_fn)(char *name));
 extern void route_map_upd8_dependency(route_map_event_t type, const char *arg,
 				      const char *rmap_name);
@@ -435,6 +435,7 @@ static int lib_route_map_entry_goto_value_modify(struct nb_cb_modify_args *args)
 	case NB_EV_APPLY:
 		rmi = nb_running_get_entry(args->dnode, NULL, true);
 		rmi->nextpref = yang_dnode_get_uint16(args->dnode, NULL);
+		route_map_version_bump(rmi->map);
 		break;
 	}
 
@@ -455,6 +456,7 @@ lib_route_map_entry_goto_value_destroy(struct nb_cb_destroy_args *args)
 	case NB_EV_APPLY:
 		rmi = nb_running_get_entry(args->dnode, NULL, true);
 		rmi->nextpref = 0;
+		route_map_version_bump(rmi->map);
 		break;
 	}
 
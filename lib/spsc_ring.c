@@ -0,0 +1,35 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/*
+ * Single-producer, single-consumer lock-free pointer ring.
+ */
+#include <zebra.h>
+
+#include "spsc_ring.h"
+#include "memory.h"
+
+DEFINE_MTYPE_STATIC(LIB, SPSC_RING, "SPSC ring");
+
+struct spsc_ring *spsc_ring_new(size_t size)
+{
+	struct spsc_ring *ring;
+	size_t slots = 1;
+
+	while (slots < size)
+		slots <<= 1;
+
+	ring = XCALLOC(MTYPE_SPSC_RING, sizeof(*ring));
+	ring->slots = XCALLOC(MTYPE_SPSC_RING, slots * sizeof(void *));
+	ring->mask = slots - 1;
+	atomic_store_explicit(&ring->head, 0, memory_order_relaxed);
+	atomic_store_explicit(&ring->tail, 0, memory_order_relaxed);
+	return ring;
+}
+
+void spsc_ring_free(struct spsc_ring **ring)
+{
+	if (!*ring)
+		return;
+
+	XFREE(MTYPE_SPSC_RING, (*ring)->slots);
+	XFREE(MTYPE_SPSC_RING, *ring);
+}
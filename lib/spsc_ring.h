@@ -0,0 +1,121 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/*
+ * Single-producer, single-consumer lock-free pointer ring.
+ */
+#ifndef _FRR_SPSC_RING_H_
+#define _FRR_SPSC_RING_H_
+
+#include <zebra.h>
+
+#include "frratomic.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Bounded FIFO of pointers between exactly one producer pthread and exactly
+ * one consumer pthread, without locks.
+ *
+ * head and tail are free-running counters, each written by one side only.
+ * Each side also keeps a private copy of the other side's counter and only
+ * reloads it when that copy says the ring is full (producer) or empty
+ * (consumer), so in steady state neither side touches the other's cache
+ * line. An item handed over with spsc_ring_push() is fully visible to the
+ * consumer once spsc_ring_pop() returns it.
+ */
+struct spsc_ring {
+	size_t mask;
+	void **slots;
+
+	uint8_t pad0[64];
+
+	/* producer side */
+	atomic_size_t head;
+	size_t tail_cache;
+
+	uint8_t pad1[64];
+
+	/* consumer side */
+	atomic_size_t tail;
+	size_t head_cache;
+};
+
+/*
+ * Creates a new ring.
+ *
+ * @param size	minimum number of items, rounded up to a power of two
+ * @return the newly created ring
+ */
+extern struct spsc_ring *spsc_ring_new(size_t size);
+
+/*
+ * Deletes a ring. Items still queued are not freed.
+ */
+extern void spsc_ring_free(struct spsc_ring **ring);
+
+/*
+ * Producer only: queue an item.
+ *
+ * @return false if the ring is full, the item was not queued
+ */
+static inline bool spsc_ring_push(struct spsc_ring *ring, void *item)
+{
+	size_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+
+	if (head - ring->tail_cache > ring->mask) {
+		ring->tail_cache = atomic_load_explicit(&ring->tail,
+							memory_order_acquire);
+		if (head - ring->tail_cache > ring->mask)
+			return false;
+	}
+
+	ring->slots[head & ring->mask] = item;
+	atomic_store_explicit(&ring->head, head + 1, memory_order_release);
+	return true;
+}
+
+/*
+ * Consumer only: dequeue the oldest item.
+ *
+ * @return the item, NULL if the ring is empty
+ */
+static inline void *spsc_ring_pop(struct spsc_ring *ring)
+{
+	size_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+	void *item;
+
+	if (tail == ring->head_cache) {
+		ring->head_cache = atomic_load_explicit(&ring->head,
+							memory_order_acquire);
+		if (tail == ring->head_cache)
+			return NULL;
+	}
+
+	item = ring->slots[tail & ring->mask];
+	atomic_store_explicit(&ring->tail, tail + 1, memory_order_release);
+	return item;
+}
+
+/*
+ * Any thread: number of queued items. Only a snapshot when called while the
+ * other side is active.
+ */
+static inline size_t spsc_ring_count(struct spsc_ring *ring)
+{
+	size_t tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+	size_t head = atomic_load_explicit(&ring->head, memory_order_acquire);
+
+	return head - tail;
+}
+
+static inline size_t spsc_ring_size(const struct spsc_ring *ring)
+{
+	return ring->mask + 1;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _FRR_SPSC_RING_H_ */
@@ -295,13 +295,13 @@ static void zclient_flush_data(struct event *thread)
  * ZCLIENT_SEND_SUCCESS  - means we sent data to zebra
  * ZCLIENT_SEND_BUFFERED - means we are buffering
  */
-enum zclient_send_status zclient_send_message(struct zclient *zclient)
+static enum zclient_send_status zclient_send_stream(struct zclient *zclient,
+						   struct stream *s)
 {
 	if (zclient->sock < 0)
 		return ZCLIENT_SEND_FAILURE;
-	switch (buffer_write(zclient->wb, zclient->sock,
-			     STREAM_DATA(zclient->obuf),
-			     stream_get_endp(zclient->obuf))) {
+	switch (buffer_write(zclient->wb, zclient->sock, STREAM_DATA(s),
+			     stream_get_endp(s))) {
 	case BUFFER_ERROR:
 		flog_err(EC_LIB_ZAPI_SOCKET,
 			 "%s: buffer_write failed to zclient fd %d, closing",
@@ -320,6 +320,11 @@ enum zclient_send_status zclient_send_message(struct zclient *zclient)
 	return ZCLIENT_SEND_SUCCESS;
 }
 
+enum zclient_send_status zclient_send_message(struct zclient *zclient)
+{
+	return zclient_send_stream(zclient, zclient->obuf);
+}
+
 /*
  * If we add more data to this structure please ensure that
  * struct zmsghdr in lib/zclient.h is updated as appropriate.
@@ -1210,35 +1215,18 @@ enum zclient_send_status zclient_nhg_send(struct zclient *zclient, int cmd,
 	return zclient_send_message(zclient);
 }
 
-int zapi_route_encode(uint8_t cmd, struct stream *s, struct zapi_route *api)
+/*
+ * Encode a route from the prefix on. This part is the same in single route
+ * messages and in ZEBRA_ROUTE_ADD_BULK, where the nexthop-group id may be
+ * shared by all routes and so left out.
+ */
+static int zapi_route_encode_body(struct stream *s, struct zapi_route *api,
+				  bool common_nhg)
 {
 	struct zapi_nexthop *api_nh;
 	int i;
 	int psize;
 
-	stream_reset(s);
-	zclient_create_header(s, cmd, api->vrf_id);
-
-	if (api->type >= ZEBRA_ROUTE_MAX) {
-		flog_err(EC_LIB_ZAPI_ENCODE,
-			 "%s: Specified route type (%u) is not a legal value",
-			 __func__, api->type);
-		return -1;
-	}
-	stream_putc(s, api->type);
-
-	stream_putw(s, api->instance);
-	stream_putl(s, api->flags);
-	stream_putl(s, api->message);
-
-	if (api->safi < SAFI_UNICAST || api->safi >= SAFI_MAX) {
-		flog_err(EC_LIB_ZAPI_ENCODE,
-			 "%s: Specified route SAFI (%u) is not a legal value",
-			 __func__, api->safi);
-		return -1;
-	}
-	stream_putc(s, api->safi);
-
 	/* Put prefix information. */
 	stream_putc(s, api->prefix.family);
 	psize = PSIZE(api->prefix.prefixlen);
@@ -1251,7 +1239,7 @@ int zapi_route_encode(uint8_t cmd, struct stream *s, struct zapi_route *api)
 		stream_write(s, (uint8_t *)&api->src_prefix.prefix, psize);
 	}
 
-	if (CHECK_FLAG(api->message, ZAPI_MESSAGE_NHG))
+	if (CHECK_FLAG(api->message, ZAPI_MESSAGE_NHG) && !common_nhg)
 		stream_putl(s, api->nhgid);
 
 	/* Nexthops.  */
@@ -1357,6 +1345,38 @@ int zapi_route_encode(uint8_t cmd, struct stream *s, struct zapi_route *api)
 		stream_putw(s, api->opaque.length);
 		stream_write(s, api->opaque.data, api->opaque.length);
 	}
+
+	return 0;
+}
+
+int zapi_route_encode(uint8_t cmd, struct stream *s, struct zapi_route *api)
+{
+	stream_reset(s);
+	zclient_create_header(s, cmd, api->vrf_id);
+
+	if (api->type >= ZEBRA_ROUTE_MAX) {
+		flog_err(EC_LIB_ZAPI_ENCODE,
+			 "%s: Specified route type (%u) is not a legal value",
+			 __func__, api->type);
+		return -1;
+	}
+	stream_putc(s, api->type);
+
+	stream_putw(s, api->instance);
+	stream_putl(s, api->flags);
+	stream_putl(s, api->message);
+
+	if (api->safi < SAFI_UNICAST || api->safi >= SAFI_MAX) {
+		flog_err(EC_LIB_ZAPI_ENCODE,
+			 "%s: Specified route SAFI (%u) is not a legal value",
+			 __func__, api->safi);
+		return -1;
+	}
+	stream_putc(s, api->safi);
+
+	if (zapi_route_encode_body(s, api, false) < 0)
+		return -1;
+
 	/* Put length at the first point of the stream. */
 	stream_putw_at(s, 0, stream_get_endp(s));
 
@@ -1463,33 +1483,15 @@ stream_failure:
 	return ret;
 }
 
-int zapi_route_decode(struct stream *s, struct zapi_route *api)
+/*
+ * Decode the part of a route encoded by zapi_route_encode_body().
+ */
+static int zapi_route_decode_body(struct stream *s, struct zapi_route *api,
+				  uint32_t common_nhgid)
 {
 	struct zapi_nexthop *api_nh;
 	int i;
 
-	memset(api, 0, sizeof(*api));
-
-	/* Type, flags, message. */
-	STREAM_GETC(s, api->type);
-	if (api->type >= ZEBRA_ROUTE_MAX) {
-		flog_err(EC_LIB_ZAPI_ENCODE,
-			 "%s: Specified route type: %d is not a legal value",
-			 __func__, api->type);
-		return -1;
-	}
-
-	STREAM_GETW(s, api->instance);
-	STREAM_GETL(s, api->flags);
-	STREAM_GETL(s, api->message);
-	STREAM_GETC(s, api->safi);
-	if (api->safi < SAFI_UNICAST || api->safi >= SAFI_MAX) {
-		flog_err(EC_LIB_ZAPI_ENCODE,
-			 "%s: Specified route SAFI (%u) is not a legal value",
-			 __func__, api->safi);
-		return -1;
-	}
-
 	/* Prefix. */
 	STREAM_GETC(s, api->prefix.family);
 	STREAM_GETC(s, api->prefix.prefixlen);
@@ -1543,8 +1545,12 @@ int zapi_route_decode(struct stream *s, struct zapi_route *api)
 		}
 	}
 
-	if (CHECK_FLAG(api->message, ZAPI_MESSAGE_NHG))
-		STREAM_GETL(s, api->nhgid);
+	if (CHECK_FLAG(api->message, ZAPI_MESSAGE_NHG)) {
+		if (common_nhgid)
+			api->nhgid = common_nhgid;
+		else
+			STREAM_GETL(s, api->nhgid);
+	}
 
 	/* Nexthops. */
 	if (CHECK_FLAG(api->message, ZAPI_MESSAGE_NEXTHOP)) {
@@ -1616,6 +1622,197 @@ stream_failure:
 	return -1;
 }
 
+int zapi_route_decode(struct stream *s, struct zapi_route *api)
+{
+	memset(api, 0, sizeof(*api));
+
+	/* Type, flags, message. */
+	STREAM_GETC(s, api->type);
+	if (api->type >= ZEBRA_ROUTE_MAX) {
+		flog_err(EC_LIB_ZAPI_ENCODE,
+			 "%s: Specified route type: %d is not a legal value",
+			 __func__, api->type);
+		return -1;
+	}
+
+	STREAM_GETW(s, api->instance);
+	STREAM_GETL(s, api->flags);
+	STREAM_GETL(s, api->message);
+	STREAM_GETC(s, api->safi);
+	if (api->safi < SAFI_UNICAST || api->safi >= SAFI_MAX) {
+		flog_err(EC_LIB_ZAPI_ENCODE,
+			 "%s: Specified route SAFI (%u) is not a legal value",
+			 __func__, api->safi);
+		return -1;
+	}
+
+	return zapi_route_decode_body(s, api, 0);
+stream_failure:
+	return -1;
+}
+
+/* zapi header, type, instance, safi, family, flags, nhgid and count */
+#define ZAPI_ROUTE_BULK_HDR_MAX (ZEBRA_HEADER_SIZE + 12)
+
+void zapi_route_bulk_init(struct zapi_route_bulk *bulk,
+			  struct zclient *zclient)
+{
+	memset(bulk, 0, sizeof(*bulk));
+	bulk->zclient = zclient;
+	bulk->s = stream_new(ZEBRA_MAX_PACKET_SIZ);
+}
+
+void zapi_route_bulk_fini(struct zapi_route_bulk *bulk)
+{
+	stream_free(bulk->s);
+	bulk->s = NULL;
+}
+
+enum zclient_send_status zapi_route_bulk_flush(struct zapi_route_bulk *bulk)
+{
+	if (!bulk->hdr.count)
+		return ZCLIENT_SEND_SUCCESS;
+
+	stream_putw_at(bulk->s, bulk->count_pos, bulk->hdr.count);
+	stream_putw_at(bulk->s, 0, stream_get_endp(bulk->s));
+	bulk->hdr.count = 0;
+
+	return zclient_send_stream(bulk->zclient, bulk->s);
+}
+
+enum zclient_send_status zapi_route_bulk_add(struct zapi_route_bulk *bulk,
+					     struct zapi_route *api)
+{
+	struct stream *body = bulk->zclient->obuf;
+	struct zapi_route_bulk_hdr *hdr = &bulk->hdr;
+	enum zclient_send_status ret = ZCLIENT_SEND_SUCCESS, ret2;
+	uint32_t nhgid = 0;
+
+	if (api->type >= ZEBRA_ROUTE_MAX ||
+	    api->safi < SAFI_UNICAST || api->safi >= SAFI_MAX) {
+		flog_err(EC_LIB_ZAPI_ENCODE,
+			 "%s: Specified route type (%u) or SAFI (%u) is not a legal value",
+			 __func__, api->type, api->safi);
+		return ZCLIENT_SEND_FAILURE;
+	}
+
+	if (CHECK_FLAG(api->message, ZAPI_MESSAGE_NHG))
+		nhgid = api->nhgid;
+
+	/* The route goes to zclient->obuf first, to know its size */
+	stream_reset(body);
+	stream_putl(body, api->flags);
+	stream_putl(body, api->message);
+	if (zapi_route_encode_body(body, api, nhgid != 0) < 0)
+		return ZCLIENT_SEND_FAILURE;
+
+	if (hdr->count &&
+	    (bulk->vrf_id != api->vrf_id || hdr->type != api->type ||
+	     hdr->instance != api->instance || hdr->safi != api->safi ||
+	     hdr->family != api->prefix.family || hdr->nhgid != nhgid ||
+	     hdr->count == UINT16_MAX ||
+	     STREAM_WRITEABLE(bulk->s) < stream_get_endp(body))) {
+		ret = zapi_route_bulk_flush(bulk);
+		if (ret == ZCLIENT_SEND_FAILURE)
+			return ret;
+	}
+
+	if (!hdr->count) {
+		/* Too large to share a message, send it on its own */
+		if (ZAPI_ROUTE_BULK_HDR_MAX + stream_get_endp(body) >
+		    STREAM_SIZE(bulk->s)) {
+			ret2 = zclient_route_send(ZEBRA_ROUTE_ADD,
+						  bulk->zclient, api);
+			return ret2 == ZCLIENT_SEND_SUCCESS ? ret : ret2;
+		}
+
+		bulk->vrf_id = api->vrf_id;
+		hdr->type = api->type;
+		hdr->instance = api->instance;
+		hdr->safi = api->safi;
+		hdr->family = api->prefix.family;
+		hdr->nhgid = nhgid;
+
+		stream_reset(bulk->s);
+		zclient_create_header(bulk->s, ZEBRA_ROUTE_ADD_BULK,
+				      api->vrf_id);
+		stream_putc(bulk->s, hdr->type);
+		stream_putw(bulk->s, hdr->instance);
+		stream_putc(bulk->s, hdr->safi);
+		stream_putc(bulk->s, hdr->family);
+		stream_putc(bulk->s, nhgid ? ZAPI_ROUTE_BULK_NHG : 0);
+		if (nhgid)
+			stream_putl(bulk->s, nhgid);
+		bulk->count_pos = stream_get_endp(bulk->s);
+		stream_putw(bulk->s, 0);
+	}
+
+	stream_put(bulk->s, STREAM_DATA(body), stream_get_endp(body));
+	hdr->count++;
+
+	return ret;
+}
+
+int zapi_route_bulk_decode_hdr(struct stream *s,
+			       struct zapi_route_bulk_hdr *hdr)
+{
+	uint8_t flags;
+
+	memset(hdr, 0, sizeof(*hdr));
+
+	STREAM_GETC(s, hdr->type);
+	STREAM_GETW(s, hdr->instance);
+	STREAM_GETC(s, hdr->safi);
+	STREAM_GETC(s, hdr->family);
+	STREAM_GETC(s, flags);
+	if (CHECK_FLAG(flags, ZAPI_ROUTE_BULK_NHG)) {
+		STREAM_GETL(s, hdr->nhgid);
+		if (!hdr->nhgid)
+			return -1;
+	}
+	STREAM_GETW(s, hdr->count);
+
+	if (hdr->type >= ZEBRA_ROUTE_MAX || hdr->safi < SAFI_UNICAST ||
+	    hdr->safi >= SAFI_MAX ||
+	    (hdr->family != AF_INET && hdr->family != AF_INET6)) {
+		flog_err(EC_LIB_ZAPI_ENCODE,
+			 "%s: Invalid type (%u), SAFI (%u) or family (%u)",
+			 __func__, hdr->type, hdr->safi, hdr->family);
+		return -1;
+	}
+
+	return 0;
+stream_failure:
+	return -1;
+}
+
+int zapi_route_bulk_decode_route(struct stream *s,
+				 const struct zapi_route_bulk_hdr *hdr,
+				 struct zapi_route *api)
+{
+	memset(api, 0, sizeof(*api));
+
+	api->type = hdr->type;
+	api->instance = hdr->instance;
+	api->safi = hdr->safi;
+	STREAM_GETL(s, api->flags);
+	STREAM_GETL(s, api->message);
+
+	if (zapi_route_decode_body(s, api, hdr->nhgid) < 0)
+		return -1;
+
+	if (api->prefix.family != hdr->family) {
+		flog_err(EC_LIB_ZAPI_ENCODE,
+			 "%s: prefix %pFX does not match the family of the batch",
+			 __func__, &api->prefix);
+		return -1;
+	}
+
+	return 0;
+stream_failure:
+	return -1;
+}
+
 static void zapi_encode_prefix(struct stream *s, struct prefix *p,
 			       uint8_t family)
 {
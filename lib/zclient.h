@@ -235,6 +235,7 @@ typedef enum {
 	ZEBRA_TC_FILTER_ADD,
 	ZEBRA_TC_FILTER_DELETE,
 	ZEBRA_OPAQUE_NOTIFY,
+	ZEBRA_ROUTE_ADD_BULK,
 } zebra_message_types_t;
 /* Zebra message types. Please update the corresponding
  * command_types array with any changes!
@@ -611,6 +612,31 @@ struct zapi_route {
 
 extern char *zclient_dump_route_flags(uint32_t flags, char *buf, size_t len);
 
+/*
+ * ZEBRA_ROUTE_ADD_BULK carries up to a message worth of routes that share
+ * VRF (in the zapi header), type, instance, SAFI, address family and, if
+ * they use one, nexthop-group id. Each route is then encoded as in
+ * ZEBRA_ROUTE_ADD, from the flags on, without those common values.
+ */
+struct zapi_route_bulk_hdr {
+	uint8_t type;
+	unsigned short instance;
+	safi_t safi;
+	uint8_t family;
+#define ZAPI_ROUTE_BULK_NHG 0x01
+	uint32_t nhgid;
+	uint16_t count;
+};
+
+/* Sender side state for building ZEBRA_ROUTE_ADD_BULK messages. */
+struct zapi_route_bulk {
+	struct zclient *zclient;
+	struct stream *s;
+	vrf_id_t vrf_id;
+	struct zapi_route_bulk_hdr hdr;
+	size_t count_pos;
+};
+
 struct zapi_labels {
 	uint8_t message;
 #define ZAPI_LABELS_FTN           0x01
@@ -1114,6 +1140,29 @@ int zapi_nexthop_encode(struct stream *s, const struct zapi_nexthop *api_nh,
 			uint32_t api_flags, uint32_t api_message);
 extern int zapi_route_encode(uint8_t, struct stream *, struct zapi_route *);
 extern int zapi_route_decode(struct stream *s, struct zapi_route *api);
+
+/*
+ * Queue a route for installation. Routes are sent in ZEBRA_ROUTE_ADD_BULK
+ * messages, a message goes out when it is full, when a route that cannot
+ * share it is added, or on zapi_route_bulk_flush(). Anything else sent to
+ * zebra in between must be preceded by a flush to keep the ordering.
+ *
+ * Returns the status of the message sent, if any, ZCLIENT_SEND_SUCCESS if
+ * the route was only queued.
+ */
+extern void zapi_route_bulk_init(struct zapi_route_bulk *bulk,
+				 struct zclient *zclient);
+extern enum zclient_send_status
+zapi_route_bulk_add(struct zapi_route_bulk *bulk, struct zapi_route *api);
+extern enum zclient_send_status
+zapi_route_bulk_flush(struct zapi_route_bulk *bulk);
+extern void zapi_route_bulk_fini(struct zapi_route_bulk *bulk);
+
+extern int zapi_route_bulk_decode_hdr(struct stream *s,
+				      struct zapi_route_bulk_hdr *hdr);
+extern int zapi_route_bulk_decode_route(struct stream *s,
+					const struct zapi_route_bulk_hdr *hdr,
+					struct zapi_route *api);
 extern int zapi_nexthop_decode(struct stream *s, struct zapi_nexthop *api_nh,
 			       uint32_t api_flags, uint32_t api_message);
 bool zapi_nhg_notify_decode(struct stream *s, uint32_t *id,
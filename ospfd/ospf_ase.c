@@ -551,62 +551,226 @@ static int ospf_ase_compare_tables(struct ospf *ospf,
 	return 0;
 }
 
-static void ospf_ase_calculate_timer(struct event *t)
+/* Calculate external route for each AS-external-LSA */
+static void ospf_ase_calculate_all(struct ospf *ospf)
 {
-	struct ospf *ospf;
 	struct ospf_lsa *lsa;
 	struct route_node *rn;
 	struct listnode *node;
 	struct ospf_area *area;
-	struct timeval start_time, stop_time;
+
+	LSDB_LOOP (EXTERNAL_LSDB(ospf), rn, lsa)
+		ospf_ase_calculate_route(ospf, lsa);
+
+	/*  This version simple adds to the table all NSSA areas  */
+	if (ospf->anyNSSA)
+		for (ALL_LIST_ELEMENTS_RO(ospf->areas, node, area)) {
+			if (IS_DEBUG_OSPF_NSSA)
+				zlog_debug("%s: looking at area %pI4",
+					   __func__, &area->area_id);
+
+			if (area->external_routing == OSPF_AREA_NSSA)
+				LSDB_LOOP (NSSA_LSDB(area), rn, lsa)
+					ospf_ase_calculate_route(ospf, lsa);
+		}
+	/* kevinm: And add the NSSA routes in ospf_top */
+	LSDB_LOOP (NSSA_LSDB(ospf), rn, lsa)
+		ospf_ase_calculate_route(ospf, lsa);
+
+	/* Compare old and new external routing table and install the
+	   difference info zebra/kernel */
+	ospf_ase_compare_tables(ospf, ospf->new_external_route,
+				ospf->old_external_route);
+
+	/* Delete old external routing table */
+	ospf_route_table_free(ospf->old_external_route);
+	ospf->old_external_route = ospf->new_external_route;
+	ospf->new_external_route = route_table_init();
+}
+
+static void ospf_ase_prefix_update(struct ospf *ospf, struct prefix_ipv4 *p);
+
+/* Add the destinations of the LSAs in a dependency table under 'p' */
+static void ospf_ase_deps_collect(struct route_table *deps,
+				  struct prefix_ls *p,
+				  struct route_table *prefixes)
+{
+	struct route_node *rn, *top;
+	struct listnode *node;
+	struct ospf_lsa *lsa;
+	struct as_external_lsa *al;
+	struct prefix_ipv4 dest;
+
+	/*
+	 * The walk stops at 'top', so keep it locked: if route_node_get()
+	 * just created it, leaving it would free it.
+	 */
+	top = route_node_get(deps, (struct prefix *)p);
+	for (rn = route_lock_node(top); rn; rn = route_next_until(rn, top)) {
+		if (!rn->info)
+			continue;
+
+		for (ALL_LIST_ELEMENTS_RO((struct list *)rn->info, node, lsa)) {
+			al = (struct as_external_lsa *)lsa->data;
+			dest.family = AF_INET;
+			dest.prefix = al->header.id;
+			dest.prefixlen = ip_masklen(al->mask);
+			apply_mask_ipv4(&dest);
+
+			ospf_prc_prefix_add(prefixes, &dest);
+		}
+	}
+	route_unlock_node(top);
+}
+
+static unsigned long ospf_ase_lsa_count(struct ospf *ospf)
+{
+	struct listnode *node;
+	struct ospf_area *area;
+	unsigned long count;
+
+	count = ospf_lsdb_count(ospf->lsdb, OSPF_AS_EXTERNAL_LSA);
+	for (ALL_LIST_ELEMENTS_RO(ospf->areas, node, area))
+		if (area->external_routing == OSPF_AREA_NSSA)
+			count += ospf_lsdb_count(area->lsdb, OSPF_AS_NSSA_LSA);
+
+	return count;
+}
+
+/*
+ * Recalculate only the external routes that depend on what changed since
+ * the last calculation: the route to their ASBR or to their forwarding
+ * address, or an internal route to their destination.  Returns the number
+ * of destinations, or -1 when that is most of them and recalculating
+ * everything is cheaper.
+ */
+static long ospf_ase_calculate_changed(struct ospf *ospf)
+{
+	struct route_table *prefixes;
+	struct route_node *rn, *ext_rn;
+	struct prefix_ls key;
+	unsigned long count;
+
+	prefixes = route_table_init();
+	memset(&key, 0, sizeof(key));
+	key.family = AF_UNSPEC;
+
+	/* Routes through an ASBR whose route changed */
+	for (rn = route_top(ospf->ase_asbrs); rn; rn = route_next(rn)) {
+		if (!rn->info)
+			continue;
+		key.prefixlen = IPV4_MAX_BITLEN;
+		key.id = rn->p.u.prefix4;
+		ospf_ase_deps_collect(ospf->ase_asbr_lsas, &key, prefixes);
+	}
+
+	for (rn = route_top(ospf->ase_prefixes); rn; rn = route_next(rn)) {
+		if (!rn->info)
+			continue;
+
+		/* Routes through a forwarding address in it */
+		key.prefixlen = rn->p.prefixlen;
+		key.id = rn->p.u.prefix4;
+		ospf_ase_deps_collect(ospf->ase_fwd_lsas, &key, prefixes);
+
+		/* An internal route to it appeared or went away */
+		ext_rn = route_node_lookup(ospf->external_lsas, &rn->p);
+		if (ext_rn) {
+			if (ext_rn->info)
+				ospf_prc_prefix_add(
+					prefixes, (struct prefix_ipv4 *)&rn->p);
+			route_unlock_node(ext_rn);
+		}
+	}
+
+	count = ospf_prc_prefix_count(prefixes);
+	if (count > ospf_ase_lsa_count(ospf) / 2) {
+		route_table_finish(prefixes);
+		return -1;
+	}
+
+	for (rn = route_top(prefixes); rn; rn = route_next(rn))
+		if (rn->info)
+			ospf_ase_prefix_update(ospf,
+					       (struct prefix_ipv4 *)&rn->p);
+
+	route_table_finish(prefixes);
+
+	return count;
+}
+
+/* Forget the changes noted for the next external route calculation */
+static void ospf_ase_changes_reset(struct ospf *ospf)
+{
+	ospf->ase_full_pending = false;
+
+	if (route_table_count(ospf->ase_asbrs)) {
+		route_table_finish(ospf->ase_asbrs);
+		ospf->ase_asbrs = route_table_init();
+	}
+	if (route_table_count(ospf->ase_prefixes)) {
+		route_table_finish(ospf->ase_prefixes);
+		ospf->ase_prefixes = route_table_init();
+	}
+}
+
+/*
+ * Calculate the external routes: only those depending on what changed
+ * since the last calculation when that is possible, see
+ * ospf_ase_calculate_changed().  Returns how many destinations that was,
+ * or -1 for a calculation of all of them.
+ */
+long ospf_ase_calculate(struct ospf *ospf)
+{
+	struct timeval start_time;
+	unsigned long usec;
+	long count = -1;
+
+	monotime(&start_time);
+
+	if (!ospf->ase_full_pending)
+		count = ospf_ase_calculate_changed(ospf);
+	if (count < 0)
+		ospf_ase_calculate_all(ospf);
+	ospf_ase_changes_reset(ospf);
+
+	usec = monotime_since(&start_time, NULL);
+	ospf->ase_stats.last_usec = usec;
+	if (count < 0) {
+		ospf->ase_stats.full++;
+		ospf->ase_stats.full_usec += usec;
+		if (usec > ospf->ase_stats.full_max_usec)
+			ospf->ase_stats.full_max_usec = usec;
+	} else {
+		ospf->ase_stats.incremental++;
+		ospf->ase_stats.prefixes += count;
+		ospf->ase_stats.incremental_usec += usec;
+		if (usec > ospf->ase_stats.incremental_max_usec)
+			ospf->ase_stats.incremental_max_usec = usec;
+	}
+
+	if (IS_DEBUG_OSPF_EVENT) {
+		if (count < 0)
+			zlog_info("SPF Processing Time(usecs): External Routes: %lu",
+				  usec);
+		else
+			zlog_info("SPF Processing Time(usecs): External Routes: %lu (%ld destinations)",
+				  usec, count);
+	}
+
+	return count;
+}
+
+static void ospf_ase_calculate_timer(struct event *t)
+{
+	struct ospf *ospf;
 
 	ospf = EVENT_ARG(t);
 	ospf->t_ase_calc = NULL;
 
 	if (ospf->ase_calc) {
 		ospf->ase_calc = 0;
-
-		monotime(&start_time);
-
-		/* Calculate external route for each AS-external-LSA */
-		LSDB_LOOP (EXTERNAL_LSDB(ospf), rn, lsa)
-			ospf_ase_calculate_route(ospf, lsa);
-
-		/*  This version simple adds to the table all NSSA areas  */
-		if (ospf->anyNSSA)
-			for (ALL_LIST_ELEMENTS_RO(ospf->areas, node, area)) {
-				if (IS_DEBUG_OSPF_NSSA)
-					zlog_debug("%s: looking at area %pI4",
-						   __func__, &area->area_id);
-
-				if (area->external_routing == OSPF_AREA_NSSA)
-					LSDB_LOOP (NSSA_LSDB(area), rn, lsa)
-						ospf_ase_calculate_route(ospf,
-									 lsa);
-			}
-		/* kevinm: And add the NSSA routes in ospf_top */
-		LSDB_LOOP (NSSA_LSDB(ospf), rn, lsa)
-			ospf_ase_calculate_route(ospf, lsa);
-
-		/* Compare old and new external routing table and install the
-		   difference info zebra/kernel */
-		ospf_ase_compare_tables(ospf, ospf->new_external_route,
-					ospf->old_external_route);
-
-		/* Delete old external routing table */
-		ospf_route_table_free(ospf->old_external_route);
-		ospf->old_external_route = ospf->new_external_route;
-		ospf->new_external_route = route_table_init();
-
-		monotime(&stop_time);
-
-		if (IS_DEBUG_OSPF_EVENT)
-			zlog_info(
-				"SPF Processing Time(usecs): External Routes: %lld",
-				(stop_time.tv_sec - start_time.tv_sec)
-						* 1000000LL
-					+ (stop_time.tv_usec
-					   - start_time.tv_usec));
+		ospf_ase_calculate(ospf);
 	}
 
 	/*
@@ -637,6 +801,61 @@ void ospf_ase_calculate_timer_add(struct ospf *ospf)
 			OSPF_ASE_CALC_INTERVAL, &ospf->t_ase_calc);
 }
 
+/* Dependency tables are keyed by an address, then the LSA's ID */
+static void ospf_ase_dep_key(struct prefix_ls *lp, struct in_addr addr,
+			     struct ospf_lsa *lsa)
+{
+	memset(lp, 0, sizeof(*lp));
+	lp->family = AF_UNSPEC;
+	lp->prefixlen = 64;
+	lp->id = addr;
+	lp->adv_router = lsa->data->id;
+}
+
+static void ospf_ase_dep_add(struct route_table *deps, struct in_addr addr,
+			     struct ospf_lsa *lsa)
+{
+	struct route_node *rn;
+	struct prefix_ls lp;
+
+	ospf_ase_dep_key(&lp, addr, lsa);
+
+	rn = route_node_get(deps, (struct prefix *)&lp);
+	if (!rn->info)
+		rn->info = list_new();
+	else
+		route_unlock_node(rn);
+
+	listnode_add(rn->info, ospf_lsa_lock(lsa));
+}
+
+static void ospf_ase_dep_del(struct route_table *deps, struct in_addr addr,
+			     struct ospf_lsa *lsa)
+{
+	struct route_node *rn;
+	struct prefix_ls lp;
+	struct list *lst;
+
+	ospf_ase_dep_key(&lp, addr, lsa);
+
+	rn = route_node_lookup(deps, (struct prefix *)&lp);
+	if (!rn)
+		return;
+
+	lst = rn->info;
+	if (listnode_lookup(lst, lsa)) {
+		listnode_delete(lst, lsa);
+		ospf_lsa_unlock(&lsa);
+	}
+
+	if (!listcount(lst)) {
+		list_delete(&lst);
+		rn->info = NULL;
+		route_unlock_node(rn);
+	}
+	route_unlock_node(rn);
+}
+
 void ospf_ase_register_external_lsa(struct ospf_lsa *lsa, struct ospf *top)
 {
 	struct route_node *rn;
@@ -659,6 +878,11 @@ void ospf_ase_register_external_lsa(struct ospf_lsa *lsa, struct ospf *top)
 	/* We assume that if LSA is deleted from DB
 	   is is also deleted from this RT */
 	listnode_add(lst, ospf_lsa_lock(lsa)); /* external_lsas lst */
+
+	/* What its route depends on, see ospf_ase_calculate_changed() */
+	ospf_ase_dep_add(top->ase_asbr_lsas, al->header.adv_router, lsa);
+	if (al->e[0].fwd_addr.s_addr != INADDR_ANY)
+		ospf_ase_dep_add(top->ase_fwd_lsas, al->e[0].fwd_addr, lsa);
 }
 
 void ospf_ase_unregister_external_lsa(struct ospf_lsa *lsa, struct ospf *top)
@@ -674,6 +898,10 @@ void ospf_ase_unregister_external_lsa(struct ospf_lsa *lsa, struct ospf *top)
 	p.prefixlen = ip_masklen(al->mask);
 	apply_mask_ipv4(&p);
 
+	ospf_ase_dep_del(top->ase_asbr_lsas, al->header.adv_router, lsa);
+	if (al->e[0].fwd_addr.s_addr != INADDR_ANY)
+		ospf_ase_dep_del(top->ase_fwd_lsas, al->e[0].fwd_addr, lsa);
+
 	rn = route_node_lookup(top->external_lsas, (struct prefix *)&p);
 
 	if (rn) {
@@ -706,20 +934,14 @@ void ospf_ase_external_lsas_finish(struct route_table *rt)
 	route_table_finish(rt);
 }
 
-void ospf_ase_incremental_update(struct ospf *ospf, struct ospf_lsa *lsa)
+/* Recalculate the external route to one prefix */
+static void ospf_ase_prefix_update(struct ospf *ospf, struct prefix_ipv4 *p)
 {
 	struct list *lsas;
 	struct listnode *node;
 	struct route_node *rn, *rn2;
-	struct prefix_ipv4 p;
 	struct route_table *tmp_old;
-	struct as_external_lsa *al;
-
-	al = (struct as_external_lsa *)lsa->data;
-	p.family = AF_INET;
-	p.prefix = lsa->data->id;
-	p.prefixlen = ip_masklen(al->mask);
-	apply_mask_ipv4(&p);
+	struct ospf_lsa *lsa;
 
 	/* if new_table is NULL, there was no spf calculation, thus
 	   incremental update is unneeded */
@@ -730,27 +952,27 @@ void ospf_ase_incremental_update(struct ospf *ospf, struct ospf_lsa *lsa)
 	   to the destination, no recalculation is necessary
 	   (internal routes take precedence). */
 
-	rn = route_node_lookup(ospf->new_table, (struct prefix *)&p);
+	rn = route_node_lookup(ospf->new_table, (struct prefix *)p);
 	if (rn) {
 		route_unlock_node(rn);
 		if (rn->info)
 			return;
 	}
 
-	rn = route_node_lookup(ospf->external_lsas, (struct prefix *)&p);
-	assert(rn);
-	assert(rn->info);
-	lsas = rn->info;
-	route_unlock_node(rn);
-
-	for (ALL_LIST_ELEMENTS_RO(lsas, node, lsa))
-		ospf_ase_calculate_route(ospf, lsa);
+	rn = route_node_lookup(ospf->external_lsas, (struct prefix *)p);
+	if (rn) {
+		lsas = rn->info;
+		route_unlock_node(rn);
+		if (lsas)
+			for (ALL_LIST_ELEMENTS_RO(lsas, node, lsa))
+				ospf_ase_calculate_route(ospf, lsa);
+	}
 
 	/* prepare temporary old routing table for compare */
 	tmp_old = route_table_init();
-	rn = route_node_lookup(ospf->old_external_route, (struct prefix *)&p);
+	rn = route_node_lookup(ospf->old_external_route, (struct prefix *)p);
 	if (rn && rn->info) {
-		rn2 = route_node_get(tmp_old, (struct prefix *)&p);
+		rn2 = route_node_get(tmp_old, (struct prefix *)p);
 		rn2->info = rn->info;
 		route_unlock_node(rn);
 	}
@@ -762,12 +984,12 @@ void ospf_ase_incremental_update(struct ospf *ospf, struct ospf_lsa *lsa)
 	if (rn && rn->info)
 		ospf_route_free((struct ospf_route *)rn->info);
 
-	rn2 = route_node_lookup(ospf->new_external_route, (struct prefix *)&p);
+	rn2 = route_node_lookup(ospf->new_external_route, (struct prefix *)p);
 	/* if new route exists, install it to ospf->old_external_route */
 	if (rn2 && rn2->info) {
 		if (!rn)
 			rn = route_node_get(ospf->old_external_route,
-					    (struct prefix *)&p);
+					    (struct prefix *)p);
 		rn->info = rn2->info;
 	} else {
 		/* remove route node from ospf->old_external_route */
@@ -787,3 +1009,152 @@ void ospf_ase_incremental_update(struct ospf *ospf, struct ospf_lsa *lsa)
 
 	route_table_finish(tmp_old);
 }
+
+void ospf_ase_incremental_update(struct ospf *ospf, struct ospf_lsa *lsa)
+{
+	struct prefix_ipv4 p;
+	struct as_external_lsa *al;
+
+	al = (struct as_external_lsa *)lsa->data;
+	p.family = AF_INET;
+	p.prefix = lsa->data->id;
+	p.prefixlen = ip_masklen(al->mask);
+	apply_mask_ipv4(&p);
+
+	ospf_ase_prefix_update(ospf, &p);
+}
+
+/*
+ * A partial route calculation changed the internal routes to the prefixes
+ * in 'changed'.  Recalculate the external routes to those, in case an
+ * internal one went away, and those using a forwarding address in them.
+ */
+void ospf_ase_prefixes_update(struct ospf *ospf, struct route_table *changed)
+{
+	struct route_table *prefixes;
+	struct route_node *rn;
+	struct prefix_ls key;
+
+	if (!route_table_count(changed))
+		return;
+
+	prefixes = route_table_init();
+	memset(&key, 0, sizeof(key));
+	key.family = AF_UNSPEC;
+
+	for (rn = route_top(changed); rn; rn = route_next(rn)) {
+		if (!rn->info)
+			continue;
+
+		ospf_prc_prefix_add(prefixes, (struct prefix_ipv4 *)&rn->p);
+
+		key.prefixlen = rn->p.prefixlen;
+		key.id = rn->p.u.prefix4;
+		ospf_ase_deps_collect(ospf->ase_fwd_lsas, &key, prefixes);
+	}
+
+	for (rn = route_top(prefixes); rn; rn = route_next(rn))
+		if (rn->info)
+			ospf_ase_prefix_update(ospf,
+					       (struct prefix_ipv4 *)&rn->p);
+
+	route_table_finish(prefixes);
+}
+
+/* Whether the routes to an ABR/ASBR in two ABR/ASBR routing tables differ */
+static bool ospf_ase_rtr_routes_same(struct list *a, struct list *b)
+{
+	struct listnode *na, *nb, *pa, *pb;
+	struct ospf_route *ora, *orb;
+	struct ospf_path *opa, *opb;
+
+	if (listcount(a) != listcount(b))
+		return false;
+
+	for (na = listhead(a), nb = listhead(b); na && nb;
+	     na = listnextnode(na), nb = listnextnode(nb)) {
+		ora = listgetdata(na);
+		orb = listgetdata(nb);
+
+		if (!IPV4_ADDR_SAME(&ora->u.std.area_id, &orb->u.std.area_id)
+		    || ora->cost != orb->cost
+		    || ora->path_type != orb->path_type
+		    || ora->u.std.flags != orb->u.std.flags
+		    || ora->u.std.external_routing
+			       != orb->u.std.external_routing
+		    || listcount(ora->paths) != listcount(orb->paths))
+			return false;
+
+		for (pa = listhead(ora->paths), pb = listhead(orb->paths);
+		     pa && pb; pa = listnextnode(pa), pb = listnextnode(pb)) {
+			opa = listgetdata(pa);
+			opb = listgetdata(pb);
+			if (!IPV4_ADDR_SAME(&opa->nexthop, &opb->nexthop)
+			    || opa->ifindex != opb->ifindex)
+				return false;
+		}
+	}
+
+	return true;
+}
+
+/* Whether 'rtrs' has the same routes to the router of 'rn' */
+static bool ospf_ase_rtr_same(struct route_table *rtrs, struct route_node *rn)
+{
+	struct route_node *other;
+
+	if (!rtrs)
+		return false;
+
+	other = route_node_lookup(rtrs, &rn->p);
+	if (!other)
+		return false;
+	route_unlock_node(other);
+
+	return other->info && ospf_ase_rtr_routes_same(other->info, rn->info);
+}
+
+/*
+ * Note what a routing table calculation changed for the next external
+ * route calculation: which ASBRs' routes, comparing ospf->old_rtrs with
+ * ospf->new_rtrs, and which prefixes' routes, comparing ospf->old_table
+ * with ospf->new_table.
+ */
+void ospf_ase_routes_changed(struct ospf *ospf)
+{
+	struct route_node *rn;
+
+	/* All of them are going to be recalculated anyway */
+	if (ospf->ase_full_pending)
+		return;
+
+	for (rn = route_top(ospf->new_rtrs); rn; rn = route_next(rn))
+		if (rn->info && !ospf_ase_rtr_same(ospf->old_rtrs, rn))
+			ospf_prc_prefix_add(ospf->ase_asbrs,
+					    (struct prefix_ipv4 *)&rn->p);
+
+	if (ospf->old_rtrs)
+		for (rn = route_top(ospf->old_rtrs); rn; rn = route_next(rn))
+			if (rn->info && !ospf_ase_rtr_same(ospf->new_rtrs, rn))
+				ospf_prc_prefix_add(
+					ospf->ase_asbrs,
+					(struct prefix_ipv4 *)&rn->p);
+
+	for (rn = route_top(ospf->new_table); rn; rn = route_next(rn))
+		if (rn->info &&
+		    !ospf_route_match_same(ospf->old_table,
+					   (struct prefix_ipv4 *)&rn->p,
+					   rn->info))
+			ospf_prc_prefix_add(ospf->ase_prefixes,
+					    (struct prefix_ipv4 *)&rn->p);
+
+	if (ospf->old_table)
+		for (rn = route_top(ospf->old_table); rn; rn = route_next(rn))
+			if (rn->info &&
+			    !ospf_route_match_same(ospf->new_table,
+						   (struct prefix_ipv4 *)&rn->p,
+						   rn->info))
+				ospf_prc_prefix_add(
+					ospf->ase_prefixes,
+					(struct prefix_ipv4 *)&rn->p);
+}
@@ -14,11 +14,15 @@ ospf_find_asbr_route_through_area(struct route_table *, struct prefix_ipv4 *,
 				  struct ospf_area *);
 
 extern int ospf_ase_calculate_route(struct ospf *, struct ospf_lsa *);
+extern long ospf_ase_calculate(struct ospf *ospf);
 extern void ospf_ase_calculate_schedule(struct ospf *);
 extern void ospf_ase_calculate_timer_add(struct ospf *);
 
 extern void ospf_ase_external_lsas_finish(struct route_table *);
 extern void ospf_ase_incremental_update(struct ospf *, struct ospf_lsa *);
+extern void ospf_ase_prefixes_update(struct ospf *ospf,
+				     struct route_table *changed);
+extern void ospf_ase_routes_changed(struct ospf *ospf);
 extern void ospf_ase_register_external_lsa(struct ospf_lsa *, struct ospf *);
 extern void ospf_ase_unregister_external_lsa(struct ospf_lsa *, struct ospf *);
 
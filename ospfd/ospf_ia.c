@@ -266,6 +266,57 @@ static void ospf_examine_summaries(struct ospf_area *area,
 		process_summary_lsa(area, rt, rtrs, lsa);
 }
 
+/*
+ * Process the summary-LSAs for one prefix.  Their Link State ID is the
+ * network address, or the broadcast one when that is taken (RFC 2328
+ * Appendix E), and only those from border routers we reach in the area can
+ * give a route, so look them up that way rather than walking the LSDB.
+ */
+static void ospf_examine_prefix_summaries(struct ospf_area *area,
+					  struct prefix_ipv4 *p,
+					  struct route_table *rt,
+					  struct route_table *rtrs)
+{
+	struct route_node *rn;
+	struct ospf_route *or;
+	struct listnode *node;
+	struct ospf_lsa *lsa;
+	struct summary_lsa *sl;
+	struct in_addr mask, id[2];
+	int i;
+
+	masklen2ip(p->prefixlen, &mask);
+	id[0] = p->prefix;
+	id[1].s_addr = p->prefix.s_addr | ~mask.s_addr;
+
+	for (rn = route_top(rtrs); rn; rn = route_next(rn)) {
+		if (!rn->info)
+			continue;
+
+		for (ALL_LIST_ELEMENTS_RO((struct list *)rn->info, node, or))
+			if (IPV4_ADDR_SAME(&or->u.std.area_id, &area->area_id)
+			    && (or->u.std.flags & ROUTER_LSA_BORDER))
+				break;
+		if (!or)
+			continue;
+
+		for (i = 0; i < 2; i++) {
+			if (i && IPV4_ADDR_SAME(&id[0], &id[1]))
+				break;
+
+			lsa = ospf_lsdb_lookup_by_id(area->lsdb,
+						     OSPF_SUMMARY_LSA, id[i],
+						     rn->p.u.prefix4);
+			if (!lsa)
+				continue;
+
+			sl = (struct summary_lsa *)lsa->data;
+			if (sl->mask.s_addr == mask.s_addr)
+				process_summary_lsa(area, rt, rtrs, lsa);
+		}
+	}
+}
+
 int ospf_area_is_transit(struct ospf_area *area)
 {
 	return (area->transit == OSPF_TRANSIT_TRUE)
@@ -666,3 +717,46 @@ void ospf_ia_routing(struct ospf *ospf, struct route_table *rt,
 			OSPF_EXAMINE_SUMMARIES_ALL(area, rt, rtrs);
 	}
 }
+
+/*
+ * Inter-area routes to the prefixes in 'prefixes' only, for a partial route
+ * calculation.  The areas are chosen as in ospf_ia_routing(); the caller
+ * makes sure there are no transit areas or shortcuts to consider.
+ */
+void ospf_ia_routing_prefixes(struct ospf *ospf, struct route_table *rt,
+			      struct route_table *rtrs,
+			      struct route_table *prefixes)
+{
+	struct listnode *node;
+	struct ospf_area *area;
+	struct route_node *rn;
+	bool backbone_only = false;
+
+	if (IS_OSPF_ABR(ospf)) {
+		switch (ospf->abr_type) {
+		case OSPF_ABR_STAND:
+			if (!ospf->backbone)
+				return;
+			backbone_only = true;
+			break;
+		case OSPF_ABR_IBM:
+		case OSPF_ABR_CISCO:
+			backbone_only = ospf->backbone
+					&& ospf_act_bb_connection(ospf);
+			break;
+		default:
+			return;
+		}
+	}
+
+	for (rn = route_top(prefixes); rn; rn = route_next(rn)) {
+		if (!rn->info)
+			continue;
+
+		for (ALL_LIST_ELEMENTS_RO(ospf->areas, node, area))
+			if (!backbone_only || area == ospf->backbone)
+				ospf_examine_prefix_summaries(
+					area, (struct prefix_ipv4 *)&rn->p, rt,
+					rtrs);
+	}
+}
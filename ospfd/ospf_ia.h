@@ -24,6 +24,9 @@
 
 extern void ospf_ia_routing(struct ospf *, struct route_table *,
 			    struct route_table *);
+extern void ospf_ia_routing_prefixes(struct ospf *ospf, struct route_table *rt,
+				     struct route_table *rtrs,
+				     struct route_table *prefixes);
 extern int ospf_area_is_transit(struct ospf_area *);
 
 #endif /* _ZEBRA_OSPF_IA_H */
@@ -3019,6 +3019,7 @@ struct ospf_lsa *ospf_lsa_install(struct ospf *ospf, struct ospf_interface *oi,
 				ospf_helper_handle_topo_chg(ospf, lsa);
 		}
 
+		ospf_spf_lsa_changed(old, lsa);
 		rt_recalc = 1;
 	}
 
@@ -3403,6 +3404,7 @@ static int ospf_lsa_maxage_walker_remover(struct ospf *ospf,
 				ospf_ase_incremental_update(ospf, lsa);
 				break;
 			default:
+				ospf_spf_lsa_changed(lsa, NULL);
 				ospf_spf_calculate_schedule(ospf,
 							    SPF_FLAG_MAXAGE);
 				break;
@@ -347,6 +347,117 @@ void ospf_route_install(struct ospf *ospf, struct route_table *rt)
 		}
 }
 
+/*
+ * Put a route into ospf->new_table in place of the one there, if any.  The
+ * replaced route is kept in ospf->old_table until the external routes that
+ * may point at it (as route to their forwarding address) are redone.
+ */
+static void ospf_route_replace(struct ospf *ospf, struct prefix_ipv4 *p,
+			       struct ospf_route *or)
+{
+	struct route_node *rn, *old_rn;
+
+	rn = route_node_get(ospf->new_table, (struct prefix *)p);
+	if (rn->info) {
+		route_unlock_node(rn);
+
+		old_rn = route_node_get(ospf->old_table, (struct prefix *)p);
+		if (old_rn->info) {
+			ospf_route_free(old_rn->info);
+			route_unlock_node(old_rn);
+		}
+		old_rn->info = rn->info;
+	}
+
+	rn->info = or;
+	if (!or)
+		route_unlock_node(rn);
+}
+
+/*
+ * Install the routes a partial route calculation found in 'rt' for the
+ * prefixes in 'prefixes'.  Like ospf_route_install(), only what changed is
+ * sent to zebra; those prefixes are added to 'changed'.  Returns how many.
+ */
+unsigned int ospf_route_install_prefixes(struct ospf *ospf,
+					 struct route_table *rt,
+					 struct route_table *prefixes,
+					 struct route_table *changed)
+{
+	struct route_node *pn, *rn, *ext_rn;
+	struct ospf_route *or, *new_or;
+	struct prefix_ipv4 *p;
+	unsigned int count = 0;
+
+	if (!ospf->old_table)
+		ospf->old_table = route_table_init();
+
+	for (pn = route_top(prefixes); pn; pn = route_next(pn)) {
+		if (!pn->info)
+			continue;
+
+		p = (struct prefix_ipv4 *)&pn->p;
+
+		new_or = NULL;
+		rn = route_node_lookup(rt, &pn->p);
+		if (rn) {
+			new_or = rn->info;
+			rn->info = NULL;
+			if (new_or)
+				route_unlock_node(rn);
+			route_unlock_node(rn);
+		}
+
+		or = NULL;
+		rn = route_node_lookup(ospf->new_table, &pn->p);
+		if (rn) {
+			or = rn->info;
+			route_unlock_node(rn);
+		}
+
+		/* Area range discard routes are the ABR task's business */
+		if (or && or->type == OSPF_DESTINATION_DISCARD) {
+			if (new_or)
+				ospf_route_free(new_or);
+			continue;
+		}
+
+		if (new_or) {
+			/* As ospf_route_delete_same_ext() */
+			ext_rn = route_node_lookup(ospf->old_external_route,
+						   &pn->p);
+			if (ext_rn) {
+				if (ext_rn->info) {
+					ospf_zebra_delete(ospf, p,
+							  ext_rn->info);
+					ospf_route_free(ext_rn->info);
+					ext_rn->info = NULL;
+					route_unlock_node(ext_rn);
+				}
+				route_unlock_node(ext_rn);
+			}
+
+			/* Keep the route external ones may point at */
+			if (ospf_route_match_same(ospf->new_table, p, new_or)) {
+				ospf_route_free(new_or);
+				continue;
+			}
+			ospf_zebra_add(ospf, p, new_or);
+		} else if (or) {
+			if (or->path_type == OSPF_PATH_INTRA_AREA ||
+			    or->path_type == OSPF_PATH_INTER_AREA)
+				ospf_zebra_delete(ospf, p, or);
+		} else
+			continue;
+
+		ospf_route_replace(ospf, p, new_or);
+		ospf_prc_prefix_add(changed, p);
+		count++;
+	}
+
+	return count;
+}
+
 /* RFC2328 16.1. (4). For "router". */
 void ospf_intra_add_router(struct route_table *rt, struct vertex *v,
 			   struct ospf_area *area, bool add_only)
@@ -125,6 +125,10 @@ extern void ospf_route_delete(struct ospf *, struct route_table *);
 extern void ospf_route_table_free(struct route_table *);
 
 extern void ospf_route_install(struct ospf *, struct route_table *);
+extern unsigned int ospf_route_install_prefixes(struct ospf *ospf,
+						struct route_table *rt,
+						struct route_table *prefixes,
+						struct route_table *changed);
 extern void ospf_route_table_dump(struct route_table *);
 extern void ospf_router_route_table_dump(struct route_table *rt);
 
@@ -15,6 +15,8 @@
 #include "table.h"
 #include "log.h"
 #include "sockunion.h" /* for inet_ntop () */
+#include "frr_pthread.h"
+#include "frratomic.h"
 
 #include "ospfd/ospfd.h"
 #include "ospfd/ospf_interface.h"
@@ -196,8 +198,6 @@ static struct vertex *ospf_vertex_new(struct ospf_area *area,
 
 	lsa->stat = new;
 
-	listnode_add(area->spf_vertex_list, new);
-
 	if (IS_DEBUG_OSPF_EVENT)
 		zlog_debug("%s: Created %s vertex %pI4", __func__,
 			   new->type == OSPF_VERTEX_ROUTER ? "Router"
@@ -541,16 +541,16 @@ static void ospf_spf_init(struct ospf_area *area, struct ospf_lsa *root_lsa,
 	vertex_list->del = ospf_vertex_free;
 	area->spf_vertex_list = vertex_list;
 
-	/* Create root node. */
+	/*
+	 * Create root node.  Other vertices are added to the list as they
+	 * join the tree, see ospf_spf_calculate_tree().
+	 */
 	v = ospf_vertex_new(area, root_lsa);
+	listnode_add(vertex_list, v);
 	area->spf = v;
 
 	area->spf_dry_run = is_dry_run;
 	area->spf_root_node = is_root_node;
-
-	/* Reset ABR and ASBR router counts. */
-	area->abr_count = 0;
-	area->asbr_count = 0;
 }
 
 /* return index of link back to V from W, or -1 if no link found */
@@ -898,9 +898,11 @@ static unsigned int ospf_nexthop_calculation(struct ospf_area *area,
 				 * we just check here if it is enabled and then
 				 * blindly assume that P2P is used. Ultimately
 				 * the interface code needs to be removed
-				 * somehow.
+				 * somehow. Dry runs have no interfaces to
+				 * look at either.
 				 */
 				if (area->ospf->ti_lfa_enabled
+				    || area->spf_dry_run
 				    || (oi && oi->type == OSPF_IFTYPE_POINTOPOINT)
 				    || (oi && oi->type == OSPF_IFTYPE_POINTOMULTIPOINT
 					   && oi->address->prefixlen == IPV4_MAX_BITLEN)) {
@@ -1485,7 +1487,6 @@ static void ospf_spf_next(struct vertex *v, struct ospf_area *area,
 						     lsa_pos))
 				vertex_pqueue_add(candidate, w);
 			else {
-				listnode_delete(area->spf_vertex_list, w);
 				ospf_vertex_free(w);
 				w_lsa->stat = LSA_SPF_NOT_EXPLORED;
 				if (IS_DEBUG_OSPF_EVENT)
@@ -1581,9 +1582,33 @@ void ospf_spf_print(struct vty *vty, struct vertex *v, int i)
 		ospf_spf_print(vty, v, i);
 }
 
-/* Second stage of SPF calculation. */
+/* Whether a stub link's prefix is one of 'prefixes' */
+static bool ospf_prc_stub_match(struct route_table *prefixes,
+				struct router_lsa_link *l)
+{
+	struct route_node *rn;
+	struct prefix_ipv4 p;
+
+	p.family = AF_INET;
+	p.prefix = l->link_id;
+	p.prefixlen = ip_masklen(l->link_data);
+	apply_mask_ipv4(&p);
+
+	rn = route_node_lookup(prefixes, (struct prefix *)&p);
+	if (!rn)
+		return false;
+	route_unlock_node(rn);
+
+	return rn->info != NULL;
+}
+
+/*
+ * Second stage of SPF calculation.  With 'only' set, just the stub links to
+ * those prefixes, for a partial route calculation.
+ */
 static void ospf_spf_process_stubs(struct ospf_area *area, struct vertex *v,
-				   struct route_table *rt, int parent_is_root)
+				   struct route_table *rt, int parent_is_root,
+				   struct route_table *only)
 {
 	struct listnode *cnode, *cnnode;
 	struct vertex *child;
@@ -1620,6 +1645,7 @@ static void ospf_spf_process_stubs(struct ospf_area *area, struct vertex *v,
 
 			/* Don't process TI-LFA protected resources */
 			if (l->m[0].type == LSA_LINK_TYPE_STUB
+			    && (!only || ospf_prc_stub_match(only, l))
 			    && !ospf_spf_is_protected_resource(area, l, v->lsa))
 				ospf_intra_add_stub(rt, l, v, area,
 						    parent_is_root, lsa_pos);
@@ -1644,7 +1670,7 @@ static void ospf_spf_process_stubs(struct ospf_area *area, struct vertex *v,
 		else if (v->type == OSPF_VERTEX_ROUTER)
 			parent_is_root = 0;
 
-		ospf_spf_process_stubs(area, child, rt, parent_is_root);
+		ospf_spf_process_stubs(area, child, rt, parent_is_root, only);
 
 		SET_FLAG(child->flags, OSPF_VERTEX_PROCESSED);
 	}
@@ -1690,12 +1716,19 @@ void ospf_spf_cleanup(struct vertex *spf, struct list *vertex_list)
 		list_delete(&vertex_list);
 }
 
-/* Calculating the shortest-path tree for an area, see RFC2328 16.1. */
-void ospf_spf_calculate(struct ospf_area *area, struct ospf_lsa *root_lsa,
-			struct route_table *new_table,
-			struct route_table *all_rtrs,
-			struct route_table *new_rtrs, bool is_dry_run,
-			bool is_root_node)
+/*
+ * First stage of the SPF calculation, RFC2328 16.1. (1) to (3): build the
+ * shortest-path tree.  Vertices are appended to area->spf_vertex_list in the
+ * order they join the tree, for ospf_spf_calculate_tables().
+ *
+ * Only the area's own LSDB, interfaces and vertices are used, except for the
+ * nexthops of virtual links in the backbone.  The trees of non-backbone
+ * areas can therefore be computed on SPF pthreads, see
+ * ospf_spf_calculate_trees().
+ */
+static bool ospf_spf_calculate_tree(struct ospf_area *area,
+				    struct ospf_lsa *root_lsa, bool is_dry_run,
+				    bool is_root_node)
 {
 	struct vertex_pqueue_head candidate;
 	struct vertex *v;
@@ -1715,7 +1748,7 @@ void ospf_spf_calculate(struct ospf_area *area, struct ospf_lsa *root_lsa,
 			zlog_debug(
 				"%s: Skip area %pI4's calculation due to empty root LSA",
 				__func__, &area->area_id);
-		return;
+		return false;
 	}
 
 	/* Initialize the algorithm's data structures, see RFC2328 16.1. (1). */
@@ -1737,7 +1770,6 @@ void ospf_spf_calculate(struct ospf_area *area, struct ospf_lsa *root_lsa,
 
 	/* Set Area A's TransitCapability to false. */
 	area->transit = OSPF_TRANSIT_FALSE;
-	area->shortcut_capability = 1;
 
 	/*
 	 * Use the root vertex for the start of the SPF algorithm and make it
@@ -1760,7 +1792,38 @@ void ospf_spf_calculate(struct ospf_area *area, struct ospf_lsa *root_lsa,
 
 		ospf_vertex_add_parent(v);
 
-		/* RFC2328 16.1. (4). */
+		listnode_add(area->spf_vertex_list, v);
+
+		/* Iterate back to (2), see RFC2328 16.1. (5). */
+	}
+
+	return true;
+}
+
+/*
+ * RFC2328 16.1. (4) for each vertex of the tree, in the order they joined
+ * it, and then the second stage: add the stub networks.
+ */
+static void ospf_spf_calculate_tables(struct ospf_area *area,
+				      struct route_table *new_table,
+				      struct route_table *all_rtrs,
+				      struct route_table *new_rtrs)
+{
+	struct listnode *node;
+	struct vertex *v;
+
+	area->shortcut_capability = 1;
+
+	/* Reset ABR and ASBR router counts. */
+	area->abr_count = 0;
+	area->asbr_count = 0;
+
+	for (ALL_LIST_ELEMENTS_RO(area->spf_vertex_list, node, v)) {
+		UNSET_FLAG(v->flags, OSPF_VERTEX_PROCESSED);
+
+		if (v == area->spf)
+			continue;
+
 		if (v->type != OSPF_VERTEX_ROUTER)
 			ospf_intra_add_transit(new_table, v, area);
 		else {
@@ -1769,8 +1832,6 @@ void ospf_spf_calculate(struct ospf_area *area, struct ospf_lsa *root_lsa,
 			if (all_rtrs)
 				ospf_intra_add_router(all_rtrs, v, area, true);
 		}
-
-		/* Iterate back to (2), see RFC2328 16.1. (5). */
 	}
 
 	if (IS_DEBUG_OSPF_EVENT) {
@@ -1784,7 +1845,7 @@ void ospf_spf_calculate(struct ospf_area *area, struct ospf_lsa *root_lsa,
 	 * Second stage of SPF calculation procedure's, add leaves to the tree
 	 * for stub networks.
 	 */
-	ospf_spf_process_stubs(area, area->spf, new_table, 0);
+	ospf_spf_process_stubs(area, area->spf, new_table, 0, NULL);
 
 	ospf_vertex_dump(__func__, area->spf, 0, 1);
 
@@ -1799,22 +1860,474 @@ void ospf_spf_calculate(struct ospf_area *area, struct ospf_lsa *root_lsa,
 			   mtype_stats_alloc(MTYPE_OSPF_VERTEX));
 }
 
+/* Calculating the shortest-path tree for an area, see RFC2328 16.1. */
+void ospf_spf_calculate(struct ospf_area *area, struct ospf_lsa *root_lsa,
+			struct route_table *new_table,
+			struct route_table *all_rtrs,
+			struct route_table *new_rtrs, bool is_dry_run,
+			bool is_root_node)
+{
+	if (!ospf_spf_calculate_tree(area, root_lsa, is_dry_run, is_root_node))
+		return;
+
+	ospf_spf_calculate_tables(area, new_table, all_rtrs, new_rtrs);
+}
+
+/*
+ * Whether two instances of a router-LSA give the same shortest-path tree:
+ * same flags, and the same links at the same positions, except that links
+ * to stub networks may differ and may be added or removed at the end.
+ * Those are only looked at by ospf_spf_process_stubs().
+ */
+static bool ospf_spf_router_lsa_same_tree(struct lsa_header *a,
+					  struct lsa_header *b)
+{
+	struct router_lsa_link *la, *lb;
+	uint8_t *pa, *pb, *lima, *limb;
+
+	if (((struct router_lsa *)a)->flags != ((struct router_lsa *)b)->flags)
+		return false;
+
+	pa = ((uint8_t *)a) + OSPF_LSA_HEADER_SIZE + 4;
+	lima = ((uint8_t *)a) + ntohs(a->length);
+	pb = ((uint8_t *)b) + OSPF_LSA_HEADER_SIZE + 4;
+	limb = ((uint8_t *)b) + ntohs(b->length);
+
+	while (pa < lima || pb < limb) {
+		la = lb = NULL;
+		if (pa < lima) {
+			la = (struct router_lsa_link *)pa;
+			pa += OSPF_ROUTER_LSA_LINK_SIZE +
+			      la->m[0].tos_count * OSPF_ROUTER_LSA_TOS_SIZE;
+		}
+		if (pb < limb) {
+			lb = (struct router_lsa_link *)pb;
+			pb += OSPF_ROUTER_LSA_LINK_SIZE +
+			      lb->m[0].tos_count * OSPF_ROUTER_LSA_TOS_SIZE;
+		}
+
+		if (!la || !lb) {
+			if ((la ? la : lb)->m[0].type != LSA_LINK_TYPE_STUB)
+				return false;
+			continue;
+		}
+
+		if (la->m[0].type != lb->m[0].type)
+			return false;
+		if (la->m[0].type == LSA_LINK_TYPE_STUB)
+			continue;
+		if (la->link_id.s_addr != lb->link_id.s_addr ||
+		    la->link_data.s_addr != lb->link_data.s_addr ||
+		    la->m[0].metric != lb->m[0].metric)
+			return false;
+	}
+
+	return true;
+}
+
+/* Add a prefix to a set of them, as kept in ospf->prc_prefixes */
+void ospf_prc_prefix_add(struct route_table *prefixes, struct prefix_ipv4 *p)
+{
+	struct route_node *rn;
+
+	rn = route_node_get(prefixes, (struct prefix *)p);
+	if (rn->info)
+		route_unlock_node(rn);
+	else
+		rn->info = (void *)1;
+}
+
+/*
+ * Number of prefixes in such a set.  route_table_count() would also count
+ * the glue nodes the table adds between them.
+ */
+unsigned long ospf_prc_prefix_count(struct route_table *prefixes)
+{
+	struct route_node *rn;
+	unsigned long count = 0;
+
+	for (rn = route_top(prefixes); rn; rn = route_next(rn))
+		if (rn->info)
+			count++;
+
+	return count;
+}
+
+static void ospf_prc_stub_add(struct route_table *prefixes,
+			      struct router_lsa_link *l)
+{
+	struct prefix_ipv4 p;
+
+	p.family = AF_INET;
+	p.prefix = l->link_id;
+	p.prefixlen = ip_masklen(l->link_data);
+	apply_mask_ipv4(&p);
+
+	ospf_prc_prefix_add(prefixes, &p);
+}
+
+/*
+ * Note the prefixes of the stub links that differ between two instances of
+ * a router-LSA giving the same tree, compared position by position as in
+ * ospf_spf_router_lsa_same_tree().
+ */
+static void ospf_prc_stubs_changed(struct route_table *prefixes,
+				   struct lsa_header *a, struct lsa_header *b)
+{
+	struct router_lsa_link *la, *lb;
+	uint8_t *pa, *pb, *lima, *limb;
+
+	pa = ((uint8_t *)a) + OSPF_LSA_HEADER_SIZE + 4;
+	lima = ((uint8_t *)a) + ntohs(a->length);
+	pb = ((uint8_t *)b) + OSPF_LSA_HEADER_SIZE + 4;
+	limb = ((uint8_t *)b) + ntohs(b->length);
+
+	while (pa < lima || pb < limb) {
+		la = lb = NULL;
+		if (pa < lima) {
+			la = (struct router_lsa_link *)pa;
+			pa += OSPF_ROUTER_LSA_LINK_SIZE +
+			      la->m[0].tos_count * OSPF_ROUTER_LSA_TOS_SIZE;
+		}
+		if (pb < limb) {
+			lb = (struct router_lsa_link *)pb;
+			pb += OSPF_ROUTER_LSA_LINK_SIZE +
+			      lb->m[0].tos_count * OSPF_ROUTER_LSA_TOS_SIZE;
+		}
+
+		if (la && lb && la->m[0].type == LSA_LINK_TYPE_STUB &&
+		    la->link_id.s_addr == lb->link_id.s_addr &&
+		    la->link_data.s_addr == lb->link_data.s_addr &&
+		    la->m[0].metric == lb->m[0].metric)
+			continue;
+
+		if (la && la->m[0].type == LSA_LINK_TYPE_STUB)
+			ospf_prc_stub_add(prefixes, la);
+		if (lb && lb->m[0].type == LSA_LINK_TYPE_STUB)
+			ospf_prc_stub_add(prefixes, lb);
+	}
+}
+
+static void ospf_prc_summary_add(struct route_table *prefixes,
+				 struct ospf_lsa *lsa)
+{
+	struct summary_lsa *sl = (struct summary_lsa *)lsa->data;
+	struct prefix_ipv4 p;
+
+	p.family = AF_INET;
+	p.prefix = sl->header.id;
+	p.prefixlen = ip_masklen(sl->mask);
+	apply_mask_ipv4(&p);
+
+	ospf_prc_prefix_add(prefixes, &p);
+}
+
+/*
+ * An LSA was installed, changed or aged out: note whether the area's kept
+ * shortest-path tree may no longer be right.  Summary-LSAs and changes to
+ * stub links are leaves of the tree and never invalidate it; the prefixes
+ * they are about are noted for a partial route calculation instead.
+ */
+void ospf_spf_lsa_changed(struct ospf_lsa *old, struct ospf_lsa *new)
+{
+	struct ospf_lsa *lsa = new ? new : old;
+	struct ospf *ospf;
+
+	if (!lsa->area)
+		return;
+
+	ospf = lsa->area->ospf;
+
+	switch (lsa->data->type) {
+	case OSPF_ROUTER_LSA:
+		if (old && new && !IS_LSA_MAXAGE(old) && !IS_LSA_MAXAGE(new)
+		    && ospf_spf_router_lsa_same_tree(old->data, new->data)) {
+			ospf_prc_stubs_changed(ospf->prc_prefixes, old->data,
+					       new->data);
+			lsa->area->spf_stubs_changed = true;
+			return;
+		}
+		break;
+	case OSPF_NETWORK_LSA:
+		break;
+	case OSPF_SUMMARY_LSA:
+		if (old)
+			ospf_prc_summary_add(ospf->prc_prefixes, old);
+		if (new)
+			ospf_prc_summary_add(ospf->prc_prefixes, new);
+		return;
+	case OSPF_ASBR_SUMMARY_LSA:
+		/* Routes to ASBRs are only redone by a full calculation */
+		ospf->prc_blocked = true;
+		return;
+	default:
+		return;
+	}
+
+	lsa->area->spf_topo_changed = true;
+}
+
+/* Free a tree kept by ospf_spf_tree_keep() */
+static void ospf_spf_tree_release(struct ospf_area *area)
+{
+	struct listnode *node;
+	struct vertex *v;
+	struct ospf_lsa *lsa;
+
+	if (!area->spf)
+		return;
+
+	for (ALL_LIST_ELEMENTS_RO(area->spf_vertex_list, node, v)) {
+		lsa = v->lsa_p;
+		ospf_lsa_unlock(&lsa);
+	}
+
+	ospf_spf_cleanup(area->spf, area->spf_vertex_list);
+
+	area->spf = NULL;
+	area->spf_vertex_list = NULL;
+}
+
+/* Keep the area's tree for the next SPF, see ospf_spf_tree_refresh() */
+static void ospf_spf_tree_keep(struct ospf_area *area)
+{
+	struct listnode *node;
+	struct vertex *v;
+
+	for (ALL_LIST_ELEMENTS_RO(area->spf_vertex_list, node, v))
+		ospf_lsa_lock(v->lsa_p);
+}
+
+/*
+ * Point a kept tree at the current instances of its LSAs.  Fails if one of
+ * them is gone or now gives a different tree, which is not expected when
+ * area->spf_topo_changed is not set.
+ */
+static bool ospf_spf_tree_refresh(struct ospf_area *area)
+{
+	struct listnode *node;
+	struct vertex *v;
+	struct ospf_lsa *lsa, *old;
+
+	if (!area->router_lsa_self)
+		return false;
+
+	for (ALL_LIST_ELEMENTS_RO(area->spf_vertex_list, node, v)) {
+		lsa = ospf_lsa_lookup(area->ospf, area, v->lsa->type, v->id,
+				      v->lsa->adv_router);
+
+		if (!lsa || IS_LSA_MAXAGE(lsa))
+			return false;
+		if (lsa == v->lsa_p)
+			continue;
+
+		if (v->type == OSPF_VERTEX_ROUTER) {
+			if (!ospf_spf_router_lsa_same_tree(v->lsa, lsa->data))
+				return false;
+		} else if (ospf_lsa_different(v->lsa_p, lsa, false))
+			return false;
+
+		old = v->lsa_p;
+		v->lsa_p = ospf_lsa_lock(lsa);
+		v->lsa = lsa->data;
+		ospf_lsa_unlock(&old);
+	}
+
+	return area->spf->lsa_p == area->router_lsa_self;
+}
+
+/*
+ * SPF pthreads, shared by all instances.  They are started when first
+ * needed and stay around, idle, until the daemon exits.
+ */
+static struct frr_pthread *spf_pthreads[OSPF_SPF_THREADS_MAX];
+static unsigned int spf_pthreads_count;
+
+/* Area trees handed to the SPF pthreads by ospf_spf_calculate_trees() */
+struct ospf_spf_job {
+	struct ospf_area **areas;
+	unsigned int count;
+	_Atomic unsigned int next;
+
+	pthread_mutex_t mtx;
+	pthread_cond_t cond;
+	unsigned int running;
+};
+
+static void ospf_spf_job_run(struct ospf_spf_job *job)
+{
+	struct ospf_area *area;
+	struct timeval start;
+	unsigned int i;
+
+	for (;;) {
+		i = atomic_fetch_add_explicit(&job->next, 1,
+					      memory_order_relaxed);
+		if (i >= job->count)
+			break;
+
+		area = job->areas[i];
+		monotime(&start);
+		ospf_spf_calculate_tree(area, area->router_lsa_self,
+					area->ospf->spf_dry_run,
+					!area->ospf->spf_dry_run);
+		area->spf_tree_usec = monotime_since(&start, NULL);
+	}
+}
+
+/* Runs in an SPF pthread */
+static void ospf_spf_job_worker(struct event *event)
+{
+	struct ospf_spf_job *job = EVENT_ARG(event);
+
+	ospf_spf_job_run(job);
+
+	frr_with_mutex (&job->mtx) {
+		job->running--;
+		pthread_cond_signal(&job->cond);
+	}
+}
+
+static unsigned int ospf_spf_pthreads_start(unsigned int count)
+{
+	struct frr_pthread_attr attr = {
+		.start = frr_pthread_attr_default.start,
+		.stop = frr_pthread_attr_default.stop
+	};
+	char name[32];
+	char os_name[OS_THREAD_NAMELEN];
+
+	if (count > OSPF_SPF_THREADS_MAX)
+		count = OSPF_SPF_THREADS_MAX;
+
+	while (spf_pthreads_count < count) {
+		snprintf(name, sizeof(name), "OSPF SPF %u",
+			 spf_pthreads_count);
+		snprintf(os_name, sizeof(os_name), "ospf_spf_%u",
+			 spf_pthreads_count);
+		spf_pthreads[spf_pthreads_count] =
+			frr_pthread_new(&attr, name, os_name);
+		frr_pthread_run(spf_pthreads[spf_pthreads_count], NULL);
+		frr_pthread_wait_running(spf_pthreads[spf_pthreads_count]);
+		spf_pthreads_count++;
+	}
+
+	return spf_pthreads_count;
+}
+
+/*
+ * Compute the trees of the non-backbone areas flagged by
+ * ospf_spf_calculate_areas() on the SPF pthreads, the main pthread taking
+ * its share.  It waits for all of them: the LSDBs must not change meanwhile,
+ * and the routing tables are filled in area order afterwards.
+ */
+static bool ospf_spf_calculate_trees(struct ospf *ospf)
+{
+	struct ospf_spf_job job = {};
+	struct ospf_area *area;
+	struct listnode *node;
+	unsigned int i, workers;
+
+	if (ospf->spf_threads < 2 || ospf->ti_lfa_enabled)
+		return false;
+
+	job.areas = XCALLOC(MTYPE_TMP,
+			    sizeof(*job.areas) * listcount(ospf->areas));
+	for (ALL_LIST_ELEMENTS_RO(ospf->areas, node, area))
+		if (area != ospf->backbone && area->spf_topo_changed)
+			job.areas[job.count++] = area;
+
+	if (job.count < 2) {
+		XFREE(MTYPE_TMP, job.areas);
+		return false;
+	}
+
+	workers = MIN(ospf->spf_threads, job.count) - 1;
+	workers = MIN(workers, ospf_spf_pthreads_start(workers));
+
+	pthread_mutex_init(&job.mtx, NULL);
+	pthread_cond_init(&job.cond, NULL);
+	job.running = workers;
+
+	for (i = 0; i < workers; i++)
+		event_add_event(spf_pthreads[i]->master, ospf_spf_job_worker,
+				&job, 0, NULL);
+
+	ospf_spf_job_run(&job);
+
+	frr_with_mutex (&job.mtx) {
+		while (job.running)
+			pthread_cond_wait(&job.cond, &job.mtx);
+	}
+
+	pthread_cond_destroy(&job.cond);
+	pthread_mutex_destroy(&job.mtx);
+	XFREE(MTYPE_TMP, job.areas);
+
+	return true;
+}
+
 void ospf_spf_calculate_area(struct ospf *ospf, struct ospf_area *area,
 			     struct route_table *new_table,
 			     struct route_table *all_rtrs,
 			     struct route_table *new_rtrs)
 {
-	ospf_spf_calculate(area, area->router_lsa_self, new_table, all_rtrs,
-			   new_rtrs, false, true);
+	struct timeval start;
+	bool incremental = false;
+	bool precomputed = area->spf_topo_changed && area->spf;
+
+	monotime(&start);
+
+	/*
+	 * The tree is computed here unless ospf_spf_calculate_trees() already
+	 * did, or the kept one can be used as is.
+	 */
+	if (!area->spf_topo_changed && area->spf &&
+	    ospf_spf_tree_refresh(area))
+		incremental = true;
+	else if (!area->spf_topo_changed || !area->spf) {
+		ospf_spf_tree_release(area);
+		ospf_spf_calculate_tree(area, area->router_lsa_self,
+					ospf->spf_dry_run, !ospf->spf_dry_run);
+		area->spf_tree_usec = monotime_since(&start, NULL);
+	}
+	area->spf_topo_changed = false;
+	area->spf_stubs_changed = false;
+
+	if (area->spf)
+		ospf_spf_calculate_tables(area, new_table, all_rtrs, new_rtrs);
 
 	if (ospf->ti_lfa_enabled)
 		ospf_ti_lfa_compute(area, new_table,
 				    ospf->ti_lfa_protection_type);
 
-	ospf_spf_cleanup(area->spf, area->spf_vertex_list);
+	if (ospf->spf_incremental && !ospf->ti_lfa_enabled && area->spf) {
+		if (!incremental)
+			ospf_spf_tree_keep(area);
+	} else {
+		ospf_spf_cleanup(area->spf, area->spf_vertex_list);
 
-	area->spf = NULL;
-	area->spf_vertex_list = NULL;
+		area->spf = NULL;
+		area->spf_vertex_list = NULL;
+	}
+
+	area->spf_usec = monotime_since(&start, NULL);
+	if (precomputed)
+		area->spf_usec += area->spf_tree_usec;
+
+	if (incremental) {
+		area->spf_incremental++;
+		ospf->spf_stats.incremental++;
+		ospf->spf_stats.incremental_usec += area->spf_usec;
+		if (area->spf_usec > ospf->spf_stats.incremental_max_usec)
+			ospf->spf_stats.incremental_max_usec = area->spf_usec;
+	} else {
+		area->spf_full++;
+		ospf->spf_stats.full++;
+		ospf->spf_stats.full_usec += area->spf_usec;
+		if (area->spf_usec > ospf->spf_stats.full_max_usec)
+			ospf->spf_stats.full_max_usec = area->spf_usec;
+	}
 }
 
 void ospf_spf_calculate_areas(struct ospf *ospf, struct route_table *new_table,
@@ -1823,6 +2336,31 @@ void ospf_spf_calculate_areas(struct ospf *ospf, struct route_table *new_table,
 {
 	struct ospf_area *area;
 	struct listnode *node, *nnode;
+	bool full, changed = false;
+
+	/* Find out which areas need a new tree */
+	full = ospf->spf_full_pending || !ospf->spf_incremental
+	       || ospf->ti_lfa_enabled;
+	ospf->spf_full_pending = false;
+
+	for (ALL_LIST_ELEMENTS_RO(ospf->areas, node, area)) {
+		if (full || !area->spf)
+			area->spf_topo_changed = true;
+		if (area->spf_topo_changed) {
+			ospf_spf_tree_release(area);
+			if (area != ospf->backbone)
+				changed = true;
+		}
+	}
+
+	/* Virtual links' nexthops come from their transit area's tree */
+	if (ospf->backbone && changed && listcount(ospf->vlinks)) {
+		ospf->backbone->spf_topo_changed = true;
+		ospf_spf_tree_release(ospf->backbone);
+	}
+
+	if (ospf_spf_calculate_trees(ospf))
+		ospf->spf_stats.parallel_runs++;
 
 	/* Calculate SPF for each area. */
 	for (ALL_LIST_ELEMENTS(ospf->areas, node, nnode, area)) {
@@ -1841,6 +2379,177 @@ void ospf_spf_calculate_areas(struct ospf *ospf, struct route_table *new_table,
 					all_rtrs, new_rtrs);
 }
 
+/* Forget the tree kept for incremental SPF */
+void ospf_spf_area_release(struct ospf_area *area)
+{
+	ospf_spf_tree_release(area);
+	area->spf_topo_changed = true;
+}
+
+void ospf_spf_trees_release(struct ospf *ospf)
+{
+	struct ospf_area *area;
+	struct listnode *node;
+
+	for (ALL_LIST_ELEMENTS_RO(ospf->areas, node, area))
+		ospf_spf_area_release(area);
+}
+
+/* Forget the changes noted for a partial route calculation */
+static void ospf_prc_reset(struct ospf *ospf)
+{
+	ospf->prc_blocked = false;
+
+	if (!route_table_count(ospf->prc_prefixes))
+		return;
+
+	route_table_finish(ospf->prc_prefixes);
+	ospf->prc_prefixes = route_table_init();
+}
+
+/*
+ * Partial route calculation (PRC): when only prefixes changed since the
+ * last calculation, through summary-LSAs or stub links, the kept area
+ * trees are still right and just the routes to those prefixes need to be
+ * redone.  Virtual links, transit areas, area ranges and the shortcut ABR
+ * type tie routes to each other in more ways, so those still get the full
+ * calculation.
+ */
+bool ospf_prc_possible(struct ospf *ospf)
+{
+	struct ospf_area *area;
+	struct listnode *node;
+
+	if (!ospf->spf_incremental || ospf->ti_lfa_enabled ||
+	    ospf->spf_full_pending || ospf->prc_blocked)
+		return false;
+
+	if (!ospf->new_table || !ospf->new_rtrs)
+		return false;
+
+	if (ospf->gr_info.restart_in_progress ||
+	    ospf->gr_info.finishing_restart)
+		return false;
+
+	if (listcount(ospf->vlinks) ||
+	    (IS_OSPF_ABR(ospf) && ospf->abr_type == OSPF_ABR_SHORTCUT))
+		return false;
+
+	for (ALL_LIST_ELEMENTS_RO(ospf->areas, node, area)) {
+		if (!area->spf || area->spf_topo_changed)
+			return false;
+		if (route_table_count(area->ranges) ||
+		    ospf_area_is_transit(area))
+			return false;
+	}
+
+	/* Stub links are read from the LSAs, get the current ones */
+	for (ALL_LIST_ELEMENTS_RO(ospf->areas, node, area)) {
+		if (!area->spf_stubs_changed)
+			continue;
+
+		if (!ospf_spf_tree_refresh(area)) {
+			area->spf_topo_changed = true;
+			return false;
+		}
+		area->spf_stubs_changed = false;
+	}
+
+	return true;
+}
+
+/* RFC2328 16.1. (4) and second stage, for the changed prefixes only */
+static void ospf_prc_area(struct ospf_area *area, struct route_table *rt,
+			  struct route_table *prefixes)
+{
+	struct listnode *node;
+	struct vertex *v;
+	struct network_lsa *nlsa;
+	struct prefix_ipv4 p;
+	struct route_node *rn;
+
+	for (ALL_LIST_ELEMENTS_RO(area->spf_vertex_list, node, v)) {
+		UNSET_FLAG(v->flags, OSPF_VERTEX_PROCESSED);
+
+		if (v == area->spf || v->type == OSPF_VERTEX_ROUTER)
+			continue;
+
+		nlsa = (struct network_lsa *)v->lsa;
+		p.family = AF_INET;
+		p.prefix = v->id;
+		p.prefixlen = ip_masklen(nlsa->mask);
+		apply_mask_ipv4(&p);
+
+		rn = route_node_lookup(prefixes, (struct prefix *)&p);
+		if (!rn)
+			continue;
+		route_unlock_node(rn);
+
+		if (rn->info)
+			ospf_intra_add_transit(rt, v, area);
+	}
+
+	ospf_spf_process_stubs(area, area->spf, rt, 0, prefixes);
+}
+
+void ospf_prc_calculate(struct ospf *ospf)
+{
+	struct route_table *rt, *changed;
+	struct ospf_area *area;
+	struct listnode *node;
+	struct timeval start;
+	unsigned long prefixes, prc_time;
+	unsigned int count;
+
+	monotime(&start);
+
+	prefixes = ospf_prc_prefix_count(ospf->prc_prefixes);
+	rt = route_table_init();
+	changed = route_table_init();
+
+	/* Same order as ospf_spf_calculate_areas(), backbone last */
+	for (ALL_LIST_ELEMENTS_RO(ospf->areas, node, area))
+		if (area != ospf->backbone)
+			ospf_prc_area(area, rt, ospf->prc_prefixes);
+	if (ospf->backbone)
+		ospf_prc_area(ospf->backbone, rt, ospf->prc_prefixes);
+
+	ospf_ia_routing_prefixes(ospf, rt, ospf->new_rtrs, ospf->prc_prefixes);
+	ospf_prune_unreachable_networks(rt);
+
+	count = ospf_route_install_prefixes(ospf, rt, ospf->prc_prefixes,
+					    changed);
+	ospf_route_table_free(rt);
+
+	/* External routes depending on those, instead of all of them */
+	ospf_ase_prefixes_update(ospf, changed);
+	route_table_finish(changed);
+
+	if (count) {
+		if (IS_OSPF_ABR(ospf)) {
+			if (ospf->anyNSSA)
+				ospf_abr_nssa_check_status(ospf);
+			ospf_abr_task(ospf);
+		}
+
+		ospf_sr_update_task(ospf);
+	}
+
+	ospf_prc_reset(ospf);
+
+	prc_time = monotime_since(&start, NULL);
+	ospf->spf_stats.prc_runs++;
+	ospf->spf_stats.prc_prefixes += prefixes;
+	ospf->spf_stats.prc_changed += count;
+	ospf->spf_stats.prc_usec += prc_time;
+	if (prc_time > ospf->spf_stats.prc_max_usec)
+		ospf->spf_stats.prc_max_usec = prc_time;
+
+	if (IS_DEBUG_OSPF_EVENT)
+		zlog_debug("SPF: partial route calculation, %lu prefixes, %u routes changed, %lu usecs",
+			   prefixes, count, prc_time);
+}
+
 /* Worker for SPF calculation scheduler. */
 static void ospf_spf_calculate_schedule_worker(struct event *thread)
 {
@@ -1857,6 +2566,13 @@ static void ospf_spf_calculate_schedule_worker(struct event *thread)
 
 	ospf->t_spf_calc = NULL;
 
+	if (ospf_prc_possible(ospf)) {
+		ospf_prc_calculate(ospf);
+		ospf_clear_spf_reason_flags();
+		return;
+	}
+	ospf_prc_reset(ospf);
+
 	ospf_vl_unapprove(ospf);
 
 	/* Execute SPF for each area including backbone, see RFC 2328 16.1. */
@@ -1871,6 +2587,11 @@ static void ospf_spf_calculate_schedule_worker(struct event *thread)
 	ospf_spf_calculate_areas(ospf, new_table, all_rtrs, new_rtrs);
 	spf_time = monotime_since(&spf_start_time, NULL);
 
+	ospf->spf_stats.runs++;
+	ospf->spf_stats.areas_usec = spf_time;
+	if (spf_time > ospf->spf_stats.areas_max_usec)
+		ospf->spf_stats.areas_max_usec = spf_time;
+
 	ospf_vl_shut_unapproved(ospf);
 
 	/* Calculate inter-area routes, see RFC 2328 16.2. */
@@ -1930,6 +2651,9 @@ static void ospf_spf_calculate_schedule_worker(struct event *thread)
 	ospf->old_rtrs = ospf->new_rtrs;
 	ospf->new_rtrs = new_rtrs;
 
+	/* For the external route calculation scheduled above */
+	ospf_ase_routes_changed(ospf);
+
 	/* ABRs may require additional changes, see RFC 2328 16.7. */
 	monotime(&start_time);
 	if (IS_OSPF_ABR(ospf)) {
@@ -2003,6 +2727,27 @@ void ospf_spf_calculate_schedule(struct ospf *ospf, ospf_spf_reason_t reason)
 
 	ospf_spf_set_reason(reason);
 
+	/*
+	 * The areas whose tree is affected by an LSA change are flagged by
+	 * ospf_spf_lsa_changed(), anything else may affect all of them, and
+	 * all external routes.
+	 */
+	switch (reason) {
+	case SPF_FLAG_ROUTER_LSA_INSTALL:
+	case SPF_FLAG_NETWORK_LSA_INSTALL:
+	case SPF_FLAG_SUMMARY_LSA_INSTALL:
+	case SPF_FLAG_ASBR_SUMMARY_LSA_INSTALL:
+	case SPF_FLAG_MAXAGE:
+		break;
+	case SPF_FLAG_ABR_STATUS_CHANGE:
+	case SPF_FLAG_ASBR_STATUS_CHANGE:
+	case SPF_FLAG_CONFIG_CHANGE:
+	case SPF_FLAG_GR_FINISH:
+		ospf->spf_full_pending = true;
+		ospf->ase_full_pending = true;
+		break;
+	}
+
 	/* SPF calculation timer is already scheduled. */
 	if (ospf->t_spf_calc) {
 		if (IS_DEBUG_OSPF_EVENT)
@@ -16,6 +16,9 @@
 /* values for vertex->flags */
 #define OSPF_VERTEX_PROCESSED      0x01
 
+/* Most pthreads computing area SPF trees, see "spf threads" */
+#define OSPF_SPF_THREADS_MAX 32
+
 /* The "root" is the node running the SPF calculation */
 
 PREDECL_SKIPLIST_NONUNIQ(vertex_pqueue);
@@ -72,6 +75,14 @@ extern void ospf_spf_calculate_areas(struct ospf *ospf,
 				     struct route_table *new_table,
 				     struct route_table *all_rtrs,
 				     struct route_table *new_rtrs);
+extern void ospf_spf_lsa_changed(struct ospf_lsa *old, struct ospf_lsa *new);
+extern void ospf_spf_area_release(struct ospf_area *area);
+extern void ospf_spf_trees_release(struct ospf *ospf);
+extern void ospf_prc_prefix_add(struct route_table *prefixes,
+				struct prefix_ipv4 *p);
+extern unsigned long ospf_prc_prefix_count(struct route_table *prefixes);
+extern bool ospf_prc_possible(struct ospf *ospf);
+extern void ospf_prc_calculate(struct ospf *ospf);
 extern void ospf_rtrs_free(struct route_table *);
 extern void ospf_spf_cleanup(struct vertex *spf, struct list *vertex_list);
 extern void ospf_spf_copy(struct vertex *vertex, struct list *vertex_list);
@@ -2621,6 +2621,51 @@ DEFUN(no_ospf_ti_lfa, no_ospf_ti_lfa_cmd,
 	return CMD_SUCCESS;
 }
 
+DEFPY (ospf_spf_threads,
+       ospf_spf_threads_cmd,
+       "spf threads (2-32)$threads",
+       "SPF calculation\n"
+       "Compute the areas' shortest-path trees in parallel\n"
+       "Number of pthreads, including the main one\n")
+{
+	VTY_DECLVAR_INSTANCE_CONTEXT(ospf, ospf);
+
+	ospf->spf_threads = threads;
+
+	return CMD_SUCCESS;
+}
+
+DEFPY (no_ospf_spf_threads,
+       no_ospf_spf_threads_cmd,
+       "no spf threads [(2-32)]",
+       NO_STR
+       "SPF calculation\n"
+       "Compute the areas' shortest-path trees in parallel\n"
+       "Number of pthreads, including the main one\n")
+{
+	VTY_DECLVAR_INSTANCE_CONTEXT(ospf, ospf);
+
+	ospf->spf_threads = 1;
+
+	return CMD_SUCCESS;
+}
+
+DEFPY (ospf_spf_incremental,
+       ospf_spf_incremental_cmd,
+       "[no] spf incremental",
+       NO_STR
+       "SPF calculation\n"
+       "Reuse the areas' shortest-path trees when only leaves changed\n")
+{
+	VTY_DECLVAR_INSTANCE_CONTEXT(ospf, ospf);
+
+	ospf->spf_incremental = !no;
+	if (no)
+		ospf_spf_trees_release(ospf);
+
+	return CMD_SUCCESS;
+}
+
 static void ospf_maxpath_set(struct vty *vty, struct ospf *ospf, uint16_t paths)
 {
 	if (ospf->max_multipath == paths)
@@ -10830,6 +10875,238 @@ DEFPY (show_ip_ospf_gr_helper,
 	return CMD_SUCCESS;
 }
 /* Graceful Restart HELPER commands end */
+static void ospf_show_spf_statistics(struct vty *vty, struct ospf *ospf,
+				     uint8_t use_vrf, json_object *json,
+				     bool uj)
+{
+	struct listnode *node;
+	struct ospf_area *area;
+	json_object *json_vrf = NULL;
+	json_object *json_areas = NULL;
+	json_object *json_area;
+	char buf[INET_ADDRSTRLEN];
+	uint64_t full_avg = 0, incr_avg = 0, prc_avg = 0;
+	uint64_t ase_full_avg = 0, ase_incr_avg = 0;
+
+	if (ospf->spf_stats.full)
+		full_avg = ospf->spf_stats.full_usec / ospf->spf_stats.full;
+	if (ospf->spf_stats.incremental)
+		incr_avg = ospf->spf_stats.incremental_usec /
+			   ospf->spf_stats.incremental;
+	if (ospf->spf_stats.prc_runs)
+		prc_avg = ospf->spf_stats.prc_usec / ospf->spf_stats.prc_runs;
+	if (ospf->ase_stats.full)
+		ase_full_avg = ospf->ase_stats.full_usec / ospf->ase_stats.full;
+	if (ospf->ase_stats.incremental)
+		ase_incr_avg = ospf->ase_stats.incremental_usec /
+			       ospf->ase_stats.incremental;
+
+	if (uj) {
+		if (use_vrf)
+			json_vrf = json_object_new_object();
+		else
+			json_vrf = json;
+	}
+
+	if (ospf->instance) {
+		if (uj)
+			json_object_int_add(json, "ospfInstance",
+					    ospf->instance);
+		else
+			vty_out(vty, "\nOSPF Instance: %d\n\n", ospf->instance);
+	}
+
+	ospf_show_vrf_name(ospf, vty, json_vrf, use_vrf);
+
+	if (uj) {
+		json_object_int_add(json_vrf, "spfThreads", ospf->spf_threads);
+		json_object_boolean_add(json_vrf, "spfIncremental",
+					ospf->spf_incremental);
+		json_object_int_add(json_vrf, "spfRuns", ospf->spf_stats.runs);
+		json_object_int_add(json_vrf, "spfParallelRuns",
+				    ospf->spf_stats.parallel_runs);
+		json_object_int_add(json_vrf, "spfLastRunUsecs",
+				    ospf->spf_stats.areas_usec);
+		json_object_int_add(json_vrf, "spfMaxRunUsecs",
+				    ospf->spf_stats.areas_max_usec);
+		json_object_int_add(json_vrf, "fullCalculations",
+				    ospf->spf_stats.full);
+		json_object_int_add(json_vrf, "fullAvgUsecs", full_avg);
+		json_object_int_add(json_vrf, "fullMaxUsecs",
+				    ospf->spf_stats.full_max_usec);
+		json_object_int_add(json_vrf, "incrementalCalculations",
+				    ospf->spf_stats.incremental);
+		json_object_int_add(json_vrf, "incrementalAvgUsecs", incr_avg);
+		json_object_int_add(json_vrf, "incrementalMaxUsecs",
+				    ospf->spf_stats.incremental_max_usec);
+		json_object_int_add(json_vrf, "prcRuns",
+				    ospf->spf_stats.prc_runs);
+		json_object_int_add(json_vrf, "prcPrefixes",
+				    ospf->spf_stats.prc_prefixes);
+		json_object_int_add(json_vrf, "prcRoutesChanged",
+				    ospf->spf_stats.prc_changed);
+		json_object_int_add(json_vrf, "prcAvgUsecs", prc_avg);
+		json_object_int_add(json_vrf, "prcMaxUsecs",
+				    ospf->spf_stats.prc_max_usec);
+		json_object_int_add(json_vrf, "externalFullCalculations",
+				    ospf->ase_stats.full);
+		json_object_int_add(json_vrf, "externalFullAvgUsecs",
+				    ase_full_avg);
+		json_object_int_add(json_vrf, "externalFullMaxUsecs",
+				    ospf->ase_stats.full_max_usec);
+		json_object_int_add(json_vrf, "externalIncrementalCalculations",
+				    ospf->ase_stats.incremental);
+		json_object_int_add(json_vrf, "externalIncrementalAvgUsecs",
+				    ase_incr_avg);
+		json_object_int_add(json_vrf, "externalIncrementalMaxUsecs",
+				    ospf->ase_stats.incremental_max_usec);
+		json_object_int_add(json_vrf, "externalIncrementalPrefixes",
+				    ospf->ase_stats.prefixes);
+		json_object_int_add(json_vrf, "externalLastUsecs",
+				    ospf->ase_stats.last_usec);
+		json_areas = json_object_new_object();
+	} else {
+		vty_out(vty, " SPF threads: %u, incremental SPF %s\n",
+			ospf->spf_threads,
+			ospf->spf_incremental ? "enabled" : "disabled");
+		vty_out(vty, " SPF runs: %u, %u with parallel areas\n",
+			ospf->spf_stats.runs, ospf->spf_stats.parallel_runs);
+		vty_out(vty,
+			" Areas' SPF time, last run: %lu usecs, max: %lu usecs\n",
+			ospf->spf_stats.areas_usec,
+			ospf->spf_stats.areas_max_usec);
+		vty_out(vty, " %-14s %10s %12s %12s\n", "Area SPF", "Count",
+			"Avg(usecs)", "Max(usecs)");
+		vty_out(vty, " %-14s %10u %12" PRIu64 " %12lu\n", "Full",
+			ospf->spf_stats.full, full_avg,
+			ospf->spf_stats.full_max_usec);
+		vty_out(vty, " %-14s %10u %12" PRIu64 " %12lu\n",
+			"Incremental", ospf->spf_stats.incremental, incr_avg,
+			ospf->spf_stats.incremental_max_usec);
+		vty_out(vty, " %-14s %10u %12" PRIu64 " %12lu\n",
+			"Partial (PRC)", ospf->spf_stats.prc_runs, prc_avg,
+			ospf->spf_stats.prc_max_usec);
+		vty_out(vty,
+			" PRC prefixes: %" PRIu64 ", routes changed: %" PRIu64
+			"\n",
+			ospf->spf_stats.prc_prefixes,
+			ospf->spf_stats.prc_changed);
+		vty_out(vty, " %-14s %10s %12s %12s\n", "External", "Count",
+			"Avg(usecs)", "Max(usecs)");
+		vty_out(vty, " %-14s %10u %12" PRIu64 " %12lu\n", "Full",
+			ospf->ase_stats.full, ase_full_avg,
+			ospf->ase_stats.full_max_usec);
+		vty_out(vty, " %-14s %10u %12" PRIu64 " %12lu\n",
+			"Incremental", ospf->ase_stats.incremental,
+			ase_incr_avg, ospf->ase_stats.incremental_max_usec);
+		vty_out(vty,
+			" External incremental destinations: %" PRIu64
+			", last run: %lu usecs\n",
+			ospf->ase_stats.prefixes, ospf->ase_stats.last_usec);
+	}
+
+	for (ALL_LIST_ELEMENTS_RO(ospf->areas, node, area)) {
+		if (uj) {
+			json_area = json_object_new_object();
+			json_object_int_add(json_area, "full", area->spf_full);
+			json_object_int_add(json_area, "incremental",
+					    area->spf_incremental);
+			json_object_int_add(json_area, "lastUsecs",
+					    area->spf_usec);
+			json_object_int_add(json_area, "lastDijkstraUsecs",
+					    area->spf_tree_usec);
+			json_object_object_add(json_areas,
+					       inet_ntop(AF_INET,
+							 &area->area_id, buf,
+							 sizeof(buf)),
+					       json_area);
+			continue;
+		}
+
+		vty_out(vty, "\n Area %pI4\n", &area->area_id);
+		vty_out(vty, "   Full: %u, incremental: %u\n", area->spf_full,
+			area->spf_incremental);
+		vty_out(vty, "   Last SPF: %lu usecs, last Dijkstra: %lu usecs\n",
+			area->spf_usec, area->spf_tree_usec);
+	}
+
+	if (uj) {
+		json_object_object_add(json_vrf, "areas", json_areas);
+		if (use_vrf)
+			json_object_object_add(json, ospf_get_name(ospf),
+					       json_vrf);
+	} else
+		vty_out(vty, "\n");
+}
+
+DEFPY (show_ip_ospf_spf_statistics,
+       show_ip_ospf_spf_statistics_cmd,
+       "show ip ospf [vrf <NAME|all>] spf statistics [json]",
+       SHOW_STR
+       IP_STR
+       "OSPF information\n"
+       VRF_CMD_HELP_STR
+       "All VRFs\n"
+       "SPF calculation\n"
+       "Full and incremental SPF counts and timings\n"
+       JSON_STR)
+{
+	char *vrf_name = NULL;
+	bool all_vrf = false;
+	int idx_vrf = 0;
+	uint8_t use_vrf = 0;
+	bool uj = use_json(argc, argv);
+	struct ospf *ospf = NULL;
+	json_object *json = NULL;
+	struct listnode *node = NULL;
+
+	OSPF_FIND_VRF_ARGS(argv, argc, idx_vrf, vrf_name, all_vrf);
+
+	if (uj)
+		json = json_object_new_object();
+
+	/* vrf input is provided */
+	if (vrf_name) {
+		use_vrf = 1;
+
+		if (all_vrf) {
+			for (ALL_LIST_ELEMENTS_RO(om->ospf, node, ospf)) {
+				if (!ospf->oi_running)
+					continue;
+
+				ospf_show_spf_statistics(vty, ospf, use_vrf,
+							 json, uj);
+			}
+
+			if (uj)
+				vty_json(vty, json);
+
+			return CMD_SUCCESS;
+		}
+
+		ospf = ospf_lookup_by_inst_name(0, vrf_name);
+	} else {
+		/* Default Vrf */
+		ospf = ospf_lookup_by_vrf_id(VRF_DEFAULT);
+	}
+
+	if (ospf == NULL || !ospf->oi_running) {
+		if (uj)
+			vty_json(vty, json);
+		else
+			vty_out(vty, "%% OSPF is not enabled in vrf %s\n",
+				vrf_name ? vrf_name : "default");
+
+		return CMD_SUCCESS;
+	}
+
+	ospf_show_spf_statistics(vty, ospf, use_vrf, json, uj);
+	if (uj)
+		vty_json(vty, json);
+
+	return CMD_SUCCESS;
+}
+
 DEFUN (no_ospf_route_aggregation_timer,
        no_ospf_route_aggregation_timer_cmd,
        "no aggregation timer",
@@ -13064,6 +13341,12 @@ static int ospf_config_write_one(struct vty *vty, struct ospf *ospf)
 			vty_out(vty, " fast-reroute ti-lfa\n");
 	}
 
+	/* SPF calculation print. */
+	if (ospf->spf_threads > 1)
+		vty_out(vty, " spf threads %u\n", ospf->spf_threads);
+	if (ospf->spf_incremental)
+		vty_out(vty, " spf incremental\n");
+
 	/* Network area print. */
 	config_write_network_area(vty, ospf);
 
@@ -13187,6 +13470,7 @@ void ospf_vty_show_init(void)
 
 	/* "show ip ospf gr-helper details" command */
 	install_element(VIEW_NODE, &show_ip_ospf_gr_helper_cmd);
+	install_element(VIEW_NODE, &show_ip_ospf_spf_statistics_cmd);
 
 	/* "show ip ospf summary-address" command */
 	install_element(VIEW_NODE, &show_ip_ospf_external_aggregator_cmd);
@@ -13781,6 +14065,11 @@ void ospf_vty_init(void)
 	install_element(OSPF_NODE, &ospf_ti_lfa_cmd);
 	install_element(OSPF_NODE, &no_ospf_ti_lfa_cmd);
 
+	/* "spf" commands. */
+	install_element(OSPF_NODE, &ospf_spf_threads_cmd);
+	install_element(OSPF_NODE, &no_ospf_spf_threads_cmd);
+	install_element(OSPF_NODE, &ospf_spf_incremental_cmd);
+
 	/* Max path configurations */
 	install_element(OSPF_NODE, &ospf_max_multipath_cmd);
 	install_element(OSPF_NODE, &no_ospf_max_multipath_cmd);
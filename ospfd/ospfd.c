@@ -362,6 +362,11 @@ struct ospf *ospf_new_alloc(unsigned short instance, const char *name)
 	new->new_external_route = route_table_init();
 	new->old_external_route = route_table_init();
 	new->external_lsas = route_table_init();
+	new->ase_asbr_lsas = route_table_init();
+	new->ase_fwd_lsas = route_table_init();
+	new->ase_asbrs = route_table_init();
+	new->ase_prefixes = route_table_init();
+	new->ase_full_pending = true;
 
 	new->stub_router_startup_time = OSPF_STUB_ROUTER_UNCONFIGURED;
 	new->stub_router_shutdown_time = OSPF_STUB_ROUTER_UNCONFIGURED;
@@ -383,6 +388,8 @@ struct ospf *ospf_new_alloc(unsigned short instance, const char *name)
 	new->spf_holdtime = OSPF_SPF_HOLDTIME_DEFAULT;
 	new->spf_max_holdtime = OSPF_SPF_MAX_HOLDTIME_DEFAULT;
 	new->spf_hold_multiplier = 1;
+	new->spf_threads = 1;
+	new->prc_prefixes = route_table_init();
 
 	/* MaxAge init. */
 	new->maxage_delay = OSPF_LSA_MAXAGE_REMOVE_DELAY_DEFAULT;
@@ -819,6 +826,11 @@ static void ospf_finish_final(struct ospf *ospf)
 	if (ospf->external_lsas) {
 		ospf_ase_external_lsas_finish(ospf->external_lsas);
 	}
+	ospf_ase_external_lsas_finish(ospf->ase_asbr_lsas);
+	ospf_ase_external_lsas_finish(ospf->ase_fwd_lsas);
+	route_table_finish(ospf->ase_asbrs);
+	route_table_finish(ospf->ase_prefixes);
+	route_table_finish(ospf->prc_prefixes);
 
 	for (i = ZEBRA_ROUTE_SYSTEM; i <= ZEBRA_ROUTE_MAX; i++) {
 		struct list *ext_list;
@@ -986,6 +998,9 @@ static void ospf_area_free(struct ospf_area *area)
 {
 	ospf_opaque_type10_lsa_term(area);
 
+	/* Drop the SPF tree's locks on the LSAs before freeing them. */
+	ospf_spf_area_release(area);
+
 	/* Free LSDBs. */
 	ospf_area_lsdb_discard_delete(area);
 
@@ -215,6 +215,18 @@ struct ospf {
 	unsigned int spf_max_holdtime; /* SPF maximum-holdtime */
 	unsigned int
 		spf_hold_multiplier; /* Adaptive multiplier for hold time */
+	unsigned int spf_threads; /* Pthreads computing area SPF trees */
+	bool spf_incremental;	  /* Reuse unchanged area SPF trees */
+	bool spf_full_pending;	  /* Next SPF may not reuse any tree */
+	bool spf_dry_run;	  /* No interfaces to look at, unit tests */
+
+	/*
+	 * Partial route calculation: prefixes whose routes may have changed
+	 * without the area trees changing, since the last calculation.
+	 * 'prc_blocked' is set when some change needs a full one anyway.
+	 */
+	struct route_table *prc_prefixes;
+	bool prc_blocked;
 
 	int default_originate;	/* Default information originate. */
 #define DEFAULT_ORIGINATE_NONE		0
@@ -254,10 +266,53 @@ struct ospf {
 	struct route_table *external_lsas; /* Database of external LSAs,
 					      prefix is LSA's adv. network*/
 
+	/*
+	 * What external routes depend on, for incremental external route
+	 * calculation: the same LSAs by (ASBR, LSA ID) and by (forwarding
+	 * address, LSA ID), see ospf_ase_register_external_lsa().  And what
+	 * changed since the last calculation, see ospf_ase_routes_changed().
+	 */
+	struct route_table *ase_asbr_lsas;
+	struct route_table *ase_fwd_lsas;
+	struct route_table *ase_asbrs;	  /* ASBRs whose route changed */
+	struct route_table *ase_prefixes; /* Prefixes whose route changed */
+	bool ase_full_pending;		  /* Next one must redo all of them */
+
 	/* Time stamps */
 	struct timeval ts_spf;		/* SPF calculation time stamp. */
 	struct timeval ts_spf_duration; /* Execution time of last SPF */
 
+	/* SPF statistics, see "show ip ospf spf statistics". */
+	struct {
+		uint32_t runs;		/* SPF runs */
+		uint32_t parallel_runs; /* runs with worker pthreads */
+		uint32_t full;		/* area trees computed */
+		uint32_t incremental;	/* area trees reused */
+		uint64_t full_usec;	/* time spent in full area SPFs */
+		uint64_t incremental_usec; /* ... in incremental ones */
+		unsigned long full_max_usec;
+		unsigned long incremental_max_usec;
+		unsigned long areas_usec;  /* last run, all areas */
+		unsigned long areas_max_usec;
+		uint32_t prc_runs;	/* partial route calculations */
+		uint64_t prc_prefixes;	/* prefixes they looked at */
+		uint64_t prc_changed;	/* routes they sent to zebra */
+		uint64_t prc_usec;
+		unsigned long prc_max_usec;
+	} spf_stats;
+
+	/* External route calculation statistics, same place */
+	struct {
+		uint32_t full;		 /* all LSAs recalculated */
+		uint32_t incremental;	 /* only those depending on changes */
+		uint64_t prefixes;	 /* ... and their destinations */
+		uint64_t full_usec;
+		uint64_t incremental_usec;
+		unsigned long full_max_usec;
+		unsigned long incremental_max_usec;
+		unsigned long last_usec;
+	} ase_stats;
+
 	struct route_table *maxage_lsa; /* List of MaxAge LSA for deletion. */
 	int redistribute;		/* Num of redistributed protocols. */
 
@@ -614,6 +669,20 @@ struct ospf_area {
 
 	/* Statistics field. */
 	uint32_t spf_calculation; /* SPF Calculation Count. */
+	uint32_t spf_full;	  /* Full SPF calculations. */
+	uint32_t spf_incremental; /* SPF calculations reusing the tree. */
+	unsigned long spf_tree_usec; /* Last Dijkstra run time. */
+	unsigned long spf_usec;	     /* Last SPF calculation time. */
+
+	/*
+	 * The tree in 'spf' is kept after the calculation when
+	 * incremental SPF is enabled.  'spf_topo_changed' is set when an
+	 * LSA that could change its shape has been installed since.
+	 */
+	bool spf_topo_changed;
+
+	/* Stub links changed, the kept tree needs ospf_spf_tree_refresh() */
+	bool spf_stubs_changed;
 
 	/* reverse SPF (used for TI-LFA Q spaces) */
 	bool spf_reversed;
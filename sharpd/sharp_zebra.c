@@ -224,13 +224,14 @@ struct buffer_delay {
 } wb;
 
 /*
- * route_add - Encodes a route to zebra
+ * route_add - Encodes a route to zebra, in a bulk message
  *
  * This function returns true when the route was buffered
  * by the underlying stream system
  */
-static bool route_add(const struct prefix *p, vrf_id_t vrf_id, uint8_t instance,
-		      uint32_t nhgid, const struct nexthop_group *nhg,
+static bool route_add(struct zapi_route_bulk *bulk, const struct prefix *p,
+		      vrf_id_t vrf_id, uint8_t instance, uint32_t nhgid,
+		      const struct nexthop_group *nhg,
 		      const struct nexthop_group *backup_nhg, uint32_t flags,
 		      char *opaque)
 {
@@ -291,8 +292,7 @@ static bool route_add(const struct prefix *p, vrf_id_t vrf_id, uint8_t instance,
 		memcpy(api.opaque.data, opaque, api.opaque.length);
 	}
 
-	if (zclient_route_send(ZEBRA_ROUTE_ADD, zclient, &api) ==
-	    ZCLIENT_SEND_BUFFERED)
+	if (zapi_route_bulk_add(bulk, &api) == ZCLIENT_SEND_BUFFERED)
 		return true;
 	else
 		return false;
@@ -332,6 +332,7 @@ static void sharp_install_routes_restart(struct prefix *p, uint32_t count,
 {
 	uint32_t temp, i;
 	bool v4 = false;
+	struct zapi_route_bulk bulk;
 
 	if (p->family == AF_INET) {
 		v4 = true;
@@ -339,9 +340,12 @@ static void sharp_install_routes_restart(struct prefix *p, uint32_t count,
 	} else
 		temp = ntohl(p->u.val32[3]);
 
+	zapi_route_bulk_init(&bulk, zclient);
+
 	for (i = count; i < routes; i++) {
-		bool buffered = route_add(p, vrf_id, (uint8_t)instance, nhgid,
-					  nhg, backup_nhg, flags, opaque);
+		bool buffered = route_add(&bulk, p, vrf_id, (uint8_t)instance,
+					  nhgid, nhg, backup_nhg, flags,
+					  opaque);
 		if (v4)
 			p->u.prefix4.s_addr = htonl(++temp);
 		else
@@ -360,9 +364,13 @@ static void sharp_install_routes_restart(struct prefix *p, uint32_t count,
 			wb.opaque = opaque;
 			wb.restart = SHARP_INSTALL_ROUTES_RESTART;
 
-			return;
+			break;
 		}
 	}
+
+	/* routes still waiting in bulk are already accounted for in wb */
+	zapi_route_bulk_flush(&bulk);
+	zapi_route_bulk_fini(&bulk);
 }
 
 void sharp_install_routes_helper(struct prefix *p, vrf_id_t vrf_id,
@@ -0,0 +1,116 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/*
+ * BGP adj-out set test
+ */
+
+#include <zebra.h>
+
+#include "bgpd/bgpd.h"
+#include "bgpd/bgp_advertise.h"
+#include "bgpd/bgp_updgrp.h"
+
+/* Satisfy link requirements from including bgpd.h */
+struct zebra_privs_t bgpd_privs = {0};
+
+#define SUBGROUPS 8
+#define PATHS 4
+
+static struct update_subgroup subgrps[SUBGROUPS];
+static struct bgp_adj_out adjs[SUBGROUPS * PATHS];
+
+static void check_sorted(const struct bgp_adj_out_set *set)
+{
+	struct bgp_adj_out *const *arr = bgp_adj_out_set_array(set);
+	uint32_t i;
+
+	for (i = 1; i < set->count; i++) {
+		if (arr[i - 1]->subgroup == arr[i]->subgroup)
+			assert(arr[i - 1]->addpath_tx_id <
+			       arr[i]->addpath_tx_id);
+		else
+			assert((uintptr_t)arr[i - 1]->subgroup <
+			       (uintptr_t)arr[i]->subgroup);
+	}
+}
+
+static void test_single(void)
+{
+	struct bgp_adj_out_set set = {};
+	struct bgp_adj_out *adj;
+	uint32_t i, n = 0;
+
+	adjs[0].subgroup = &subgrps[0];
+	adjs[0].addpath_tx_id = 0;
+
+	bgp_adj_out_set_add(&set, &adjs[0]);
+	assert(set.count == 1 && set.size == 0);
+	assert(bgp_adj_out_set_find(&set, &subgrps[0], 0) == &adjs[0]);
+	assert(!bgp_adj_out_set_find(&set, &subgrps[0], 1));
+	assert(!bgp_adj_out_set_find(&set, &subgrps[1], 0));
+
+	BGP_ADJ_OUT_FOREACH (&set, adj, i) {
+		assert(adj == &adjs[0]);
+		n++;
+	}
+	assert(n == 1);
+
+	bgp_adj_out_set_del(&set, &adjs[0]);
+	assert(bgp_adj_out_set_empty(&set));
+	assert(!bgp_adj_out_set_find(&set, &subgrps[0], 0));
+
+	printf("Single entry checks successful\n");
+}
+
+static void test_many(void)
+{
+	struct bgp_adj_out_set set = {};
+	struct bgp_adj_out *adj;
+	uint32_t i, j, n;
+
+	/* insert in an order unrelated to the sort order */
+	for (i = 0; i < SUBGROUPS * PATHS; i++) {
+		j = (i * 7) % (SUBGROUPS * PATHS);
+		adjs[j].subgroup = &subgrps[j % SUBGROUPS];
+		adjs[j].addpath_tx_id = j / SUBGROUPS;
+		bgp_adj_out_set_add(&set, &adjs[j]);
+		check_sorted(&set);
+	}
+	assert(set.count == SUBGROUPS * PATHS);
+
+	for (i = 0; i < SUBGROUPS * PATHS; i++)
+		assert(bgp_adj_out_set_find(&set, &subgrps[i % SUBGROUPS],
+					    i / SUBGROUPS) == &adjs[i]);
+	assert(!bgp_adj_out_set_find(&set, &subgrps[0], PATHS));
+
+	/* drop all paths of one subgroup while walking the set */
+	n = 0;
+	BGP_ADJ_OUT_FOREACH_SAFE (&set, adj, i) {
+		n++;
+		if (adj->subgroup == &subgrps[3])
+			bgp_adj_out_set_del(&set, adj);
+	}
+	assert(n == SUBGROUPS * PATHS);
+	assert(set.count == (SUBGROUPS - 1) * PATHS);
+	assert(!bgp_adj_out_set_find(&set, &subgrps[3], 0));
+	check_sorted(&set);
+
+	/* removing everything but one goes back to the inline entry */
+	BGP_ADJ_OUT_FOREACH_SAFE (&set, adj, i) {
+		if (adj != &adjs[5])
+			bgp_adj_out_set_del(&set, adj);
+	}
+	assert(set.count == 1 && set.size == 0);
+	assert(bgp_adj_out_set_find(&set, &subgrps[5], 0) == &adjs[5]);
+
+	bgp_adj_out_set_del(&set, &adjs[5]);
+	assert(bgp_adj_out_set_empty(&set));
+
+	printf("Multiple entry checks successful\n");
+}
+
+int main(void)
+{
+	test_single();
+	test_many();
+	return 0;
+}
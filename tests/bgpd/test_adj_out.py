@@ -0,0 +1,9 @@
+import frrtest
+
+
+class TestAdjOut(frrtest.TestMultiOut):
+    program = "./test_adj_out"
+
+
+TestAdjOut.onesimple("Single entry checks successful")
+TestAdjOut.onesimple("Multiple entry checks successful")
@@ -16,6 +16,7 @@
 #include "bgpd/bgp_aspath.h"
 #include "bgpd/bgp_attr.h"
 #include "bgpd/bgp_packet.h"
+#include "bgpd/bgp_regex.h"
 
 #define VT100_RESET "\x1b[0m"
 #define VT100_RED "\x1b[31m"
@@ -1151,6 +1152,89 @@ static void empty_get_test(void)
 	aspath_free(as);
 }
 
+/* expressions the ASN matcher compiles, checked against regexec() */
+static const char *const regex_tests[] = {
+	".*",		"^$",		 "_8466_",	 "^8466_",
+	"_8466$",	"^8466$",	 "_4096$",	 "_3_",
+	"^8466_3_",	"_52737_4096_",	 "^8466_3_52737_4096$",
+	"_4_",		"_8722_4_",	 "^[0-9]+$",	 "^[0-9]+_3_",
+	"_[0-9]+_4$",	"_0_",		 "_5204_",	 "_41590_51793$",
+	NULL,
+};
+
+/* and ones it has to leave to regexec() */
+static const char *const regex_unsupported[] = {
+	"^84",	    "8466", "_846[0-9]_", "_8466_|_4_", "^8466 3_",
+	"_08466_", "_4294967296_", "_8466_.*_4096_", NULL,
+};
+
+static void regex_test(void)
+{
+	struct bgp_aspath_regex *asreg;
+	struct aspath *asp;
+	regex_t *reg;
+	unsigned int i, j, checked = 0;
+	int ret, fails = 0;
+
+	printf("regex test\n");
+
+	for (i = 0; regex_tests[i]; i++) {
+		asreg = bgp_aspath_regcomp(regex_tests[i]);
+		reg = bgp_regcomp(regex_tests[i]);
+		assert(reg);
+		if (!asreg) {
+			printf("%s: not compiled\n", regex_tests[i]);
+			fails++;
+			bgp_regex_free(reg);
+			continue;
+		}
+
+		for (j = 0; test_segments[j].name; j++) {
+			asp = make_aspath(test_segments[j].asdata,
+					  test_segments[j].len, 0,
+					  test_segments[j].asnotation);
+			if (!asp)
+				continue;
+
+			ret = bgp_aspath_regexec(asreg, asp);
+			if (ret >= 0) {
+				checked++;
+				if (ret != (bgp_regexec(reg, asp) !=
+					    REG_NOMATCH)) {
+					printf("%s on \"%s\": got %d\n",
+					       regex_tests[i], aspath_print(asp),
+					       ret);
+					fails++;
+				}
+			}
+			aspath_unintern(&asp);
+		}
+
+		bgp_aspath_regex_free(asreg);
+		bgp_regex_free(reg);
+	}
+
+	for (i = 0; regex_unsupported[i]; i++) {
+		asreg = bgp_aspath_regcomp(regex_unsupported[i]);
+		if (asreg) {
+			printf("%s: should not compile\n",
+			       regex_unsupported[i]);
+			fails++;
+			bgp_aspath_regex_free(asreg);
+		}
+	}
+
+	if (!fails && checked) {
+		printf("%u matches checked\n", checked);
+		printf(OK "\n");
+	} else {
+		failed++;
+		printf(FAILED "\n");
+	}
+
+	printf("\n");
+}
+
 /* basic parsing test */
 static void parse_test(struct test_segment *t)
 {
@@ -1344,7 +1428,7 @@ static int handle_attr_test(struct aspath_tests *t)
 
 	peer.curr = stream_new(BGP_MAX_PACKET_SIZE);
 	peer.connection = bgp_peer_connection_new(&peer);
-	peer.connection->obuf = stream_fifo_new();
+	peer.connection->obuf = bgp_obuf_new();
 	peer.bgp = &bgp;
 	peer.host = (char *)"none";
 	peer.connection->fd = -1;
@@ -1445,6 +1529,8 @@ int main(void)
 
 	empty_get_test();
 
+	regex_test();
+
 	i = 0;
 
 	frr_pthread_init();
@@ -67,6 +67,7 @@ for _ in range(22):
     TestAspath.okfail("left cmp ")
 
 TestAspath.okfail("empty_get_test")
+TestAspath.okfail("regex test")
 
 TestAspath.attrtest("basic test")
 TestAspath.attrtest("length too short")
@@ -0,0 +1,245 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/*
+ * BGP attribute memory benchmark.
+ *
+ * Interns one distinct attribute per path of a synthetic full table and
+ * reports what that costs, so that struct attr layout changes can be
+ * compared between builds:
+ *
+ *   tests/bgpd/test_attr_mem [paths]
+ *
+ * A small share of the paths carries the rarely used values kept in
+ * struct attr_ext (OTC, AIGP, link bandwidth, SR-TE color), everything
+ * else only has the common attributes.
+ */
+
+#include <zebra.h>
+
+#include "qobj.h"
+#include "memory.h"
+#include "mempool.h"
+#include "privs.h"
+
+#include "bgpd/bgpd.h"
+#include "bgpd/bgp_attr.h"
+#include "bgpd/bgp_aspath.h"
+#include "bgpd/bgp_network.h"
+
+/* need these to link in libbgp */
+struct zebra_privs_t bgpd_privs = {};
+struct event_loop *master = NULL;
+
+#define PATHS_DEFAULT 1000000
+#define ASPATHS 4096
+
+static struct aspath *aspaths[ASPATHS];
+
+#define EXT_SIZEOF(field) sizeof(((struct attr_ext *)NULL)->field)
+
+/*
+ * Before struct attr_ext, struct attr carried its values in place of the
+ * ext pointer.  Without padding they take this much, so the baseline
+ * struct attr was at least ATTR_BASELINE_SIZE.
+ */
+#define ATTR_EXT_VALUES_SIZE                                                   \
+	(EXT_SIZEOF(evpn_overlay) + EXT_SIZEOF(aigp_metric) +                  \
+	 EXT_SIZEOF(link_bw) + EXT_SIZEOF(otc) + EXT_SIZEOF(srte_color) +      \
+	 EXT_SIZEOF(rmap_table_id) + EXT_SIZEOF(mm_seqnum) +                   \
+	 EXT_SIZEOF(mm_sync_seqnum) + EXT_SIZEOF(encap_tunneltype) +           \
+	 EXT_SIZEOF(df_pref) + EXT_SIZEOF(df_alg) + EXT_SIZEOF(router_flag) +  \
+	 EXT_SIZEOF(sticky) + EXT_SIZEOF(default_gw))
+#define ATTR_BASELINE_SIZE                                                     \
+	(sizeof(struct attr) - sizeof(struct attr_ext *) + ATTR_EXT_VALUES_SIZE)
+
+static struct mempool *attr_ext_pool;
+
+static int attr_ext_pool_find(void *arg, struct mempool *mp)
+{
+	if (mp && !strcmp(mp->mt->name, "BGP attribute extension")) {
+		attr_ext_pool = mp;
+		return 1;
+	}
+	return 0;
+}
+
+/* Extension blocks allocated, interned and private ones */
+static size_t attr_ext_blocks(void)
+{
+	struct mempool_stats stats;
+
+	mempool_stats_get(attr_ext_pool, &stats);
+	return stats.used;
+}
+
+static size_t rss_bytes(void)
+{
+	unsigned long size, resident;
+	FILE *fp;
+
+	fp = fopen("/proc/self/statm", "r");
+	if (!fp)
+		return 0;
+	if (fscanf(fp, "%lu %lu", &size, &resident) != 2)
+		resident = 0;
+	fclose(fp);
+
+	return resident * sysconf(_SC_PAGESIZE);
+}
+
+static void attr_make(struct attr *attr, uint32_t i)
+{
+	memset(attr, 0, sizeof(*attr));
+
+	attr->origin = BGP_ORIGIN_IGP;
+	attr->aspath = aspaths[i % ASPATHS];
+	attr->nexthop.s_addr = htonl(0x0a000000 | (i % 256));
+	attr->med = i;
+	attr->local_pref = BGP_DEFAULT_LOCAL_PREF;
+	attr->label_index = BGP_INVALID_LABEL_INDEX;
+	attr->flag = ATTR_FLAG_BIT(BGP_ATTR_ORIGIN) |
+		     ATTR_FLAG_BIT(BGP_ATTR_AS_PATH) |
+		     ATTR_FLAG_BIT(BGP_ATTR_NEXT_HOP) |
+		     ATTR_FLAG_BIT(BGP_ATTR_MULTI_EXIT_DISC) |
+		     ATTR_FLAG_BIT(BGP_ATTR_LOCAL_PREF);
+
+	if (i % 20 == 0) {
+		bgp_attr_set_otc(attr, 64512);
+		attr->flag |= ATTR_FLAG_BIT(BGP_ATTR_OTC);
+	}
+	if (i % 50 == 0)
+		bgp_attr_set_aigp_metric(attr, 10);
+	if (i % 100 == 0)
+		bgp_attr_set_link_bw(attr, 1000000);
+	if (i % 200 == 0)
+		bgp_attr_set_srte_color(attr, 100);
+}
+
+int main(int argc, char **argv)
+{
+	struct attr **attrs;
+	struct attr attr, tmp, copy;
+	struct timeval start, end;
+	uint32_t paths = PATHS_DEFAULT, i;
+	size_t rss_before, rss_after;
+	unsigned long n_attr, n_ext;
+	double bytes_per_path;
+	char buf[32];
+
+	if (argc > 1)
+		paths = strtoul(argv[1], NULL, 10);
+	if (paths < 200)
+		paths = 200;
+
+	qobj_init();
+	master = event_master_create("test attr mem");
+	bgp_master_init(master, BGP_SOCKET_SNDBUF_SIZE, list_new());
+	bgp_attr_init();
+
+	mempool_walk(attr_ext_pool_find, NULL);
+	assert(attr_ext_pool);
+
+	for (i = 0; i < ASPATHS; i++) {
+		snprintf(buf, sizeof(buf), "%u %u", 64512 + i % 1000,
+			 65000 + i);
+		aspaths[i] = aspath_intern(
+			aspath_str2aspath(buf, ASNOTATION_PLAIN));
+	}
+
+	attrs = XCALLOC(MTYPE_TMP, paths * sizeof(*attrs));
+
+	rss_before = rss_bytes();
+	monotime(&start);
+	for (i = 0; i < paths; i++) {
+		attr_make(&attr, i);
+		attrs[i] = bgp_attr_intern(&attr);
+	}
+	monotime(&end);
+	rss_after = rss_bytes();
+
+	n_attr = attr_count();
+	n_ext = attr_ext_count();
+
+	/* every path is distinct, extension blocks are shared */
+	assert(n_attr == paths);
+	assert(n_ext > 0 && n_ext < paths / 10);
+	assert(attrs[1]->ext == NULL);
+	assert(attrs[20]->ext && attrs[20]->ext == attrs[60]->ext);
+	assert(bgp_attr_get_otc(attrs[20]) == 64512);
+	assert(bgp_attr_get_aigp_metric(attrs[100]) == 10);
+	assert(bgp_attr_get_srte_color(attrs[200]) == 100);
+
+	/* interning handed every private copy over to the hash, or freed it */
+	assert(attr_ext_blocks() == n_ext);
+
+	/* changing a copy leaves the interned attribute alone */
+	tmp = *attrs[200];
+	bgp_attr_set_srte_color(&tmp, 200);
+	assert(bgp_attr_get_srte_color(&tmp) == 200);
+	assert(bgp_attr_get_srte_color(attrs[200]) == 100);
+	assert(attr_ext_blocks() == n_ext + 1);
+
+	/* further changes go to the same private copy */
+	bgp_attr_set_aigp_metric(&tmp, 20);
+	assert(attr_ext_blocks() == n_ext + 1);
+
+	/* a struct copy borrows it, and makes its own once changed */
+	copy = tmp;
+	bgp_attr_set_srte_color(&copy, 300);
+	assert(copy.ext != tmp.ext);
+	assert(bgp_attr_get_srte_color(&tmp) == 200);
+	assert(bgp_attr_get_aigp_metric(&copy) == 20);
+	assert(attr_ext_blocks() == n_ext + 2);
+
+	/* flushing frees each attr's own copy */
+	bgp_attr_flush(&copy);
+	assert(attr_ext_blocks() == n_ext + 1);
+	bgp_attr_flush(&tmp);
+	assert(tmp.ext == NULL);
+	assert(attr_ext_blocks() == n_ext);
+
+	/* re-interning an equal attribute finds the existing one, and frees
+	 * the private copy
+	 */
+	attr_make(&attr, 200);
+	assert(attr_ext_blocks() == n_ext + 1);
+	assert(bgp_attr_intern(&attr) == attrs[200]);
+	assert(attr.ext == attrs[200]->ext);
+	assert(attr_ext_blocks() == n_ext);
+	bgp_attr_unintern(&attrs[200]);
+
+	/* the attribute memory per path is below the baseline layout */
+	bytes_per_path = sizeof(struct attr) +
+			 (double)sizeof(struct attr_ext) * n_ext / paths;
+	assert(sizeof(struct attr) < ATTR_BASELINE_SIZE);
+	assert(bytes_per_path < ATTR_BASELINE_SIZE);
+
+	printf("struct attr:      %zu bytes (baseline %zu bytes or more)\n",
+	       sizeof(struct attr), ATTR_BASELINE_SIZE);
+	printf("struct attr_ext:  %zu bytes\n", sizeof(struct attr_ext));
+	printf("attr bytes/path:  %.1f (%.1f saved)\n", bytes_per_path,
+	       ATTR_BASELINE_SIZE - bytes_per_path);
+	printf("attr layout:      below baseline\n");
+	printf("paths:            %u\n", paths);
+	printf("attributes:       %lu (%lu extension blocks)\n", n_attr,
+	       n_ext);
+	printf("RSS growth:       %zu kB (%.1f bytes/path)\n",
+	       (rss_after - rss_before) / 1024,
+	       (double)(rss_after - rss_before) / paths);
+	printf("intern time:      %lu us (%.1f ns/path)\n",
+	       timeval_elapsed(end, start),
+	       timeval_elapsed(end, start) * 1000.0 / paths);
+
+	for (i = 0; i < paths; i++)
+		bgp_attr_unintern(&attrs[i]);
+	XFREE(MTYPE_TMP, attrs);
+
+	assert(attr_count() == 0);
+	assert(attr_ext_count() == 0);
+	assert(attr_ext_blocks() == 0);
+
+	for (i = 0; i < ASPATHS; i++)
+		aspath_unintern(&aspaths[i]);
+
+	bgp_attr_finish();
+	return 0;
+}
@@ -0,0 +1,10 @@
+import frrtest
+
+
+class TestAttrMem(frrtest.TestMultiOut):
+    program = "./test_attr_mem"
+
+
+TestAttrMem.onesimple("attr layout:      below baseline")
+TestAttrMem.onesimple("paths:            1000000")
+TestAttrMem.onesimple("attributes:       1000000 (4 extension blocks)")
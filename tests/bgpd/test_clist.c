@@ -0,0 +1,208 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/*
+ * BGP community-list matching test
+ *
+ * Checks the indexed community-list lookups against a plain walk over the
+ * list entries, for random community attributes.
+ */
+
+#include <zebra.h>
+
+#include "memory.h"
+#include "privs.h"
+
+#include "bgpd/bgpd.h"
+#include "bgpd/bgp_community.h"
+#include "bgpd/bgp_lcommunity.h"
+#include "bgpd/bgp_community_alias.h"
+#include "bgpd/bgp_clist.h"
+
+/* need these to link in libbgp */
+struct zebra_privs_t bgpd_privs = {};
+struct event_loop *master = NULL;
+
+#define ROUNDS 20000
+
+static int ref_entry_any(struct community_list *list, struct community *com,
+			 int i)
+{
+	struct community_entry *entry;
+	char buf[32];
+	uint32_t val = community_val_get(com, i);
+
+	snprintf(buf, sizeof(buf), "%u:%u", val >> 16, val & 0xffff);
+
+	for (entry = list->head; entry; entry = entry->next) {
+		if (entry->style == COMMUNITY_LIST_STANDARD &&
+		    community_include(entry->u.com, val))
+			return entry->direct == COMMUNITY_PERMIT;
+		if (entry->style == COMMUNITY_LIST_EXPANDED &&
+		    regexec(entry->reg, buf, 0, NULL, 0) == 0)
+			return entry->direct == COMMUNITY_PERMIT;
+	}
+	return -1;
+}
+
+static bool ref_match(struct community_list *list, struct community *com,
+		      bool exact)
+{
+	struct community_entry *entry;
+	const char *str = com->size ? com->str : "";
+
+	for (entry = list->head; entry; entry = entry->next) {
+		if (entry->style == COMMUNITY_LIST_EXPANDED) {
+			if (regexec(entry->reg, str, 0, NULL, 0) == 0)
+				return entry->direct == COMMUNITY_PERMIT;
+		} else if (exact ? community_cmp(com, entry->u.com)
+				 : community_match(com, entry->u.com))
+			return entry->direct == COMMUNITY_PERMIT;
+	}
+	return false;
+}
+
+static bool ref_any_match(struct community_list *list, struct community *com)
+{
+	int i, ret;
+
+	for (i = 0; i < com->size; i++) {
+		ret = ref_entry_any(list, com, i);
+		if (ret >= 0)
+			return ret;
+	}
+	return false;
+}
+
+static struct community *random_community(void)
+{
+	struct community *com;
+	char buf[256] = "";
+	size_t len = 0;
+	int i, n = 1 + frr_weak_random() % 12;
+
+	for (i = 0; i < n; i++)
+		len += snprintf(buf + len, sizeof(buf) - len, "%lu:%lu ",
+				100 + frr_weak_random() % 3,
+				1 + frr_weak_random() % 8);
+
+	com = community_str2com(buf);
+	assert(com);
+	return community_intern(com);
+}
+
+static void check_list(struct community_list *list)
+{
+	struct community *com, *del;
+	int i, j;
+
+	for (i = 0; i < ROUNDS; i++) {
+		com = random_community();
+
+		assert(community_list_match(com, list) ==
+		       ref_match(list, com, false));
+		assert(community_list_exact_match(com, list) ==
+		       ref_match(list, com, true));
+		/* again, answered from the cache for expanded lists */
+		assert(community_list_match(com, list) ==
+		       ref_match(list, com, false));
+		if (com->size)
+			assert(community_list_any_match(com, list) ==
+			       ref_any_match(list, com));
+
+		del = community_list_match_delete(community_dup(com), list);
+		for (j = 0; j < com->size; j++)
+			assert(community_include(del,
+						 community_val_get(com, j)) ==
+			       (ref_entry_any(list, com, j) != 1));
+		community_free(&del);
+
+		community_unintern(&com);
+	}
+}
+
+static void test_community(void)
+{
+	struct community_list *list;
+
+	community_list_set(bgp_clist, "std", "100:1 100:2", NULL,
+			   COMMUNITY_PERMIT, COMMUNITY_LIST_STANDARD);
+	community_list_set(bgp_clist, "std", "100:3", NULL, COMMUNITY_DENY,
+			   COMMUNITY_LIST_STANDARD);
+	community_list_set(bgp_clist, "std", "100:3 100:4 100:5", NULL,
+			   COMMUNITY_PERMIT, COMMUNITY_LIST_STANDARD);
+	community_list_set(bgp_clist, "std", "101:1 102:2", NULL,
+			   COMMUNITY_PERMIT, COMMUNITY_LIST_STANDARD);
+	community_list_set(bgp_clist, "std", "101:6", NULL, COMMUNITY_PERMIT,
+			   COMMUNITY_LIST_STANDARD);
+	list = community_list_lookup(bgp_clist, "std", 0,
+				     COMMUNITY_LIST_MASTER);
+	check_list(list);
+
+	/* changing the list drops the index */
+	community_list_unset(bgp_clist, "std", "100:3", NULL, COMMUNITY_DENY,
+			     COMMUNITY_LIST_STANDARD);
+	check_list(list);
+
+	community_list_set(bgp_clist, "exp", "^100:[12]$", NULL,
+			   COMMUNITY_DENY, COMMUNITY_LIST_EXPANDED);
+	community_list_set(bgp_clist, "exp", "10[12]:[3-5]", NULL,
+			   COMMUNITY_PERMIT, COMMUNITY_LIST_EXPANDED);
+	community_list_set(bgp_clist, "exp", "100:7 100:8", NULL,
+			   COMMUNITY_PERMIT, COMMUNITY_LIST_EXPANDED);
+	list = community_list_lookup(bgp_clist, "exp", 0,
+				     COMMUNITY_LIST_MASTER);
+	check_list(list);
+
+	community_list_set(bgp_clist, "exp", "^$", "1", COMMUNITY_PERMIT,
+			   COMMUNITY_LIST_EXPANDED);
+	check_list(list);
+
+	printf("Community-list checks successful\n");
+}
+
+static void test_lcommunity(void)
+{
+	struct community_list *list;
+	struct lcommunity *lcom;
+
+	lcommunity_list_set(bgp_clist, "lstd", "1:1:1 1:1:2", NULL,
+			    COMMUNITY_PERMIT, LARGE_COMMUNITY_LIST_STANDARD);
+	lcommunity_list_set(bgp_clist, "lstd", "1:1:3", NULL, COMMUNITY_DENY,
+			    LARGE_COMMUNITY_LIST_STANDARD);
+	list = community_list_lookup(bgp_clist, "lstd", 0,
+				     LARGE_COMMUNITY_LIST_MASTER);
+
+	lcom = lcommunity_str2com("1:1:1 1:1:2 2:2:2");
+	assert(lcommunity_list_match(lcom, list));
+	assert(!lcommunity_list_exact_match(lcom, list));
+	assert(lcommunity_list_any_match(lcom, list));
+	lcommunity_free(&lcom);
+
+	lcom = lcommunity_str2com("1:1:1 1:1:2");
+	assert(lcommunity_list_exact_match(lcom, list));
+	lcommunity_free(&lcom);
+
+	lcom = lcommunity_str2com("1:1:1 1:1:3");
+	assert(!lcommunity_list_match(lcom, list));
+	lcom = lcommunity_list_match_delete(lcom, list);
+	assert(lcom->size == 1);
+	lcommunity_free(&lcom);
+
+	printf("Large community-list checks successful\n");
+}
+
+int main(void)
+{
+	community_init();
+	lcommunity_init();
+	bgp_community_alias_init();
+	bgp_clist = community_list_init();
+
+	test_community();
+	test_lcommunity();
+
+	community_list_terminate(bgp_clist);
+	bgp_community_alias_finish();
+	lcommunity_finish();
+	community_finish();
+	return 0;
+}
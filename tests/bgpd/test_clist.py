@@ -0,0 +1,9 @@
+import frrtest
+
+
+class TestClist(frrtest.TestMultiOut):
+    program = "./test_clist"
+
+
+TestClist.onesimple("Community-list checks successful")
+TestClist.onesimple("Large community-list checks successful")
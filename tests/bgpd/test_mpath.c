@@ -17,6 +17,7 @@
 #include "zclient.h"
 #include "queue.h"
 #include "filter.h"
+#include "frr_pthread.h"
 
 #include "bgpd/bgpd.h"
 #include "bgpd/bgp_table.h"
@@ -26,6 +27,8 @@
 #include "bgpd/bgp_mpath.h"
 #include "bgpd/bgp_evpn.h"
 #include "bgpd/bgp_network.h"
+#include "bgpd/bgp_aspath.h"
+#include "bgpd/bgp_select.h"
 
 #define VT100_RESET "\x1b[0m"
 #define VT100_RED "\x1b[31m"
@@ -363,12 +366,191 @@ testcase_t test_bgp_path_info_mpath_update = {
 	.cleanup = cleanup_bgp_path_info_mpath_update,
 };
 
+/*=========================================================
+ * Testcase for batched best path selection
+ */
+#define SELECT_TEST_DESTS (2 * BGP_SELECT_MIN_BATCH)
+#define SELECT_TEST_PATHS 4
+
+static struct peer_connection test_select_conn[SELECT_TEST_PATHS];
+static struct peer test_select_peer[SELECT_TEST_PATHS];
+static struct attr test_select_attr[SELECT_TEST_DESTS][SELECT_TEST_PATHS];
+/* [0] is selected serially, [1] on the selection shards */
+static struct bgp_path_info test_select_info[2][SELECT_TEST_DESTS]
+					    [SELECT_TEST_PATHS];
+static struct bgp_dest *test_select_dest[2][SELECT_TEST_DESTS];
+static struct aspath *test_select_aspath;
+
+static int setup_bgp_best_selection_batch(testcase_t *t)
+{
+	char addr[INET_ADDRSTRLEN], pfx[PREFIX_STRLEN];
+	struct bgp_table *rt;
+	struct prefix p;
+	struct bgp *bgp;
+	as_t asn = 1;
+	int set, i, j;
+
+	t->tmp_data = bgp_create_fake(&asn, NULL);
+	if (!t->tmp_data)
+		return -1;
+
+	bgp = t->tmp_data;
+	rt = bgp->rib[AFI_IP][SAFI_UNICAST];
+	bgp->maxpaths[AFI_IP][SAFI_UNICAST].maxpaths_ebgp = 1;
+	bgp->maxpaths[AFI_IP][SAFI_UNICAST].maxpaths_ibgp = 1;
+
+	test_select_aspath = aspath_empty_get();
+
+	for (j = 0; j < SELECT_TEST_PATHS; j++) {
+		snprintf(addr, sizeof(addr), "10.0.0.%d", j + 1);
+		test_select_conn[j].peer = &test_select_peer[j];
+		test_select_conn[j].status = Established;
+		test_select_peer[j].connection = &test_select_conn[j];
+		test_select_peer[j].bgp = bgp;
+		test_select_peer[j].local_as = 1;
+		test_select_peer[j].as = 2 + j;
+		test_select_peer[j].sort = BGP_PEER_EBGP;
+		inet_pton(AF_INET, addr, &test_select_peer[j].remote_id);
+		test_select_peer[j].su_remote = sockunion_str2su(addr);
+		if (!test_select_peer[j].su_remote)
+			return -1;
+	}
+
+	/* Mix of local-preference, MED and router-id tie breaks */
+	for (i = 0; i < SELECT_TEST_DESTS; i++) {
+		for (j = 0; j < SELECT_TEST_PATHS; j++) {
+			struct attr *attr = &test_select_attr[i][j];
+
+			attr->aspath = test_select_aspath;
+			attr->flag = ATTR_FLAG_BIT(BGP_ATTR_LOCAL_PREF) |
+				     ATTR_FLAG_BIT(BGP_ATTR_MULTI_EXIT_DISC);
+			attr->local_pref = 100 + ((i + j) % 3) * 10;
+			attr->med = (i * 7 + j * 3) % 5;
+			attr->nexthop = test_select_peer[j].remote_id;
+		}
+	}
+
+	for (set = 0; set < 2; set++) {
+		for (i = 0; i < SELECT_TEST_DESTS; i++) {
+			snprintf(pfx, sizeof(pfx), "%d.%d.%d.0/24", 20 + set,
+				 i / 256, i % 256);
+			str2prefix(pfx, &p);
+			test_select_dest[set][i] = bgp_node_get(rt, &p);
+
+			for (j = 0; j < SELECT_TEST_PATHS; j++) {
+				struct bgp_path_info *pi =
+					&test_select_info[set][i][j];
+
+				pi->peer = &test_select_peer[j];
+				pi->attr = &test_select_attr[i][j];
+				pi->type = ZEBRA_ROUTE_BGP;
+				pi->sub_type = BGP_ROUTE_NORMAL;
+				SET_FLAG(pi->flags, BGP_PATH_VALID);
+				bgp_path_info_add(test_select_dest[set][i], pi);
+				/* Static, keep bgp_delete() from freeing it */
+				bgp_path_info_lock(pi);
+			}
+		}
+	}
+
+	return 0;
+}
+
+static int test_select_index(int set, int i, struct bgp_path_info *pi)
+{
+	int j;
+
+	for (j = 0; j < SELECT_TEST_PATHS; j++)
+		if (pi == &test_select_info[set][i][j])
+			return j;
+
+	return -1;
+}
+
+static int run_bgp_best_selection_batch(testcase_t *t)
+{
+	struct bgp_best_selection_job jobs[SELECT_TEST_DESTS];
+	struct bgp_path_info_pair serial, batched;
+	struct bgp_maxpaths_cfg *mpath_cfg;
+	struct bgp_path_info *pi;
+	struct bgp *bgp = t->tmp_data;
+	int test_result = TEST_PASSED;
+	int i;
+
+	mpath_cfg = &bgp->maxpaths[AFI_IP][SAFI_UNICAST];
+
+	memset(jobs, 0, sizeof(jobs));
+	for (i = 0; i < SELECT_TEST_DESTS; i++) {
+		jobs[i].dest = test_select_dest[1][i];
+		jobs[i].afi = AFI_IP;
+		jobs[i].safi = SAFI_UNICAST;
+		jobs[i].defer_reap = true;
+	}
+
+	bgp_select_set_threads(4);
+	EXPECT_TRUE(bgp_select_enabled(), test_result);
+	bgp_select_run(bgp, jobs, SELECT_TEST_DESTS);
+
+	for (i = 0; i < SELECT_TEST_DESTS; i++) {
+		EXPECT_TRUE(jobs[i].computed, test_result);
+		EXPECT_TRUE(!bgp_best_selection_stale(&jobs[i]), test_result);
+
+		bgp_best_selection(bgp, test_select_dest[0][i], mpath_cfg,
+				   &serial, AFI_IP, SAFI_UNICAST);
+		bgp_best_selection_apply(bgp, &jobs[i], mpath_cfg, &batched);
+
+		EXPECT_TRUE(serial.new != NULL, test_result);
+		EXPECT_TRUE(batched.old == NULL, test_result);
+		EXPECT_TRUE(test_select_index(0, i, serial.new) ==
+				    test_select_index(1, i, batched.new),
+			    test_result);
+	}
+
+	/* A path requeued behind the list head still invalidates the job */
+	memset(&jobs[0], 0, sizeof(jobs[0]));
+	jobs[0].dest = test_select_dest[1][0];
+	jobs[0].afi = AFI_IP;
+	jobs[0].safi = SAFI_UNICAST;
+	jobs[0].defer_reap = true;
+	bgp_select_run(bgp, jobs, 1);
+	EXPECT_TRUE(!bgp_best_selection_stale(&jobs[0]), test_result);
+
+	pi = bgp_dest_get_bgp_path_info(test_select_dest[1][0]);
+	SET_FLAG(pi->next->flags, BGP_PATH_UNSORTED);
+	EXPECT_TRUE(bgp_best_selection_stale(&jobs[0]), test_result);
+	bgp_best_selection_discard(&jobs[0]);
+	EXPECT_TRUE(!jobs[0].computed, test_result);
+
+	bgp_select_set_threads(0);
+	EXPECT_TRUE(!bgp_select_enabled(), test_result);
+
+	return test_result;
+}
+
+static int cleanup_bgp_best_selection_batch(testcase_t *t)
+{
+	int j;
+
+	for (j = 0; j < SELECT_TEST_PATHS; j++)
+		sockunion_free(test_select_peer[j].su_remote);
+	aspath_free(test_select_aspath);
+
+	return bgp_delete((struct bgp *)t->tmp_data);
+}
+
+testcase_t test_bgp_best_selection_batch = {
+	.desc = "Test batched bgp best path selection",
+	.setup = setup_bgp_best_selection_batch,
+	.run = run_bgp_best_selection_batch,
+	.cleanup = cleanup_bgp_best_selection_batch,
+};
+
 /*=========================================================
  * Set up testcase vector
  */
 testcase_t *all_tests[] = {
 	&test_bgp_cfg_maximum_paths, &test_bgp_mp_list,
-	&test_bgp_path_info_mpath_update,
+	&test_bgp_path_info_mpath_update, &test_bgp_best_selection_batch,
 };
 
 int all_tests_count = array_size(all_tests);
@@ -379,6 +561,7 @@ int all_tests_count = array_size(all_tests);
 static int global_test_init(void)
 {
 	qobj_init();
+	frr_pthread_init();
 	master = event_master_create(NULL);
 	zclient = zclient_new(master, &zclient_options_default, NULL, 0);
 	bgp_master_init(master, BGP_SOCKET_SNDBUF_SIZE, list_new());
@@ -0,0 +1,147 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/*
+ * BGP inbound route-map memo test
+ *
+ * Checks that bgp_route_map_apply_memo() reuses results for equal
+ * attributes, and never hands out a result of a map that changed or was
+ * deleted and recreated under the same name.
+ */
+
+#include <zebra.h>
+
+#include "command.h"
+#include "memory.h"
+#include "privs.h"
+#include "routemap.h"
+
+#include "bgpd/bgpd.h"
+#include "bgpd/bgp_attr.h"
+#include "bgpd/bgp_aspath.h"
+#include "bgpd/bgp_route.h"
+#include "bgpd/bgp_network.h"
+
+/* need these to link in libbgp */
+struct zebra_privs_t bgpd_privs = {};
+struct event_loop *master = NULL;
+
+static struct peer peer;
+static struct aspath *aspath;
+static struct prefix p;
+
+static struct route_map *memo_map_make(const char *lpref)
+{
+	struct route_map_index *index;
+	struct route_map *map;
+
+	map = route_map_get("MEMO");
+	index = route_map_index_get(map, RMAP_PERMIT, 10);
+	assert(route_map_add_match(index, "metric", "10",
+				   RMAP_EVENT_MATCH_ADDED) ==
+	       RMAP_COMPILE_SUCCESS);
+	assert(route_map_add_set(index, "local-preference", lpref) ==
+	       RMAP_COMPILE_SUCCESS);
+	assert(route_map_memoizable(map));
+
+	return map;
+}
+
+/* Apply map to a fresh attribute with the given MED, returns the resulting
+ * local-preference or 0 if the map denied.
+ */
+static uint32_t memo_apply(struct route_map *map, uint32_t med)
+{
+	struct bgp_path_info path = {};
+	struct attr attr = {};
+
+	attr.aspath = aspath;
+	attr.med = med;
+	attr.local_pref = BGP_DEFAULT_LOCAL_PREF;
+	attr.flag = ATTR_FLAG_BIT(BGP_ATTR_AS_PATH) |
+		    ATTR_FLAG_BIT(BGP_ATTR_MULTI_EXIT_DISC);
+
+	path.peer = &peer;
+	path.attr = &attr;
+
+	if (bgp_route_map_apply_memo(&peer, AFI_IP, SAFI_UNICAST, map, &p,
+				     &path) == RMAP_DENYMATCH)
+		return 0;
+
+	return attr.local_pref;
+}
+
+static void noop_update(char *name)
+{
+}
+
+static void test_memo(void)
+{
+	struct route_map *map;
+	uint64_t version;
+
+	str2prefix("10.0.0.0/24", &p);
+	map = memo_map_make("200");
+
+	/* miss, then a hit on an equal attribute */
+	assert(memo_apply(map, 10) == 200);
+	assert(map->memo_misses == 1 && map->memo_hits == 0);
+	assert(memo_apply(map, 10) == 200);
+	assert(map->memo_misses == 1 && map->memo_hits == 1);
+	assert(map->applied == 2);
+
+	/* a different attribute is a miss, and deny is memoized too */
+	assert(memo_apply(map, 20) == 0);
+	assert(map->memo_misses == 2);
+	assert(memo_apply(map, 20) == 0);
+	assert(map->memo_hits == 2);
+	assert(map->applied == 4);
+
+	/* editing the map invalidates the memo */
+	version = map->version;
+	assert(route_map_add_set(map->head, "local-preference", "300") ==
+	       RMAP_COMPILE_SUCCESS);
+	assert(map->version != version);
+	assert(memo_apply(map, 10) == 300);
+	assert(map->memo_misses == 3);
+	assert(memo_apply(map, 10) == 300);
+	assert(map->memo_hits == 3);
+
+	/* a map recreated under the same name, quite possibly at the same
+	 * address, never matches the old map's version
+	 */
+	version = map->version;
+	route_map_delete(map);
+	route_map_walk_update_list(noop_update);
+	map = memo_map_make("400");
+	assert(map->version > version);
+	assert(memo_apply(map, 10) == 400);
+	assert(map->memo_misses == 1 && map->memo_hits == 0);
+
+	bgp_route_map_memo_free(&peer, AFI_IP, SAFI_UNICAST);
+	assert(peer.rmap_memo[AFI_IP][SAFI_UNICAST] == NULL);
+
+	route_map_delete(map);
+	route_map_walk_update_list(noop_update);
+
+	printf("Route-map memo checks successful\n");
+}
+
+int main(void)
+{
+	qobj_init();
+	cmd_init(0);
+	master = event_master_create("test rmap memo");
+	bgp_master_init(master, BGP_SOCKET_SNDBUF_SIZE, list_new());
+	bgp_attr_init();
+	bgp_route_map_init();
+
+	aspath = aspath_empty(ASNOTATION_PLAIN);
+
+	test_memo();
+
+	aspath_unintern(&aspath);
+	assert(attr_count() == 0);
+
+	bgp_route_map_terminate();
+	bgp_attr_finish();
+	return 0;
+}
@@ -0,0 +1,8 @@
+import frrtest
+
+
+class TestRmapMemo(frrtest.TestMultiOut):
+    program = "./test_rmap_memo"
+
+
+TestRmapMemo.onesimple("Route-map memo checks successful")
@@ -15,13 +15,18 @@
 #include "log.h"
 #include "vrf.h"
 #include "yang.h"
+#include "stream.h"
+#include "zclient.h"
+#include "srcdest_table.h"
 
 #include "isisd/isisd.h"
 #include "isisd/isis_dynhn.h"
 #include "isisd/isis_misc.h"
+#include "isisd/isis_mt.h"
 #include "isisd/isis_route.h"
 #include "isisd/isis_spf.h"
 #include "isisd/isis_spf_private.h"
+#include "isisd/isis_zebra.h"
 
 #include "test_common.h"
 
@@ -31,6 +36,7 @@ enum test_type {
 	TEST_LFA,
 	TEST_RLFA,
 	TEST_TI_LFA,
+	TEST_PRC,
 };
 
 #define F_DISPLAY_LSPDB 0x01
@@ -39,6 +45,16 @@ enum test_type {
 #define F_LEVEL1_ONLY 0x08
 #define F_LEVEL2_ONLY 0x10
 
+/* LSP change of a partial route calculation test */
+struct test_prc_change {
+	const struct isis_test_node *node;
+	/* Set the metric of the links to this neighbor, or of the prefixes */
+	const struct isis_test_node *neighbor;
+	uint32_t metric;
+};
+
+static struct zclient *prc_zclient;
+
 static void test_run_spf(struct vty *vty, const struct isis_topology *topology,
 			 const struct isis_test_node *root,
 			 struct isis_area *area, struct lspdb_head *lspdb,
@@ -237,10 +253,212 @@ static void test_run_ti_lfa(struct vty *vty,
 	isis_spftree_del(spftree_pc);
 }
 
+static void test_reach_metric_set(struct isis_item_list *items,
+				  const uint8_t *id, uint32_t metric)
+{
+	struct isis_extended_reach *er;
+
+	if (!items)
+		return;
+
+	for (er = (struct isis_extended_reach *)items->head; er; er = er->next)
+		if (memcmp(er->id, id, sizeof(er->id)) == 0)
+			er->metric = metric;
+}
+
+static void test_tlvs_metric_set(struct isis_tlvs *tlvs,
+				 const struct test_prc_change *change)
+{
+	struct isis_extended_ip_reach *r;
+	struct isis_ipv6_reach *r6;
+	struct isis_item_list *items;
+	uint8_t id[ISIS_SYS_ID_LEN + 1];
+
+	if (change->neighbor) {
+		memcpy(id, change->neighbor->sysid, ISIS_SYS_ID_LEN);
+		LSP_PSEUDO_ID(id) = change->neighbor->pseudonode_id;
+
+		test_reach_metric_set(&tlvs->extended_reach, id,
+				      change->metric);
+		test_reach_metric_set(isis_lookup_mt_items(&tlvs->mt_reach,
+							   ISIS_MT_IPV6_UNICAST),
+				      id, change->metric);
+		return;
+	}
+
+	for (r = (struct isis_extended_ip_reach *)tlvs->extended_ip_reach.head;
+	     r; r = r->next)
+		r->metric = change->metric;
+	for (r6 = (struct isis_ipv6_reach *)tlvs->ipv6_reach.head; r6;
+	     r6 = r6->next)
+		r6->metric = change->metric;
+	items = isis_lookup_mt_items(&tlvs->mt_ipv6_reach,
+				     ISIS_MT_IPV6_UNICAST);
+	for (r6 = items ? (struct isis_ipv6_reach *)items->head : NULL; r6;
+	     r6 = r6->next)
+		r6->metric = change->metric;
+}
+
+/* Replace an LSP by a newer instance carrying the given TLVs, as on receipt */
+static void test_lsp_update(struct isis_area *area, struct isis_lsp *lsp,
+			    struct isis_tlvs *tlvs)
+{
+	struct isis_lsp_hdr hdr = lsp->hdr;
+	struct stream *stream;
+
+	hdr.seqno++;
+	stream = stream_dup(lsp->pdu);
+	lsp_update(lsp, &hdr, tlvs, stream, area, lsp->level, false);
+	stream_free(stream);
+}
+
+static bool test_nexthops_same(struct list *a, struct list *b)
+{
+	struct isis_nexthop *nha, *nhb;
+	struct listnode *na, *nb;
+
+	if (listcount(a) != listcount(b))
+		return false;
+
+	for (ALL_LIST_ELEMENTS_RO(a, na, nha)) {
+		for (ALL_LIST_ELEMENTS_RO(b, nb, nhb))
+			if (nha->family == nhb->family
+			    && nha->ifindex == nhb->ifindex
+			    && !memcmp(&nha->ip, &nhb->ip, sizeof(nha->ip))
+			    && !memcmp(nha->sysid, nhb->sysid,
+				       sizeof(nha->sysid)))
+				break;
+		if (!nb)
+			return false;
+	}
+
+	return true;
+}
+
+/* Whether every route of table a is in table b, with the same nexthops */
+static bool test_route_table_in(struct route_table *a, struct route_table *b)
+{
+	struct route_node *rn, *rn_b;
+	struct isis_route_info *rinfo, *rinfo_b;
+
+	for (rn = route_top(a); rn; rn = srcdest_route_next(rn)) {
+		rinfo = rn->info;
+		if (!rinfo)
+			continue;
+
+		rn_b = srcdest_rnode_lookup(b, &rn->p, NULL);
+		if (rn_b)
+			route_unlock_node(rn_b);
+		rinfo_b = rn_b ? rn_b->info : NULL;
+		if (!rinfo_b || rinfo->cost != rinfo_b->cost
+		    || rinfo->depth != rinfo_b->depth
+		    || !test_nexthops_same(rinfo->nexthops,
+					   rinfo_b->nexthops)) {
+			route_unlock_node(rn);
+			return false;
+		}
+	}
+
+	return true;
+}
+
+/*
+ * Change the prefix metrics of a system, or the metric of its links to a
+ * neighbor, by a newer instance of its LSP. The SPF trees that ran before
+ * then do a partial run if they can, which has to give the routes of a full
+ * run over the new LSPDB.
+ */
+static void test_run_prc(struct vty *vty, const struct isis_test_node *root,
+			 struct isis_area *area, struct lspdb_head *lspdb,
+			 int level, uint8_t flags,
+			 const struct test_prc_change *change)
+{
+	struct isis_spftree *spftrees[SPFTREE_IPV6 + 1] = {};
+	struct isis_spf_changes *changes = &area->spf_changes[level - 1];
+	struct isis_spftree *spftree, *spftree_full;
+	uint8_t lspid[ISIS_SYS_ID_LEN + 2] = {};
+	struct isis_lsp *lsp;
+	struct isis_tlvs *tlvs;
+	bool same;
+
+	memcpy(lspid, change->node->sysid, ISIS_SYS_ID_LEN);
+	lsp = lsp_search(lspdb, lspid);
+	if (!lsp) {
+		vty_out(vty, "%% Node \"%s\" has no LSP\n",
+			change->node->hostname);
+		return;
+	}
+
+	/* Run SPF. */
+	for (int tree = SPFTREE_IPV4; tree <= SPFTREE_IPV6; tree++) {
+		if (tree == SPFTREE_IPV4 && CHECK_FLAG(flags, F_IPV6_ONLY))
+			continue;
+		if (tree == SPFTREE_IPV6 && CHECK_FLAG(flags, F_IPV4_ONLY))
+			continue;
+
+		spftrees[tree] = isis_spftree_new(area, lspdb, root->sysid,
+						  level, tree,
+						  SPF_TYPE_FORWARD,
+						  F_SPFTREE_NO_ADJACENCIES,
+						  SR_ALGORITHM_SPF);
+		isis_run_spf(spftrees[tree]);
+	}
+	/* As after a full run of the level. */
+	changes->full = false;
+
+	tlvs = isis_copy_tlvs(lsp->tlvs);
+	test_tlvs_metric_set(tlvs, change);
+	test_lsp_update(area, lsp, tlvs);
+
+	for (int tree = SPFTREE_IPV4; tree <= SPFTREE_IPV6; tree++) {
+		spftree = spftrees[tree];
+		if (!spftree)
+			continue;
+
+		vty_out(vty, "IS-IS %s %s SPF run: ",
+			circuit_t2string(level),
+			tree == SPFTREE_IPV4 ? "IPv4" : "IPv6");
+		if (changes->full
+		    || !isis_spf_prc_tree_possible(spftree, changes)) {
+			vty_out(vty, "full\n");
+			isis_spftree_del(spftree);
+			continue;
+		}
+		vty_out(vty, "partial\n");
+
+		/*
+		 * Partial runs send their routes to zebra right away, to
+		 * nowhere. Only lend them a client here: the (remote) LFA
+		 * tests expect to run without one.
+		 */
+		zclient = prc_zclient;
+		isis_run_prc(spftree, tree == SPFTREE_IPV4
+					      ? changes->prefixes4
+					      : changes->prefixes6);
+		zclient = NULL;
+
+		spftree_full = isis_spftree_new(area, lspdb, root->sysid,
+						level, tree, SPF_TYPE_FORWARD,
+						F_SPFTREE_NO_ADJACENCIES,
+						SR_ALGORITHM_SPF);
+		isis_run_spf(spftree_full);
+		same = test_route_table_in(spftree->route_table,
+					   spftree_full->route_table)
+		       && test_route_table_in(spftree_full->route_table,
+					      spftree->route_table);
+		vty_out(vty, "Routing table %s a full SPF\n",
+			same ? "matches" : "differs from");
+
+		isis_spftree_del(spftree_full);
+		isis_spftree_del(spftree);
+	}
+}
+
 static int test_run(struct vty *vty, const struct isis_topology *topology,
 		    const struct isis_test_node *root, enum test_type test_type,
 		    uint8_t flags, enum lfa_protection_type protection_type,
-		    const char *fail_sysid_str, uint8_t fail_pseudonode_id)
+		    const char *fail_sysid_str, uint8_t fail_pseudonode_id,
+		    const struct test_prc_change *prc_change)
 {
 	struct isis_area *area;
 	struct lfa_protected_resource protected_resource = {};
@@ -250,7 +468,8 @@ static int test_run(struct vty *vty, const struct isis_topology *topology,
 	area = isis_area_create("1", NULL);
 	memcpy(area->isis->sysid, root->sysid, sizeof(area->isis->sysid));
 	area->is_type = IS_LEVEL_1_AND_2;
-	area->srdb.enabled = true;
+	/* Partial runs are only done without segment routing */
+	area->srdb.enabled = test_type != TEST_PRC;
 	if (test_topology_load(topology, area, area->lspdb) != 0) {
 		vty_out(vty, "%% Failed to load topology\n");
 		return CMD_WARNING;
@@ -290,6 +509,13 @@ static int test_run(struct vty *vty, const struct isis_topology *topology,
 						 &area->lspdb[level - 1], NULL,
 						 ISIS_UI_LEVEL_DETAIL);
 
+		/* Both trees have to run before the LSPDB changes. */
+		if (test_type == TEST_PRC) {
+			test_run_prc(vty, root, area, &area->lspdb[level - 1],
+				     level, flags, prc_change);
+			continue;
+		}
+
 		for (int tree = SPFTREE_IPV4; tree <= SPFTREE_IPV6; tree++) {
 			if (tree == SPFTREE_IPV4
 			    && CHECK_FLAG(flags, F_IPV6_ONLY))
@@ -324,6 +550,8 @@ static int test_run(struct vty *vty, const struct isis_topology *topology,
 						&area->lspdb[level - 1], level,
 						tree, &protected_resource);
 				break;
+			case TEST_PRC:
+				break;
 			}
 		}
 	}
@@ -342,6 +570,7 @@ DEFUN(test_isis, test_isis_cmd,
 	   |lfa system-id WORD [pseudonode-id <1-255>]\
 	   |remote-lfa system-id WORD [pseudonode-id <1-255>]\
 	   |ti-lfa system-id WORD [pseudonode-id <1-255>] [node-protection]\
+	   |partial-route-calculation <prefix-metric HOSTNAME|link-metric HOSTNAME NEIGHBOR> (0-16777215)\
 	 >\
 	 [display-lspdb] [<ipv4-only|ipv6-only>] [<level-1-only|level-2-only>]",
       "Test command\n"
@@ -368,6 +597,13 @@ DEFUN(test_isis, test_isis_cmd,
       "Pseudonode-ID\n"
       "Pseudonode-ID\n"
       "Node protection\n"
+      "Partial route calculation\n"
+      "Change the metric of the prefixes of a node\n"
+      "Node hostname\n"
+      "Change the metric of the links of a node to a neighbor\n"
+      "Node hostname\n"
+      "Neighbor hostname\n"
+      "Metric\n"
       "Display the LSPDB\n"
       "Do IPv4 processing only\n"
       "Do IPv6 processing only\n"
@@ -381,6 +617,7 @@ DEFUN(test_isis, test_isis_cmd,
 	enum lfa_protection_type protection_type = 0;
 	const char *fail_sysid_str = NULL;
 	uint8_t fail_pseudonode_id = 0;
+	struct test_prc_change prc_change = {};
 	uint8_t flags = 0;
 	int idx = 0;
 
@@ -434,6 +671,29 @@ DEFUN(test_isis, test_isis_cmd,
 			protection_type = LFA_NODE_PROTECTION;
 		else
 			protection_type = LFA_LINK_PROTECTION;
+	} else if (argv_find(argv, argc, "partial-route-calculation", &idx)) {
+		test_type = TEST_PRC;
+
+		/* Skip to prefix-metric or link-metric. */
+		idx++;
+		prc_change.node =
+			test_topology_find_node(topology, argv[idx + 1]->arg, 0);
+		if (!prc_change.node) {
+			vty_out(vty, "%% Node \"%s\" not found\n",
+				argv[idx + 1]->arg);
+			return CMD_WARNING;
+		}
+		if (strmatch(argv[idx]->text, "link-metric")) {
+			idx++;
+			prc_change.neighbor = test_topology_find_node(
+				topology, argv[idx + 1]->arg, 0);
+			if (!prc_change.neighbor) {
+				vty_out(vty, "%% Node \"%s\" not found\n",
+					argv[idx + 1]->arg);
+				return CMD_WARNING;
+			}
+		}
+		prc_change.metric = strtoul(argv[idx + 2]->arg, NULL, 10);
 	} else
 		return CMD_WARNING;
 
@@ -450,7 +710,7 @@ DEFUN(test_isis, test_isis_cmd,
 		SET_FLAG(flags, F_LEVEL2_ONLY);
 
 	return test_run(vty, topology, root, test_type, flags, protection_type,
-			fail_sysid_str, fail_pseudonode_id);
+			fail_sysid_str, fail_pseudonode_id, &prc_change);
 }
 
 static void vty_do_exit(int isexit)
@@ -547,6 +807,9 @@ int main(int argc, char **argv)
 	debug_events |= DEBUG_EVENTS;
 	debug_rte_events |= DEBUG_RTE_EVENTS;
 
+	prc_zclient = zclient_new(master, &zclient_options_default, NULL, 0);
+	prc_zclient->sock = -1;
+
 	/* Install test command. */
 	install_element(VIEW_NODE, &test_isis_cmd);
 
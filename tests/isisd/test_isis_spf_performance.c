@@ -0,0 +1,211 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/*
+ * Test program which measures the time it takes to run the IS-IS SPF on a
+ * synthetic level-2 LSDB.
+ *
+ * The topology is a ring of routers with random chords, so that it has
+ * plenty of equal and unequal cost paths, and every router advertises a
+ * few /32 prefixes.
+ */
+
+#include <zebra.h>
+
+#include "frrevent.h"
+#include "command.h"
+#include "vty.h"
+#include "yang.h"
+#include "prng.h"
+
+#include "isisd/isisd.h"
+#include "isisd/isis_lsp.h"
+#include "isisd/isis_mt.h"
+#include "isisd/isis_spf.h"
+#include "isisd/isis_spf_private.h"
+
+#include "test_common.h"
+
+#define DEFAULT_NODES 3000
+#define DEFAULT_PREFIXES 4
+#define DEFAULT_RUNS 20
+#define CHORDS 2
+#define MAX_LINKS 16
+#define MAX_METRIC 64
+
+struct bench_node {
+	uint8_t sysid[ISIS_SYS_ID_LEN];
+	unsigned int links;
+	uint32_t nbr[MAX_LINKS];
+	uint32_t metric[MAX_LINKS];
+};
+
+static struct bench_node *nodes;
+
+static void node_sysid(uint8_t *sysid, uint32_t i)
+{
+	memset(sysid, 0, ISIS_SYS_ID_LEN);
+	sysid[3] = (i + 1) >> 16;
+	sysid[4] = (i + 1) >> 8;
+	sysid[5] = (i + 1);
+}
+
+static void node_link(uint32_t a, uint32_t b, uint32_t metric)
+{
+	if (a == b || nodes[a].links == MAX_LINKS ||
+	    nodes[b].links == MAX_LINKS)
+		return;
+
+	for (unsigned int i = 0; i < nodes[a].links; i++)
+		if (nodes[a].nbr[i] == b)
+			return;
+
+	nodes[a].nbr[nodes[a].links] = b;
+	nodes[a].metric[nodes[a].links++] = metric;
+	nodes[b].nbr[nodes[b].links] = a;
+	nodes[b].metric[nodes[b].links++] = metric;
+}
+
+static void lspdb_build(struct isis_area *area, struct lspdb_head *lspdb,
+			uint32_t n_nodes, uint32_t n_prefixes,
+			struct prng *prng)
+{
+	struct sr_prefix_cfg *pcfgs[SR_ALGORITHM_COUNT] = {};
+	struct nlpids nlpids = { .count = 1, .nlpids = { NLPID_IP } };
+
+	nodes = XCALLOC(MTYPE_TMP, n_nodes * sizeof(*nodes));
+	for (uint32_t i = 0; i < n_nodes; i++) {
+		node_sysid(nodes[i].sysid, i);
+		node_link(i, (i + 1) % n_nodes,
+			  1 + prng_rand(prng) % MAX_METRIC);
+		for (unsigned int c = 0; c < CHORDS; c++)
+			node_link(i, prng_rand(prng) % n_nodes,
+				  1 + prng_rand(prng) % MAX_METRIC);
+	}
+
+	lsp_db_init(lspdb);
+	for (uint32_t i = 0; i < n_nodes; i++) {
+		uint8_t lspid[ISIS_SYS_ID_LEN + 2] = {};
+		uint8_t nodeid[ISIS_SYS_ID_LEN + 1] = {};
+		struct isis_lsp *lsp;
+
+		memcpy(lspid, nodes[i].sysid, ISIS_SYS_ID_LEN);
+		lsp = lsp_new(area, lspid, 6000, 1, 0, 0, NULL, ISIS_LEVEL2);
+		lsp->tlvs = isis_alloc_tlvs();
+		isis_tlvs_set_protocols_supported(lsp->tlvs, &nlpids);
+		isis_tlvs_add_mt_router_info(lsp->tlvs, ISIS_MT_IPV4_UNICAST,
+					     false, false);
+
+		for (uint32_t p = 0; p < n_prefixes; p++) {
+			struct prefix_ipv4 prefix = {
+				.family = AF_INET,
+				.prefixlen = IPV4_MAX_BITLEN,
+			};
+
+			prefix.prefix.s_addr =
+				htonl(0x0a000000 + i * n_prefixes + p);
+			isis_tlvs_add_extended_ip_reach(lsp->tlvs, &prefix, 10,
+							false, pcfgs);
+		}
+
+		for (unsigned int l = 0; l < nodes[i].links; l++) {
+			memcpy(nodeid, nodes[nodes[i].nbr[l]].sysid,
+			       ISIS_SYS_ID_LEN);
+			isis_tlvs_add_extended_reach(lsp->tlvs,
+						     ISIS_MT_IPV4_UNICAST,
+						     nodeid,
+						     nodes[i].metric[l], NULL);
+		}
+
+		lspdb_add(lspdb, lsp);
+	}
+}
+
+static void usage(const char *progname)
+{
+	fprintf(stderr,
+		"Usage: %s [-n nodes] [-p prefixes per node] [-r runs] [-s seed]\n",
+		progname);
+	exit(1);
+}
+
+int main(int argc, char **argv)
+{
+	uint32_t n_nodes = DEFAULT_NODES, n_prefixes = DEFAULT_PREFIXES;
+	unsigned int runs = DEFAULT_RUNS;
+	unsigned long long seed = 0;
+	unsigned long usec, first = 0, total = 0, max = 0;
+	struct timeval tv_start, tv_stop;
+	struct isis_spftree *spftree;
+	struct isis_area *area;
+	struct prng *prng;
+	int opt;
+
+	while ((opt = getopt(argc, argv, "n:p:r:s:h")) != -1) {
+		switch (opt) {
+		case 'n':
+			n_nodes = strtoul(optarg, NULL, 10);
+			break;
+		case 'p':
+			n_prefixes = strtoul(optarg, NULL, 10);
+			break;
+		case 'r':
+			runs = strtoul(optarg, NULL, 10);
+			break;
+		case 's':
+			seed = strtoull(optarg, NULL, 10);
+			break;
+		default:
+			usage(argv[0]);
+		}
+	}
+	if (n_nodes < 2 || n_nodes > 0xffffff || runs < 2)
+		usage(argv[0]);
+
+	master = event_master_create(NULL);
+	isis_master_init(master);
+	cmd_init(1);
+	vty_init(master, false);
+	yang_init(true, false);
+	zlog_aux_init("NONE: ", ZLOG_DISABLED);
+	yang_module_load("frr-isisd", NULL);
+	SET_FLAG(im->options, F_ISIS_UNIT_TEST);
+
+	area = isis_area_create("1", NULL);
+	area->is_type = IS_LEVEL_2;
+	prng = prng_new(seed);
+	lspdb_build(area, &area->lspdb[ISIS_LEVEL2 - 1], n_nodes, n_prefixes,
+		    prng);
+	memcpy(area->isis->sysid, nodes[0].sysid, ISIS_SYS_ID_LEN);
+
+	spftree = isis_spftree_new(area, &area->lspdb[ISIS_LEVEL2 - 1],
+				   nodes[0].sysid, ISIS_LEVEL2, SPFTREE_IPV4,
+				   SPF_TYPE_FORWARD, F_SPFTREE_NO_ADJACENCIES,
+				   SR_ALGORITHM_SPF);
+
+	/* The first run also allocates the vertices the others reuse */
+	for (unsigned int i = 0; i < runs; i++) {
+		monotime(&tv_start);
+		isis_run_spf(spftree);
+		monotime(&tv_stop);
+
+		usec = timeval_elapsed(tv_stop, tv_start);
+		if (i == 0) {
+			first = usec;
+			continue;
+		}
+		total += usec;
+		if (usec > max)
+			max = usec;
+	}
+
+	printf("%u nodes, %u prefixes each, %u vertices in PATHS\n", n_nodes,
+	       n_prefixes, isis_vertex_queue_count(&spftree->paths));
+	printf("first run: %lu usecs, then %u runs: avg %lu usecs, max %lu usecs\n",
+	       first, runs - 1, total / (runs - 1), max);
+
+	isis_spftree_del(spftree);
+	isis_area_destroy(area);
+	XFREE(MTYPE_TMP, nodes);
+	prng_free(prng);
+
+	return 0;
+}
@@ -4,13 +4,13 @@
 
 #include "test_common.h"
 
+static struct isis_spftree t = {
+};
 static struct isis_vertex **vertices;
 static size_t vertex_count;
 
 static void setup_test_vertices(void)
 {
-	struct isis_spftree t = {
-	};
 	struct prefix_pair p = {
 	};
 	uint8_t node_id[7];
@@ -55,8 +55,7 @@ static void setup_test_vertices(void)
 
 static void cleanup_test_vertices(void)
 {
-	for (size_t i = 0; i < vertex_count; i++)
-		isis_vertex_del(vertices[i]);
+	isis_vertex_arena_fini(&t.vertices);
 	XFREE(MTYPE_TMP, vertices);
 	vertex_count = 0;
 }
@@ -96,11 +95,50 @@ static void test_ordered(void)
 	isis_vertex_queue_free(&q);
 }
 
+static void test_arena(void)
+{
+	struct isis_spftree a = {
+	};
+	struct isis_vertex *first, *last = NULL, *vertex = NULL;
+	uint8_t node_id[7];
+
+	memset(node_id, 0, sizeof(node_id));
+
+	/* Deleted vertices are handed out again, with empty lists */
+	first = isis_vertex_new(&a, node_id, VTYPE_NONPSEUDO_TE_IS);
+	listnode_add(first->parents, first);
+	isis_vertex_del(&a, first);
+	vertex = isis_vertex_new(&a, node_id, VTYPE_NONPSEUDO_TE_IS);
+	assert(vertex == first);
+	assert(listcount(vertex->parents) == 0);
+
+	/* Spill into a second chunk */
+	for (size_t i = 1; i <= ISIS_VERTEX_CHUNK_SIZE; i++) {
+		node_id[5] = i;
+		last = isis_vertex_new(&a, node_id, VTYPE_NONPSEUDO_TE_IS);
+		listnode_add(last->parents, first);
+	}
+	assert(a.vertices.chunks->next == a.vertices.current);
+
+	/* A reset starts over from the first one */
+	isis_vertex_arena_reset(&a.vertices);
+	assert(isis_vertex_new(&a, node_id, VTYPE_NONPSEUDO_TE_IS) == first);
+	for (size_t i = 1; i <= ISIS_VERTEX_CHUNK_SIZE; i++)
+		vertex = isis_vertex_new(&a, node_id, VTYPE_NONPSEUDO_TE_IS);
+	assert(vertex == last);
+	assert(listcount(vertex->parents) == 0);
+	assert(memcmp(vertex->N.id, node_id, sizeof(node_id)) == 0);
+
+	isis_vertex_arena_fini(&a.vertices);
+	assert(a.vertices.chunks == NULL);
+}
+
 int main(int argc, char **argv)
 {
 	setup_test_vertices();
 	test_ordered();
 	cleanup_test_vertices();
+	test_arena();
 
 	return 0;
 }
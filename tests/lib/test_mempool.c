@@ -0,0 +1,78 @@
+// SPDX-License-Identifier: ISC
+/*
+ * Fixed size object pool tests.
+ */
+
+#include <zebra.h>
+
+#include "memory.h"
+#include "mempool.h"
+
+DEFINE_MGROUP(TEST_MEMPOOL, "mempool test");
+DEFINE_MTYPE_STATIC(TEST_MEMPOOL, TEST_OBJ, "test object");
+
+struct test_obj {
+	uint64_t a, b, c;
+	uint8_t pad[40];
+};
+
+DEFINE_MEMPOOL_STATIC(TEST_OBJ, MTYPE_TEST_OBJ, sizeof(struct test_obj));
+
+#define NOBJS 100000
+
+static struct test_obj *objs[NOBJS];
+
+int main(int argc, char **argv)
+{
+	struct mempool_stats st;
+	size_t i, per_slab;
+
+	/* 1. objects come back zeroed, distinct, and counted in the MTYPE */
+	for (i = 0; i < NOBJS; i++) {
+		objs[i] = mempool_alloc(MPOOL_TEST_OBJ);
+		assert(objs[i]->a == 0 && objs[i]->pad[39] == 0);
+		objs[i]->a = i;
+		objs[i]->c = ~(uint64_t)i;
+	}
+	for (i = 0; i < NOBJS; i++)
+		assert(objs[i]->a == i && objs[i]->c == ~(uint64_t)i);
+
+	assert(mtype_stats_alloc(MTYPE_TEST_OBJ) == NOBJS);
+
+	mempool_stats_get(MPOOL_TEST_OBJ, &st);
+	assert(st.used == NOBJS);
+	assert(st.capacity >= NOBJS);
+	assert(st.objsize >= sizeof(struct test_obj));
+
+	/* 2. freeing every other object leaves all slabs in place */
+	for (i = 0; i < NOBJS; i += 2)
+		MPFREE(MPOOL_TEST_OBJ, objs[i]);
+
+	mempool_stats_get(MPOOL_TEST_OBJ, &st);
+	assert(st.used == NOBJS / 2);
+	assert(mtype_stats_alloc(MTYPE_TEST_OBJ) == NOBJS / 2);
+
+	/* 3. freed slots are reused before new slabs are added */
+	per_slab = st.capacity / (st.slabs ? st.slabs : 1);
+	for (i = 0; i < NOBJS; i += 2)
+		objs[i] = mempool_alloc(MPOOL_TEST_OBJ);
+
+	mempool_stats_get(MPOOL_TEST_OBJ, &st);
+	assert(st.used == NOBJS);
+	assert(st.capacity < NOBJS + per_slab || !st.slabs);
+
+	/* 4. empty slabs are returned, keeping at most one spare */
+	for (i = 0; i < NOBJS; i++)
+		MPFREE(MPOOL_TEST_OBJ, objs[i]);
+
+	mempool_stats_get(MPOOL_TEST_OBJ, &st);
+	assert(st.used == 0);
+	assert(st.slabs <= 1);
+	assert(st.fragmented == 0);
+	assert(mtype_stats_alloc(MTYPE_TEST_OBJ) == 0);
+
+	mempool_free(MPOOL_TEST_OBJ, NULL);
+
+	puts("Memory pool test successful.\n");
+	return 0;
+}
@@ -0,0 +1,159 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/*
+ * Prefix list lookup test
+ *
+ * Compares prefix_list_apply() and prefix_list_apply_batch() against a
+ * plain walk over the entries, for random lists with any ge/le
+ * combination, and across entry changes.
+ */
+
+#include <zebra.h>
+
+#include "lib/command.h"
+#include "lib/prefix.h"
+#include "lib/plist.h"
+#include "lib/plist_int.h"
+
+#include "tests/helpers/c/prng.h"
+
+#define LISTS 200
+#define ENTRIES 64
+#define QUERIES 2000
+
+static struct prng *prng;
+
+static void random_prefix(struct prefix *p, int family, bool short_len)
+{
+	int i, bitlen = family == AF_INET ? IPV4_MAX_BITLEN : IPV6_MAX_BITLEN;
+
+	memset(p, 0, sizeof(*p));
+	p->family = family;
+
+	/* few distinct values so that entries overlap */
+	for (i = 0; i < bitlen / 8; i++)
+		p->u.val[i] = prng_rand(prng) % 4 ? (i < 2 ? 10 : 0)
+						  : prng_rand(prng) & 0xff;
+
+	p->prefixlen = prng_rand(prng) % ((short_len ? 24 : bitlen) + 1);
+	apply_mask(p);
+}
+
+static const struct prefix_list_entry *ref_apply(struct prefix_list *plist,
+						 const struct prefix *p,
+						 bool address_mode)
+{
+	struct prefix_list_entry *pentry;
+
+	for (pentry = plist->head; pentry; pentry = pentry->next) {
+		if (pentry->prefix.family != p->family)
+			continue;
+		if (!prefix_match(&pentry->prefix, p))
+			continue;
+		if (address_mode)
+			return pentry;
+
+		if (!pentry->le && !pentry->ge) {
+			if (pentry->prefix.prefixlen != p->prefixlen)
+				continue;
+		} else {
+			if (pentry->le && p->prefixlen > pentry->le)
+				continue;
+			if (pentry->ge && p->prefixlen < pentry->ge)
+				continue;
+		}
+		return pentry;
+	}
+	return NULL;
+}
+
+static void check_list(struct prefix_list *plist, int family)
+{
+	const struct prefix_list_entry *which, *ref;
+	struct prefix queries[QUERIES];
+	const struct prefix *qptrs[QUERIES];
+	enum prefix_list_type results[QUERIES], ret;
+	int i;
+
+	for (i = 0; i < QUERIES; i++) {
+		random_prefix(&queries[i], family, prng_rand(prng) % 2);
+		qptrs[i] = &queries[i];
+
+		ref = ref_apply(plist, &queries[i], false);
+		ret = prefix_list_apply_ext(plist, &which, &queries[i], false);
+		assert(which == ref);
+		assert(ret == (ref ? ref->type : PREFIX_DENY));
+
+		ref = ref_apply(plist, &queries[i], true);
+		prefix_list_apply_ext(plist, &which, &queries[i], true);
+		assert(which == ref);
+	}
+
+	prefix_list_apply_batch(plist, qptrs, results, QUERIES);
+	for (i = 0; i < QUERIES; i++)
+		assert(results[i] == prefix_list_apply(plist, qptrs[i]));
+}
+
+static void test_list(int family)
+{
+	struct prefix_list *plist;
+	struct prefix_list_entry *pentry, *next;
+	int i, bitlen = family == AF_INET ? IPV4_MAX_BITLEN : IPV6_MAX_BITLEN;
+
+	plist = prefix_list_get(family2afi(family), 0, "test");
+
+	for (i = 0; i < ENTRIES; i++) {
+		pentry = prefix_list_entry_new();
+		pentry->pl = plist;
+		pentry->seq = (i + 1) * 5;
+		pentry->type = prng_rand(prng) % 2 ? PREFIX_PERMIT
+						   : PREFIX_DENY;
+		random_prefix(&pentry->prefix, family, prng_rand(prng) % 4);
+		if (prng_rand(prng) % 2)
+			pentry->ge = prng_rand(prng) % (bitlen + 1);
+		if (prng_rand(prng) % 2)
+			pentry->le = prng_rand(prng) % (bitlen + 1);
+		prefix_list_entry_update_finish(pentry);
+	}
+	check_list(plist, family);
+
+	/* every change must be visible in the next lookup */
+	for (pentry = plist->head; pentry; pentry = next) {
+		next = pentry->next;
+		if (prng_rand(prng) % 3 == 0)
+			prefix_list_entry_delete2(pentry);
+	}
+	check_list(plist, family);
+
+	for (pentry = plist->head; pentry; pentry = pentry->next) {
+		if (prng_rand(prng) % 3)
+			continue;
+		prefix_list_entry_update_start(pentry);
+		pentry->le = 0;
+		pentry->ge = 0;
+		prefix_list_entry_update_finish(pentry);
+	}
+	check_list(plist, family);
+
+	prefix_list_delete(plist);
+}
+
+int main(int argc, char **argv)
+{
+	int i;
+
+	prng = prng_new(0);
+	cmd_init(1);
+	prefix_list_init();
+
+	for (i = 0; i < LISTS; i++) {
+		test_list(AF_INET);
+		test_list(AF_INET6);
+	}
+
+	prefix_list_reset();
+	cmd_terminate();
+	prng_free(prng);
+
+	printf("Prefix list lookup checks successful\n");
+	return 0;
+}
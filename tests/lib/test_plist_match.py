@@ -0,0 +1,8 @@
+import frrtest
+
+
+class TestPlistMatch(frrtest.TestMultiOut):
+    program = "./test_plist_match"
+
+
+TestPlistMatch.onesimple("Prefix list lookup checks successful")
@@ -0,0 +1,73 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/*
+ * SPSC ring tests.
+ */
+#include <zebra.h>
+
+#include "spsc_ring.h"
+
+#define ITEMS 2000000
+
+static void *producer(void *arg)
+{
+	struct spsc_ring *ring = arg;
+	uintptr_t i;
+
+	for (i = 1; i <= ITEMS; i++)
+		while (!spsc_ring_push(ring, (void *)i))
+			sched_yield();
+
+	return NULL;
+}
+
+int main(int argc, char **argv)
+{
+	struct spsc_ring *ring;
+	pthread_t thread;
+	uintptr_t i, expect;
+	void *item;
+
+	/* size is rounded up to a power of two */
+	ring = spsc_ring_new(100);
+	assert(spsc_ring_size(ring) == 128);
+	assert(spsc_ring_count(ring) == 0);
+	assert(spsc_ring_pop(ring) == NULL);
+
+	/* fill, overflow, drain, and wrap around a few times */
+	printf("Validating single thread use...\n");
+	for (expect = 1; expect < 1000; expect += 128) {
+		for (i = 0; i < 128; i++)
+			assert(spsc_ring_push(ring, (void *)(expect + i)));
+		assert(!spsc_ring_push(ring, (void *)1));
+		assert(spsc_ring_count(ring) == 128);
+
+		for (i = 0; i < 128; i++)
+			assert(spsc_ring_pop(ring) == (void *)(expect + i));
+		assert(spsc_ring_pop(ring) == NULL);
+		assert(spsc_ring_count(ring) == 0);
+	}
+
+	/* items come out once and in order across threads */
+	printf("Validating producer/consumer threads...\n");
+	assert(pthread_create(&thread, NULL, producer, ring) == 0);
+
+	expect = 1;
+	while (expect <= ITEMS) {
+		item = spsc_ring_pop(ring);
+		if (!item) {
+			sched_yield();
+			continue;
+		}
+		assert(item == (void *)expect);
+		expect++;
+	}
+
+	pthread_join(thread, NULL);
+	assert(spsc_ring_pop(ring) == NULL);
+
+	spsc_ring_free(&ring);
+	assert(ring == NULL);
+
+	printf("SPSC ring checks successful\n");
+	return 0;
+}
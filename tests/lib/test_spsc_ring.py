@@ -0,0 +1,8 @@
+import frrtest
+
+
+class TestSpscRing(frrtest.TestMultiOut):
+    program = "./test_spsc_ring"
+
+
+TestSpscRing.exit_cleanly()
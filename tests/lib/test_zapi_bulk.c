@@ -0,0 +1,171 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/*
+ * ZEBRA_ROUTE_ADD_BULK encoding test
+ *
+ * Queues routes through zapi_route_bulk_add() on a zclient connected to a
+ * socketpair, and decodes what comes out on the other side.
+ */
+
+#include <zebra.h>
+
+#include "lib/frrevent.h"
+#include "lib/network.h"
+#include "lib/stream.h"
+#include "lib/zclient.h"
+
+#define ROUTES 3000
+
+static struct event_loop *master;
+static struct zclient *zclient;
+static int peer_sock;
+
+static struct stream *ibuf;
+static unsigned int n_bulk, n_single, n_decoded;
+
+static void make_route(struct zapi_route *api, uint32_t i)
+{
+	memset(api, 0, sizeof(*api));
+	api->vrf_id = VRF_DEFAULT;
+	api->type = ZEBRA_ROUTE_SHARP;
+	api->safi = SAFI_UNICAST;
+
+	if (i % 1000 < 900) {
+		api->prefix.family = AF_INET;
+		api->prefix.prefixlen = 32;
+		api->prefix.u.prefix4.s_addr = htonl(0x0a000000 + i);
+	} else {
+		api->prefix.family = AF_INET6;
+		api->prefix.prefixlen = 128;
+		api->prefix.u.prefix6.s6_addr[0] = 0x20;
+		api->prefix.u.prefix6.s6_addr[1] = 0x01;
+		api->prefix.u.prefix6.s6_addr32[3] = htonl(i);
+	}
+
+	SET_FLAG(api->message, ZAPI_MESSAGE_METRIC);
+	api->metric = i;
+
+	/* a run of routes sharing a nexthop-group, then plain nexthops */
+	if (i % 1000 < 500) {
+		zapi_route_set_nhg_id(api, &(uint32_t){ 100 + i / 1000 });
+		return;
+	}
+
+	SET_FLAG(api->message, ZAPI_MESSAGE_NEXTHOP);
+	api->nexthop_num = 1;
+	api->nexthops[0].vrf_id = VRF_DEFAULT;
+	if (api->prefix.family == AF_INET) {
+		api->nexthops[0].type = NEXTHOP_TYPE_IPV4;
+		api->nexthops[0].gate.ipv4.s_addr = htonl(0xc0000200 + i % 7);
+	} else {
+		api->nexthops[0].type = NEXTHOP_TYPE_IFINDEX;
+		api->nexthops[0].ifindex = 1 + i % 7;
+	}
+}
+
+static void check_route(const struct zapi_route *api)
+{
+	struct zapi_route ref;
+
+	make_route(&ref, n_decoded++);
+
+	assert(api->type == ref.type);
+	assert(api->safi == ref.safi);
+	assert(prefix_same(&api->prefix, &ref.prefix));
+	assert(api->message == ref.message);
+	assert(api->metric == ref.metric);
+	assert(api->nhgid == ref.nhgid);
+	assert(api->nexthop_num == ref.nexthop_num);
+	if (ref.nexthop_num) {
+		assert(api->nexthops[0].type == ref.nexthops[0].type);
+		assert(api->nexthops[0].ifindex == ref.nexthops[0].ifindex);
+		assert(api->nexthops[0].gate.ipv4.s_addr ==
+		       ref.nexthops[0].gate.ipv4.s_addr);
+	}
+}
+
+/* Read and decode everything sent so far */
+static void drain(void)
+{
+	struct zapi_route_bulk_hdr bhdr;
+	struct zapi_route api;
+	struct zmsghdr hdr;
+	ssize_t nb;
+	uint16_t i;
+
+	for (;;) {
+		stream_reset(ibuf);
+		nb = stream_read_try(ibuf, peer_sock, ZEBRA_HEADER_SIZE);
+		if (nb == -2)
+			return;
+		assert(nb == ZEBRA_HEADER_SIZE);
+
+		assert(zapi_parse_header(ibuf, &hdr));
+		assert(hdr.length <= ZEBRA_MAX_PACKET_SIZ);
+		assert(stream_read(ibuf, peer_sock,
+				   hdr.length - ZEBRA_HEADER_SIZE) ==
+		       hdr.length - ZEBRA_HEADER_SIZE);
+
+		if (hdr.command == ZEBRA_ROUTE_ADD) {
+			n_single++;
+			assert(zapi_route_decode(ibuf, &api) == 0);
+			check_route(&api);
+			continue;
+		}
+
+		assert(hdr.command == ZEBRA_ROUTE_ADD_BULK);
+		n_bulk++;
+		assert(zapi_route_bulk_decode_hdr(ibuf, &bhdr) == 0);
+		assert(bhdr.count > 0);
+		for (i = 0; i < bhdr.count; i++) {
+			assert(zapi_route_bulk_decode_route(ibuf, &bhdr,
+							    &api) == 0);
+			check_route(&api);
+		}
+		assert(STREAM_READABLE(ibuf) == 0);
+	}
+}
+
+int main(int argc, char **argv)
+{
+	struct zapi_route_bulk bulk;
+	struct zapi_route api;
+	int sv[2];
+	uint32_t i;
+
+	master = event_master_create(NULL);
+	zclient = zclient_new(master, &zclient_options_default, NULL, 0);
+	ibuf = stream_new(ZEBRA_MAX_PACKET_SIZ);
+
+	assert(socketpair(AF_UNIX, SOCK_STREAM, 0, sv) == 0);
+	set_nonblocking(sv[0]);
+	set_nonblocking(sv[1]);
+	zclient->sock = sv[0];
+	peer_sock = sv[1];
+
+	zapi_route_bulk_init(&bulk, zclient);
+	for (i = 0; i < ROUTES; i++) {
+		make_route(&api, i);
+		assert(zapi_route_bulk_add(&bulk, &api) ==
+		       ZCLIENT_SEND_SUCCESS);
+		drain();
+	}
+	assert(zapi_route_bulk_flush(&bulk) == ZCLIENT_SEND_SUCCESS);
+	drain();
+	zapi_route_bulk_fini(&bulk);
+
+	assert(n_decoded == ROUTES);
+	assert(n_single == 0);
+	/* one message per nexthop-group run, family change, or full one */
+	assert(n_bulk >= 3 * 3);
+	assert(n_bulk < ROUTES / 50);
+
+	zclient->sock = -1;
+	close(sv[0]);
+	close(sv[1]);
+	stream_free(ibuf);
+	zclient_free(zclient);
+	event_master_free(master);
+
+	printf("ZAPI bulk route checks successful\n");
+	return 0;
+}
@@ -10,10 +10,15 @@
 #include "vrf.h"
 #include "table.h"
 #include "mpls.h"
+#include "stream.h"
+#include "zclient.h"
 
 #include "ospfd/ospfd.h"
+#include "ospfd/ospf_ase.h"
 #include "ospfd/ospf_asbr.h"
+#include "ospfd/ospf_ia.h"
 #include "ospfd/ospf_lsa.h"
+#include "ospfd/ospf_lsdb.h"
 #include "ospfd/ospf_route.h"
 #include "ospfd/ospf_spf.h"
 #include "ospfd/ospf_ti_lfa.h"
@@ -161,6 +166,435 @@ static int test_run(struct vty *vty, struct ospf_topology *topology,
 	return 0;
 }
 
+/*
+ * The routing table calculation of ospf_spf_calculate_schedule_worker(),
+ * less the external routes and the ABR and SR tasks.
+ */
+static void test_spf_calculate(struct ospf *ospf)
+{
+	struct route_table *new_table, *new_rtrs;
+
+	new_table = route_table_init();
+	new_rtrs = route_table_init();
+
+	ospf_spf_calculate_areas(ospf, new_table, NULL, new_rtrs);
+	ospf_ia_routing(ospf, new_table, new_rtrs);
+	ospf_prune_unreachable_networks(new_table);
+	ospf_prune_unreachable_routers(new_rtrs);
+
+	ospf_route_install(ospf, new_table);
+
+	if (ospf->old_rtrs)
+		ospf_rtrs_free(ospf->old_rtrs);
+	ospf->old_rtrs = ospf->new_rtrs;
+	ospf->new_rtrs = new_rtrs;
+
+	ospf_ase_routes_changed(ospf);
+}
+
+/* Same vertices joining the tree in the same order, through the same parents */
+static bool test_spf_tree_same(struct list *a, struct list *b)
+{
+	struct listnode *na, *nb, *pa, *pb;
+	struct vertex *va, *vb;
+	struct vertex_parent *vpa, *vpb;
+
+	if (listcount(a) != listcount(b))
+		return false;
+
+	for (na = listhead(a), nb = listhead(b); na && nb;
+	     na = listnextnode(na), nb = listnextnode(nb)) {
+		va = listgetdata(na);
+		vb = listgetdata(nb);
+
+		if (va->type != vb->type || va->id.s_addr != vb->id.s_addr
+		    || va->distance != vb->distance
+		    || listcount(va->parents) != listcount(vb->parents))
+			return false;
+
+		for (pa = listhead(va->parents), pb = listhead(vb->parents);
+		     pa && pb; pa = listnextnode(pa), pb = listnextnode(pb)) {
+			vpa = listgetdata(pa);
+			vpb = listgetdata(pb);
+
+			if (vpa->parent->id.s_addr != vpb->parent->id.s_addr
+			    || vpa->nexthop->router.s_addr
+				       != vpb->nexthop->router.s_addr)
+				return false;
+		}
+	}
+
+	return true;
+}
+
+static bool test_route_table_same(struct route_table *a,
+				  struct route_table *b)
+{
+	struct route_node *rn;
+
+	for (rn = route_top(a); rn; rn = route_next(rn))
+		if (rn->info
+		    && !ospf_route_match_same(b, (struct prefix_ipv4 *)&rn->p,
+					      rn->info)) {
+			route_unlock_node(rn);
+			return false;
+		}
+
+	for (rn = route_top(b); rn; rn = route_next(rn))
+		if (rn->info
+		    && !ospf_route_match_same(a, (struct prefix_ipv4 *)&rn->p,
+					      rn->info)) {
+			route_unlock_node(rn);
+			return false;
+		}
+
+	return true;
+}
+
+/*
+ * A full SPF, then one on the unchanged area, which must reuse the kept
+ * tree and give the same tree and routing table as another full SPF.
+ */
+static void test_run_incremental_spf(struct vty *vty, struct ospf *ospf)
+{
+	struct ospf_area *area = ospf->backbone;
+	struct vertex *spf;
+	struct list *spf_vertex_list;
+
+	test_spf_calculate(ospf);
+	test_spf_calculate(ospf);
+
+	vty_out(vty, "SPF runs: %u full, %u incremental\n", area->spf_full,
+		area->spf_incremental);
+
+	/* Set the kept tree aside and start from scratch */
+	spf = area->spf;
+	spf_vertex_list = area->spf_vertex_list;
+	area->spf = NULL;
+	area->spf_vertex_list = NULL;
+	ospf->spf_full_pending = true;
+
+	test_spf_calculate(ospf);
+
+	vty_out(vty, "Kept SPF tree %s a full SPF\n",
+		test_spf_tree_same(spf_vertex_list, area->spf_vertex_list)
+			? "matches"
+			: "differs from");
+	vty_out(vty, "Routing table %s a full SPF\n",
+		test_route_table_same(ospf->old_table, ospf->new_table)
+			? "matches"
+			: "differs from");
+
+	ospf_spf_area_release(area);
+	area->spf = spf;
+	area->spf_vertex_list = spf_vertex_list;
+	ospf_spf_area_release(area);
+
+	print_route_table(vty, ospf->new_table);
+}
+
+/* A new instance of a router's LSA, to change before installing it */
+static struct ospf_lsa *test_router_lsa_new(struct ospf *ospf,
+					    const char *router_id)
+{
+	struct in_addr id;
+	struct ospf_lsa *old, *new;
+
+	inet_aton(router_id, &id);
+	old = ospf_lsa_lookup_by_id(ospf->backbone, OSPF_ROUTER_LSA, id);
+	new = ospf_lsa_dup(old);
+	new->data->ls_seqnum = lsa_seqnum_increment(old);
+
+	return new;
+}
+
+static void test_router_lsa_install(struct ospf *ospf, struct ospf_lsa *new)
+{
+	struct ospf_area *area = ospf->backbone;
+	struct ospf_lsa *old;
+
+	old = ospf_lsa_lookup_by_id(area, OSPF_ROUTER_LSA, new->data->id);
+	ospf_spf_lsa_changed(old, new);
+	ospf_lsdb_add(area->lsdb, new);
+
+	if (area->router_lsa_self == old) {
+		ospf_lsa_unlock(&area->router_lsa_self);
+		area->router_lsa_self = ospf_lsa_lock(new);
+	}
+
+	ospf_lsa_unlock(&new);
+}
+
+/* Raise the metric of a router's stub links */
+static void test_stubs_metric_add(struct ospf *ospf, const char *router_id,
+				  uint16_t metric)
+{
+	struct ospf_lsa *new;
+	struct router_lsa *rl;
+	int i;
+
+	new = test_router_lsa_new(ospf, router_id);
+
+	rl = (struct router_lsa *)new->data;
+	for (i = 0; i < ntohs(rl->links); i++)
+		if (rl->link[i].type == LSA_LINK_TYPE_STUB)
+			rl->link[i].metric =
+				htons(ntohs(rl->link[i].metric) + metric);
+
+	test_router_lsa_install(ospf, new);
+}
+
+/*
+ * A full SPF, then a change to rt2's stub links only, which the partial
+ * route calculation must handle with the same result as a full SPF.
+ */
+static void test_run_prc(struct vty *vty, struct ospf *ospf)
+{
+	test_spf_calculate(ospf);
+
+	test_stubs_metric_add(ospf, "2.2.2.2", 20);
+
+	if (!ospf_prc_possible(ospf)) {
+		vty_out(vty, "Partial route calculation not possible\n");
+		return;
+	}
+	ospf_prc_calculate(ospf);
+
+	vty_out(vty,
+		"Partial route calculation: %" PRIu64 " prefixes, %" PRIu64
+		" routes changed\n",
+		ospf->spf_stats.prc_prefixes, ospf->spf_stats.prc_changed);
+
+	ospf->spf_full_pending = true;
+	test_spf_calculate(ospf);
+
+	vty_out(vty, "Routing table %s a full SPF\n",
+		test_route_table_same(ospf->old_table, ospf->new_table)
+			? "matches"
+			: "differs from");
+
+	print_route_table(vty, ospf->new_table);
+}
+
+/* Make a router an ASBR, before any SPF */
+static void test_asbr_set(struct ospf *ospf, const char *router_id)
+{
+	struct in_addr id;
+	struct ospf_lsa *lsa;
+
+	inet_aton(router_id, &id);
+	lsa = ospf_lsa_lookup_by_id(ospf->backbone, OSPF_ROUTER_LSA, id);
+	SET_FLAG(((struct router_lsa *)lsa->data)->flags, ROUTER_LSA_EXTERNAL);
+}
+
+/* An AS-external-LSA with a type 1 metric of 20 */
+static void test_external_lsa_add(struct ospf *ospf, const char *adv_router,
+				  const char *prefix, const char *fwd_addr)
+{
+	struct in_addr router_id, mask, fwd;
+	struct prefix_ipv4 p;
+	struct stream *s;
+	struct lsa_header *lsah;
+	struct ospf_lsa *new;
+	int length;
+
+	inet_aton(adv_router, &router_id);
+	str2prefix_ipv4(prefix, &p);
+	masklen2ip(p.prefixlen, &mask);
+	inet_aton(fwd_addr, &fwd);
+
+	s = stream_new(OSPF_MAX_LSA_SIZE);
+	lsa_header_set(s, OSPF_OPTION_E, OSPF_AS_EXTERNAL_LSA, p.prefix,
+		       router_id);
+
+	stream_put_ipv4(s, mask.s_addr);
+	stream_putc(s, 0);
+	stream_put3(s, 20);
+	stream_put_ipv4(s, fwd.s_addr);
+	stream_putl(s, 0);
+
+	length = stream_get_endp(s);
+	lsah = (struct lsa_header *)STREAM_DATA(s);
+	lsah->length = htons(length);
+
+	new = ospf_lsa_new_and_data(length);
+	new->vrf_id = ospf->vrf_id;
+	memcpy(new->data, lsah, length);
+	stream_free(s);
+
+	ospf_lsdb_add(ospf->lsdb, new);
+	ospf_ase_register_external_lsa(new, ospf);
+	ospf_lsa_unlock(&new);
+}
+
+/* Set the metric of a router's point-to-point links to a neighbor */
+static void test_link_metric_set(struct ospf *ospf, const char *router_id,
+				 const char *nbr_id, uint16_t metric)
+{
+	struct in_addr nbr;
+	struct ospf_lsa *new;
+	struct router_lsa *rl;
+	int i;
+
+	inet_aton(nbr_id, &nbr);
+	new = test_router_lsa_new(ospf, router_id);
+
+	rl = (struct router_lsa *)new->data;
+	for (i = 0; i < ntohs(rl->links); i++)
+		if (rl->link[i].type == LSA_LINK_TYPE_POINTOPOINT
+		    && rl->link[i].link_id.s_addr == nbr.s_addr)
+			rl->link[i].metric = htons(metric);
+
+	test_router_lsa_install(ospf, new);
+}
+
+static bool test_external_route_match(struct route_table *rt,
+				      struct route_node *rn)
+{
+	struct route_node *other;
+	struct ospf_route *a = rn->info, *b;
+	struct listnode *na, *nb;
+	struct ospf_path *pa, *pb;
+
+	other = route_node_lookup(rt, &rn->p);
+	if (!other)
+		return false;
+	route_unlock_node(other);
+
+	b = other->info;
+	if (!b || a->path_type != b->path_type || a->cost != b->cost
+	    || a->u.ext.type2_cost != b->u.ext.type2_cost
+	    || listcount(a->paths) != listcount(b->paths))
+		return false;
+
+	list_sort(a->paths, sort_paths);
+	list_sort(b->paths, sort_paths);
+
+	for (na = listhead(a->paths), nb = listhead(b->paths); na && nb;
+	     na = listnextnode(na), nb = listnextnode(nb)) {
+		pa = listgetdata(na);
+		pb = listgetdata(nb);
+
+		if (pa->nexthop.s_addr != pb->nexthop.s_addr)
+			return false;
+	}
+
+	return true;
+}
+
+static bool test_external_table_same(struct route_table *a,
+				     struct route_table *b)
+{
+	struct route_node *rn;
+
+	for (rn = route_top(a); rn; rn = route_next(rn))
+		if (rn->info && !test_external_route_match(b, rn)) {
+			route_unlock_node(rn);
+			return false;
+		}
+
+	for (rn = route_top(b); rn; rn = route_next(rn))
+		if (rn->info && !test_external_route_match(a, rn)) {
+			route_unlock_node(rn);
+			return false;
+		}
+
+	return true;
+}
+
+static void print_external_table(struct vty *vty, struct route_table *rt)
+{
+	struct route_node *rn;
+	struct ospf_route *or;
+	struct listnode *pnode;
+	struct ospf_path *path;
+
+	for (rn = route_top(rt); rn; rn = route_next(rn)) {
+		if ((or = rn->info) == NULL)
+			continue;
+
+		vty_out(vty, "E%d %-18pFX %d\n",
+			or->path_type == OSPF_PATH_TYPE1_EXTERNAL ? 1 : 2,
+			&rn->p, or->cost);
+
+		list_sort(or->paths, sort_paths);
+
+		for (ALL_LIST_ELEMENTS_RO(or->paths, pnode, path))
+			vty_out(vty, "  -> %pI4\n", &path->nexthop);
+	}
+}
+
+/*
+ * External routes through rt2 and rt3, one of them through a forwarding
+ * address behind both.  Once rt1 reaches rt2 through rt3, only the routes
+ * through rt2 or that forwarding address may be recalculated, with the
+ * same result as a calculation of all of them.
+ */
+static void test_run_ase(struct vty *vty, struct ospf *ospf)
+{
+	struct route_table *ext;
+	long count;
+
+	test_asbr_set(ospf, "2.2.2.2");
+	test_asbr_set(ospf, "3.3.3.3");
+	test_external_lsa_add(ospf, "2.2.2.2", "192.168.1.0/24", "0.0.0.0");
+	test_external_lsa_add(ospf, "2.2.2.2", "192.168.2.0/24", "0.0.0.0");
+	test_external_lsa_add(ospf, "3.3.3.3", "192.168.3.0/24", "0.0.0.0");
+	test_external_lsa_add(ospf, "3.3.3.3", "192.168.4.0/24", "10.0.2.2");
+	test_external_lsa_add(ospf, "3.3.3.3", "192.168.5.0/24", "0.0.0.0");
+	test_external_lsa_add(ospf, "3.3.3.3", "192.168.6.0/24", "0.0.0.0");
+
+	test_spf_calculate(ospf);
+	ospf_ase_calculate(ospf);
+
+	test_link_metric_set(ospf, "1.1.1.1", "2.2.2.2", 30);
+
+	test_spf_calculate(ospf);
+	count = ospf_ase_calculate(ospf);
+
+	vty_out(vty, "External routes recalculated: %ld\n", count);
+
+	/* Calculate all of them, from scratch */
+	ext = ospf->old_external_route;
+	ospf->old_external_route = route_table_init();
+	ospf->ase_full_pending = true;
+	ospf_ase_calculate(ospf);
+
+	vty_out(vty, "External routes %s a full calculation\n",
+		test_external_table_same(ext, ospf->old_external_route)
+			? "match"
+			: "differ from");
+	ospf_route_table_free(ext);
+
+	print_external_table(vty, ospf->old_external_route);
+}
+
+static int test_run_incremental(struct vty *vty,
+				struct ospf_topology *topology,
+				struct ospf_test_node *root, const char *test)
+{
+	struct ospf *ospf;
+
+	ospf = test_init(root);
+	ospf->ti_lfa_enabled = false;
+	ospf->spf_incremental = true;
+	ospf->spf_dry_run = true;
+
+	if (topology_load(vty, topology, root, ospf)) {
+		vty_out(vty, "%% Failed to load topology\n");
+		return CMD_WARNING;
+	}
+
+	if (strmatch(test, "incremental-spf"))
+		test_run_incremental_spf(vty, ospf);
+	else if (strmatch(test, "partial-route-calculation"))
+		test_run_prc(vty, ospf);
+	else if (strmatch(test, "external-routes"))
+		test_run_ase(vty, ospf);
+
+	return 0;
+}
+
 DEFUN(test_ospf, test_ospf_cmd,
       "test ospf topology WORD root HOSTNAME ti-lfa [node-protection] [verbose]",
       "Test mode\n"
@@ -203,6 +637,41 @@ DEFUN(test_ospf, test_ospf_cmd,
 	return test_run(vty, topology, root, protection_type, verbose);
 }
 
+DEFUN(test_ospf_incremental, test_ospf_incremental_cmd,
+      "test ospf topology WORD root HOSTNAME <incremental-spf|partial-route-calculation|external-routes>",
+      "Test mode\n"
+      "Choose OSPF for SPF testing\n"
+      "Network topology to choose\n"
+      "Name of the network topology to choose\n"
+      "Root node to choose\n"
+      "Hostname of the root node to choose\n"
+      "Reuse the shortest-path tree of an unchanged area\n"
+      "Recalculate the routes to changed stub links only\n"
+      "Recalculate the external routes depending on changed routes only\n")
+{
+	struct ospf_topology *topology;
+	struct ospf_test_node *root;
+	int idx = 0;
+
+	/* Parse topology. */
+	argv_find(argv, argc, "topology", &idx);
+	topology = test_find_topology(argv[idx + 1]->arg);
+	if (!topology) {
+		vty_out(vty, "%% Topology not found\n");
+		return CMD_WARNING;
+	}
+
+	argv_find(argv, argc, "root", &idx);
+	root = test_find_node(topology, argv[idx + 1]->arg);
+	if (!root) {
+		vty_out(vty, "%% Root not found\n");
+		return CMD_WARNING;
+	}
+
+	return test_run_incremental(vty, topology, root,
+				    argv[argc - 1]->text);
+}
+
 static void vty_do_exit(int isexit)
 {
 	printf("\nend.\n");
@@ -287,11 +756,16 @@ int main(int argc, char **argv)
 
 	/* Install test command. */
 	install_element(VIEW_NODE, &test_ospf_cmd);
+	install_element(VIEW_NODE, &test_ospf_incremental_cmd);
 
 	/* needed for SR DB init */
 	ospf_vty_init();
 	ospf_sr_init();
 
+	/* Routes are "installed" by the incremental tests, to nowhere */
+	zclient = zclient_new(master, &zclient_options_default, NULL, 0);
+	zclient->sock = -1;
+
 	term_debug_ospf_ti_lfa = 1;
 
 	/* Read input from .in file. */
@@ -18,6 +18,7 @@ import re
 import sys
 import pytest
 import json
+from time import sleep
 from functools import partial
 
 # Save the Current Working Directory to find configuration files.
@@ -67,6 +68,7 @@ def setup_module(module):
         router.load_config(
             TopoRouter.RD_FPM_LISTENER,
             os.path.join(CWD, "{}/fpm_stub.conf".format(rname)),
+            "-s",
         )
 
     tgen.start_router()
@@ -130,6 +132,103 @@ def test_fpm_install_routes():
     assert success, "Unable to remove 10000 routes: {}".format(result)
 
 
+def fpm_listener_routes(tgen, router):
+    "Amount of routes the fpm listener last reported having"
+
+    output = router.run(
+        "grep 'Route table:' {} | tail -1".format(
+            os.path.join(tgen.logdir, router.name, "fpm_listener.out")
+        )
+    )
+    match = re.search(r"Route table: (\d+) routes", output)
+    if match is None:
+        return None
+    return int(match.group(1))
+
+
+def fpm_counter(router, name):
+    "Value of a FPM counter"
+
+    output = json.loads(router.vtysh_cmd("show fpm counters json"))
+    return output[name]
+
+
+def sharp_routes_expected(count):
+    "Route summary with `count` sharp routes"
+
+    return {
+        "routes": [
+            {"fib": 1, "rib": 1, "type": "connected"},
+            {"fib": 1, "rib": 1, "type": "local"},
+            {"fib": count, "rib": count, "type": "sharp"},
+        ]
+    }
+
+
+def test_fpm_reconnect_resync():
+    "Test that a reconnecting client resumes without losing routes"
+
+    tgen = get_topogen()
+    router = tgen.gears["r1"]
+
+    # Let the listener catch up with the routes removed by the last test.
+    def _listener_settled():
+        before = fpm_listener_routes(tgen, router)
+        sleep(2)
+        return before is not None and before == fpm_listener_routes(tgen, router)
+
+    success, _ = topotest.run_and_expect(_listener_settled, True, 30, 1)
+    assert success, "fpm listener route count never settled"
+    base = fpm_listener_routes(tgen, router)
+
+    router.vtysh_cmd("sharp install routes 10.0.0.0 nexthop 192.168.44.33 1000")
+    test_func = partial(
+        topotest.router_json_cmp,
+        router,
+        "show ip route summ json",
+        sharp_routes_expected(1000),
+    )
+    success, result = topotest.run_and_expect(test_func, None, 60, 1)
+    assert success, "Unable to install 1000 routes: {}".format(result)
+
+    test_func = partial(fpm_listener_routes, tgen, router)
+    success, result = topotest.run_and_expect(test_func, base + 1000, 60, 1)
+    assert success, "fpm listener has {} routes, expected {}".format(
+        result, base + 1000
+    )
+
+    resyncs_full = fpm_counter(router, "resyncs-full")
+    resyncs_incremental = fpm_counter(router, "resyncs-incremental")
+
+    # Reconnect and remove routes while the connection is down.
+    router.vtysh_cmd("configure terminal\nfpm address 127.0.0.1")
+    router.vtysh_cmd("sharp remove routes 10.0.0.0 500")
+
+    test_func = partial(fpm_counter, router, "resyncs-incremental")
+    success, result = topotest.run_and_expect(
+        test_func, resyncs_incremental + 1, 30, 1
+    )
+    assert success, "No incremental resync happened"
+    assert fpm_counter(router, "resyncs-full") == resyncs_full
+
+    test_func = partial(
+        topotest.router_json_cmp,
+        router,
+        "show ip route summ json",
+        sharp_routes_expected(500),
+    )
+    success, result = topotest.run_and_expect(test_func, None, 60, 1)
+    assert success, "Unable to remove 500 routes: {}".format(result)
+
+    test_func = partial(fpm_listener_routes, tgen, router)
+    success, result = topotest.run_and_expect(test_func, base + 500, 60, 1)
+    assert success, "fpm listener lost routes: has {}, expected {}".format(
+        result, base + 500
+    )
+
+    router.vtysh_cmd("sharp remove routes 10.0.1.244 500")
+
+
 if __name__ == "__main__":
     args = ["-s"] + sys.argv[1:]
     sys.exit(pytest.main(args))
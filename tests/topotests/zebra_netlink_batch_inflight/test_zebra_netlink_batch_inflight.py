@@ -0,0 +1,153 @@
+#!/usr/bin/env python
+# SPDX-License-Identifier: ISC
+
+#
+# test_zebra_netlink_batch_inflight.py
+#
+
+"""
+test_zebra_netlink_batch_inflight.py: Time the install of 2M routes into
+the kernel, with the dataplane reading the kernel's responses after every
+netlink batch ("zebra kernel netlink batch-inflight 0") and with its
+default of keeping several batches in flight.
+
+Each run installs the routes through sharpd, waits for zebra to report all
+of them installed, then removes them again.  The install and removal times
+sharpd measured are logged for both runs, so they can be compared.
+"""
+
+import re
+import sys
+from functools import partial
+
+import pytest
+from lib import topotest
+from lib.topogen import Topogen, TopoRouter
+from lib.topolog import logger
+
+pytestmark = [pytest.mark.sharpd]
+
+ROUTES = 2000000
+
+
+#####################################################
+##
+##   Tests starting
+##
+#####################################################
+
+
+@pytest.fixture(scope="module")
+def tgen(request):
+    "Sets up the pytest environment"
+
+    topodef = {"s1": ("r1")}
+    tgen = Topogen(topodef, request.module.__name__)
+    tgen.start_topology()
+
+    # Initialize all routers.
+    router_list = tgen.routers()
+    for rname, router in router_list.items():
+        router.load_config(TopoRouter.RD_ZEBRA, "zebra.conf")
+        router.load_config(TopoRouter.RD_SHARP)
+
+    tgen.start_router()
+    yield tgen
+    tgen.stop_topology()
+
+
+@pytest.fixture(autouse=True)
+def skip_on_failure(tgen):
+    if tgen.routers_have_failure():
+        pytest.skip("skipped because of previous test failure")
+
+
+def sharp_route_data(router):
+    "Route counts and time of sharpd's last install or removal"
+
+    output = router.vtysh_cmd("sharp data route", isjson=False)
+    m = re.search(r"Total: (\d+) (\d+) (\d+) Time: (\d+)\.(\d+)", output)
+    if not m:
+        return None
+
+    # The microseconds are printed unpadded.
+    return {
+        "total": int(m.group(1)),
+        "installed": int(m.group(2)),
+        "removed": int(m.group(3)),
+        "time": int(m.group(4)) + int(m.group(5)) / 1000000.0,
+    }
+
+
+def sharp_routes_done(router, key):
+    data = sharp_route_data(router)
+    if data is None:
+        return "no sharp route data"
+    if data[key] != ROUTES:
+        return "{} of {} routes {}".format(data[key], ROUTES, key)
+    return None
+
+
+def time_routes(router, inflight):
+    "Install and remove the routes, return sharpd's times for both"
+
+    if inflight is None:
+        router.vtysh_cmd("conf t\nno zebra kernel netlink batch-inflight 0")
+    else:
+        router.vtysh_cmd(
+            "conf t\nzebra kernel netlink batch-inflight {}".format(inflight)
+        )
+
+    router.vtysh_cmd(
+        "sharp install routes 1.0.0.0 nexthop 192.168.1.2 {}".format(ROUTES)
+    )
+    test_func = partial(sharp_routes_done, router, "installed")
+    success, result = topotest.run_and_expect(test_func, None, 300, 2)
+    assert success, "Route install failed: {}".format(result)
+    install_time = sharp_route_data(router)["time"]
+
+    router.vtysh_cmd("sharp remove routes 1.0.0.0 {}".format(ROUTES))
+    test_func = partial(sharp_routes_done, router, "removed")
+    success, result = topotest.run_and_expect(test_func, None, 300, 2)
+    assert success, "Route removal failed: {}".format(result)
+    remove_time = sharp_route_data(router)["time"]
+
+    return install_time, remove_time
+
+
+def test_zebra_netlink_batch_inflight(tgen):
+    "Compare the route install times without and with batches in flight."
+
+    r1 = tgen.gears["r1"]
+
+    # 2M routes take several GB across zebra, sharpd and the kernel.
+    output = tgen.net.cmd_raises("free")
+    m = re.search(r"Mem:\s+(\d+)", output)
+    if int(m.group(1)) < 8000000:
+        pytest.skip("Not enough memory for {} routes".format(ROUTES))
+
+    entry = {"r1-eth0": {"addresses": ["192.168.1.1/24"]}}
+    ok = topotest.router_json_cmp_retry(r1, "show int brief json", entry, False, 30)
+    assert ok, '"r1" Address not installed yet'
+
+    times = {}
+    for name, inflight in (("batch-inflight 0", 0), ("default", None)):
+        logger.info("Installing {} routes with {}".format(ROUTES, name))
+        times[name] = time_routes(r1, inflight)
+
+    for name, (install_time, remove_time) in times.items():
+        logger.info(
+            "{} routes with {}: installed in {:.3f}s, removed in {:.3f}s".format(
+                ROUTES, name, install_time, remove_time
+            )
+        )
+    logger.info(
+        "Install time with the default: {:.1%} of batch-inflight 0".format(
+            times["default"][0] / times["batch-inflight 0"][0]
+        )
+    )
+
+
+if __name__ == "__main__":
+    args = ["-s"] + sys.argv[1:]
+    sys.exit(pytest.main(args))
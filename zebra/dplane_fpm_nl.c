@@ -14,6 +14,7 @@
 
 #include <sys/types.h>
 #include <sys/socket.h>
+#include <sys/uio.h>
 
 #include <errno.h>
 #include <string.h>
@@ -43,6 +44,7 @@
 #include "zebra/kernel_netlink.h"
 #include "zebra/rt_netlink.h"
 #include "zebra/debug.h"
+#include "zebra/rib.h"
 #include "fpm/fpm.h"
 
 #include "zebra/dplane_fpm_nl_clippy.c"
@@ -68,6 +70,84 @@
  */
 #define FPM_HEADER_SIZE 4
 
+/*
+ * Output buffer: encoded messages are appended to a queue of large
+ * contiguous segments which are handed to writev() as they are.
+ *
+ * FPM_MSG_MAX is the room an encoder gets for one context (header
+ * included), FPM_OBUF_SIZE caps the amount of bytes waiting to be sent.
+ */
+#define FPM_MSG_MAX (NL_PKT_BUF_SIZE + FPM_HEADER_SIZE)
+#define FPM_OBUF_SEG_SIZE (8 * NL_PKT_BUF_SIZE)
+#define FPM_OBUF_SIZE (128 * NL_PKT_BUF_SIZE)
+
+/* Batches smaller than this are merged into the last queued segment. */
+#define FPM_OBUF_MERGE_MAX (FPM_OBUF_SEG_SIZE / 8)
+
+/* Maximum amount of segments written by a single writev() call. */
+#define FPM_WRITEV_MAX 16
+
+/* Maximum amount of data plane contexts encoded in one batch. */
+#define FPM_BATCH_MAX 128
+
+/* Amount of RIB nodes visited before the RIB walk yields. */
+#define FPM_RIB_WALK_CHUNK 4096
+
+/* Amount of route deletes remembered for incremental resyncs. */
+#define FPM_TOMBS_MAX 65536
+
+/* Seconds to wait for the client to ask for an incremental resync. */
+#define FPM_RESYNC_WAIT 3
+
+DEFINE_MTYPE_STATIC(ZEBRA, FPM_OBUF, "FPM output buffer");
+DEFINE_MTYPE_STATIC(ZEBRA, FPM_TOMB, "FPM route delete log");
+
+PREDECL_DLIST(fpm_obuf_segs);
+
+struct fpm_obuf_seg {
+	struct fpm_obuf_segs_item entry;
+
+	/* Bytes encoded into `data` and bytes of those already written. */
+	size_t len;
+	size_t sent;
+
+	/* Lowest RIB version of the route messages in `data`. */
+	uint64_t min_version;
+
+	uint8_t data[FPM_OBUF_SEG_SIZE];
+};
+
+DECLARE_DLIST(fpm_obuf_segs, struct fpm_obuf_seg, entry);
+
+/*
+ * Incremental resync.
+ *
+ * Route messages carry the RIB version of the change (see rib_dest_t) in
+ * the netlink header: the low 32 bits in `nlmsg_seq` and the high ones in
+ * `nlmsg_pid`. A client that wants to pick up where it left off sends an
+ * RTM_GETROUTE request with the version it has applied encoded the same
+ * way. At the start of the RIB replay zebra sends an NLMSG_DONE carrying
+ * the version it resyncs from, 0 meaning everything is sent again, then the
+ * route deletes and routes changed after that version.
+ *
+ * The replay ends with another NLMSG_DONE carrying the version the client
+ * is complete up to. Route messages arrive in no particular version order,
+ * walked ones mixed with live changes, so that marker is the only version
+ * a client may resume from.
+ */
+PREDECL_DLIST(fpm_tombs);
+
+/* A logged route delete, encoded and ready to be sent. */
+struct fpm_tomb {
+	struct fpm_tombs_item entry;
+
+	uint64_t version;
+	uint16_t len;
+	uint8_t data[];
+};
+
+DECLARE_DLIST(fpm_tombs, struct fpm_tomb, entry);
+
 static const char *prov_name = "dplane_fpm_nl";
 
 struct fpm_nl_ctx {
@@ -77,13 +157,24 @@ struct fpm_nl_ctx {
 	bool connecting;
 	bool use_nhg;
 	bool use_route_replace;
+	bool use_incremental_resync;
 	struct sockaddr_storage addr;
 
 	/* data plane buffers. */
 	struct stream *ibuf;
-	struct stream *obuf;
+	struct fpm_obuf_segs_head obuf;
+	/* Amount of bytes in obuf not written yet. */
+	size_t obuf_len;
+	/* Released segment kept around for reuse. */
+	struct fpm_obuf_seg *obuf_spare;
 	pthread_mutex_t obuf_mutex;
 
+	/*
+	 * Segment the FPM pthread encodes data plane contexts into without
+	 * holding `obuf_mutex`, then hands over to obuf in one go.
+	 */
+	struct fpm_obuf_seg *batch;
+
 	/*
 	 * data plane context queue:
 	 * When a FPM server connection becomes a bottleneck, we must keep the
@@ -113,6 +204,37 @@ struct fpm_nl_ctx {
 	struct event *t_rmacreset;
 	struct event *t_rmacwalk;
 
+	/* RIB walk position, so the walk can yield and resume. */
+	rib_tables_iter_t rib_iter;
+	struct prefix rib_walk_last;
+	bool rib_walk_resume;
+
+	/*
+	 * Incremental resync state shared between pthreads: the route
+	 * delete log, the oldest version the log is complete from, and the
+	 * lowest version of the route changes dropped while disconnected.
+	 */
+	struct fpm_tombs_head tombs;
+	uint64_t tombs_floor;
+	uint64_t resync_lost;
+	pthread_mutex_t resync_mutex;
+
+	/* Version the client asked to resync from, if it did. */
+	_Atomic bool resync_requested;
+	_Atomic uint64_t resync_version;
+
+	/*
+	 * Current RIB replay (zebra pthread): the version it sends changes
+	 * after, the RIB version when it started (0 when no end marker is
+	 * sent), the deletes and messages to send before walking the tables
+	 * and whether the end marker was queued.
+	 */
+	uint64_t rib_since;
+	uint64_t rib_end;
+	struct fpm_tombs_head rib_replay;
+	bool rib_walk_pending;
+	unsigned int resync_wait;
+
 	/* Statistic counters. */
 	struct {
 		/* Amount of bytes read into ibuf. */
@@ -143,6 +265,22 @@ struct fpm_nl_ctx {
 
 		/* Amount of buffer full events. */
 		_Atomic uint32_t buffer_full;
+
+		/* Amount of context batches handed over to obuf. */
+		_Atomic uint32_t batches;
+		/* Amount of writev() calls and segments written by them. */
+		_Atomic uint32_t writev_calls;
+		_Atomic uint32_t writev_segments;
+
+		/* Amount of RIB walk chunks and routes sent by them. */
+		_Atomic uint32_t rib_walk_chunks;
+		_Atomic uint32_t rib_walk_routes;
+
+		/* Amount of full and incremental RIB resyncs. */
+		_Atomic uint32_t resyncs_full;
+		_Atomic uint32_t resyncs_incremental;
+		/* Amount of logged route deletes replayed. */
+		_Atomic uint32_t resync_deletes;
 	} counters;
 } *gfnc;
 
@@ -180,6 +318,7 @@ enum fpm_nl_events {
  * Prototypes.
  */
 static void fpm_process_event(struct event *t);
+static void fpm_write(struct event *t);
 static int fpm_nl_enqueue(struct fpm_nl_ctx *fnc, struct zebra_dplane_ctx *ctx);
 static void fpm_lsp_send(struct event *t);
 static void fpm_lsp_reset(struct event *t);
@@ -189,6 +328,7 @@ static void fpm_rib_send(struct event *t);
 static void fpm_rib_reset(struct event *t);
 static void fpm_rmac_send(struct event *t);
 static void fpm_rmac_reset(struct event *t);
+static void fpm_tombs_free(struct fpm_tombs_head *head);
 
 /*
  * CLI.
@@ -314,6 +454,35 @@ DEFUN(no_fpm_use_route_replace, no_fpm_use_route_replace_cmd,
 	return CMD_SUCCESS;
 }
 
+DEFUN(fpm_use_incremental_resync, fpm_use_incremental_resync_cmd,
+      "fpm incremental-resync",
+      FPM_STR
+      "Only send changes the client missed when it reconnects\n")
+{
+	if (gfnc->use_incremental_resync)
+		return CMD_SUCCESS;
+
+	/* Deletes older than now were not logged. */
+	frr_with_mutex (&gfnc->resync_mutex) {
+		gfnc->tombs_floor = zrouter.rib_version;
+	}
+	gfnc->use_incremental_resync = true;
+	return CMD_SUCCESS;
+}
+
+DEFUN(no_fpm_use_incremental_resync, no_fpm_use_incremental_resync_cmd,
+      "no fpm incremental-resync",
+      NO_STR
+      FPM_STR
+      "Only send changes the client missed when it reconnects\n")
+{
+	gfnc->use_incremental_resync = false;
+	frr_with_mutex (&gfnc->resync_mutex) {
+		fpm_tombs_free(&gfnc->tombs);
+	}
+	return CMD_SUCCESS;
+}
+
 DEFUN(fpm_reset_counters, fpm_reset_counters_cmd,
       "clear fpm counters",
       CLEAR_STR
@@ -417,6 +586,17 @@ DEFUN(fpm_show_counters, fpm_show_counters_cmd,
 	SHOW_COUNTER("Data plane items queue peak",
 		     gfnc->counters.ctxqueue_len_peak);
 	SHOW_COUNTER("Buffer full hits", gfnc->counters.buffer_full);
+	SHOW_COUNTER("Encoded batches", gfnc->counters.batches);
+	SHOW_COUNTER("Output writev calls", gfnc->counters.writev_calls);
+	SHOW_COUNTER("Output segments written",
+		     gfnc->counters.writev_segments);
+	SHOW_COUNTER("RIB walk chunks", gfnc->counters.rib_walk_chunks);
+	SHOW_COUNTER("RIB walk routes sent", gfnc->counters.rib_walk_routes);
+	SHOW_COUNTER("Full resyncs", gfnc->counters.resyncs_full);
+	SHOW_COUNTER("Incremental resyncs",
+		     gfnc->counters.resyncs_incremental);
+	SHOW_COUNTER("Resync deletes replayed",
+		     gfnc->counters.resync_deletes);
 	SHOW_COUNTER("User FPM configurations", gfnc->counters.user_configures);
 	SHOW_COUNTER("User FPM disable requests", gfnc->counters.user_disables);
 
@@ -450,6 +630,19 @@ DEFUN(fpm_show_counters_json, fpm_show_counters_json_cmd,
 	json_object_int_add(jo, "data-plane-contexts-queue-peak",
 			    gfnc->counters.ctxqueue_len_peak);
 	json_object_int_add(jo, "buffer-full-hits", gfnc->counters.buffer_full);
+	json_object_int_add(jo, "encoded-batches", gfnc->counters.batches);
+	json_object_int_add(jo, "writev-calls", gfnc->counters.writev_calls);
+	json_object_int_add(jo, "writev-segments",
+			    gfnc->counters.writev_segments);
+	json_object_int_add(jo, "rib-walk-chunks",
+			    gfnc->counters.rib_walk_chunks);
+	json_object_int_add(jo, "rib-walk-routes",
+			    gfnc->counters.rib_walk_routes);
+	json_object_int_add(jo, "resyncs-full", gfnc->counters.resyncs_full);
+	json_object_int_add(jo, "resyncs-incremental",
+			    gfnc->counters.resyncs_incremental);
+	json_object_int_add(jo, "resync-deletes",
+			    gfnc->counters.resync_deletes);
 	json_object_int_add(jo, "user-configures",
 			    gfnc->counters.user_configures);
 	json_object_int_add(jo, "user-disables", gfnc->counters.user_disables);
@@ -501,6 +694,11 @@ static int fpm_write_config(struct vty *vty)
 		written = 1;
 	}
 
+	if (gfnc->use_incremental_resync) {
+		vty_out(vty, "fpm incremental-resync\n");
+		written = 1;
+	}
+
 	return written;
 }
 
@@ -514,6 +712,357 @@ static struct cmd_node fpm_node = {
 /*
  * FPM functions.
  */
+/*
+ * Output buffer functions.
+ *
+ * Unless noted otherwise these must be called with `obuf_mutex` held.
+ */
+static struct fpm_obuf_seg *fpm_obuf_seg_new(struct fpm_nl_ctx *fnc)
+{
+	struct fpm_obuf_seg *seg = fnc->obuf_spare;
+
+	if (seg)
+		fnc->obuf_spare = NULL;
+	else
+		seg = XMALLOC(MTYPE_FPM_OBUF, sizeof(*seg));
+
+	seg->len = 0;
+	seg->sent = 0;
+	seg->min_version = UINT64_MAX;
+	return seg;
+}
+
+static void fpm_obuf_seg_free(struct fpm_nl_ctx *fnc, struct fpm_obuf_seg *seg)
+{
+	if (fnc->obuf_spare == NULL)
+		fnc->obuf_spare = seg;
+	else
+		XFREE(MTYPE_FPM_OBUF, seg);
+}
+
+static void fpm_resync_lost(struct fpm_nl_ctx *fnc, uint64_t version);
+
+/* Drops everything not written yet. */
+static void fpm_obuf_reset(struct fpm_nl_ctx *fnc)
+{
+	struct fpm_obuf_seg *seg;
+
+	while ((seg = fpm_obuf_segs_pop(&fnc->obuf))) {
+		if (seg->sent < seg->len)
+			fpm_resync_lost(fnc, seg->min_version);
+		fpm_obuf_seg_free(fnc, seg);
+	}
+
+	fnc->obuf_len = 0;
+}
+
+/*
+ * Returns a segment with room for one more message at the end of obuf, or
+ * NULL if the output buffer is full.
+ */
+static struct fpm_obuf_seg *fpm_obuf_reserve(struct fpm_nl_ctx *fnc)
+{
+	struct fpm_obuf_seg *seg;
+
+	/* Check if we have enough buffer space. */
+	if (fnc->obuf_len + FPM_MSG_MAX > FPM_OBUF_SIZE) {
+		atomic_fetch_add_explicit(&fnc->counters.buffer_full, 1,
+					  memory_order_relaxed);
+
+		if (IS_ZEBRA_DEBUG_FPM)
+			zlog_debug(
+				"%s: buffer full: wants to write %zu but has %zu",
+				__func__, (size_t)FPM_MSG_MAX,
+				FPM_OBUF_SIZE - fnc->obuf_len);
+
+		return NULL;
+	}
+
+	seg = fpm_obuf_segs_last(&fnc->obuf);
+	if (seg == NULL || FPM_OBUF_SEG_SIZE - seg->len < FPM_MSG_MAX) {
+		seg = fpm_obuf_seg_new(fnc);
+		fpm_obuf_segs_add_tail(&fnc->obuf, seg);
+	}
+
+	return seg;
+}
+
+/*
+ * Completes a message whose `nl_len` bytes of netlink payload were put
+ * right after the room for its header at the end of `seg`.
+ *
+ * Called without `obuf_mutex` for the batch segment.
+ */
+static size_t fpm_obuf_seg_commit(struct fpm_obuf_seg *seg, size_t nl_len)
+{
+	uint16_t msg_len;
+
+	/* We must know if someday a message goes beyond 65KiB. */
+	assert((nl_len + FPM_HEADER_SIZE) <= UINT16_MAX);
+
+	/*
+	 * Fill in the FPM header information in front of the message.
+	 *
+	 * See FPM_HEADER_SIZE definition for more information.
+	 */
+	msg_len = htons(nl_len + FPM_HEADER_SIZE);
+	seg->data[seg->len] = 1;
+	seg->data[seg->len + 1] = 1;
+	memcpy(&seg->data[seg->len + 2], &msg_len, sizeof(msg_len));
+	seg->len += nl_len + FPM_HEADER_SIZE;
+
+	return nl_len + FPM_HEADER_SIZE;
+}
+
+/* Accounts `len` new bytes in obuf and tells the thread to write them. */
+static void fpm_obuf_queued(struct fpm_nl_ctx *fnc, size_t len)
+{
+	uint64_t obytes, obytes_peak;
+
+	fnc->obuf_len += len;
+
+	/* Account number of bytes waiting to be written. */
+	atomic_fetch_add_explicit(&fnc->counters.obuf_bytes, len,
+				  memory_order_relaxed);
+	obytes = atomic_load_explicit(&fnc->counters.obuf_bytes,
+				      memory_order_relaxed);
+	obytes_peak = atomic_load_explicit(&fnc->counters.obuf_peak,
+					   memory_order_relaxed);
+	if (obytes_peak < obytes)
+		atomic_store_explicit(&fnc->counters.obuf_peak, obytes,
+				      memory_order_relaxed);
+
+	/* Tell the thread to start writing. */
+	event_add_write(fnc->fthread->master, fpm_write, fnc, fnc->socket,
+			&fnc->t_write);
+}
+
+/* Releases the first `len` bytes of obuf after they were written. */
+static void fpm_obuf_consume(struct fpm_nl_ctx *fnc, size_t len)
+{
+	struct fpm_obuf_seg *seg;
+	size_t n;
+
+	fnc->obuf_len -= len;
+
+	while ((seg = fpm_obuf_segs_first(&fnc->obuf))) {
+		n = MIN(len, seg->len - seg->sent);
+		seg->sent += n;
+		len -= n;
+
+		if (seg->sent < seg->len)
+			break;
+
+		fpm_obuf_segs_del(&fnc->obuf, seg);
+		fpm_obuf_seg_free(fnc, seg);
+		if (len == 0)
+			break;
+	}
+}
+
+/*
+ * Hands the batch segment over to obuf: small batches are copied into the
+ * room left in the last queued segment, bigger ones are queued as they are.
+ *
+ * Called by the FPM pthread without holding `obuf_mutex`.
+ */
+static void fpm_obuf_push_batch(struct fpm_nl_ctx *fnc)
+{
+	struct fpm_obuf_seg *seg = fnc->batch, *last;
+	size_t len = seg->len;
+
+	if (len == 0)
+		return;
+
+	frr_with_mutex (&fnc->obuf_mutex) {
+		last = fpm_obuf_segs_last(&fnc->obuf);
+		if (len <= FPM_OBUF_MERGE_MAX && last &&
+		    FPM_OBUF_SEG_SIZE - last->len >= len) {
+			memcpy(&last->data[last->len], seg->data, len);
+			last->len += len;
+			last->min_version =
+				MIN(last->min_version, seg->min_version);
+			seg->len = 0;
+			seg->min_version = UINT64_MAX;
+		} else {
+			fpm_obuf_segs_add_tail(&fnc->obuf, seg);
+			fnc->batch = fpm_obuf_seg_new(fnc);
+		}
+
+		fpm_obuf_queued(fnc, len);
+	}
+
+	atomic_fetch_add_explicit(&fnc->counters.batches, 1,
+				  memory_order_relaxed);
+}
+
+/*
+ * Incremental resync functions.
+ */
+static void fpm_nl_stamp_version(uint8_t *buf, uint64_t version)
+{
+	struct nlmsghdr *nlh = (struct nlmsghdr *)buf;
+
+	nlh->nlmsg_seq = (uint32_t)version;
+	nlh->nlmsg_pid = (uint32_t)(version >> 32);
+}
+
+/* Encodes a resync marker into `buf`, returns its length. */
+static size_t fpm_nl_encode_marker(uint8_t *buf, int mark, uint64_t version)
+{
+	struct nlmsghdr *nlh = (struct nlmsghdr *)buf;
+
+	memset(buf, 0, NLMSG_SPACE(sizeof(mark)));
+	nlh->nlmsg_len = NLMSG_LENGTH(sizeof(mark));
+	nlh->nlmsg_type = NLMSG_DONE;
+	nlh->nlmsg_flags = NLM_F_MULTI;
+	memcpy(NLMSG_DATA(nlh), &mark, sizeof(mark));
+	fpm_nl_stamp_version(buf, version);
+
+	return NLMSG_SPACE(sizeof(mark));
+}
+
+static void fpm_tombs_free(struct fpm_tombs_head *head)
+{
+	struct fpm_tomb *tomb;
+
+	while ((tomb = fpm_tombs_pop(head)))
+		XFREE(MTYPE_FPM_TOMB, tomb);
+}
+
+/* Notes that route changes from `version` on never made it out. */
+static void fpm_resync_lost(struct fpm_nl_ctx *fnc, uint64_t version)
+{
+	frr_with_mutex (&fnc->resync_mutex) {
+		fnc->resync_lost = MIN(fnc->resync_lost, version);
+	}
+}
+
+/* Accounts a data plane context dropped without being sent. */
+static void fpm_resync_dropped(struct fpm_nl_ctx *fnc,
+			       struct zebra_dplane_ctx *ctx)
+{
+	enum dplane_op_e op = dplane_ctx_get_op(ctx);
+
+	if (op != DPLANE_OP_ROUTE_INSTALL && op != DPLANE_OP_ROUTE_UPDATE &&
+	    op != DPLANE_OP_ROUTE_DELETE)
+		return;
+
+	fpm_resync_lost(fnc, dplane_ctx_get_rib_version(ctx));
+}
+
+/*
+ * Logs a route delete so a client coming back with an older version gets
+ * to know about it. Called by the data plane pthread.
+ */
+static void fpm_tomb_add(struct fpm_nl_ctx *fnc, struct zebra_dplane_ctx *ctx)
+{
+	uint8_t nl_buf[NL_PKT_BUF_SIZE];
+	struct fpm_tomb *tomb;
+	ssize_t rv;
+
+	rv = netlink_route_multipath_msg_encode(RTM_DELROUTE, ctx, nl_buf,
+						sizeof(nl_buf), true,
+						fnc->use_nhg, false);
+	if (rv <= 0)
+		return;
+
+	tomb = XMALLOC(MTYPE_FPM_TOMB, sizeof(*tomb) + rv);
+	tomb->version = dplane_ctx_get_rib_version(ctx);
+	tomb->len = rv;
+	memcpy(tomb->data, nl_buf, rv);
+	fpm_nl_stamp_version(tomb->data, tomb->version);
+
+	frr_with_mutex (&fnc->resync_mutex) {
+		fpm_tombs_add_tail(&fnc->tombs, tomb);
+		if (fpm_tombs_count(&fnc->tombs) <= FPM_TOMBS_MAX)
+			break;
+
+		/* Clients older than the evicted delete need a full resync. */
+		tomb = fpm_tombs_pop(&fnc->tombs);
+		fnc->tombs_floor = MAX(fnc->tombs_floor, tomb->version);
+		XFREE(MTYPE_FPM_TOMB, tomb);
+	}
+}
+
+/*
+ * Picks the version the RIB replay starts from and queues what has to be
+ * sent before walking the tables: the NLMSG_DONE marker telling the client
+ * that version, then the logged deletes after it.
+ */
+static void fpm_resync_start(struct fpm_nl_ctx *fnc)
+{
+	struct fpm_tomb *tomb, *copy;
+	uint64_t since = 0, owed = UINT64_MAX;
+
+	/* An unfinished replay still owes everything after its version. */
+	if (fnc->rib_walk_pending)
+		owed = fnc->rib_since;
+
+	fpm_tombs_free(&fnc->rib_replay);
+	fnc->rib_since = 0;
+	fnc->rib_end = 0;
+	fnc->rib_walk_pending = true;
+
+	if (atomic_load_explicit(&fnc->resync_requested, memory_order_relaxed))
+		since = atomic_load_explicit(&fnc->resync_version,
+					     memory_order_relaxed);
+	since = MIN(since, owed);
+
+	frr_with_mutex (&fnc->resync_mutex) {
+		if (fnc->resync_lost <= since)
+			since = fnc->resync_lost - 1;
+		fnc->resync_lost = UINT64_MAX;
+	}
+
+	if (!fnc->use_incremental_resync) {
+		atomic_fetch_add_explicit(&fnc->counters.resyncs_full, 1,
+					  memory_order_relaxed);
+		return;
+	}
+
+	frr_with_mutex (&fnc->resync_mutex) {
+
+		if (since < fnc->tombs_floor || since > zrouter.rib_version)
+			since = 0;
+
+		frr_each (fpm_tombs, &fnc->tombs, tomb) {
+			if (since == 0)
+				break;
+			if (tomb->version <= since)
+				continue;
+
+			copy = XMALLOC(MTYPE_FPM_TOMB,
+				       sizeof(*copy) + tomb->len);
+			copy->version = tomb->version;
+			copy->len = tomb->len;
+			memcpy(copy->data, tomb->data, tomb->len);
+			fpm_tombs_add_tail(&fnc->rib_replay, copy);
+		}
+	}
+
+	/* Resync start marker, a message without a version of its own. */
+	copy = XCALLOC(MTYPE_FPM_TOMB,
+		       sizeof(*copy) + NLMSG_SPACE(sizeof(int)));
+	copy->len = fpm_nl_encode_marker(copy->data, FPM_RESYNC_START, since);
+	fpm_tombs_add_head(&fnc->rib_replay, copy);
+
+	fnc->rib_since = since;
+	fnc->rib_end = zrouter.rib_version;
+
+	if (since)
+		atomic_fetch_add_explicit(&fnc->counters.resyncs_incremental,
+					  1, memory_order_relaxed);
+	else
+		atomic_fetch_add_explicit(&fnc->counters.resyncs_full, 1,
+					  memory_order_relaxed);
+
+	if (IS_ZEBRA_DEBUG_FPM)
+		zlog_debug("%s: resync from version %" PRIu64 " (%zu deletes)",
+			   __func__, since,
+			   fpm_tombs_count(&fnc->rib_replay) - 1);
+}
+
 static void fpm_connect(struct event *t);
 
 static void fpm_reconnect(struct fpm_nl_ctx *fnc)
@@ -541,7 +1090,9 @@ static void fpm_reconnect(struct fpm_nl_ctx *fnc)
 	}
 
 	stream_reset(fnc->ibuf);
-	stream_reset(fnc->obuf);
+	fpm_obuf_reset(fnc);
+	atomic_store_explicit(&fnc->resync_requested, false,
+			      memory_order_relaxed);
 	EVENT_OFF(fnc->t_read);
 	EVENT_OFF(fnc->t_write);
 
@@ -704,6 +1255,18 @@ static void fpm_read(struct event *t)
 				 */
 			}
 			break;
+		case RTM_GETROUTE:
+			/*
+			 * Incremental resync request, the version the
+			 * client has is in the sequence and port id.
+			 */
+			atomic_store_explicit(&fnc->resync_version,
+					      ((uint64_t)hdr->nlmsg_pid << 32) |
+						      hdr->nlmsg_seq,
+					      memory_order_relaxed);
+			atomic_store_explicit(&fnc->resync_requested, true,
+					      memory_order_relaxed);
+			break;
 		default:
 			if (IS_ZEBRA_DEBUG_FPM)
 				zlog_debug(
@@ -719,10 +1282,12 @@ static void fpm_read(struct event *t)
 static void fpm_write(struct event *t)
 {
 	struct fpm_nl_ctx *fnc = EVENT_ARG(t);
+	struct iovec iov[FPM_WRITEV_MAX];
+	struct fpm_obuf_seg *seg;
 	socklen_t statuslen;
 	ssize_t bwritten;
 	int rv, status;
-	size_t btotal;
+	int iovcnt;
 
 	if (fnc->connecting == true) {
 		status = 0;
@@ -763,16 +1328,23 @@ static void fpm_write(struct event *t)
 	frr_mutex_lock_autounlock(&fnc->obuf_mutex);
 
 	while (true) {
-		/* Stream is empty: reset pointers and return. */
-		if (STREAM_READABLE(fnc->obuf) == 0) {
-			stream_reset(fnc->obuf);
-			break;
+		/* Gather as many segments as possible in one write. */
+		iovcnt = 0;
+		frr_each (fpm_obuf_segs, &fnc->obuf, seg) {
+			if (seg->sent == seg->len)
+				continue;
+
+			iov[iovcnt].iov_base = &seg->data[seg->sent];
+			iov[iovcnt].iov_len = seg->len - seg->sent;
+			if (++iovcnt == FPM_WRITEV_MAX)
+				break;
 		}
 
-		/* Try to write all at once. */
-		btotal = stream_get_endp(fnc->obuf) -
-			stream_get_getp(fnc->obuf);
-		bwritten = write(fnc->socket, stream_pnt(fnc->obuf), btotal);
+		/* Output buffer is empty. */
+		if (iovcnt == 0)
+			break;
+
+		bwritten = writev(fnc->socket, iov, iovcnt);
 		if (bwritten == 0) {
 			atomic_fetch_add_explicit(
 				&fnc->counters.connection_closes, 1,
@@ -808,12 +1380,16 @@ static void fpm_write(struct event *t)
 		atomic_fetch_sub_explicit(&fnc->counters.obuf_bytes, bwritten,
 					  memory_order_relaxed);
 
-		stream_forward_getp(fnc->obuf, (size_t)bwritten);
+		atomic_fetch_add_explicit(&fnc->counters.writev_calls, 1,
+					  memory_order_relaxed);
+		atomic_fetch_add_explicit(&fnc->counters.writev_segments,
+					  iovcnt, memory_order_relaxed);
+
+		fpm_obuf_consume(fnc, (size_t)bwritten);
 	}
 
-	/* Stream is not empty yet, we must schedule more writes. */
-	if (STREAM_READABLE(fnc->obuf)) {
-		stream_pulldown(fnc->obuf);
+	/* Output buffer is not empty yet, we must schedule more writes. */
+	if (fnc->obuf_len > 0) {
 		event_add_write(fnc->fthread->master, fpm_write, fnc,
 				fnc->socket, &fnc->t_write);
 		return;
@@ -884,19 +1460,22 @@ static void fpm_connect(struct event *t)
 }
 
 /**
- * Encode data plane operation context into netlink and enqueue it in the FPM
- * output buffer.
+ * Encode data plane operation context into netlink and append it, with its
+ * FPM header, to an output buffer segment.
  *
  * @param fnc the netlink FPM context.
  * @param ctx the data plane operation context data.
- * @return 0 on success or -1 on not enough space.
+ * @param seg the segment to append to, with at least FPM_MSG_MAX bytes free.
+ * @return the amount of bytes appended, 0 if nothing was.
  */
-static int fpm_nl_enqueue(struct fpm_nl_ctx *fnc, struct zebra_dplane_ctx *ctx)
+static size_t fpm_nl_encode(struct fpm_nl_ctx *fnc,
+			    struct zebra_dplane_ctx *ctx,
+			    struct fpm_obuf_seg *seg)
 {
-	uint8_t nl_buf[NL_PKT_BUF_SIZE];
+	uint8_t *nl_buf = &seg->data[seg->len + FPM_HEADER_SIZE];
+	const size_t nl_buf_size = NL_PKT_BUF_SIZE;
 	size_t nl_buf_len;
 	ssize_t rv;
-	uint64_t obytes, obytes_peak;
 	enum dplane_op_e op = dplane_ctx_get_op(ctx);
 
 	/*
@@ -910,8 +1489,6 @@ static int fpm_nl_enqueue(struct fpm_nl_ctx *fnc, struct zebra_dplane_ctx *ctx)
 
 	nl_buf_len = 0;
 
-	frr_mutex_lock_autounlock(&fnc->obuf_mutex);
-
 	/*
 	 * If route replace is enabled then directly encode the install which
 	 * is going to use `NLM_F_REPLACE` (instead of delete/add operations).
@@ -923,7 +1500,7 @@ static int fpm_nl_enqueue(struct fpm_nl_ctx *fnc, struct zebra_dplane_ctx *ctx)
 	case DPLANE_OP_ROUTE_UPDATE:
 	case DPLANE_OP_ROUTE_DELETE:
 		rv = netlink_route_multipath_msg_encode(RTM_DELROUTE, ctx,
-							nl_buf, sizeof(nl_buf),
+							nl_buf, nl_buf_size,
 							true, fnc->use_nhg,
 							false);
 		if (rv <= 0) {
@@ -933,6 +1510,9 @@ static int fpm_nl_enqueue(struct fpm_nl_ctx *fnc, struct zebra_dplane_ctx *ctx)
 			return 0;
 		}
 
+		if (fnc->use_incremental_resync)
+			fpm_nl_stamp_version(nl_buf,
+					     dplane_ctx_get_rib_version(ctx));
 		nl_buf_len = (size_t)rv;
 
 		/* UPDATE operations need a INSTALL, otherwise just quit. */
@@ -943,7 +1523,7 @@ static int fpm_nl_enqueue(struct fpm_nl_ctx *fnc, struct zebra_dplane_ctx *ctx)
 	case DPLANE_OP_ROUTE_INSTALL:
 		rv = netlink_route_multipath_msg_encode(RTM_NEWROUTE, ctx,
 							&nl_buf[nl_buf_len],
-							sizeof(nl_buf) -
+							nl_buf_size -
 								nl_buf_len,
 							true, fnc->use_nhg,
 							fnc->use_route_replace);
@@ -954,12 +1534,15 @@ static int fpm_nl_enqueue(struct fpm_nl_ctx *fnc, struct zebra_dplane_ctx *ctx)
 			return 0;
 		}
 
+		if (fnc->use_incremental_resync)
+			fpm_nl_stamp_version(&nl_buf[nl_buf_len],
+					     dplane_ctx_get_rib_version(ctx));
 		nl_buf_len += (size_t)rv;
 		break;
 
 	case DPLANE_OP_MAC_INSTALL:
 	case DPLANE_OP_MAC_DELETE:
-		rv = netlink_macfdb_update_ctx(ctx, nl_buf, sizeof(nl_buf));
+		rv = netlink_macfdb_update_ctx(ctx, nl_buf, nl_buf_size);
 		if (rv <= 0) {
 			zlog_err("%s: netlink_macfdb_update_ctx failed",
 				 __func__);
@@ -971,7 +1554,7 @@ static int fpm_nl_enqueue(struct fpm_nl_ctx *fnc, struct zebra_dplane_ctx *ctx)
 
 	case DPLANE_OP_NH_DELETE:
 		rv = netlink_nexthop_msg_encode(RTM_DELNEXTHOP, ctx, nl_buf,
-						sizeof(nl_buf), true);
+						nl_buf_size, true);
 		if (rv <= 0) {
 			zlog_err("%s: netlink_nexthop_msg_encode failed",
 				 __func__);
@@ -983,7 +1566,7 @@ static int fpm_nl_enqueue(struct fpm_nl_ctx *fnc, struct zebra_dplane_ctx *ctx)
 	case DPLANE_OP_NH_INSTALL:
 	case DPLANE_OP_NH_UPDATE:
 		rv = netlink_nexthop_msg_encode(RTM_NEWNEXTHOP, ctx, nl_buf,
-						sizeof(nl_buf), true);
+						nl_buf_size, true);
 		if (rv <= 0) {
 			zlog_err("%s: netlink_nexthop_msg_encode failed",
 				 __func__);
@@ -996,7 +1579,7 @@ static int fpm_nl_enqueue(struct fpm_nl_ctx *fnc, struct zebra_dplane_ctx *ctx)
 	case DPLANE_OP_LSP_INSTALL:
 	case DPLANE_OP_LSP_UPDATE:
 	case DPLANE_OP_LSP_DELETE:
-		rv = netlink_lsp_msg_encoder(ctx, nl_buf, sizeof(nl_buf));
+		rv = netlink_lsp_msg_encoder(ctx, nl_buf, nl_buf_size);
 		if (rv <= 0) {
 			zlog_err("%s: netlink_lsp_msg_encoder failed",
 				 __func__);
@@ -1060,50 +1643,98 @@ static int fpm_nl_enqueue(struct fpm_nl_ctx *fnc, struct zebra_dplane_ctx *ctx)
 	if (nl_buf_len == 0)
 		return 0;
 
-	/* We must know if someday a message goes beyond 65KiB. */
-	assert((nl_buf_len + FPM_HEADER_SIZE) <= UINT16_MAX);
+	if (op == DPLANE_OP_ROUTE_INSTALL || op == DPLANE_OP_ROUTE_UPDATE ||
+	    op == DPLANE_OP_ROUTE_DELETE)
+		seg->min_version = MIN(seg->min_version,
+				       dplane_ctx_get_rib_version(ctx));
 
-	/* Check if we have enough buffer space. */
-	if (STREAM_WRITEABLE(fnc->obuf) < (nl_buf_len + FPM_HEADER_SIZE)) {
-		atomic_fetch_add_explicit(&fnc->counters.buffer_full, 1,
-					  memory_order_relaxed);
+	return fpm_obuf_seg_commit(seg, nl_buf_len);
+}
 
-		if (IS_ZEBRA_DEBUG_FPM)
-			zlog_debug(
-				"%s: buffer full: wants to write %zu but has %zu",
-				__func__, nl_buf_len + FPM_HEADER_SIZE,
-				STREAM_WRITEABLE(fnc->obuf));
+/**
+ * Encode data plane operation context into netlink and enqueue it in the FPM
+ * output buffer.
+ *
+ * @param fnc the netlink FPM context.
+ * @param ctx the data plane operation context data.
+ * @return 0 on success or -1 on not enough space.
+ */
+static int fpm_nl_enqueue(struct fpm_nl_ctx *fnc, struct zebra_dplane_ctx *ctx)
+{
+	struct fpm_obuf_seg *seg;
+	size_t len;
 
+	frr_mutex_lock_autounlock(&fnc->obuf_mutex);
+
+	seg = fpm_obuf_reserve(fnc);
+	if (seg == NULL)
 		return -1;
-	}
 
-	/*
-	 * Fill in the FPM header information.
-	 *
-	 * See FPM_HEADER_SIZE definition for more information.
-	 */
-	stream_putc(fnc->obuf, 1);
-	stream_putc(fnc->obuf, 1);
-	stream_putw(fnc->obuf, nl_buf_len + FPM_HEADER_SIZE);
+	len = fpm_nl_encode(fnc, ctx, seg);
+	if (len > 0)
+		fpm_obuf_queued(fnc, len);
 
-	/* Write current data. */
-	stream_write(fnc->obuf, nl_buf, (size_t)nl_buf_len);
+	return 0;
+}
 
-	/* Account number of bytes waiting to be written. */
-	atomic_fetch_add_explicit(&fnc->counters.obuf_bytes,
-				  nl_buf_len + FPM_HEADER_SIZE,
-				  memory_order_relaxed);
-	obytes = atomic_load_explicit(&fnc->counters.obuf_bytes,
-				      memory_order_relaxed);
-	obytes_peak = atomic_load_explicit(&fnc->counters.obuf_peak,
-					   memory_order_relaxed);
-	if (obytes_peak < obytes)
-		atomic_store_explicit(&fnc->counters.obuf_peak, obytes,
-				      memory_order_relaxed);
+/**
+ * Enqueue an already encoded netlink message in the FPM output buffer.
+ *
+ * @param fnc the netlink FPM context.
+ * @param tomb the message and the RIB version it belongs to.
+ * @return 0 on success or -1 on not enough space.
+ */
+static int fpm_nl_enqueue_raw(struct fpm_nl_ctx *fnc,
+			      const struct fpm_tomb *tomb)
+{
+	struct fpm_obuf_seg *seg;
 
-	/* Tell the thread to start writing. */
-	event_add_write(fnc->fthread->master, fpm_write, fnc, fnc->socket,
-			&fnc->t_write);
+	frr_mutex_lock_autounlock(&fnc->obuf_mutex);
+
+	seg = fpm_obuf_reserve(fnc);
+	if (seg == NULL)
+		return -1;
+
+	memcpy(&seg->data[seg->len + FPM_HEADER_SIZE], tomb->data, tomb->len);
+	if (tomb->version)
+		seg->min_version = MIN(seg->min_version, tomb->version);
+	fpm_obuf_queued(fnc, fpm_obuf_seg_commit(seg, tomb->len));
+
+	return 0;
+}
+
+/**
+ * Enqueue the marker ending the RIB replay in the FPM output buffer.
+ *
+ * Its version is the one the replay started at, or the one before the
+ * oldest route change still in the data plane if lower: changes on their way
+ * may be deletes the walk never saw. With several netlink route shards the
+ * changes reach us out of version order, so having queued a newer one says
+ * nothing about the older ones.
+ *
+ * @param fnc the netlink FPM context.
+ * @return 0 on success or -1 on not enough space.
+ */
+static int fpm_nl_enqueue_resync_end(struct fpm_nl_ctx *fnc)
+{
+	struct fpm_obuf_seg *seg;
+	uint64_t version;
+	size_t len;
+
+	frr_mutex_lock_autounlock(&fnc->obuf_mutex);
+
+	seg = fpm_obuf_reserve(fnc);
+	if (seg == NULL)
+		return -1;
+
+	version = MIN(fnc->rib_end, dplane_rib_version_pending() - 1);
+	len = fpm_nl_encode_marker(&seg->data[seg->len + FPM_HEADER_SIZE],
+				   FPM_RESYNC_END, version);
+	fpm_obuf_queued(fnc, fpm_obuf_seg_commit(seg, len));
+
+	if (IS_ZEBRA_DEBUG_FPM)
+		zlog_debug("%s: resync complete up to version %" PRIu64,
+			   __func__, version);
 
 	return 0;
 }
@@ -1218,6 +1849,9 @@ static void fpm_nhg_send(struct event *t)
 	/* We are done sending next hops, lets install the routes now. */
 	if (fna.complete) {
 		WALK_FINISH(fnc, FNE_NHG_FINISHED);
+
+		/* The RIB reset waits for a resync request from scratch. */
+		fnc->resync_wait = 0;
 		event_add_timer(zrouter.master, fpm_rib_reset, fnc, 0,
 				&fnc->t_ribreset);
 	} else /* Otherwise reschedule next hop group again. */
@@ -1225,8 +1859,59 @@ static void fpm_nhg_send(struct event *t)
 				&fnc->t_nhgwalk);
 }
 
+/*
+ * Returns the table the RIB walk stopped in. If it went away meanwhile the
+ * walk starts over from the first table.
+ */
+static struct route_table *fpm_rib_walk_table(struct fpm_nl_ctx *fnc)
+{
+	rib_tables_iter_t iter = fnc->rib_iter;
+	struct route_table *rt;
+
+	if (iter.state == RIB_TABLES_ITER_S_ITERATING) {
+		/* Step back one table and look it up again. */
+		iter.afi_safi_ix--;
+		rt = rib_tables_iter_next(&iter);
+		if (rt && iter.vrf_id == fnc->rib_iter.vrf_id &&
+		    iter.afi_safi_ix == fnc->rib_iter.afi_safi_ix)
+			return rt;
+
+		fnc->rib_iter.state = RIB_TABLES_ITER_S_INIT;
+		fnc->rib_walk_resume = false;
+	}
+
+	return rib_tables_iter_next(&fnc->rib_iter);
+}
+
+/*
+ * Closes the RIB replay: until the end marker is queued the replay still
+ * owes the client everything after `rib_since`.
+ */
+static void fpm_rib_end(struct event *t)
+{
+	struct fpm_nl_ctx *fnc = EVENT_ARG(t);
+
+	if (fnc->rib_end && fpm_nl_enqueue_resync_end(fnc) == -1) {
+		event_add_timer(zrouter.master, fpm_rib_end, fnc, 1,
+				&fnc->t_ribwalk);
+		return;
+	}
+
+	fnc->rib_walk_pending = false;
+	WALK_FINISH(fnc, FNE_RIB_FINISHED);
+
+	/* Schedule next event: RMAC reset. */
+	event_add_event(zrouter.master, fpm_rmac_reset, fnc, 0,
+			&fnc->t_rmacreset);
+}
+
 /**
  * Send all RIB installed routes to the connected data plane.
+ *
+ * The walk yields every FPM_RIB_WALK_CHUNK nodes so a big RIB doesn't hold
+ * the main pthread, and resumes after the last destination it completed.
+ * Routes already sent are flagged, so tables changing in between only
+ * cost some extra node visits.
  */
 static void fpm_rib_send(struct event *t)
 {
@@ -1235,14 +1920,54 @@ static void fpm_rib_send(struct event *t)
 	struct route_node *rn;
 	struct route_table *rt;
 	struct zebra_dplane_ctx *ctx;
-	rib_tables_iter_t rt_iter;
+	struct fpm_tomb *tomb;
+	struct prefix cur;
+	bool have_cur = false;
+	uint32_t nodes = 0, routes = 0;
+
+	/* Send the resync marker and route deletes first. */
+	while ((tomb = fpm_tombs_first(&fnc->rib_replay))) {
+		if (fpm_nl_enqueue_raw(fnc, tomb) == -1) {
+			event_add_timer(zrouter.master, fpm_rib_send, fnc, 1,
+					&fnc->t_ribwalk);
+			return;
+		}
+
+		if (tomb->version)
+			atomic_fetch_add_explicit(&fnc->counters.resync_deletes,
+						  1, memory_order_relaxed);
+		fpm_tombs_del(&fnc->rib_replay, tomb);
+		XFREE(MTYPE_FPM_TOMB, tomb);
+	}
 
 	/* Allocate temporary context for all transactions. */
 	ctx = dplane_ctx_alloc();
 
-	rt_iter.state = RIB_TABLES_ITER_S_INIT;
-	while ((rt = rib_tables_iter_next(&rt_iter))) {
-		for (rn = route_top(rt); rn; rn = srcdest_route_next(rn)) {
+	for (rt = fpm_rib_walk_table(fnc); rt;
+	     rt = rib_tables_iter_next(&fnc->rib_iter)) {
+		if (fnc->rib_walk_resume)
+			rn = route_table_get_next(rt, &fnc->rib_walk_last);
+		else
+			rn = route_top(rt);
+
+		for (; rn; rn = srcdest_route_next(rn)) {
+			if (!rnode_is_srcnode(rn)) {
+				/* Previous destination is done. */
+				if (have_cur) {
+					prefix_copy(&fnc->rib_walk_last, &cur);
+					fnc->rib_walk_resume = true;
+				}
+
+				if (nodes >= FPM_RIB_WALK_CHUNK) {
+					route_unlock_node(rn);
+					goto yield;
+				}
+
+				prefix_copy(&cur, &rn->p);
+				have_cur = true;
+			}
+			nodes++;
+
 			dest = rib_dest_from_rnode(rn);
 			/* Skip bad route entries. */
 			if (dest == NULL || dest->selected_fib == NULL)
@@ -1252,14 +1977,25 @@ static void fpm_rib_send(struct event *t)
 			if (CHECK_FLAG(dest->flags, RIB_DEST_UPDATE_FPM))
 				continue;
 
+			/* Client already has this one. */
+			if (dest->version <= fnc->rib_since) {
+				SET_FLAG(dest->flags, RIB_DEST_UPDATE_FPM);
+				continue;
+			}
+
 			/* Enqueue route install. */
 			dplane_ctx_reset(ctx);
 			dplane_ctx_route_init(ctx, DPLANE_OP_ROUTE_INSTALL, rn,
 					      dest->selected_fib);
 			if (fpm_nl_enqueue(fnc, ctx) == -1) {
+				route_unlock_node(rn);
+
 				/* Free the temporary allocated context. */
 				dplane_ctx_fini(&ctx);
 
+				atomic_fetch_add_explicit(
+					&fnc->counters.rib_walk_routes, routes,
+					memory_order_relaxed);
 				event_add_timer(zrouter.master, fpm_rib_send,
 						fnc, 1, &fnc->t_ribwalk);
 				return;
@@ -1267,18 +2003,35 @@ static void fpm_rib_send(struct event *t)
 
 			/* Mark as sent. */
 			SET_FLAG(dest->flags, RIB_DEST_UPDATE_FPM);
+			routes++;
 		}
+
+		fnc->rib_walk_resume = false;
+		have_cur = false;
 	}
 
 	/* Free the temporary allocated context. */
 	dplane_ctx_fini(&ctx);
 
+	atomic_fetch_add_explicit(&fnc->counters.rib_walk_chunks, 1,
+				  memory_order_relaxed);
+	atomic_fetch_add_explicit(&fnc->counters.rib_walk_routes, routes,
+				  memory_order_relaxed);
+
 	/* All RIB routes sent! */
-	WALK_FINISH(fnc, FNE_RIB_FINISHED);
+	event_add_event(zrouter.master, fpm_rib_end, fnc, 0, &fnc->t_ribwalk);
+	return;
 
-	/* Schedule next event: RMAC reset. */
-	event_add_event(zrouter.master, fpm_rmac_reset, fnc, 0,
-			&fnc->t_rmacreset);
+yield:
+	/* Free the temporary allocated context. */
+	dplane_ctx_fini(&ctx);
+
+	atomic_fetch_add_explicit(&fnc->counters.rib_walk_chunks, 1,
+				  memory_order_relaxed);
+	atomic_fetch_add_explicit(&fnc->counters.rib_walk_routes, routes,
+				  memory_order_relaxed);
+
+	event_add_event(zrouter.master, fpm_rib_send, fnc, 0, &fnc->t_ribwalk);
 }
 
 /*
@@ -1401,6 +2154,18 @@ static void fpm_rib_reset(struct event *t)
 	struct route_table *rt;
 	rib_tables_iter_t rt_iter;
 
+	/* Give the client some time to tell which version it has. */
+	if (fnc->use_incremental_resync &&
+	    !atomic_load_explicit(&fnc->resync_requested,
+				  memory_order_relaxed) &&
+	    fnc->resync_wait++ < FPM_RESYNC_WAIT) {
+		event_add_timer(zrouter.master, fpm_rib_reset, fnc, 1,
+				&fnc->t_ribreset);
+		return;
+	}
+
+	fpm_resync_start(fnc);
+
 	rt_iter.state = RIB_TABLES_ITER_S_INIT;
 	while ((rt = rib_tables_iter_next(&rt_iter))) {
 		for (rn = route_top(rt); rn; rn = srcdest_route_next(rn)) {
@@ -1413,6 +2178,10 @@ static void fpm_rib_reset(struct event *t)
 		}
 	}
 
+	/* Start sending from the first table. */
+	fnc->rib_iter.state = RIB_TABLES_ITER_S_INIT;
+	fnc->rib_walk_resume = false;
+
 	/* Schedule next step: send RIB routes. */
 	event_add_event(zrouter.master, fpm_rib_send, fnc, 0, &fnc->t_ribwalk);
 }
@@ -1460,46 +2229,73 @@ static void fpm_process_wedged(struct event *t)
 static void fpm_process_queue(struct event *t)
 {
 	struct fpm_nl_ctx *fnc = EVENT_ARG(t);
+	struct dplane_ctx_list_head batch, done;
 	struct zebra_dplane_ctx *ctx;
 	bool no_bufs = false;
 	uint64_t processed_contexts = 0;
+	size_t writeable_amount, count;
 
-	while (true) {
-		size_t writeable_amount;
+	dplane_ctx_q_init(&batch);
+	dplane_ctx_q_init(&done);
 
+	while (true) {
 		frr_with_mutex (&fnc->obuf_mutex) {
-			writeable_amount = STREAM_WRITEABLE(fnc->obuf);
+			writeable_amount = FPM_OBUF_SIZE -
+					   MIN(fnc->obuf_len, FPM_OBUF_SIZE);
 		}
 
 		/* No space available yet. */
-		if (writeable_amount < NL_PKT_BUF_SIZE) {
+		if (writeable_amount < FPM_MSG_MAX) {
 			no_bufs = true;
 			break;
 		}
 
-		/* Dequeue next item or quit processing. */
+		/*
+		 * Dequeue at once as many items as the output buffer is
+		 * sure to have room for, or quit processing.
+		 */
+		count = MIN(writeable_amount / FPM_MSG_MAX, FPM_BATCH_MAX);
 		frr_with_mutex (&fnc->ctxqueue_mutex) {
-			ctx = dplane_ctx_dequeue(&fnc->ctxqueue);
+			while (count-- > 0) {
+				ctx = dplane_ctx_dequeue(&fnc->ctxqueue);
+				if (ctx == NULL)
+					break;
+
+				dplane_ctx_enqueue_tail(&batch, ctx);
+			}
 		}
-		if (ctx == NULL)
+		if (dplane_ctx_q_count(&batch) == 0)
 			break;
 
-		/*
-		 * Intentionally ignoring the return value
-		 * as that we are ensuring that we can write to
-		 * the output data in the STREAM_WRITEABLE
-		 * check above, so we can ignore the return
-		 */
-		if (fnc->socket != -1)
-			(void)fpm_nl_enqueue(fnc, ctx);
+		/* Encode the batch without holding the output buffer lock. */
+		while ((ctx = dplane_ctx_dequeue(&batch))) {
+			if (fnc->socket != -1) {
+				if (FPM_OBUF_SEG_SIZE - fnc->batch->len <
+				    FPM_MSG_MAX)
+					fpm_obuf_push_batch(fnc);
 
-		/* Account the processed entries. */
-		processed_contexts++;
-		atomic_fetch_sub_explicit(&fnc->counters.ctxqueue_len, 1,
-					  memory_order_relaxed);
+				fpm_nl_encode(fnc, ctx, fnc->batch);
+			} else
+				fpm_resync_dropped(fnc, ctx);
 
-		dplane_ctx_set_status(ctx, ZEBRA_DPLANE_REQUEST_SUCCESS);
-		dplane_provider_enqueue_out_ctx(fnc->prov, ctx);
+			/* Account the processed entries. */
+			processed_contexts++;
+			atomic_fetch_sub_explicit(&fnc->counters.ctxqueue_len,
+						  1, memory_order_relaxed);
+
+			dplane_ctx_set_status(ctx,
+					      ZEBRA_DPLANE_REQUEST_SUCCESS);
+			dplane_ctx_enqueue_tail(&done, ctx);
+		}
+
+		/*
+		 * Only hand the contexts back once their messages are in obuf:
+		 * the resync end marker takes those no longer in the data
+		 * plane as queued.
+		 */
+		fpm_obuf_push_batch(fnc);
+		while ((ctx = dplane_ctx_dequeue(&done)))
+			dplane_provider_enqueue_out_ctx(fnc->prov, ctx);
 	}
 
 	/* Update count of processed contexts */
@@ -1560,6 +2356,8 @@ static void fpm_process_event(struct event *t)
 	case FNE_TOGGLE_NHG:
 		zlog_info("%s: toggle next hop groups support", __func__);
 		fnc->use_nhg = !fnc->use_nhg;
+		/* Routes are encoded differently now, resend them all. */
+		fpm_resync_lost(fnc, 1);
 		fpm_reconnect(fnc);
 		break;
 
@@ -1598,8 +2396,13 @@ static int fpm_nl_start(struct zebra_dplane_provider *prov)
 	fnc->fthread = frr_pthread_new(NULL, prov_name, prov_name);
 	assert(frr_pthread_run(fnc->fthread, NULL) == 0);
 	fnc->ibuf = stream_new(NL_PKT_BUF_SIZE);
-	fnc->obuf = stream_new(NL_PKT_BUF_SIZE * 128);
+	fpm_obuf_segs_init(&fnc->obuf);
+	fnc->batch = fpm_obuf_seg_new(fnc);
 	pthread_mutex_init(&fnc->obuf_mutex, NULL);
+	fpm_tombs_init(&fnc->tombs);
+	fpm_tombs_init(&fnc->rib_replay);
+	fnc->resync_lost = UINT64_MAX;
+	pthread_mutex_init(&fnc->resync_mutex, NULL);
 	fnc->socket = -1;
 	fnc->disabled = true;
 	fnc->prov = prov;
@@ -1647,7 +2450,15 @@ static int fpm_nl_finish_late(struct fpm_nl_ctx *fnc)
 	pthread_mutex_destroy(&fnc->obuf_mutex);
 	pthread_mutex_destroy(&fnc->ctxqueue_mutex);
 	stream_free(fnc->ibuf);
-	stream_free(fnc->obuf);
+	fpm_obuf_reset(fnc);
+	fpm_obuf_segs_fini(&fnc->obuf);
+	XFREE(MTYPE_FPM_OBUF, fnc->obuf_spare);
+	XFREE(MTYPE_FPM_OBUF, fnc->batch);
+	fpm_tombs_free(&fnc->tombs);
+	fpm_tombs_fini(&fnc->tombs);
+	fpm_tombs_free(&fnc->rib_replay);
+	fpm_tombs_fini(&fnc->rib_replay);
+	pthread_mutex_destroy(&fnc->resync_mutex);
 	free(gfnc);
 	gfnc = NULL;
 
@@ -1679,6 +2490,10 @@ static int fpm_nl_process(struct zebra_dplane_provider *prov)
 		if (ctx == NULL)
 			break;
 
+		if (fnc->use_incremental_resync &&
+		    dplane_ctx_get_op(ctx) == DPLANE_OP_ROUTE_DELETE)
+			fpm_tomb_add(fnc, ctx);
+
 		/*
 		 * Skip all notifications if not connected, we'll walk the RIB
 		 * anyway.
@@ -1703,6 +2518,7 @@ static int fpm_nl_process(struct zebra_dplane_provider *prov)
 			continue;
 		}
 
+		fpm_resync_dropped(fnc, ctx);
 		dplane_ctx_set_status(ctx, ZEBRA_DPLANE_REQUEST_SUCCESS);
 		dplane_provider_enqueue_out_ctx(prov, ctx);
 	}
@@ -1752,6 +2568,8 @@ static int fpm_nl_new(struct event_loop *tm)
 	install_element(CONFIG_NODE, &no_fpm_use_nhg_cmd);
 	install_element(CONFIG_NODE, &fpm_use_route_replace_cmd);
 	install_element(CONFIG_NODE, &no_fpm_use_route_replace_cmd);
+	install_element(CONFIG_NODE, &fpm_use_incremental_resync_cmd);
+	install_element(CONFIG_NODE, &no_fpm_use_incremental_resync_cmd);
 
 	return 0;
 }
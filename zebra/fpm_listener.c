@@ -36,6 +36,7 @@
 #include "rt_netlink.h"
 #include "fpm/fpm.h"
 #include "lib/libfrr.h"
+#include "lib/table.h"
 
 XREF_SETUP();
 
@@ -44,6 +45,15 @@ struct glob {
 	int sock;
 	bool reflect;
 	bool dump_hex;
+
+	/*
+	 * Incremental resync: the version of the last replay end marker and
+	 * the routes received, kept across connections.
+	 */
+	bool resync;
+	uint64_t resync_version;
+	struct route_table *routes[AFI_MAX];
+	unsigned long route_count;
 };
 
 struct glob glob_space;
@@ -676,6 +686,137 @@ static void fpm_listener_hexdump(const void *mem, size_t len)
 	}
 }
 
+/*
+ * netlink_msg_version
+ *
+ * RIB version zebra stamps in the sequence number and port id.
+ */
+static uint64_t netlink_msg_version(struct nlmsghdr *hdr)
+{
+	return ((uint64_t)hdr->nlmsg_pid << 32) | hdr->nlmsg_seq;
+}
+
+/*
+ * send_resync_request
+ *
+ * Asks zebra to only send the changes after the version we have.
+ */
+static void send_resync_request(void)
+{
+	struct {
+		fpm_msg_hdr_t fpm;
+		struct nlmsghdr hdr;
+		struct rtmsg rtm;
+	} __attribute__((packed)) req;
+
+	memset(&req, 0, sizeof(req));
+	req.fpm.version = FPM_PROTO_VERSION;
+	req.fpm.msg_type = FPM_MSG_TYPE_NETLINK;
+	req.fpm.msg_len = htons(sizeof(req));
+	req.hdr.nlmsg_len = NLMSG_LENGTH(sizeof(req.rtm));
+	req.hdr.nlmsg_type = RTM_GETROUTE;
+	req.hdr.nlmsg_flags = NLM_F_REQUEST;
+	req.hdr.nlmsg_seq = (uint32_t)glob->resync_version;
+	req.hdr.nlmsg_pid = (uint32_t)(glob->resync_version >> 32);
+
+	fprintf(stdout, "Requesting resync from version %" PRIu64 "\n",
+		glob->resync_version);
+	if (write(glob->sock, &req, sizeof(req)) != sizeof(req))
+		fprintf(stderr, "Failed to send resync request: %s\n",
+			strerror(errno));
+}
+
+/*
+ * routes_clear
+ */
+static void routes_clear(void)
+{
+	afi_t afi;
+
+	for (afi = AFI_IP; afi < AFI_MAX; afi++) {
+		if (glob->routes[afi])
+			route_table_finish(glob->routes[afi]);
+		glob->routes[afi] = route_table_init();
+	}
+	glob->route_count = 0;
+}
+
+/*
+ * routes_update
+ *
+ * Keeps track of the routes zebra has, to tell whether a resync lost any.
+ */
+static void routes_update(struct netlink_msg_ctx *ctx)
+{
+	struct rtmsg *rtmsg = ctx->rtmsg;
+	struct route_node *rn;
+	struct prefix p = {};
+	afi_t afi;
+
+	afi = family2afi(rtmsg->rtm_family);
+	if (afi != AFI_IP && afi != AFI_IP6)
+		return;
+
+	p.family = rtmsg->rtm_family;
+	p.prefixlen = rtmsg->rtm_dst_len;
+	if (ctx->dest)
+		memcpy(&p.u.prefix, RTA_DATA(ctx->dest),
+		       MIN(RTA_PAYLOAD(ctx->dest), sizeof(p.u.prefix)));
+	apply_mask(&p);
+
+	if (ctx->hdr->nlmsg_type == RTM_NEWROUTE) {
+		rn = route_node_get(glob->routes[afi], &p);
+		if (rn->info)
+			route_unlock_node(rn);
+		else {
+			rn->info = glob;
+			glob->route_count++;
+		}
+	} else {
+		rn = route_node_lookup(glob->routes[afi], &p);
+		if (rn) {
+			rn->info = NULL;
+			glob->route_count--;
+			route_unlock_node(rn);
+			route_unlock_node(rn);
+		}
+	}
+
+	printf("  Route table: %lu routes\n", glob->route_count);
+	fflush(stdout);
+}
+
+/*
+ * process_resync_marker
+ */
+static void process_resync_marker(struct nlmsghdr *hdr)
+{
+	uint64_t version = netlink_msg_version(hdr);
+	int mark;
+
+	if (hdr->nlmsg_len < NLMSG_LENGTH(sizeof(mark)))
+		return;
+	memcpy(&mark, NLMSG_DATA(hdr), sizeof(mark));
+
+	switch (mark) {
+	case FPM_RESYNC_START:
+		printf("Resync start from version %" PRIu64 "\n", version);
+
+		/* Everything is sent again. */
+		if (version == 0)
+			routes_clear();
+		break;
+	case FPM_RESYNC_END:
+		/* The only version it is safe to resume from. */
+		glob->resync_version = version;
+		printf("Resync end at version %" PRIu64
+		       ", Route table: %lu routes\n",
+		       version, glob->route_count);
+		break;
+	}
+	fflush(stdout);
+}
+
 /*
  * parse_netlink_msg
  */
@@ -709,6 +850,9 @@ static void parse_netlink_msg(char *buf, size_t buf_len, fpm_msg_hdr_t *fpm)
 
 			print_netlink_msg_ctx(ctx);
 
+			if (glob->resync && !ctx->err_msg)
+				routes_update(ctx);
+
 			if (glob->reflect && hdr->nlmsg_type == RTM_NEWROUTE &&
 			    ctx->rtmsg->rtm_protocol > RTPROT_STATIC) {
 				printf("  Route %s(%u) reflecting back\n",
@@ -720,6 +864,12 @@ static void parse_netlink_msg(char *buf, size_t buf_len, fpm_msg_hdr_t *fpm)
 			}
 			break;
 
+		case NLMSG_DONE:
+			if (glob->resync) {
+				process_resync_marker(hdr);
+				break;
+			}
+			fallthrough;
 		default:
 			fprintf(stdout,
 				"Ignoring netlink message - Type: %s(%d)\n",
@@ -771,7 +921,7 @@ int main(int argc, char **argv)
 
 	memset(glob, 0, sizeof(*glob));
 
-	while ((r = getopt(argc, argv, "rdv")) != -1) {
+	while ((r = getopt(argc, argv, "rdvs")) != -1) {
 		switch (r) {
 		case 'r':
 			glob->reflect = true;
@@ -782,6 +932,9 @@ int main(int argc, char **argv)
 		case 'v':
 			glob->dump_hex = true;
 			break;
+		case 's':
+			glob->resync = true;
+			break;
 		}
 	}
 
@@ -795,11 +948,16 @@ int main(int argc, char **argv)
 	if (!create_listen_sock(FPM_DEFAULT_PORT, &glob->server_sock))
 		exit(1);
 
+	if (glob->resync)
+		routes_clear();
+
 	/*
 	 * Server forever.
 	 */
 	while (1) {
 		glob->sock = accept_conn(glob->server_sock);
+		if (glob->resync)
+			send_resync_request();
 		fpm_serve();
 		fprintf(stdout, "Done serving client");
 	}
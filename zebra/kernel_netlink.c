@@ -26,6 +26,8 @@
 #include "mpls.h"
 #include "lib_errors.h"
 #include "hash.h"
+#include "jhash.h"
+#include "frr_pthread.h"
 
 #include "zebra/zebra_router.h"
 #include "zebra/zebra_ns.h"
@@ -81,6 +83,22 @@
  */
 #define NL_DEFAULT_BATCH_SEND_THRESHOLD (15 * NL_PKT_BUF_SIZE)
 
+/*
+ * Number of messages that may have been sent on the dataplane socket
+ * before their responses are read.  Whatever is configured, this is
+ * capped so that an error response for every one of them still fits the
+ * socket's receive buffer, taking NL_ERR_TRUESIZE of it each.
+ */
+#define NL_DEFAULT_BATCH_INFLIGHT 2048
+#define NL_ERR_TRUESIZE 1024
+
+/* Route updates are sent from this many pthreads, see struct nl_shard */
+#define NL_DEFAULT_ROUTE_SHARDS 1
+#define NL_SHARDS_MAX 16
+
+/* Sockets whose own messages are filtered out of the listening sockets */
+#define NL_FILTER_PIDS_MAX (2 + NL_SHARDS_MAX)
+
 static const struct message nlmsg_str[] = {
 	{ RTM_NEWROUTE, "RTM_NEWROUTE" },
 	{ RTM_DELROUTE, "RTM_DELROUTE" },
@@ -183,11 +201,68 @@ pthread_mutex_t nlsock_mutex;
 #define NLSOCK_LOCK() pthread_mutex_lock(&nlsock_mutex)
 #define NLSOCK_UNLOCK() pthread_mutex_unlock(&nlsock_mutex)
 
-size_t nl_batch_tx_bufsize;
-char *nl_batch_tx_buf;
-
 _Atomic uint32_t nl_batch_bufsize = NL_DEFAULT_BATCH_BUFSIZE;
 _Atomic uint32_t nl_batch_send_threshold = NL_DEFAULT_BATCH_SEND_THRESHOLD;
+_Atomic uint32_t nl_batch_inflight = NL_DEFAULT_BATCH_INFLIGHT;
+_Atomic uint32_t nl_route_shards = NL_DEFAULT_ROUTE_SHARDS;
+
+/*
+ * A sender of batched dataplane updates.
+ *
+ * Shard 0 is the dplane pthread itself, writing to each namespace's
+ * dataplane socket.  When "route-shards" is configured above 1, route
+ * updates in the default namespace are spread over the other shards as
+ * well, each running its own pthread with its own netlink socket.  The
+ * shard is picked by table, so every update for a given prefix goes out
+ * on the same socket, in the order the dplane queued it.  Everything
+ * else stays on shard 0, and waits until the other shards are idle so
+ * that it is ordered against the routes around it.
+ */
+struct nl_shard {
+	unsigned int idx;
+
+	/* Transmit buffer */
+	char *tx_buf;
+	size_t tx_bufsize;
+
+	/*
+	 * Batches sent whose responses have not been read yet.  The kernel
+	 * handles a whole batch inside sendmsg(), and none of the batched
+	 * messages ask for NLM_F_ACK, so all the socket will ever hold for
+	 * them are errors for the ones that failed.  Rather than reading
+	 * after every batch, the shard keeps sending and collects those once
+	 * enough messages are in flight, when it switches to another
+	 * namespace's socket, or when it runs out of work.  The contexts stay
+	 * in the order they were sent.
+	 */
+	struct dplane_ctx_list_head inflight_list;
+	const struct zebra_dplane_info *inflight_zns;
+	size_t inflight_msgcnt;
+
+	/* The rest is only used by the shards with their own pthread */
+	struct frr_pthread *pthread;
+	struct nlsock nls;
+	struct event *t_work;
+
+	pthread_mutex_t mutex;
+	struct dplane_ctx_list_head in_list;
+	struct dplane_ctx_list_head out_list;
+
+	/* Contexts handed over and not collected yet; dplane pthread only */
+	uint32_t outstanding;
+};
+
+static struct nl_shard nl_shards[NL_SHARDS_MAX];
+
+/* Shards in use and shards started; dplane pthread only */
+static unsigned int nl_shards_active = 1;
+static unsigned int nl_shards_started = 1;
+
+/* Contexts not handed to any shard yet; dplane pthread only */
+static struct dplane_ctx_list_head nl_shards_pending;
+
+/* Namespace the route shards' sockets live in */
+static struct zebra_ns *nl_shards_zns;
 
 struct nl_batch {
 	void *buf;
@@ -200,6 +275,8 @@ struct nl_batch {
 
 	const struct zebra_dplane_info *zns;
 
+	struct nl_shard *shard;
+
 	struct dplane_ctx_list_head ctx_list;
 
 	/*
@@ -215,12 +292,23 @@ int netlink_config_write_helper(struct vty *vty)
 		atomic_load_explicit(&nl_batch_bufsize, memory_order_relaxed);
 	uint32_t threshold = atomic_load_explicit(&nl_batch_send_threshold,
 						  memory_order_relaxed);
+	uint32_t inflight = atomic_load_explicit(&nl_batch_inflight,
+						 memory_order_relaxed);
+	uint32_t shards = atomic_load_explicit(&nl_route_shards,
+					       memory_order_relaxed);
 
 	if (size != NL_DEFAULT_BATCH_BUFSIZE
 	    || threshold != NL_DEFAULT_BATCH_SEND_THRESHOLD)
 		vty_out(vty, "zebra kernel netlink batch-tx-buf %u %u\n", size,
 			threshold);
 
+	if (inflight != NL_DEFAULT_BATCH_INFLIGHT)
+		vty_out(vty, "zebra kernel netlink batch-inflight %u\n",
+			inflight);
+
+	if (shards != NL_DEFAULT_ROUTE_SHARDS)
+		vty_out(vty, "zebra kernel netlink route-shards %u\n", shards);
+
 	if (if_netlink_frr_protodown_r_bit_is_set())
 		vty_out(vty, "zebra protodown reason-bit %u\n",
 			if_netlink_get_frr_protodown_r_bit());
@@ -240,6 +328,23 @@ void netlink_set_batch_buffer_size(uint32_t size, uint32_t threshold, bool set)
 			      memory_order_relaxed);
 }
 
+void netlink_set_batch_inflight(uint32_t inflight, bool set)
+{
+	if (!set)
+		inflight = NL_DEFAULT_BATCH_INFLIGHT;
+
+	atomic_store_explicit(&nl_batch_inflight, inflight,
+			      memory_order_relaxed);
+}
+
+void netlink_set_route_shards(uint32_t shards, bool set)
+{
+	if (!set)
+		shards = NL_DEFAULT_ROUTE_SHARDS;
+
+	atomic_store_explicit(&nl_route_shards, shards, memory_order_relaxed);
+}
+
 int netlink_talk_filter(struct nlmsghdr *h, ns_id_t ns_id, int startup)
 {
 	/*
@@ -540,77 +645,68 @@ int kernel_dplane_read(struct zebra_dplane_info *info)
  * so that we only have to write one way to handle incoming
  * address add/delete and xxxNETCONF changes.
  */
-static void netlink_install_filter(int sock, uint32_t pid, uint32_t dplane_pid)
+static void netlink_install_filter(int sock, const uint32_t *pids,
+				   unsigned int npids)
 {
 	/*
 	 * BPF_JUMP instructions and where you jump to are based upon
 	 * 0 as being the next statement.  So count from 0.  Writing
 	 * this down because every time I look at this I have to
 	 * re-remember it.
+	 *
+	 * Logic:
+	 *   if (nlmsg_pid == any of pids) {
+	 *       if (the incoming nlmsg_type ==
+	 *           RTM_NEWADDR || RTM_DELADDR || RTM_NEWNETCONF ||
+	 *           RTM_DELNETCONF)
+	 *           keep this message
+	 *       else
+	 *           skip this message
+	 *   } else
+	 *       keep this netlink message
 	 */
-	struct sock_filter filter[] = {
-		/*
-		 * Logic:
-		 *   if (nlmsg_pid == pid ||
-		 *       nlmsg_pid == dplane_pid) {
-		 *       if (the incoming nlmsg_type ==
-		 *           RTM_NEWADDR || RTM_DELADDR || RTM_NEWNETCONF ||
-		 *           RTM_DELNETCONF)
-		 *           keep this message
-		 *       else
-		 *           skip this message
-		 *   } else
-		 *       keep this netlink message
-		 */
-		/*
-		 * 0: Load the nlmsg_pid into the BPF register
-		 */
-		BPF_STMT(BPF_LD | BPF_ABS | BPF_W,
-			 offsetof(struct nlmsghdr, nlmsg_pid)),
-		/*
-		 * 1: Compare to pid
-		 */
-		BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, htonl(pid), 1, 0),
-		/*
-		 * 2: Compare to dplane pid
-		 */
-		BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, htonl(dplane_pid), 0, 6),
-		/*
-		 * 3: Load the nlmsg_type into BPF register
-		 */
-		BPF_STMT(BPF_LD | BPF_ABS | BPF_H,
-			 offsetof(struct nlmsghdr, nlmsg_type)),
-		/*
-		 * 4: Compare to RTM_NEWADDR
-		 */
-		BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, htons(RTM_NEWADDR), 4, 0),
-		/*
-		 * 5: Compare to RTM_DELADDR
-		 */
-		BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, htons(RTM_DELADDR), 3, 0),
-		/*
-		 * 6: Compare to RTM_NEWNETCONF
-		 */
-		BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, htons(RTM_NEWNETCONF), 2,
-			 0),
-		/*
-		 * 7: Compare to RTM_DELNETCONF
-		 */
-		BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, htons(RTM_DELNETCONF), 1,
-			 0),
-		/*
-		 * 8: This is the end state of we want to skip the
-		 *    message
-		 */
-		BPF_STMT(BPF_RET | BPF_K, 0),
-		/* 9: This is the end state of we want to keep
-		 *     the message
-		 */
-		BPF_STMT(BPF_RET | BPF_K, 0xffff),
-	};
+	struct sock_filter filter[1 + NL_FILTER_PIDS_MAX + 7];
+	unsigned int i, n = 0;
+
+	assert(npids > 0 && npids <= NL_FILTER_PIDS_MAX);
+
+	/* 0: Load the nlmsg_pid into the BPF register */
+	filter[n++] = (struct sock_filter)BPF_STMT(
+		BPF_LD | BPF_ABS | BPF_W, offsetof(struct nlmsghdr, nlmsg_pid));
+
+	/*
+	 * 1 .. npids: Compare to each pid, on a match go on to the type
+	 * check right after the last one.  If the last one doesn't match
+	 * either, jump to the keep state, 6 statements past the type load.
+	 */
+	for (i = 0; i < npids; i++, n++)
+		filter[n] = (struct sock_filter)BPF_JUMP(
+			BPF_JMP | BPF_JEQ | BPF_K, htonl(pids[i]),
+			npids - 1 - i, i == npids - 1 ? 6 : 0);
+
+	/* Load the nlmsg_type into BPF register */
+	filter[n++] = (struct sock_filter)BPF_STMT(
+		BPF_LD | BPF_ABS | BPF_H,
+		offsetof(struct nlmsghdr, nlmsg_type));
+	/* Compare to RTM_NEWADDR */
+	filter[n++] = (struct sock_filter)BPF_JUMP(
+		BPF_JMP | BPF_JEQ | BPF_K, htons(RTM_NEWADDR), 4, 0);
+	/* Compare to RTM_DELADDR */
+	filter[n++] = (struct sock_filter)BPF_JUMP(
+		BPF_JMP | BPF_JEQ | BPF_K, htons(RTM_DELADDR), 3, 0);
+	/* Compare to RTM_NEWNETCONF */
+	filter[n++] = (struct sock_filter)BPF_JUMP(
+		BPF_JMP | BPF_JEQ | BPF_K, htons(RTM_NEWNETCONF), 2, 0);
+	/* Compare to RTM_DELNETCONF */
+	filter[n++] = (struct sock_filter)BPF_JUMP(
+		BPF_JMP | BPF_JEQ | BPF_K, htons(RTM_DELNETCONF), 1, 0);
+	/* This is the end state of we want to skip the message */
+	filter[n++] = (struct sock_filter)BPF_STMT(BPF_RET | BPF_K, 0);
+	/* This is the end state of we want to keep the message */
+	filter[n++] = (struct sock_filter)BPF_STMT(BPF_RET | BPF_K, 0xffff);
 
 	struct sock_fprog prog = {
-		.len = array_size(filter), .filter = filter,
+		.len = n, .filter = filter,
 	};
 
 	if (setsockopt(sock, SOL_SOCKET, SO_ATTACH_FILTER, &prog, sizeof(prog))
@@ -619,6 +715,27 @@ static void netlink_install_filter(int sock, uint32_t pid, uint32_t dplane_pid)
 			     safe_strerror(errno));
 }
 
+/*
+ * Set filter for inbound sockets, to exclude events we've generated
+ * ourselves: on the command socket, the dataplane socket, and the route
+ * shards' sockets.
+ */
+static void netlink_install_filters(struct zebra_ns *zns)
+{
+	uint32_t pids[NL_FILTER_PIDS_MAX];
+	unsigned int i, npids = 0;
+
+	pids[npids++] = zns->netlink_cmd.snl.nl_pid;
+	pids[npids++] = zns->netlink_dplane_out.snl.nl_pid;
+
+	if (zns == nl_shards_zns)
+		for (i = 1; i < nl_shards_started; i++)
+			pids[npids++] = nl_shards[i].nls.snl.nl_pid;
+
+	netlink_install_filter(zns->netlink.sock, pids, npids);
+	netlink_install_filter(zns->netlink_dplane_in.sock, pids, npids);
+}
+
 /*
  * Please note, the assumption with this function is that the
  * flags passed in that are bit masked with type, we are implicitly
@@ -1296,7 +1413,8 @@ int netlink_request(struct nlsock *nl, void *req)
 	return 0;
 }
 
-static int nl_batch_read_resp(struct nl_batch *bth, struct nlsock *nl)
+static int nl_inflight_read_resp(struct nl_shard *shard, struct nlsock *nl,
+				 struct dplane_ctx_list_head *ctx_out_q)
 {
 	struct nlmsghdr *h;
 	struct sockaddr_nl snl;
@@ -1323,13 +1441,13 @@ static int nl_batch_read_resp(struct nl_batch *bth, struct nlsock *nl)
 		 *
 		 */
 		if (status == -1 || status == 0) {
-			while ((ctx = dplane_ctx_dequeue(&(bth->ctx_list))) !=
-			       NULL) {
+			while ((ctx = dplane_ctx_dequeue(
+					&(shard->inflight_list))) != NULL) {
 				if (status == -1)
 					dplane_ctx_set_status(
 						ctx,
 						ZEBRA_DPLANE_REQUEST_FAILURE);
-				dplane_ctx_enqueue_tail(bth->ctx_out_q, ctx);
+				dplane_ctx_enqueue_tail(ctx_out_q, ctx);
 			}
 			return status;
 		}
@@ -1344,7 +1462,7 @@ static int nl_batch_read_resp(struct nl_batch *bth, struct nlsock *nl)
 		 * requests at same time.
 		 */
 		while (true) {
-			ctx = dplane_ctx_get_head(&(bth->ctx_list));
+			ctx = dplane_ctx_get_head(&(shard->inflight_list));
 			if (ctx == NULL) {
 				/*
 				 * This is a situation where we have gotten
@@ -1371,8 +1489,8 @@ static int nl_batch_read_resp(struct nl_batch *bth, struct nlsock *nl)
 				break;
 			}
 
-			ctx = dplane_ctx_dequeue(&(bth->ctx_list));
-			dplane_ctx_enqueue_tail(bth->ctx_out_q, ctx);
+			ctx = dplane_ctx_dequeue(&(shard->inflight_list));
+			dplane_ctx_enqueue_tail(ctx_out_q, ctx);
 
 			/* We have found corresponding context object. */
 			if (dplane_ctx_get_ns(ctx)->seq == seq)
@@ -1392,8 +1510,8 @@ static int nl_batch_read_resp(struct nl_batch *bth, struct nlsock *nl)
 			 * message for our operator to understand
 			 * what is going on
 			 */
-			int err = netlink_parse_error(nl, h, bth->zns->is_cmd,
-						      false);
+			int err = netlink_parse_error(
+				nl, h, shard->inflight_zns->is_cmd, false);
 
 			zlog_debug("%s: netlink error message seq=%d %d",
 				   __func__, h->nlmsg_seq, err);
@@ -1409,13 +1527,13 @@ static int nl_batch_read_resp(struct nl_batch *bth, struct nlsock *nl)
 				zlog_debug(
 					"%s: skipping unassociated response, seq number %d NS %u",
 					__func__, h->nlmsg_seq,
-					bth->zns->ns_id);
+					shard->inflight_zns->ns_id);
 			continue;
 		}
 
 		if (h->nlmsg_type == NLMSG_ERROR) {
-			int err = netlink_parse_error(nl, h, bth->zns->is_cmd,
-						      false);
+			int err = netlink_parse_error(
+				nl, h, shard->inflight_zns->is_cmd, false);
 
 			if (err == -1)
 				dplane_ctx_set_status(
@@ -1436,7 +1554,7 @@ static int nl_batch_read_resp(struct nl_batch *bth, struct nlsock *nl)
 			zlog_debug("%s: ignoring message type 0x%04x(%s) NS %u",
 				   __func__, h->nlmsg_type,
 				   nl_msg_type_to_str(h->nlmsg_type),
-				   bth->zns->ns_id);
+				   shard->inflight_zns->ns_id);
 	}
 
 	return 0;
@@ -1452,7 +1570,7 @@ static void nl_batch_reset(struct nl_batch *bth)
 	dplane_ctx_q_init(&(bth->ctx_list));
 }
 
-static void nl_batch_init(struct nl_batch *bth,
+static void nl_batch_init(struct nl_batch *bth, struct nl_shard *shard,
 			  struct dplane_ctx_list_head *ctx_out_q)
 {
 	/*
@@ -1461,32 +1579,86 @@ static void nl_batch_init(struct nl_batch *bth,
 	 */
 	size_t bufsize =
 		atomic_load_explicit(&nl_batch_bufsize, memory_order_relaxed);
-	if (bufsize != nl_batch_tx_bufsize) {
-		if (nl_batch_tx_buf)
-			XFREE(MTYPE_NL_BUF, nl_batch_tx_buf);
+	if (bufsize != shard->tx_bufsize) {
+		if (shard->tx_buf)
+			XFREE(MTYPE_NL_BUF, shard->tx_buf);
 
-		nl_batch_tx_buf = XCALLOC(MTYPE_NL_BUF, bufsize);
-		nl_batch_tx_bufsize = bufsize;
+		shard->tx_buf = XCALLOC(MTYPE_NL_BUF, bufsize);
+		shard->tx_bufsize = bufsize;
 	}
 
-	bth->buf = nl_batch_tx_buf;
+	bth->buf = shard->tx_buf;
 	bth->bufsiz = bufsize;
 	bth->limit = atomic_load_explicit(&nl_batch_send_threshold,
 					  memory_order_relaxed);
 
+	bth->shard = shard;
 	bth->ctx_out_q = ctx_out_q;
 
 	nl_batch_reset(bth);
 }
 
+/*
+ * Socket a shard uses to reach a namespace.  The route shards only ever
+ * get contexts for their own namespace.
+ */
+static struct nlsock *nl_shard_nlsock(struct nl_shard *shard,
+				      const struct zebra_dplane_info *zns)
+{
+	if (shard->pthread)
+		return &shard->nls;
+
+	return kernel_netlink_nlsock_lookup(zns->sock);
+}
+
+/*
+ * Read the responses to everything the shard has in flight and move all
+ * of it to ctx_out_q.
+ */
+static void nl_inflight_drain(struct nl_shard *shard,
+			      struct dplane_ctx_list_head *ctx_out_q)
+{
+	struct zebra_dplane_ctx *ctx;
+
+	if (shard->inflight_zns != NULL) {
+		struct nlsock *nl = nl_shard_nlsock(shard, shard->inflight_zns);
+
+		if (IS_ZEBRA_DEBUG_KERNEL)
+			zlog_debug("%s: %s, msg cnt=%zu", __func__, nl->name,
+				   shard->inflight_msgcnt);
+
+		nl_inflight_read_resp(shard, nl, ctx_out_q);
+	}
+
+	/* Contexts that did not need a message */
+	while ((ctx = dplane_ctx_dequeue(&(shard->inflight_list))) != NULL)
+		dplane_ctx_enqueue_tail(ctx_out_q, ctx);
+
+	shard->inflight_zns = NULL;
+	shard->inflight_msgcnt = 0;
+}
+
+static size_t nl_inflight_limit(void)
+{
+	size_t limit = atomic_load_explicit(&nl_batch_inflight,
+					    memory_order_relaxed);
+
+	return MIN(limit, rcvbufsize / (2 * NL_ERR_TRUESIZE));
+}
+
 static void nl_batch_send(struct nl_batch *bth)
 {
+	struct nl_shard *shard = bth->shard;
 	struct zebra_dplane_ctx *ctx;
 	bool err = false;
 
 	if (bth->curlen != 0 && bth->zns != NULL) {
-		struct nlsock *nl =
-			kernel_netlink_nlsock_lookup(bth->zns->sock);
+		struct nlsock *nl = nl_shard_nlsock(shard, bth->zns);
+
+		/* Responses are matched to contexts one socket at a time */
+		if (shard->inflight_zns != NULL &&
+		    shard->inflight_zns->sock != bth->zns->sock)
+			nl_inflight_drain(shard, bth->ctx_out_q);
 
 		if (IS_ZEBRA_DEBUG_KERNEL)
 			zlog_debug("%s: %s, batch size=%zu, msg cnt=%zu",
@@ -1495,24 +1667,27 @@ static void nl_batch_send(struct nl_batch *bth)
 
 		if (netlink_send_msg(nl, bth->buf, bth->curlen) == -1)
 			err = true;
-
-		if (!err) {
-			if (nl_batch_read_resp(bth, nl) == -1)
-				err = true;
-		}
 	}
 
-	/* Move remaining contexts to the outbound queue. */
-	while (true) {
-		ctx = dplane_ctx_dequeue(&(bth->ctx_list));
-		if (ctx == NULL)
-			break;
+	if (err) {
+		/* Whatever was sent before this batch still goes out first */
+		nl_inflight_drain(shard, bth->ctx_out_q);
 
-		if (err)
+		while ((ctx = dplane_ctx_dequeue(&(bth->ctx_list))) != NULL) {
 			dplane_ctx_set_status(ctx,
 					      ZEBRA_DPLANE_REQUEST_FAILURE);
+			dplane_ctx_enqueue_tail(bth->ctx_out_q, ctx);
+		}
+	} else {
+		if (bth->curlen != 0 && bth->zns != NULL) {
+			shard->inflight_zns = bth->zns;
+			shard->inflight_msgcnt += bth->msgcnt;
+		}
+		dplane_ctx_list_append(&(shard->inflight_list),
+				       &(bth->ctx_list));
 
-		dplane_ctx_enqueue_tail(bth->ctx_out_q, ctx);
+		if (shard->inflight_msgcnt >= nl_inflight_limit())
+			nl_inflight_drain(shard, bth->ctx_out_q);
 	}
 
 	nl_batch_reset(bth);
@@ -1554,7 +1729,7 @@ enum netlink_msg_status netlink_batch_add_msg(
 	}
 
 	seq = dplane_ctx_get_ns(ctx)->seq;
-	nl = kernel_netlink_nlsock_lookup(dplane_ctx_get_ns_sock(ctx));
+	nl = nl_shard_nlsock(bth->shard, dplane_ctx_get_ns(ctx));
 
 	if (ignore_res)
 		seq++;
@@ -1673,15 +1848,16 @@ static enum netlink_msg_status nl_put_msg(struct nl_batch *bth,
 	return FRR_NETLINK_ERROR;
 }
 
-void kernel_update_multi(struct dplane_ctx_list_head *ctx_list)
+/* Send the contexts in ctx_list from a shard, in order */
+static void nl_shard_update(struct nl_shard *shard,
+			    struct dplane_ctx_list_head *ctx_list,
+			    struct dplane_ctx_list_head *ctx_out_q)
 {
 	struct nl_batch batch;
 	struct zebra_dplane_ctx *ctx;
-	struct dplane_ctx_list_head handled_list;
 	enum netlink_msg_status res;
 
-	dplane_ctx_q_init(&handled_list);
-	nl_batch_init(&batch, &handled_list);
+	nl_batch_init(&batch, shard, ctx_out_q);
 
 	while (true) {
 		ctx = dplane_ctx_dequeue(ctx_list);
@@ -1710,9 +1886,6 @@ void kernel_update_multi(struct dplane_ctx_list_head *ctx_list)
 	}
 
 	nl_batch_send(&batch);
-
-	dplane_ctx_q_init(ctx_list);
-	dplane_ctx_list_append(ctx_list, &handled_list);
 }
 
 struct nlsock *kernel_netlink_nlsock_lookup(int sock)
@@ -1762,6 +1935,247 @@ static bool kernel_netlink_nlsock_hash_equal(const void *arg1, const void *arg2)
 	return false;
 }
 
+/* Route shards' event handler, runs in the shard's pthread */
+static void nl_shard_work(struct event *event)
+{
+	struct nl_shard *shard = EVENT_ARG(event);
+	struct dplane_ctx_list_head work_list, done_list;
+
+	dplane_ctx_q_init(&work_list);
+	dplane_ctx_q_init(&done_list);
+
+	frr_with_mutex (&shard->mutex) {
+		dplane_ctx_list_append(&work_list, &shard->in_list);
+	}
+
+	nl_shard_update(shard, &work_list, &done_list);
+	nl_inflight_drain(shard, &done_list);
+
+	frr_with_mutex (&shard->mutex) {
+		dplane_ctx_list_append(&shard->out_list, &done_list);
+	}
+
+	dplane_provider_work_ready();
+}
+
+/* Open a route shard's socket and start its pthread */
+static bool nl_shard_start(struct nl_shard *shard)
+{
+	struct frr_pthread_attr attr = {
+		.start = frr_pthread_attr_default.start,
+		.stop = frr_pthread_attr_default.stop
+	};
+	char name[64], os_name[OS_THREAD_NAMELEN];
+#if defined SOL_NETLINK
+	int one;
+#endif
+
+	snprintf(shard->nls.name, sizeof(shard->nls.name),
+		 "netlink-dp-shard%u (NS %u)", shard->idx, NS_DEFAULT);
+	shard->nls.sock = -1;
+	if (netlink_socket(&shard->nls, 0, 0, 0, NS_DEFAULT,
+			   NETLINK_ROUTE) < 0) {
+		zlog_err("Failure to create %s socket", shard->nls.name);
+		return false;
+	}
+
+#if defined SOL_NETLINK
+	one = 1;
+	if (setsockopt(shard->nls.sock, SOL_NETLINK, NETLINK_EXT_ACK, &one,
+		       sizeof(one)) < 0)
+		zlog_notice("Registration for extended dp ACK failed : %d %s",
+			    errno, safe_strerror(errno));
+
+	one = 1;
+	(void)setsockopt(shard->nls.sock, SOL_NETLINK, NETLINK_CAP_ACK, &one,
+			 sizeof(one));
+#endif
+
+	if (fcntl(shard->nls.sock, F_SETFL, O_NONBLOCK) < 0)
+		zlog_err("Can't set %s socket error: %s(%d)", shard->nls.name,
+			 safe_strerror(errno), errno);
+
+	if (rcvbufsize)
+		netlink_recvbuf(&shard->nls, rcvbufsize);
+
+	kernel_netlink_nlsock_insert(&shard->nls);
+
+	snprintf(name, sizeof(name), "Zebra netlink route shard %u",
+		 shard->idx);
+	snprintf(os_name, sizeof(os_name), "zebra_nl_%u", shard->idx);
+	shard->pthread = frr_pthread_new(&attr, name, os_name);
+	frr_pthread_run(shard->pthread, NULL);
+	frr_pthread_wait_running(shard->pthread);
+
+	return true;
+}
+
+static bool nl_shards_busy(void)
+{
+	unsigned int i;
+
+	for (i = 1; i < nl_shards_started; i++)
+		if (nl_shards[i].outstanding)
+			return true;
+
+	return false;
+}
+
+/*
+ * Follow the configured number of shards.  Routes only move to another
+ * shard once everything sent by the old one is done.
+ */
+static void nl_shards_resize(void)
+{
+	unsigned int want = atomic_load_explicit(&nl_route_shards,
+						 memory_order_relaxed);
+	bool started = false;
+
+	if (want == nl_shards_active || nl_shards_busy())
+		return;
+
+	while (nl_shards_started < want && nl_shards_zns) {
+		if (!nl_shard_start(&nl_shards[nl_shards_started]))
+			break;
+
+		nl_shards_started++;
+		started = true;
+	}
+
+	/* Don't let the new sockets' route changes come back to us */
+	if (started)
+		netlink_install_filters(nl_shards_zns);
+
+	nl_shards_active = MIN(want, nl_shards_started);
+
+	if (IS_ZEBRA_DEBUG_KERNEL)
+		zlog_debug("%s: sending routes from %u shards", __func__,
+			   nl_shards_active);
+}
+
+static void nl_shards_collect(struct dplane_ctx_list_head *ctx_out_q)
+{
+	struct nl_shard *shard;
+	struct dplane_ctx_list_head done_list;
+	unsigned int i;
+
+	for (i = 1; i < nl_shards_started; i++) {
+		shard = &nl_shards[i];
+		if (shard->outstanding == 0)
+			continue;
+
+		dplane_ctx_q_init(&done_list);
+		frr_with_mutex (&shard->mutex) {
+			dplane_ctx_list_append(&done_list, &shard->out_list);
+		}
+
+		shard->outstanding -= dplane_ctx_q_count(&done_list);
+		dplane_ctx_list_append(ctx_out_q, &done_list);
+	}
+}
+
+static void nl_shard_hand_over(struct nl_shard *shard,
+			       struct dplane_ctx_list_head *work_list)
+{
+	uint32_t count = dplane_ctx_q_count(work_list);
+
+	if (count == 0)
+		return;
+
+	shard->outstanding += count;
+
+	frr_with_mutex (&shard->mutex) {
+		dplane_ctx_list_append(&shard->in_list, work_list);
+	}
+
+	event_add_event(shard->pthread->master, nl_shard_work, shard, 0,
+			&shard->t_work);
+}
+
+/* Route updates that may go to any shard */
+static bool nl_ctx_shardable(const struct zebra_dplane_ctx *ctx)
+{
+	switch (dplane_ctx_get_op(ctx)) {
+	case DPLANE_OP_ROUTE_INSTALL:
+	case DPLANE_OP_ROUTE_UPDATE:
+	case DPLANE_OP_ROUTE_DELETE:
+		return dplane_ctx_get_ns(ctx)->ns_id == NS_DEFAULT;
+	default:
+		return false;
+	}
+}
+
+/*
+ * Hand the pending contexts to the shards, up to the first one that has
+ * to wait for the route shards to finish.
+ */
+static void nl_shards_dispatch(struct dplane_ctx_list_head *ctx_out_q)
+{
+	struct dplane_ctx_list_head work_list[NL_SHARDS_MAX];
+	struct zebra_dplane_ctx *ctx;
+	unsigned int i;
+	bool busy;
+
+	nl_shards_resize();
+	busy = nl_shards_busy();
+
+	for (i = 0; i < nl_shards_active; i++)
+		dplane_ctx_q_init(&work_list[i]);
+
+	while ((ctx = dplane_ctx_get_head(&nl_shards_pending)) != NULL) {
+		if (nl_shards_active > 1 && nl_ctx_shardable(ctx))
+			i = jhash_1word(dplane_ctx_get_table(ctx), 0) %
+			    nl_shards_active;
+		else if (busy)
+			break;
+		else
+			i = 0;
+
+		if (i > 0)
+			busy = true;
+
+		ctx = dplane_ctx_dequeue(&nl_shards_pending);
+		dplane_ctx_enqueue_tail(&work_list[i], ctx);
+	}
+
+	/*
+	 * The kernel is done with shard 0's messages when sendmsg() returns,
+	 * so anything queued ahead of the other shards' routes is in place
+	 * before they go out.
+	 */
+	nl_shard_update(&nl_shards[0], &work_list[0], ctx_out_q);
+
+	for (i = 1; i < nl_shards_active; i++)
+		nl_shard_hand_over(&nl_shards[i], &work_list[i]);
+}
+
+void kernel_update_multi(struct dplane_ctx_list_head *ctx_list)
+{
+	struct dplane_ctx_list_head handled_list;
+
+	dplane_ctx_q_init(&handled_list);
+
+	nl_shards_collect(&handled_list);
+
+	dplane_ctx_list_append(&nl_shards_pending, ctx_list);
+	nl_shards_dispatch(&handled_list);
+
+	dplane_ctx_q_init(ctx_list);
+	dplane_ctx_list_append(ctx_list, &handled_list);
+}
+
+void kernel_update_flush(struct dplane_ctx_list_head *ctx_list)
+{
+	nl_inflight_drain(&nl_shards[0], ctx_list);
+	nl_shards_collect(ctx_list);
+}
+
+bool kernel_update_pending(void)
+{
+	return nl_shards_busy() ||
+	       dplane_ctx_get_head(&nl_shards_pending) != NULL;
+}
+
 /* Exported interface function.  This function simply calls
    netlink_socket (). */
 void kernel_init(struct zebra_ns *zns)
@@ -1963,15 +2377,10 @@ void kernel_init(struct zebra_ns *zns)
 			netlink_recvbuf(&zns->ge_netlink_cmd, rcvbufsize);
 	}
 
-	/* Set filter for inbound sockets, to exclude events we've generated
-	 * ourselves.
-	 */
-	netlink_install_filter(zns->netlink.sock, zns->netlink_cmd.snl.nl_pid,
-			       zns->netlink_dplane_out.snl.nl_pid);
+	if (zns->ns_id == NS_DEFAULT)
+		nl_shards_zns = zns;
 
-	netlink_install_filter(zns->netlink_dplane_in.sock,
-			       zns->netlink_cmd.snl.nl_pid,
-			       zns->netlink_dplane_out.snl.nl_pid);
+	netlink_install_filters(zns);
 
 	zns->t_netlink = NULL;
 
@@ -1995,6 +2404,19 @@ static void kernel_nlsock_fini(struct nlsock *nls)
 	}
 }
 
+static void nl_shard_stop(struct nl_shard *shard)
+{
+	if (shard->pthread) {
+		frr_pthread_stop(shard->pthread, NULL);
+		frr_pthread_destroy(shard->pthread);
+		shard->pthread = NULL;
+	}
+
+	kernel_nlsock_fini(&shard->nls);
+	XFREE(MTYPE_NL_BUF, shard->tx_buf);
+	shard->tx_bufsize = 0;
+}
+
 void kernel_terminate(struct zebra_ns *zns, bool complete)
 {
 	EVENT_OFF(zns->t_netlink);
@@ -2013,7 +2435,18 @@ void kernel_terminate(struct zebra_ns *zns, bool complete)
 	if (complete) {
 		kernel_nlsock_fini(&zns->netlink_dplane_out);
 
-		XFREE(MTYPE_NL_BUF, nl_batch_tx_buf);
+		if (zns == nl_shards_zns) {
+			unsigned int i;
+
+			for (i = 1; i < nl_shards_started; i++)
+				nl_shard_stop(&nl_shards[i]);
+
+			nl_shards_started = nl_shards_active = 1;
+			nl_shards_zns = NULL;
+		}
+
+		XFREE(MTYPE_NL_BUF, nl_shards[0].tx_buf);
+		nl_shards[0].tx_bufsize = 0;
 	}
 }
 
@@ -2022,11 +2455,26 @@ void kernel_terminate(struct zebra_ns *zns, bool complete)
  */
 void kernel_router_init(void)
 {
+	unsigned int i;
+
 	/* Init nlsock hash and lock */
 	pthread_mutex_init(&nlsock_mutex, NULL);
 	nlsock_hash = hash_create_size(8, kernel_netlink_nlsock_key,
 				       kernel_netlink_nlsock_hash_equal,
 				       "Netlink Socket Hash");
+
+	for (i = 0; i < NL_SHARDS_MAX; i++) {
+		struct nl_shard *shard = &nl_shards[i];
+
+		shard->idx = i;
+		shard->nls.sock = -1;
+		dplane_ctx_q_init(&shard->inflight_list);
+		dplane_ctx_q_init(&shard->in_list);
+		dplane_ctx_q_init(&shard->out_list);
+		pthread_mutex_init(&shard->mutex, NULL);
+	}
+
+	dplane_ctx_q_init(&nl_shards_pending);
 }
 
 /*
@@ -2034,6 +2482,11 @@ void kernel_router_init(void)
  */
 void kernel_router_terminate(void)
 {
+	unsigned int i;
+
+	for (i = 0; i < NL_SHARDS_MAX; i++)
+		pthread_mutex_destroy(&nl_shards[i].mutex);
+
 	pthread_mutex_destroy(&nlsock_mutex);
 
 	hash_free(nlsock_hash);
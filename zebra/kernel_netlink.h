@@ -144,6 +144,18 @@ extern int netlink_config_write_helper(struct vty *vty);
 extern void netlink_set_batch_buffer_size(uint32_t size, uint32_t threshold,
 					  bool set);
 
+/*
+ * Configure how many messages the dplane may send before reading the
+ * kernel's responses. If 'unset', reset to default value.
+ */
+extern void netlink_set_batch_inflight(uint32_t inflight, bool set);
+
+/*
+ * Configure how many pthreads send route updates to the kernel. If
+ * 'unset', reset to default value.
+ */
+extern void netlink_set_route_shards(uint32_t shards, bool set);
+
 extern struct nlsock *kernel_netlink_nlsock_lookup(int sock);
 #endif /* HAVE_NETLINK */
 
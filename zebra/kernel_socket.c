@@ -1640,4 +1640,14 @@ void kernel_update_multi(struct dplane_ctx_list_head *ctx_list)
 	dplane_ctx_list_append(ctx_list, &handled_list);
 }
 
+void kernel_update_flush(struct dplane_ctx_list_head *ctx_list)
+{
+	/* Updates complete synchronously here, nothing is kept back */
+}
+
+bool kernel_update_pending(void)
+{
+	return false;
+}
+
 #endif /* !HAVE_NETLINK */
@@ -183,6 +183,10 @@ struct route_entry {
  * sub-queue 8: iBGP, eBGP
  * sub-queue 9: any other origin (if any) typically those that
  *              don't generate routes
+ *
+ * The route sub-queues (connected to any other origin) do not hold route
+ * nodes directly but one meta_queue_shard per table with nodes queued,
+ * which are serviced round-robin.
  */
 #define MQ_SIZE 11
 
@@ -194,6 +198,22 @@ struct meta_queue {
 	uint32_t size; /* sum of lengths of all subqueues */
 };
 
+/*
+ * Route nodes of one table waiting in one route sub-queue.  Up to
+ * zrouter.rib_shard_quantum nodes are processed from a shard before moving
+ * on to the next table, so that one busy table does not hold back all the
+ * others.  Nodes within a shard stay in the order they were queued.
+ */
+struct meta_queue_shard {
+	struct rib_table_info *info;
+	uint8_t qindex;
+
+	/* nodes processed since this shard came to the head */
+	uint32_t run;
+
+	struct list *nodes;
+};
+
 /*
  * Structure that represents a single destination (prefix).
  */
@@ -217,6 +237,12 @@ typedef struct rib_dest_t_ {
 	 */
 	uint32_t flags;
 
+	/*
+	 * RIB version (zrouter.rib_version) of the last FIB change sent to
+	 * the dataplane for this destination.
+	 */
+	uint64_t version;
+
 	/*
 	 * The list of nht prefixes that have ended up
 	 * depending on this route node.
@@ -305,6 +331,9 @@ struct rib_table_info {
 	afi_t afi;
 	safi_t safi;
 	uint32_t table_id;
+
+	/* This table's shard in each route sub-queue, if any */
+	struct meta_queue_shard *mq_shard[MQ_SIZE];
 };
 
 enum rib_tables_iter_state {
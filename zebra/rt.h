@@ -110,8 +110,15 @@ extern int kernel_del_mac_nhg(uint32_t nhg_id);
 
 /*
  * Message batching interface.
+ *
+ * kernel_update_multi() may keep contexts whose kernel responses are still
+ * outstanding and hand them back from a later call, in order.
+ * kernel_update_flush() hands back all of those that are done, and
+ * kernel_update_pending() tells whether some are still being worked on.
  */
 extern void kernel_update_multi(struct dplane_ctx_list_head *ctx_list);
+extern void kernel_update_flush(struct dplane_ctx_list_head *ctx_list);
+extern bool kernel_update_pending(void);
 
 /*
  * Called by the dplane pthread to read incoming OS messages and dispatch them.
@@ -132,6 +132,9 @@ struct dplane_route_info {
 
 	uint32_t zd_flags;
 
+	/* RIB version of the change, see rib_dest_t */
+	uint64_t zd_rib_version;
+
 	/* Nexthop hash entry info */
 	struct dplane_nexthop_info nhe;
 
@@ -370,6 +373,9 @@ struct dplane_srv6_encap_ctx {
 	struct in6_addr srcaddr;
 };
 
+/* List of the route updates not done yet, see dplane_rib_version_pending() */
+PREDECL_DLIST(dplane_rib_versions);
+
 /*
  * The context block used to exchange info about route updates across
  * the boundary between the zebra main context (and pthread) and the
@@ -440,6 +446,10 @@ struct zebra_dplane_ctx {
 
 	/* Embedded list linkage */
 	struct dplane_ctx_list_item zd_entries;
+
+	/* Linkage in the route updates not done yet, if zd_rib_pending */
+	struct dplane_rib_versions_item zd_rib_entries;
+	bool zd_rib_pending;
 };
 
 /* Flag that can be set by a pre-kernel provider as a signal that an update
@@ -450,6 +460,7 @@ struct zebra_dplane_ctx {
 /* List types declared now that the structs involved are defined. */
 DECLARE_DLIST(dplane_ctx_list, struct zebra_dplane_ctx, zd_entries);
 DECLARE_DLIST(dplane_intf_extra_list, struct dplane_intf_extra, dlink);
+DECLARE_DLIST(dplane_rib_versions, struct zebra_dplane_ctx, zd_rib_entries);
 
 /* List for dplane plugins/providers */
 PREDECL_DLIST(dplane_prov_list);
@@ -540,6 +551,15 @@ static struct zebra_dplane_globals {
 	/* Update context queue inbound to the dataplane */
 	struct dplane_ctx_list_head dg_update_list;
 
+	/*
+	 * Route updates that took a new RIB version, oldest first, from
+	 * their enqueueing until zebra is done with their results; and the
+	 * version of the last one.
+	 */
+	struct dplane_rib_versions_head dg_rib_versions;
+	uint64_t dg_rib_version_last;
+	pthread_mutex_t dg_rib_mutex;
+
 	/* Ordered list of providers */
 	struct dplane_prov_list_head dg_providers;
 
@@ -711,6 +731,14 @@ static void dplane_ctx_free_internal(struct zebra_dplane_ctx *ctx)
 {
 	struct dplane_intf_extra *if_extra;
 
+	if (ctx->zd_rib_pending) {
+		frr_with_mutex (&zdplane_info.dg_rib_mutex) {
+			dplane_rib_versions_del(&zdplane_info.dg_rib_versions,
+						ctx);
+		}
+		ctx->zd_rib_pending = false;
+	}
+
 	/*
 	 * Some internal allocations may need to be freed, depending on
 	 * the type of info captured in the ctx.
@@ -937,6 +965,11 @@ void dplane_ctx_q_init(struct dplane_ctx_list_head *q)
 	dplane_ctx_list_init(q);
 }
 
+uint32_t dplane_ctx_q_count(const struct dplane_ctx_list_head *q)
+{
+	return dplane_ctx_list_count(q);
+}
+
 /* Enqueue a context block */
 void dplane_ctx_enqueue_tail(struct dplane_ctx_list_head *list,
 			     const struct zebra_dplane_ctx *ctx)
@@ -1930,6 +1963,13 @@ uint16_t dplane_ctx_get_old_instance(const struct zebra_dplane_ctx *ctx)
 	return ctx->u.rinfo.zd_old_instance;
 }
 
+uint64_t dplane_ctx_get_rib_version(const struct zebra_dplane_ctx *ctx)
+{
+	DPLANE_CTX_VALID(ctx);
+
+	return ctx->u.rinfo.zd_rib_version;
+}
+
 uint32_t dplane_ctx_get_flags(const struct zebra_dplane_ctx *ctx)
 {
 	DPLANE_CTX_VALID(ctx);
@@ -3318,6 +3358,47 @@ uint32_t dplane_get_in_queue_len(void)
 				    memory_order_seq_cst);
 }
 
+/*
+ * Lowest RIB version of the route updates zebra is not done with yet, or
+ * UINT64_MAX. Providers may complete updates out of order, so a provider
+ * having seen some version does not mean it saw all the older ones.
+ */
+uint64_t dplane_rib_version_pending(void)
+{
+	struct zebra_dplane_ctx *ctx;
+
+	frr_with_mutex (&zdplane_info.dg_rib_mutex) {
+		ctx = dplane_rib_versions_first(&zdplane_info.dg_rib_versions);
+		if (ctx)
+			return ctx->u.rinfo.zd_rib_version;
+	}
+
+	return UINT64_MAX;
+}
+
+/* Notes a route update that took a new RIB version as pending */
+static void dplane_rib_version_track(struct zebra_dplane_ctx *ctx)
+{
+	uint64_t version;
+
+	if (ctx->zd_op != DPLANE_OP_ROUTE_INSTALL &&
+	    ctx->zd_op != DPLANE_OP_ROUTE_UPDATE &&
+	    ctx->zd_op != DPLANE_OP_ROUTE_DELETE)
+		return;
+
+	/* Versions are taken in order, an older one is a repeated update. */
+	version = ctx->u.rinfo.zd_rib_version;
+	frr_with_mutex (&zdplane_info.dg_rib_mutex) {
+		if (version <= zdplane_info.dg_rib_version_last)
+			break;
+
+		zdplane_info.dg_rib_version_last = version;
+		dplane_rib_versions_add_tail(&zdplane_info.dg_rib_versions,
+					     ctx);
+		ctx->zd_rib_pending = true;
+	}
+}
+
 /*
  * Internal helper that copies information from a zebra ns object; this is
  * called in the zebra main pthread context as part of dplane ctx init.
@@ -3423,6 +3504,7 @@ int dplane_ctx_route_init(struct zebra_dplane_ctx *ctx, enum dplane_op_e op,
 	const struct rib_table_info *info;
 	const struct prefix *p;
 	const struct prefix_ipv6 *src_p;
+	rib_dest_t *dest;
 	struct zebra_ns *zns;
 	struct zebra_vrf *zvrf;
 	struct nexthop *nexthop;
@@ -3455,6 +3537,10 @@ int dplane_ctx_route_init(struct zebra_dplane_ctx *ctx, enum dplane_op_e op,
 					info->safi) != AOK)
 		return ret;
 
+	dest = rib_dest_from_rnode(rn);
+	if (dest)
+		ctx->u.rinfo.zd_rib_version = dest->version;
+
 	/* Copy nexthops; recursive info is included too */
 	copy_nexthops(&(ctx->u.rinfo.zd_ng.nexthop),
 		      re->nhe->nhg.nexthop, NULL);
@@ -4198,6 +4284,8 @@ static int dplane_update_enqueue(struct zebra_dplane_ctx *ctx)
 	int ret = EINVAL;
 	uint32_t high, curr;
 
+	dplane_rib_version_track(ctx);
+
 	/* Enqueue for processing by the dataplane pthread */
 	DPLANE_LOCK();
 	{
@@ -6958,6 +7046,10 @@ static int kernel_dplane_process_func(struct zebra_dplane_provider *prov)
 
 	kernel_update_multi(&work_list);
 
+	/* Nothing else is waiting, collect what is still in flight */
+	if (counter < limit)
+		kernel_update_flush(&work_list);
+
 	while ((ctx = dplane_ctx_list_pop(&work_list)) != NULL) {
 		kernel_dplane_handle_result(ctx);
 
@@ -6985,10 +7077,16 @@ static int kernel_dplane_shutdown_func(struct zebra_dplane_provider *prov,
 				       bool early)
 {
 	struct zebra_dplane_ctx *ctx;
+	struct dplane_ctx_list_head work_list;
 
 	if (early)
 		return 1;
 
+	dplane_ctx_list_init(&work_list);
+	kernel_update_flush(&work_list);
+	while ((ctx = dplane_ctx_list_pop(&work_list)) != NULL)
+		dplane_ctx_free(&ctx);
+
 	ctx = dplane_provider_dequeue_in_ctx(prov);
 	while (ctx) {
 		dplane_ctx_free(&ctx);
@@ -7221,6 +7319,8 @@ static bool dplane_work_pending(void)
 
 	if (ctx != NULL)
 		ret = true;
+	else if (kernel_update_pending())
+		ret = true;
 
 	return ret;
 }
@@ -7539,10 +7639,12 @@ static void zebra_dplane_init_internal(void)
 	memset(&zdplane_info, 0, sizeof(zdplane_info));
 
 	pthread_mutex_init(&zdplane_info.dg_mutex, NULL);
+	pthread_mutex_init(&zdplane_info.dg_rib_mutex, NULL);
 
 	dplane_prov_list_init(&zdplane_info.dg_providers);
 
 	dplane_ctx_list_init(&zdplane_info.dg_update_list);
+	dplane_rib_versions_init(&zdplane_info.dg_rib_versions);
 	zns_info_list_init(&zdplane_info.dg_zns_list);
 
 	zdplane_info.dg_updates_per_cycle = DPLANE_DEFAULT_NEW_WORK;
@@ -323,6 +323,9 @@ struct zebra_dplane_ctx *dplane_ctx_get_head(struct dplane_ctx_list_head *q);
 /* Init a list of contexts */
 void dplane_ctx_q_init(struct dplane_ctx_list_head *q);
 
+/* Number of contexts in a list */
+uint32_t dplane_ctx_q_count(const struct dplane_ctx_list_head *q);
+
 /*
  * Accessors for information from the context object
  */
@@ -506,6 +509,7 @@ route_tag_t dplane_ctx_get_old_tag(const struct zebra_dplane_ctx *ctx);
 uint16_t dplane_ctx_get_instance(const struct zebra_dplane_ctx *ctx);
 void dplane_ctx_set_instance(struct zebra_dplane_ctx *ctx, uint16_t instance);
 uint16_t dplane_ctx_get_old_instance(const struct zebra_dplane_ctx *ctx);
+uint64_t dplane_ctx_get_rib_version(const struct zebra_dplane_ctx *ctx);
 uint32_t dplane_ctx_get_flags(const struct zebra_dplane_ctx *ctx);
 void dplane_ctx_set_flags(struct zebra_dplane_ctx *ctx, uint32_t flags);
 uint32_t dplane_ctx_get_metric(const struct zebra_dplane_ctx *ctx);
@@ -1076,6 +1080,9 @@ void dplane_set_in_queue_limit(uint32_t limit, bool set);
 /* Retrieve the current queue depth of incoming, unprocessed updates */
 uint32_t dplane_get_in_queue_len(void);
 
+/* Lowest RIB version of the route updates not done yet, or UINT64_MAX */
+uint64_t dplane_rib_version_pending(void);
+
 /*
  * Vty/cli apis
  */
@@ -52,6 +52,24 @@ static bool g_nexthops_enabled = true;
 static bool proto_nexthops_only;
 static bool use_recursive_backups = true;
 
+/*
+ * Most recently found zebra-owned nhes, most recent first.  Routes from a
+ * protocol tend to come in runs sharing the same nexthops, so comparing a
+ * lookup with these first saves hashing its whole nexthop list (and the
+ * backup list) again.  An nhe is dropped from here when it leaves
+ * zrouter.nhgs.
+ */
+#define NHG_FIND_CACHE_SIZE 8
+static struct nhg_hash_entry *nhg_find_cache[NHG_FIND_CACHE_SIZE];
+
+/* Lookups by nexthop list, see zebra_nhg_get_stats() */
+static struct {
+	uint64_t lookups;
+	uint64_t cache_hits;
+	uint64_t hash_hits;
+	uint64_t created;
+} nhg_find_stats;
+
 static struct nhg_hash_entry *depends_find(const struct nexthop *nh, afi_t afi,
 					   int type, bool from_dplane);
 static void depends_add(struct nhg_connected_tree_head *head,
@@ -666,6 +684,95 @@ static void handle_recursive_depend(struct nhg_connected_tree_head *nhg_depends,
 		depends_add(nhg_depends, depend);
 }
 
+/* Put an nhe at the front of the find cache */
+static void nhg_find_cache_add(struct nhg_hash_entry *nhe)
+{
+	memmove(&nhg_find_cache[1], &nhg_find_cache[0],
+		(NHG_FIND_CACHE_SIZE - 1) * sizeof(nhg_find_cache[0]));
+	nhg_find_cache[0] = nhe;
+}
+
+static void nhg_find_cache_del(struct nhg_hash_entry *nhe)
+{
+	unsigned int i;
+
+	for (i = 0; i < NHG_FIND_CACHE_SIZE; i++) {
+		if (nhg_find_cache[i] != nhe)
+			continue;
+
+		memmove(&nhg_find_cache[i], &nhg_find_cache[i + 1],
+			(NHG_FIND_CACHE_SIZE - 1 - i) *
+				sizeof(nhg_find_cache[0]));
+		nhg_find_cache[NHG_FIND_CACHE_SIZE - 1] = NULL;
+		return;
+	}
+}
+
+/*
+ * Find a zebra-owned nhe by its nexthops.  Every nhe in the cache is also
+ * in zrouter.nhgs, which never holds two equal entries, so a cache hit is
+ * exactly what the hash lookup would have returned.
+ */
+static struct nhg_hash_entry *
+nhg_find_by_nexthops(struct nhg_hash_entry *lookup)
+{
+	struct nhg_hash_entry *nhe;
+	unsigned int i;
+
+	nhg_find_stats.lookups++;
+
+	for (i = 0; i < NHG_FIND_CACHE_SIZE && nhg_find_cache[i]; i++) {
+		nhe = nhg_find_cache[i];
+		if (!zebra_nhg_hash_equal(nhe, lookup))
+			continue;
+
+		nhg_find_stats.cache_hits++;
+		if (i > 0) {
+			nhg_find_cache_del(nhe);
+			nhg_find_cache_add(nhe);
+		}
+		return nhe;
+	}
+
+	nhe = hash_lookup(zrouter.nhgs, lookup);
+	if (nhe) {
+		nhg_find_stats.hash_hits++;
+		nhg_find_cache_add(nhe);
+	}
+
+	return nhe;
+}
+
+void zebra_nhg_get_stats(struct zebra_nhg_stats *stats)
+{
+	struct hash_bucket *hb;
+	struct nhg_hash_entry *nhe;
+	unsigned int i, len;
+
+	memset(stats, 0, sizeof(*stats));
+
+	stats->lookups = nhg_find_stats.lookups;
+	stats->cache_hits = nhg_find_stats.cache_hits;
+	stats->hash_hits = nhg_find_stats.hash_hits;
+	stats->created = nhg_find_stats.created;
+
+	stats->entries = hashcount(zrouter.nhgs);
+	stats->buckets = zrouter.nhgs->size;
+
+	for (i = 0; i < zrouter.nhgs->size; i++) {
+		len = 0;
+		for (hb = zrouter.nhgs->index[i]; hb; hb = hb->next) {
+			nhe = hb->data;
+			stats->refs += nhe->refcnt;
+			len++;
+		}
+
+		if (len == 0)
+			stats->empty_buckets++;
+		stats->max_chain = MAX(stats->max_chain, len);
+	}
+}
+
 /*
  * Lookup an nhe in the global hash, using data from another nhe. If 'lookup'
  * has an id value, that's used. Create a new global/shared nhe if not found.
@@ -684,7 +791,7 @@ static bool zebra_nhe_find(struct nhg_hash_entry **nhe, /* return value */
 	if (lookup->id)
 		(*nhe) = zebra_nhg_lookup_id(lookup->id);
 	else
-		(*nhe) = hash_lookup(zrouter.nhgs, lookup);
+		(*nhe) = nhg_find_by_nexthops(lookup);
 
 	if (IS_ZEBRA_DEBUG_NHG_DETAIL)
 		zlog_debug("%s: id %u, lookup %p, vrf %d, type %d, depends %p%s => Found %p(%pNG)",
@@ -699,8 +806,10 @@ static bool zebra_nhe_find(struct nhg_hash_entry **nhe, /* return value */
 	/* We're going to create/insert a new nhe:
 	 * assign the next global id value if necessary.
 	 */
-	if (lookup->id == 0)
+	if (lookup->id == 0) {
 		lookup->id = nhg_get_next_id();
+		nhg_find_stats.created++;
+	}
 
 	if (!from_dplane && lookup->id < ZEBRA_NHG_PROTO_LOWER) {
 		/*
@@ -710,6 +819,7 @@ static bool zebra_nhe_find(struct nhg_hash_entry **nhe, /* return value */
 		 */
 		newnhe = hash_get(zrouter.nhgs, lookup, zebra_nhg_hash_alloc);
 		zebra_nhg_insert_id(newnhe);
+		nhg_find_cache_add(newnhe);
 	} else {
 		/*
 		 * This is upperproto owned NHG or one we read in from dataplane
@@ -1093,8 +1203,10 @@ static void zebra_nhg_release(struct nhg_hash_entry *nhe)
 	 * If its not zebra owned, we didn't store it here and have to be
 	 * sure we don't clear one thats actually being used.
 	 */
-	if (nhe->id < ZEBRA_NHG_PROTO_LOWER)
+	if (nhe->id < ZEBRA_NHG_PROTO_LOWER) {
 		hash_release(zrouter.nhgs, nhe);
+		nhg_find_cache_del(nhe);
+	}
 
 	hash_release(zrouter.nhgs_id, nhe);
 }
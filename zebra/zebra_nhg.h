@@ -376,6 +376,26 @@ extern void zebra_nhg_dplane_result(struct zebra_dplane_ctx *ctx);
 /* Sweep the nhg hash tables for old entries on restart */
 extern void zebra_nhg_sweep_table(struct hash *hash);
 
+/* Statistics on finding zebra-owned nhes by their nexthops */
+struct zebra_nhg_stats {
+	/* Lookups, and where they were satisfied */
+	uint64_t lookups;
+	uint64_t cache_hits;
+	uint64_t hash_hits;
+	uint64_t created;
+
+	/* Shape of the zebra-owned nhe hash */
+	unsigned long entries;
+	unsigned int buckets;
+	unsigned int empty_buckets;
+	unsigned int max_chain;
+
+	/* References held on those nhes, by routes and by other groups */
+	uint64_t refs;
+};
+
+extern void zebra_nhg_get_stats(struct zebra_nhg_stats *stats);
+
 /*
  * We are shutting down but the nexthops should be kept
  * as that -r has been specified and we don't want to delete
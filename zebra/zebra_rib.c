@@ -56,6 +56,7 @@ DEFINE_MTYPE(ZEBRA, RE,       "Route Entry");
 DEFINE_MTYPE_STATIC(ZEBRA, RIB_DEST,       "RIB destination");
 DEFINE_MTYPE_STATIC(ZEBRA, RIB_UPDATE_CTX, "Rib update context object");
 DEFINE_MTYPE_STATIC(ZEBRA, WQ_WRAPPER, "WQ wrapper");
+DEFINE_MTYPE_STATIC(ZEBRA, RIB_MQ_SHARD, "RIB meta-queue shard");
 
 /*
  * Event, list, and mutex for delivery of dataplane results
@@ -705,6 +706,7 @@ void rib_install_kernel(struct route_node *rn, struct route_entry *re,
 	 * Make sure we update the FPM any time we send new information to
 	 * the kernel.
 	 */
+	dest->version = ++zrouter.rib_version;
 	hook_call(rib_update, rn, "installing in kernel");
 
 	/* Send add or update */
@@ -754,6 +756,7 @@ void rib_uninstall_kernel(struct route_node *rn, struct route_entry *re)
 	struct nexthop *nexthop;
 	struct rib_table_info *info = srcdest_rnode_table_info(rn);
 	struct zebra_vrf *zvrf = zebra_vrf_lookup_by_id(re->vrf_id);
+	rib_dest_t *dest = rib_dest_from_rnode(rn);
 
 	if (info->safi != SAFI_UNICAST) {
 		UNSET_FLAG(re->status, ROUTE_ENTRY_INSTALLED);
@@ -766,6 +769,7 @@ void rib_uninstall_kernel(struct route_node *rn, struct route_entry *re)
 	 * Make sure we update the FPM any time we send new information to
 	 * the dataplane.
 	 */
+	dest->version = ++zrouter.rib_version;
 	hook_call(rib_update, rn, "uninstalling from kernel");
 
 	switch (dplane_route_delete(rn, re)) {
@@ -2664,6 +2668,35 @@ static void process_subq_route(struct listnode *lnode, uint8_t qindex)
 	route_unlock_node(rnode);
 }
 
+static void meta_queue_shard_free(struct meta_queue_shard *shard)
+{
+	list_delete(&shard->nodes);
+	XFREE(MTYPE_RIB_MQ_SHARD, shard);
+}
+
+/*
+ * Process the next route node of the table at the head of a route
+ * sub-queue, then move that table to the back if it has had its turn.
+ */
+static void process_subq_route_shard(struct list *subq,
+				     struct listnode *lnode, uint8_t qindex)
+{
+	struct meta_queue_shard *shard = listgetdata(lnode);
+	struct listnode *rnode_lnode = listhead(shard->nodes);
+
+	process_subq_route(rnode_lnode, qindex);
+	list_delete_node(shard->nodes, rnode_lnode);
+
+	if (!listcount(shard->nodes)) {
+		shard->info->mq_shard[qindex] = NULL;
+		meta_queue_shard_free(shard);
+		list_delete_node(subq, lnode);
+	} else if (++shard->run >= zrouter.rib_shard_quantum) {
+		shard->run = 0;
+		listnode_move_to_tail(subq, lnode);
+	}
+}
+
 static void rib_re_nhg_free(struct route_entry *re)
 {
 	if (re->nhe && re->nhe_id) {
@@ -3202,8 +3235,9 @@ static unsigned int process_subq(struct list *subq,
 	case META_QUEUE_NOTBGP:
 	case META_QUEUE_BGP:
 	case META_QUEUE_OTHER:
-		process_subq_route(lnode, qindex);
-		break;
+		/* the shard is only unlinked once it is empty */
+		process_subq_route_shard(subq, lnode, qindex);
+		return 1;
 	case META_QUEUE_GR_RUN:
 		process_subq_gr_run(lnode);
 		break;
@@ -3248,6 +3282,27 @@ static wq_item_status meta_queue_process(struct work_queue *dummy, void *data)
 	return mq->size ? WQ_REQUEUE : WQ_SUCCESS;
 }
 
+static struct meta_queue_shard *
+meta_queue_shard_get(struct meta_queue *mq, struct route_node *rn,
+		     uint8_t qindex)
+{
+	struct rib_table_info *info = srcdest_rnode_table_info(rn);
+	struct meta_queue_shard *shard = info->mq_shard[qindex];
+
+	if (shard)
+		return shard;
+
+	shard = XCALLOC(MTYPE_RIB_MQ_SHARD, sizeof(*shard));
+	shard->info = info;
+	shard->qindex = qindex;
+	shard->nodes = list_new();
+
+	info->mq_shard[qindex] = shard;
+	listnode_add(mq->subq[qindex], shard);
+
+	return shard;
+}
+
 
 /*
  * Look into the RN and queue it into the highest priority queue
@@ -3313,7 +3368,7 @@ static int rib_meta_queue_add(struct meta_queue *mq, void *data)
 	}
 
 	SET_FLAG(rib_dest_from_rnode(rn)->flags, RIB_ROUTE_QUEUED(qindex));
-	listnode_add(mq->subq[qindex], rn);
+	listnode_add(meta_queue_shard_get(mq, rn, qindex)->nodes, rn);
 	route_lock_node(rn);
 	mq->size++;
 
@@ -3816,19 +3871,29 @@ static void early_label_meta_queue_free(struct meta_queue *mq, struct list *l,
 static void rib_meta_queue_free(struct meta_queue *mq, struct list *l,
 				struct zebra_vrf *zvrf)
 {
+	struct meta_queue_shard *shard;
 	struct route_node *rnode;
-	struct listnode *node, *nnode;
+	struct listnode *node, *nnode, *rnode_node;
 
-	for (ALL_LIST_ELEMENTS(l, node, nnode, rnode)) {
-		rib_dest_t *dest = rib_dest_from_rnode(rnode);
+	for (ALL_LIST_ELEMENTS(l, node, nnode, shard)) {
+		/*
+		 * On shutdown the tables are gone already, only the
+		 * queue itself is left to free.
+		 */
+		if (zvrf) {
+			if (shard->info->zvrf != zvrf)
+				continue;
 
-		if (dest && rib_dest_vrf(dest) != zvrf)
-			continue;
+			for (ALL_LIST_ELEMENTS_RO(shard->nodes, rnode_node,
+						  rnode))
+				route_unlock_node(rnode);
+			shard->info->mq_shard[shard->qindex] = NULL;
+		}
 
-		route_unlock_node(rnode);
+		mq->size -= listcount(shard->nodes);
+		meta_queue_shard_free(shard);
 		node->data = NULL;
 		list_delete_node(l, node);
-		mq->size--;
 	}
 }
 
@@ -283,12 +283,14 @@ void zebra_router_init(bool asic_offload, bool notify_on_ack,
 		       bool v6_with_v4_nexthop)
 {
 	zrouter.sequence_num = 0;
+	zrouter.rib_version = (uint64_t)time(NULL) << 32;
 
 	zrouter.protodown_r_bit = FRR_PROTODOWN_REASON_DEFAULT_BIT;
 
 	zrouter.allow_delete = false;
 
 	zrouter.packets_to_process = ZEBRA_ZAPI_PACKETS_TO_PROCESS;
+	zrouter.rib_shard_quantum = ZEBRA_RIB_SHARD_QUANTUM;
 
 	zrouter.nhg_keep = ZEBRA_DEFAULT_NHG_KEEP_TIMER;
 
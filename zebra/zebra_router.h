@@ -163,11 +163,22 @@ struct zebra_router {
 	/* A sequence number used for tracking routes */
 	_Atomic uint32_t sequence_num;
 
+	/*
+	 * Bumped on every FIB change sent to the dataplane and recorded in
+	 * the destination. Seeded from the clock so versions keep growing
+	 * across restarts.
+	 */
+	uint64_t rib_version;
+
 	/* rib work queue */
 #define ZEBRA_RIB_PROCESS_HOLD_TIME 10
 #define ZEBRA_RIB_PROCESS_RETRY_TIME 1
 	struct work_queue *ribq;
 
+	/* Route nodes processed per table before moving to the next one */
+#define ZEBRA_RIB_SHARD_QUANTUM 100
+	uint32_t rib_shard_quantum;
+
 	/* Meta Queue Information */
 	struct meta_queue *mq;
 
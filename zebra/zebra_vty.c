@@ -1641,6 +1641,56 @@ DEFPY(show_nexthop_group,
 	return CMD_SUCCESS;
 }
 
+DEFPY(show_nexthop_group_stats,
+      show_nexthop_group_stats_cmd,
+      "show nexthop-group rib stats [json]",
+      SHOW_STR
+      "Show Nexthop Groups\n"
+      "RIB information\n"
+      "Lookup and sharing statistics\n"
+      JSON_STR)
+{
+	struct zebra_nhg_stats stats;
+	bool uj = use_json(argc, argv);
+	json_object *json;
+	unsigned int used;
+
+	zebra_nhg_get_stats(&stats);
+	used = stats.buckets - stats.empty_buckets;
+
+	if (uj) {
+		json = json_object_new_object();
+		json_object_int_add(json, "lookups", stats.lookups);
+		json_object_int_add(json, "cacheHits", stats.cache_hits);
+		json_object_int_add(json, "hashHits", stats.hash_hits);
+		json_object_int_add(json, "created", stats.created);
+		json_object_int_add(json, "entries", stats.entries);
+		json_object_int_add(json, "buckets", stats.buckets);
+		json_object_int_add(json, "emptyBuckets", stats.empty_buckets);
+		json_object_int_add(json, "maxChainLength", stats.max_chain);
+		json_object_int_add(json, "references", stats.refs);
+		vty_json(vty, json);
+		return CMD_SUCCESS;
+	}
+
+	vty_out(vty, "Lookups by nexthops: %" PRIu64 "\n", stats.lookups);
+	vty_out(vty, "  Recent cache hits: %" PRIu64 " (%.1f%%)\n",
+		stats.cache_hits,
+		stats.lookups ? 100.0 * stats.cache_hits / stats.lookups : 0);
+	vty_out(vty, "  Hash hits: %" PRIu64 " (%.1f%%)\n", stats.hash_hits,
+		stats.lookups ? 100.0 * stats.hash_hits / stats.lookups : 0);
+	vty_out(vty, "  Created: %" PRIu64 "\n", stats.created);
+	vty_out(vty, "Zebra nexthop-groups: %lu\n", stats.entries);
+	vty_out(vty, "  Hash buckets: %u, %u in use\n", stats.buckets, used);
+	vty_out(vty, "  Chain length: average %.2f, max %u\n",
+		used ? (double)stats.entries / used : 0, stats.max_chain);
+	vty_out(vty, "  References: %" PRIu64 ", %.2f per group\n",
+		stats.refs,
+		stats.entries ? (double)stats.refs / stats.entries : 0);
+
+	return CMD_SUCCESS;
+}
+
 DEFPY_HIDDEN(nexthop_group_use_enable,
 	     nexthop_group_use_enable_cmd,
 	     "[no] zebra nexthop kernel enable",
@@ -3766,6 +3816,23 @@ DEFPY (zebra_nexthop_group_keep,
 	return CMD_SUCCESS;
 }
 
+DEFPY (zebra_route_queue_table_quantum,
+       zebra_route_queue_table_quantum_cmd,
+       "[no] zebra route-queue table-quantum (1-100000)",
+       NO_STR
+       ZEBRA_STR
+       "Route processing queue\n"
+       "Routes processed per table before moving to the next table\n"
+       "Number of routes\n")
+{
+	if (no)
+		zrouter.rib_shard_quantum = ZEBRA_RIB_SHARD_QUANTUM;
+	else
+		zrouter.rib_shard_quantum = table_quantum;
+
+	return CMD_SUCCESS;
+}
+
 static int config_write_protocol(struct vty *vty)
 {
 	if (zrouter.allow_delete)
@@ -3781,6 +3848,10 @@ static int config_write_protocol(struct vty *vty)
 		vty_out(vty, "zebra zapi-packets %u\n",
 			zrouter.packets_to_process);
 
+	if (zrouter.rib_shard_quantum != ZEBRA_RIB_SHARD_QUANTUM)
+		vty_out(vty, "zebra route-queue table-quantum %u\n",
+			zrouter.rib_shard_quantum);
+
 	enum multicast_mode ipv4_multicast_mode = multicast_mode_ipv4_get();
 
 	if (ipv4_multicast_mode != MCAST_NO_CONFIG)
@@ -4268,6 +4339,34 @@ DEFUN_HIDDEN(no_zebra_kernel_netlink_batch_tx_buf,
 	return CMD_SUCCESS;
 }
 
+DEFPY_HIDDEN(zebra_kernel_netlink_batch_inflight,
+	     zebra_kernel_netlink_batch_inflight_cmd,
+	     "[no] zebra kernel netlink batch-inflight (0-1000000)",
+	     NO_STR ZEBRA_STR
+	     "Zebra kernel interface\n"
+	     "Set Netlink parameters\n"
+	     "Set messages sent before reading the kernel's responses\n"
+	     "Number of messages, 0 to read after every batch\n")
+{
+	netlink_set_batch_inflight(batch_inflight, !no);
+
+	return CMD_SUCCESS;
+}
+
+DEFPY_HIDDEN(zebra_kernel_netlink_route_shards,
+	     zebra_kernel_netlink_route_shards_cmd,
+	     "[no] zebra kernel netlink route-shards (1-16)",
+	     NO_STR ZEBRA_STR
+	     "Zebra kernel interface\n"
+	     "Set Netlink parameters\n"
+	     "Set pthreads sending route updates, split by table\n"
+	     "Number of pthreads, including the dplane pthread\n")
+{
+	netlink_set_route_shards(route_shards, !no);
+
+	return CMD_SUCCESS;
+}
+
 DEFPY (zebra_protodown_bit,
        zebra_protodown_bit_cmd,
        "zebra protodown reason-bit (0-31)$bit",
@@ -4381,6 +4480,7 @@ void zebra_vty_init(void)
 	install_element(CONFIG_NODE, &no_ip_multicast_mode_cmd);
 
 	install_element(CONFIG_NODE, &zebra_nexthop_group_keep_cmd);
+	install_element(CONFIG_NODE, &zebra_route_queue_table_quantum_cmd);
 	install_element(CONFIG_NODE, &ip_zebra_import_table_distance_cmd);
 	install_element(CONFIG_NODE, &no_ip_zebra_import_table_cmd);
 	install_element(CONFIG_NODE, &zebra_workqueue_timer_cmd);
@@ -4392,6 +4492,7 @@ void zebra_vty_init(void)
 	install_element(CONFIG_NODE, &backup_nexthop_recursive_use_enable_cmd);
 
 	install_element(VIEW_NODE, &show_nexthop_group_cmd);
+	install_element(VIEW_NODE, &show_nexthop_group_stats_cmd);
 	install_element(VIEW_NODE, &show_interface_nexthop_group_cmd);
 
 	install_element(VIEW_NODE, &show_vrf_cmd);
@@ -4466,6 +4567,8 @@ void zebra_vty_init(void)
 #ifdef HAVE_NETLINK
 	install_element(CONFIG_NODE, &zebra_kernel_netlink_batch_tx_buf_cmd);
 	install_element(CONFIG_NODE, &no_zebra_kernel_netlink_batch_tx_buf_cmd);
+	install_element(CONFIG_NODE, &zebra_kernel_netlink_batch_inflight_cmd);
+	install_element(CONFIG_NODE, &zebra_kernel_netlink_route_shards_cmd);
 	install_element(CONFIG_NODE, &zebra_protodown_bit_cmd);
 	install_element(CONFIG_NODE, &no_zebra_protodown_bit_cmd);
 #endif /* HAVE_NETLINK */
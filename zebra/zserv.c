@@ -68,6 +68,9 @@ static struct zserv *find_client_internal(uint8_t proto,
 /* Mem type for zclients. */
 DEFINE_MTYPE_STATIC(ZEBRA, ZSERV_CLIENT, "ZClients");
 
+/* Input ring size, "zebra zapi-packets" can be set up to 10000 */
+#define ZSERV_IBUF_RING_SIZE 10000
+
 /*
  * Client thread events.
  *
@@ -307,39 +310,39 @@ zwrite_fail:
  *
  * Any failure in any of these actions is handled by terminating the client.
  *
- * The client's input buffer ibuf_fifo can have a maximum items as configured
- * in the packets_to_process. This way we are not filling up the FIFO more
- * than the maximum when the zebra main is busy. If the fifo has space, we
+ * The client's input ring ibuf_ring can have a maximum items as configured
+ * in the packets_to_process. This way we are not filling up the ring more
+ * than the maximum when the zebra main is busy. If the ring has space, we
  * reschedule ourselves to read more.
  *
- * The main thread processes the items in ibuf_fifo and always signals the
- * client IO thread.
+ * Messages are handed to the main thread through the lock-free ibuf_ring, of
+ * which this pthread is the only producer, as soon as they are read. The main
+ * thread processes the items in ibuf_ring and always signals the client IO
+ * thread.
  */
 static void zserv_read(struct event *thread)
 {
 	struct zserv *client = EVENT_ARG(thread);
 	int sock;
 	size_t already;
-	struct stream_fifo *cache;
 	uint32_t p2p;	    /* Temp p2p used to process */
 	uint32_t p2p_orig;  /* Configured p2p (Default-1000) */
 	int p2p_avail;	    /* How much space is available for p2p */
 	struct zmsghdr hdr;
-	size_t client_ibuf_fifo_cnt = stream_fifo_count_safe(client->ibuf_fifo);
+	size_t client_ibuf_cnt = spsc_ring_count(client->ibuf_ring);
 
 	p2p_orig = atomic_load_explicit(&zrouter.packets_to_process,
 					memory_order_relaxed);
-	p2p_avail = p2p_orig - client_ibuf_fifo_cnt;
+	p2p_avail = p2p_orig - client_ibuf_cnt;
 
     /*
-     * Do nothing if ibuf_fifo count has reached its max limit. Otherwise
-     * proceed and reschedule ourselves if there is space in the ibuf_fifo.
+     * Do nothing if ibuf_ring count has reached its max limit. Otherwise
+     * proceed and reschedule ourselves if there is space in the ibuf_ring.
      */
 	if (p2p_avail <= 0)
 		return;
 
 	p2p = p2p_avail;
-	cache = stream_fifo_new();
 	sock = EVENT_FD(thread);
 
 	while (p2p) {
@@ -434,7 +437,14 @@ static void zserv_read(struct event *thread)
 		stream_set_getp(client->ibuf_work, 0);
 		struct stream *msg = stream_dup(client->ibuf_work);
 
-		stream_fifo_push(cache, msg);
+		/* Publish on client's input ring. This cannot fail unless
+		 * zapi-packets was raised since we checked, in which case the
+		 * message stays in ibuf_work for the next round.
+		 */
+		if (!spsc_ring_push(client->ibuf_ring, msg)) {
+			stream_free(msg);
+			break;
+		}
 		stream_reset(client->ibuf_work);
 		p2p--;
 	}
@@ -448,35 +458,31 @@ static void zserv_read(struct event *thread)
 			client->last_read_cmd = hdr.command;
 		}
 
-		/* publish read packets on client's input queue */
-		frr_with_mutex (&client->ibuf_mtx) {
-			while (cache->head)
-				stream_fifo_push(client->ibuf_fifo,
-						 stream_fifo_pop(cache));
-			/* Need to update count as main thread could have processed few */
-			client_ibuf_fifo_cnt =
-				stream_fifo_count_safe(client->ibuf_fifo);
-		}
+		/* Need to update count as main thread could have processed few */
+		client_ibuf_cnt = spsc_ring_count(client->ibuf_ring);
+		if (client_ibuf_cnt >
+		    atomic_load_explicit(&client->ibuf_max_count,
+					 memory_order_relaxed))
+			atomic_store_explicit(&client->ibuf_max_count,
+					      client_ibuf_cnt,
+					      memory_order_relaxed);
 
 		/* Schedule job to process those packets */
 		zserv_event(client, ZSERV_PROCESS_MESSAGES);
 	}
 
 	if (IS_ZEBRA_DEBUG_PACKET)
-		zlog_debug("Read %d packets from client: %s. Current ibuf fifo count: %zu. Conf P2p %d",
+		zlog_debug("Read %d packets from client: %s. Current ibuf ring count: %zu. Conf P2p %d",
 			   p2p_avail - p2p, zebra_route_string(client->proto),
-			   client_ibuf_fifo_cnt, p2p_orig);
+			   client_ibuf_cnt, p2p_orig);
 
-	/* Reschedule ourselves since we have space in ibuf_fifo */
-	if (client_ibuf_fifo_cnt < p2p_orig)
+	/* Reschedule ourselves since we have space in ibuf_ring */
+	if (client_ibuf_cnt < p2p_orig)
 		zserv_client_event(client, ZSERV_CLIENT_READ);
 
-	stream_fifo_free(cache);
-
 	return;
 
 zread_fail:
-	stream_fifo_free(cache);
 	zserv_client_fail(client);
 }
 
@@ -517,37 +523,39 @@ static void zserv_client_event(struct zserv *client,
  * If the client ibuf always schedules a wakeup to the client IO to read more
  * items from the socked buffer. This way we ensure
  *  - Client IO thread always tries to read the socket buffer and add more
- *    items to the ibuf_fifo (until max limit)
+ *    items to the ibuf_ring (until max limit)
  *  - the hidden config change (zebra zapi-packets <>) is taken into account.
  */
 static void zserv_process_messages(struct event *thread)
 {
 	struct zserv *client = EVENT_ARG(thread);
 	struct stream *msg;
-	struct stream_fifo *cache = stream_fifo_new();
+	struct stream_fifo cache;
 	uint32_t p2p = zrouter.packets_to_process;
 	bool need_resched = false;
+	uint32_t i;
 
-	frr_with_mutex (&client->ibuf_mtx) {
-		uint32_t i;
-		for (i = 0; i < p2p && stream_fifo_head(client->ibuf_fifo);
-		     ++i) {
-			msg = stream_fifo_pop(client->ibuf_fifo);
-			stream_fifo_push(cache, msg);
-		}
+	stream_fifo_init(&cache);
 
-		/* Need to reschedule processing work if there are still
-		 * packets in the fifo.
-		 */
-		if (stream_fifo_head(client->ibuf_fifo))
-			need_resched = true;
+	/* This is the only consumer of ibuf_ring, no locking needed */
+	for (i = 0; i < p2p; ++i) {
+		msg = spsc_ring_pop(client->ibuf_ring);
+		if (!msg)
+			break;
+		stream_fifo_push(&cache, msg);
 	}
 
+	/* Need to reschedule processing work if there are still
+	 * packets in the ring.
+	 */
+	if (i == p2p && spsc_ring_count(client->ibuf_ring))
+		need_resched = true;
+
 	/* Process the batch of messages */
-	if (stream_fifo_head(cache))
-		zserv_handle_commands(client, cache);
+	if (stream_fifo_head(&cache))
+		zserv_handle_commands(client, &cache);
 
-	stream_fifo_free(cache);
+	stream_fifo_deinit(&cache);
 
 	/* Reschedule ourselves if necessary */
 	if (need_resched)
@@ -647,8 +655,13 @@ static void zserv_client_free(struct zserv *client)
 		stream_free(client->ibuf_work);
 	if (client->obuf_work)
 		stream_free(client->obuf_work);
-	if (client->ibuf_fifo)
-		stream_fifo_free(client->ibuf_fifo);
+	if (client->ibuf_ring) {
+		struct stream *msg;
+
+		while ((msg = spsc_ring_pop(client->ibuf_ring)))
+			stream_free(msg);
+		spsc_ring_free(&client->ibuf_ring);
+	}
 	if (client->obuf_fifo)
 		stream_fifo_free(client->obuf_fifo);
 	if (client->wb)
@@ -657,7 +670,6 @@ static void zserv_client_free(struct zserv *client)
 	/* Free buffer mutexes */
 	pthread_mutex_destroy(&client->stats_mtx);
 	pthread_mutex_destroy(&client->obuf_mtx);
-	pthread_mutex_destroy(&client->ibuf_mtx);
 
 	/* Free bitmaps. */
 	for (afi_t afi = AFI_IP; afi < AFI_MAX; afi++) {
@@ -776,12 +788,11 @@ static struct zserv *zserv_client_create(int sock)
 
 	/* Make client input/output buffer. */
 	client->sock = sock;
-	client->ibuf_fifo = stream_fifo_new();
+	client->ibuf_ring = spsc_ring_new(ZSERV_IBUF_RING_SIZE);
 	client->obuf_fifo = stream_fifo_new();
 	client->ibuf_work = stream_new(stream_size);
 	client->obuf_work = stream_new(stream_size);
 	client->connect_time = monotime(NULL);
-	pthread_mutex_init(&client->ibuf_mtx, NULL);
 	pthread_mutex_init(&client->obuf_mtx, NULL);
 	pthread_mutex_init(&client->stats_mtx, NULL);
 	client->wb = buffer_new(0);
@@ -1126,7 +1137,9 @@ static void zebra_show_client_detail(struct vty *vty, struct zserv *client)
 		client->local_es_evi_add_cnt, 0, client->local_es_evi_del_cnt);
 	vty_out(vty, "Errors: %u\n", client->error_cnt);
 	vty_out(vty, "Input Fifo: %zu:%zu Output Fifo: %zu:%zu\n",
-		client->ibuf_fifo->count, client->ibuf_fifo->max_count,
+		spsc_ring_count(client->ibuf_ring),
+		atomic_load_explicit(&client->ibuf_max_count,
+				     memory_order_relaxed),
 		client->obuf_fifo->count, client->obuf_fifo->max_count);
 
 	vty_out(vty, "\n");
@@ -19,6 +19,7 @@
 #include "lib/vrf.h"          /* for vrf_bitmap_t */
 #include "lib/zclient.h"      /* for redist_proto */
 #include "lib/stream.h"       /* for stream, stream_fifo */
+#include "lib/spsc_ring.h"    /* for spsc_ring */
 #include "frrevent.h"            /* for thread, thread_master */
 #include "lib/linklist.h"     /* for list */
 #include "lib/workqueue.h"    /* for work_queue */
@@ -84,9 +85,11 @@ struct zserv {
 	int busy_count;
 	bool is_closed;
 
-	/* Input/output buffer to the client. */
-	pthread_mutex_t ibuf_mtx;
-	struct stream_fifo *ibuf_fifo;
+	/* Input/output buffer to the client. The input side only ever has
+	 * the client pthread as producer and the main pthread as consumer.
+	 */
+	struct spsc_ring *ibuf_ring;
+	atomic_size_t ibuf_max_count;
 	pthread_mutex_t obuf_mtx;
 	struct stream_fifo *obuf_fifo;
 